@@ -0,0 +1,387 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "kws_bench.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Verilator bench of wrap_TsetlinKWS.
+//
+//==============================================================================
+
+#include "kws_bench.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "fe_model.h"
+#include "ogbcsr.h"
+#include "verilated.h"
+#include "verilated_save.h"
+#include "Vwrap_TsetlinKWS.h"
+#include "Vwrap_TsetlinKWS___024root.h"
+
+// Internal signals probed by the testbench (public_flat_rd in
+// wrap_TsetlinKWS_tb.vlt), e.g. DUT(feature_extractor_inst__DOT__fe_complete).
+#define DUT(sig)    rootp->wrap_TsetlinKWS__DOT__TsetlinKWS_inst__DOT__##sig
+#define FE(sig)     DUT(feature_extractor_inst__DOT__##sig)
+#define TMA(sig)    DUT(tsetlin_machine_accelerator_inst__DOT__##sig)
+
+namespace {
+
+// Element type and depth of a Verilator unpacked array (VlUnpacked holds
+// only its elements).
+template <typename T>
+using element_t = std::remove_reference_t<decltype(std::declval<T &>()[0])>;
+
+template <typename T>
+constexpr size_t depth()
+{
+    return sizeof(T) / sizeof(element_t<T>);
+}
+
+#define TMA_TYPE(sig) \
+    decltype(std::declval<Vwrap_TsetlinKWS___024root &>().wrap_TsetlinKWS__DOT__TsetlinKWS_inst__DOT__tsetlin_machine_accelerator_inst__DOT__##sig)
+
+// The backdoor indexes the banks with the -DTKWS_* parameters of the
+// models; -G parameters that differ would write past them.
+using RowCntBank    = TMA_TYPE(mem_row_cnt_bank_inst__DOT__row_cnt_bank);
+using CclBank       = TMA_TYPE(mem_col_clause_idx_bank_inst__DOT__col_clause_idx_bank);
+using ClassRowStart = TMA_TYPE(ogbcsr_decoder_inst__DOT__class_row_start);
+static_assert(depth<RowCntBank>() == tkws::N_PE_COL && depth<CclBank>() == tkws::N_PE_COL &&
+              depth<element_t<ClassRowStart>>() == tkws::N_PE_COL,
+              "-GN_PE_COL differs from -DTKWS_N_PE_COL");
+static_assert(depth<element_t<CclBank>>() == tkws::DEPTH_CCL_BANK / tkws::N_CCL_WORD,
+              "-GN_CCL_WORD differs from -DTKWS_N_CCL_WORD");
+
+#undef TMA_TYPE
+
+} // namespace
+
+namespace tkws {
+
+KwsBench::KwsBench()
+    : ctx_(new VerilatedContext), top_(new Vwrap_TsetlinKWS(ctx_.get(), "TOP"))
+{
+    top_->MCLK      = 0;
+    top_->sys_clk   = 0;
+    top_->rst_n     = 1;
+    top_->CS        = 1;
+    top_->SCK       = 0;
+    top_->MOSI      = 0;
+    top_->ADC_SDATA = 0;
+    top_->eval();
+}
+
+KwsBench::~KwsBench()
+{
+    top_->final();
+}
+
+void KwsBench::advance(uint64_t ps)
+{
+    const uint64_t end = time_ + ps;
+
+    for (;;) {
+        uint64_t t = std::min(next_mclk_, next_sys_clk_);
+        if (t >= end)
+            break;
+        time_ = t;
+        ctx_->time(t);
+
+        if (t == next_mclk_) {
+            top_->MCLK = !top_->MCLK;
+            top_->eval();
+            next_mclk_ += MCLK_HALF_PS;
+        }
+        if (t == next_sys_clk_) {
+            if (top_->sys_clk) {
+                top_->sys_clk = 0;
+                top_->eval();
+            } else {
+                sys_clk_posedge();
+            }
+            next_sys_clk_ += SYS_CLK_HALF_PS;
+        }
+    }
+    time_ = end;
+    ctx_->time(end);
+}
+
+void KwsBench::sys_clk_posedge()
+{
+    // Sample the registered signals before the edge, like the always
+    // blocks of the testbench.
+    const bool     fe_window_done = top_->FE(fe_window_done);
+    const bool     fe_complete  = top_->FE(fe_complete);
+    const bool     decode_en    = top_->TMA(decode_en);
+    const bool     busy         = decode_en || top_->TMA(tail_flush_en);
+    const bool     argmax_ena   = top_->TMA(argmax_ena);
+    const int16_t  class_sum    = (int16_t)(top_->TMA(class_summation) << 2) >> 2;    // 14-bit signed
+    const bool     inf_done     = top_->Inf_Done;
+    const int      result       = top_->Result;
+
+    top_->sys_clk = 1;
+    top_->eval();
+
+    if (!mon_ || inf_done_)
+        return;
+
+    // The bank handed to the accelerator, one cycle after fe_complete rises
+    if (fe_complete && !window_done_) {
+        const int bank = !top_->FE(feature_module_inst__DOT__fe_bank_wsel);
+        for (int r = 0; r < N_ROW; r++)
+            mon_->window[r] = top_->FE(feature_module_inst__DOT__feature_bank)[bank][r];
+        mon_->fe_latency = fe_window_done ? 0 : fe_wait_;
+        window_done_ = true;
+    }
+    fe_wait_ = fe_window_done ? 1 : fe_wait_ + 1;
+    if (!window_done_) {
+        // A window the VAD gate finds silent raises Inf_Done alone.
+        if (inf_done) {
+            mon_->result = result;
+            inf_done_ = true;
+        }
+        return;
+    }
+
+    if (argmax_ena)
+        mon_->class_sum.push_back(class_sum);
+    if (inf_done) {
+        mon_->result = result;
+        inf_done_ = true;
+    } else if (busy) {
+        mon_->inf_cycle++;
+        mon_->decode_cycle += decode_en;
+    }
+}
+
+void KwsBench::reset()
+{
+    top_->rst_n = 1;
+    top_->eval();
+    advance(10000);
+    top_->rst_n = 0;
+    top_->eval();
+    advance(30000);
+    top_->rst_n = 1;
+    top_->eval();
+
+    // two cycles for the reset synchronizers
+    advance(450000);
+    advance(I2S_SLOT_PS);
+}
+
+void KwsBench::spi_transaction(const std::vector<uint32_t> &words)
+{
+    top_->CS = 0;
+    top_->eval();
+    advance(CS_SETUP_PS);
+
+    for (uint32_t w : words) {
+        for (int b = 31; b >= 0; b--) {
+            top_->MOSI = (w >> b) & 1;
+            top_->eval();
+            advance(SCK_HALF_PS);
+            top_->SCK = 1;
+            top_->eval();
+            advance(SCK_HALF_PS);
+            top_->SCK = 0;
+            top_->eval();
+        }
+    }
+
+    advance(CS_SETUP_PS);
+    top_->CS = 1;
+    top_->eval();
+}
+
+std::vector<uint32_t> KwsBench::spi_read(uint32_t cmd_word, size_t n)
+{
+    std::vector<uint32_t> words;
+
+    top_->CS = 0;
+    top_->eval();
+    advance(CS_SETUP_PS);
+
+    for (size_t i = 0; i < n + 2; i++) {
+        const uint32_t w = i ? 0 : cmd_word;
+        uint32_t miso = 0;
+        for (int b = 31; b >= 0; b--) {
+            top_->MOSI = (w >> b) & 1;
+            top_->eval();
+            advance(SCK_HALF_PS);
+            miso = miso << 1 | top_->MISO;
+            top_->SCK = 1;
+            top_->eval();
+            advance(SCK_HALF_PS);
+            top_->SCK = 0;
+            top_->eval();
+        }
+        if (i >= 2)
+            words.push_back(miso);
+    }
+
+    advance(CS_SETUP_PS);
+    top_->CS = 1;
+    top_->eval();
+    return words;
+}
+
+void KwsBench::enable_inference()
+{
+    spi_transaction({spi_write_word(SPI_CMD_CONF_REG, 0, 1, 1), 1});
+
+    // wait for the synchronized spi_en_inf
+    advance(2 * I2S_SLOT_PS + 800000 + 22460000);
+}
+
+void KwsBench::load_model(const ModelImage &image, bool pack)
+{
+    for (const std::vector<uint32_t> &trans : spi_load_transactions(image, pack)) {
+        spi_transaction(trans);
+        advance(CS_IDLE_PS);
+    }
+    enable_inference();
+}
+
+void KwsBench::preload_model(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+
+    for (uint32_t i = 0; i < conf.len_block_bank; i++)
+        top_->TMA(mem_block_idx_bank_inst__DOT__block_idx_bank)[i] = image.block_idx[i];
+    for (int k = 0; k < N_PE_COL; k++) {
+        for (uint32_t i = 0; i < conf.len_row_bank[k]; i++)
+            top_->TMA(mem_row_cnt_bank_inst__DOT__row_cnt_bank)[k][i] = image.row_cnt[k][i];
+        for (uint32_t i = 0; i < conf.len_ccl_bank[k]; i++) {
+            auto &line = top_->TMA(mem_col_clause_idx_bank_inst__DOT__col_clause_idx_bank)[k][i / N_CCL_WORD];
+            const int shift = CCL_IDX_BITS * (i % N_CCL_WORD);
+            line = (line & ~(0x1Fu << shift)) | ((uint32_t)image.col_clause_idx[k][i] << shift);
+        }
+    }
+    for (uint32_t i = 0; i < conf.len_weight_bank; i++)
+        top_->TMA(mem_weight_bank_inst__DOT__weight_bank)[i] = (uint32_t)image.weight[i] & 0x1FF;
+    std::vector<ClassStart> start = class_starts(image);
+    for (size_t c = 0; c < start.size(); c++) {
+        for (int k = 0; k < N_PE_COL; k++) {
+            top_->TMA(ogbcsr_decoder_inst__DOT__class_row_start)[c][k] = start[c].row[k];
+            top_->TMA(ogbcsr_decoder_inst__DOT__class_ccl_start)[c][k] = start[c].ccl[k];
+        }
+    }
+    if (conf.en_early_exit) {
+        std::vector<int16_t> bound = class_bounds(image);
+        for (size_t c = 0; c < bound.size(); c++)
+            top_->TMA(argmax_inst__DOT__class_bound)[c] = (uint32_t)bound[c] & 0x3FFF;
+    }
+    top_->eval();
+
+    spi_transaction(spi_config_words(conf));
+    advance(CS_IDLE_PS);
+    enable_inference();
+}
+
+size_t KwsBench::check_banks(const ModelImage &image) const
+{
+    const SpiConfig &conf = image.conf;
+    size_t n_diff = 0;
+
+    for (uint32_t i = 0; i < conf.len_block_bank; i++)
+        n_diff += top_->TMA(mem_block_idx_bank_inst__DOT__block_idx_bank)[i] != image.block_idx[i];
+    for (int k = 0; k < N_PE_COL; k++) {
+        for (uint32_t i = 0; i < conf.len_row_bank[k]; i++)
+            n_diff += top_->TMA(mem_row_cnt_bank_inst__DOT__row_cnt_bank)[k][i] != image.row_cnt[k][i];
+        for (uint32_t i = 0; i < conf.len_ccl_bank[k]; i++) {
+            uint32_t line = top_->TMA(mem_col_clause_idx_bank_inst__DOT__col_clause_idx_bank)[k][i / N_CCL_WORD];
+            n_diff += ((line >> (CCL_IDX_BITS * (i % N_CCL_WORD))) & 0x1F) != image.col_clause_idx[k][i];
+        }
+    }
+    for (uint32_t i = 0; i < conf.len_weight_bank; i++)
+        n_diff += top_->TMA(mem_weight_bank_inst__DOT__weight_bank)[i] != ((uint32_t)image.weight[i] & 0x1FF);
+    std::vector<ClassStart> start = class_starts(image);
+    for (size_t c = 0; c < start.size(); c++) {
+        for (int k = 0; k < N_PE_COL; k++) {
+            n_diff += top_->TMA(ogbcsr_decoder_inst__DOT__class_row_start)[c][k] != start[c].row[k];
+            n_diff += top_->TMA(ogbcsr_decoder_inst__DOT__class_ccl_start)[c][k] != start[c].ccl[k];
+        }
+    }
+    if (conf.en_early_exit) {
+        std::vector<int16_t> bound = class_bounds(image);
+        for (size_t c = 0; c < bound.size(); c++)
+            n_diff += top_->TMA(argmax_inst__DOT__class_bound)[c] != ((uint32_t)bound[c] & 0x3FFF);
+    }
+    return n_diff;
+}
+
+void KwsBench::save(const std::string &file_name)
+{
+    VerilatedSave os;
+    os.open(file_name.c_str());
+    if (!os.isOpen())
+        throw std::runtime_error("Failed to create file: " + file_name);
+    os << time_ << next_mclk_ << next_sys_clk_;
+    os << *top_;
+}
+
+void KwsBench::restore(const std::string &file_name)
+{
+    VerilatedRestore os;
+    os.open(file_name.c_str());
+    if (!os.isOpen())
+        throw std::runtime_error("Failed to open file: " + file_name);
+    os >> time_ >> next_mclk_ >> next_sys_clk_;
+    os >> *top_;
+    ctx_->time(time_);
+}
+
+void KwsBench::send_sample(int16_t sample)
+{
+    // Bit slots 1-12 of the 64 carry the 12-bit sample, MSB first.
+    for (int k = 0; k < 64; k++) {
+        top_->ADC_SDATA = (k >= 1 && k <= AUDIO_BIT_WIDTH) ? (sample >> (AUDIO_BIT_WIDTH - k)) & 1 : 0;
+        top_->eval();
+        advance(I2S_SLOT_PS);
+    }
+}
+
+BenchResult KwsBench::run_clip(const int16_t *audio, size_t n, size_t max_silence)
+{
+    BenchResult res;
+
+    mon_ = &res;
+    window_done_ = false;
+    inf_done_ = false;
+    fe_wait_ = 0;
+
+    for (size_t i = 0; i < n && !inf_done_; i++, res.n_sample++)
+        send_sample(audio[i]);
+    for (size_t i = 0; i < max_silence && !inf_done_; i++, res.n_sample++)
+        send_sample(0);
+
+    mon_ = nullptr;
+    if (!inf_done_)
+        throw std::runtime_error("No Inf_Done within " + std::to_string(max_silence) + " samples after the clip");
+    return res;
+}
+
+} // namespace tkws
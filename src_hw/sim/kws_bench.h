@@ -0,0 +1,138 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "kws_bench.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Verilator bench of wrap_TsetlinKWS. Drives the pins with the same
+//       timing as wrap_TsetlinKWS_tb.sv (reset, SPI model load, I2S audio)
+//       and records the feature window, class sums, result and cycle count
+//       of the first inference. Every bench owns its VerilatedContext, so
+//       benches on different threads are independent simulations.
+//
+//       The model banks can also be preloaded through a backdoor, and a
+//       loaded bench saved to a checkpoint that other benches restore
+//       (verilator --savable).
+//
+//==============================================================================
+
+#ifndef __KWS_BENCH_H
+#define __KWS_BENCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model_image.h"
+
+class VerilatedContext;
+class Vwrap_TsetlinKWS;
+
+namespace tkws {
+
+// Pin timing of wrap_TsetlinKWS_tb.sv, in ps.
+constexpr uint64_t MCLK_HALF_PS     = 61035;        // 8.192 MHz
+constexpr uint64_t SYS_CLK_HALF_PS  = 1250000;      // 400 kHz
+constexpr uint64_t SCK_HALF_PS      = 5120000;
+constexpr uint64_t CS_SETUP_PS      = 3000000;      // CS low to first SCK, last SCK to CS high
+constexpr uint64_t CS_IDLE_PS       = 10000000;     // CS high between transactions
+constexpr uint64_t I2S_SLOT_PS      = 976560;       // one BCLK period, 64 per sample
+
+struct BenchResult {
+    FeatureWindow           window{};       // feature_bank after the first fe_complete, none if silent
+    std::vector<int16_t>    class_sum;      // class_summation at every argmax_ena
+    int                     result = -1;    // Result at Inf_Done
+    uint64_t                inf_cycle = 0;  // decode_en or tail_flush_en cycles
+    uint64_t                decode_cycle = 0;
+    uint64_t                fe_latency = 0; // fe_window_done to fe_complete of the window
+    uint64_t                n_sample = 0;   // I2S samples sent
+};
+
+class KwsBench {
+public:
+    KwsBench();
+    ~KwsBench();
+
+    KwsBench(const KwsBench &) = delete;
+    KwsBench &operator=(const KwsBench &) = delete;
+
+    // Simulated time in ps.
+    uint64_t time_ps() const { return time_; }
+
+    // Reset sequence of the testbench, including the wait for the reset
+    // synchronizers.
+    void reset();
+
+    // One SPI transaction: CS low, the words MSB first, CS high.
+    void spi_transaction(const std::vector<uint32_t> &words);
+
+    // One SPI read burst: the command word (spi_read_word()), the
+    // turnaround frame, then n words sampled from MISO.
+    std::vector<uint32_t> spi_read(uint32_t cmd_word, size_t n);
+
+    // Load every bank and configuration register over SPI, set EN_INF and
+    // wait for the synchronized enable, as the testbench does. With pack,
+    // the narrow banks go as packed bursts, as in the firmware.
+    void load_model(const ModelImage &image, bool pack);
+
+    // Same end state as load_model(), but the SRAM banks, the class start
+    // table (and the early exit class bounds) are written directly; only the
+    // configuration registers and EN_INF go over SPI.
+    void preload_model(const ModelImage &image);
+
+    // Number of bank words that differ from the image, e.g. after an SPI load.
+    size_t check_banks(const ModelImage &image) const;
+
+    // Save the simulation state to a checkpoint file, or restore it into a
+    // freshly constructed bench of the same Verilator build.
+    void save(const std::string &file_name);
+    void restore(const std::string &file_name);
+
+    // Send audio samples over I2S until the first Inf_Done: the clip, then
+    // silence. Throws if no inference completes within max_silence samples
+    // after the clip. Call once, after load_model().
+    BenchResult run_clip(const int16_t *audio, size_t n, size_t max_silence);
+
+private:
+    // Advance the clocks to time_ + ps, evaluating the model at every edge.
+    void advance(uint64_t ps);
+    void sys_clk_posedge();
+    void enable_inference();
+    void send_sample(int16_t sample);
+
+    std::unique_ptr<VerilatedContext>   ctx_;
+    std::unique_ptr<Vwrap_TsetlinKWS>   top_;
+
+    uint64_t                            time_ = 0;
+    uint64_t                            next_mclk_ = MCLK_HALF_PS;
+    uint64_t                            next_sys_clk_ = SYS_CLK_HALF_PS;
+
+    // Monitors, sampled at sys_clk posedges.
+    BenchResult                        *mon_ = nullptr;
+    bool                                window_done_ = false;
+    bool                                inf_done_ = false;
+    uint64_t                            fe_wait_ = 0;   // cycles since fe_window_done
+};
+
+} // namespace tkws
+
+#endif
@@ -0,0 +1,193 @@
+#!/bin/bash
+#==============================================================================
+# Copyright (c) 2024-2025 Baizhou Lin
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#==============================================================================
+#
+# Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+#
+# Module: "tkws_regress.sh"
+#
+# Author: Baizhou Lin, University of Southampton
+#
+# Desc: Parameter regression of the Verilator bench (wrap_TsetlinKWS_tb.cpp).
+#       Builds the bench for every RTL parameter set below and runs the
+#       clips through it: the default build, N_CCL_WORD 2 and 4,
+#       DEPTH_BLOCK_FIFO 2 and 8, and N_PE_COL 4 and 8. Every build runs
+#       the clips with the SPI load of the first clip and the checkpoint for
+#       the others, with SPI_CLASS_SKIP, with the early exit, and with the
+#       voice activity gate at SPI_VAD_TH 1 (every window passes) and 4095
+#       (every window is silent and reports SPI_VAD_CLASS). The
+#       default build also runs every clip over SPI, packed and unpacked, so
+#       the checkpoint results can be compared with the SPI ones; the
+#       unpacked run reads every bank word back over MISO.
+#
+#       SPI_CLASS_SKIP runs with two masks: classes 4 to 7, and the first and
+#       last class (the decoder pointers then jump to the middle of a CCL
+#       line, and past the end of the banks). Before the bench, tkws_perf is
+#       built for every parameter set and run with and without each mask and
+#       the early exit, so the host part of the regression also runs where
+#       Verilator is not installed.
+#
+#       The bench checks every clip against the CTM, feature extractor and
+#       cycle-level models built for the same parameters, so a run passes
+#       when the RTL matches tkws_infer and tkws_perf.
+#
+#       The 4-column model is built from the first 8 classes of the shipped
+#       model: on 4 columns, the 12-class row count banks do not fit in
+#       DEPTH_ROW_BANK. The 8-column model holds all 12 classes.
+#
+#       Run from the repository root. The builds and logs go to obj_regress
+#       (OUT=dir to change), and JOBS=n sets the threads of every bench run
+#       (default: all cores). The exit status is non-zero if any run fails.
+#
+#       Usage: src_hw/sim/tkws_regress.sh [clip.wav|audio.csv ...]
+#
+#==============================================================================
+
+set -u
+
+OUT=$(realpath -m "${OUT:-obj_regress}")
+JOBS=${JOBS:-0}
+if [ $# -gt 0 ]; then
+    CLIPS=("$@")
+else
+    CLIPS=(src_hw/sim/audio_data.csv src_hw/sim/0yes.wav)
+fi
+
+# SPI_CLASS_SKIP masks: classes 4-7, and the first and last class of the
+# 12-class models (the 4-column model has 8, so 0x801 leaves its last one).
+SKIP=(0x0F0 0x801)
+
+mkdir -p "$OUT"
+N_FAIL=0
+SUMMARY=()
+
+# Host compressor for n columns.
+build_ogbcsr() {
+    g++ -std=c++17 -O2 -march=native -DTKWS_N_PE_COL="$1" -o "$OUT/tkws_ogbcsr_$1" \
+        src_model/tkws_ogbcsr.cpp src_model/ctm_model.cpp src_model/ogbcsr.cpp src_model/model_image.cpp
+}
+
+# build_model <N_PE_COL> <n_class> <n_sum_time> <dir>: the first n_class
+# classes of the shipped model, compressed for N_PE_COL columns.
+build_model() {
+    local n_pe_col=$1 n_class=$2 n_sum_time=$3 dir=$4
+    build_ogbcsr "$n_pe_col" || return 1
+    {
+        echo "// TA include list: $n_class classes x 120 clauses"
+        grep -v '^//' "$OUT/ta_include.txt" | head -n $((n_class * 120))
+    } > "$OUT/ta_include_$n_class.txt"
+    mkdir -p "$dir"
+    "$OUT/tkws_ogbcsr_$n_pe_col" -i "$OUT/ta_include_$n_class.txt" -k "$n_class" -s "$n_sum_time" -o "$dir" > /dev/null
+}
+
+# build <name> <N_PE_COL> <N_CCL_WORD> <DEPTH_BLOCK_FIFO>
+build() {
+    local name=$1 n_pe_col=$2 n_ccl_word=$3 depth=$4
+    echo "== build $name: N_PE_COL $n_pe_col, N_CCL_WORD $n_ccl_word, DEPTH_BLOCK_FIFO $depth"
+    verilator --cc --exe --build -j 0 -O3 --savable -Wno-fatal --top-module wrap_TsetlinKWS \
+        -Mdir "$OUT/obj_$name" -o wrap_TsetlinKWS_tb \
+        -GN_PE_COL="$n_pe_col" -GN_CCL_WORD="$n_ccl_word" -GDEPTH_BLOCK_FIFO="$depth" \
+        -CFLAGS "-O2 -march=native -I$PWD/src_model -DTKWS_N_PE_COL=$n_pe_col -DTKWS_N_CCL_WORD=$n_ccl_word -DTKWS_DEPTH_BLOCK_FIFO=$depth" \
+        -LDFLAGS -pthread \
+        src_hw/src/DFCND1.sv src_hw/src/feature_extractor/*.sv src_hw/src/feature_extractor/i2s_master.v \
+        src_hw/src/tsetlin_machine_accelerator/*.sv src_hw/src/TsetlinKWS.sv src_hw/src/wrap_TsetlinKWS.v \
+        src_hw/sim/wrap_TsetlinKWS_tb.vlt src_hw/sim/wrap_TsetlinKWS_tb.cpp src_hw/sim/kws_bench.cpp \
+        src_model/perf_model.cpp src_model/fe_model.cpp src_model/ctm_model.cpp src_model/ogbcsr.cpp \
+        src_model/model_image.cpp src_model/work_pool.cpp > "$OUT/build_$name.log" 2>&1
+}
+
+# run <name> <tag> <model_dir> [bench options]
+run() {
+    local name=$1 tag=$2 model=$3
+    shift 3
+    local log="$OUT/run_${name}_$tag.log"
+    echo "== run $name $tag: $*"
+    if "$OUT/obj_$name/wrap_TsetlinKWS_tb" -m "$model" -j "$JOBS" -l 101 "$@" "${CLIPS[@]}" > "$log" 2>&1; then
+        SUMMARY+=("pass  $name $tag")
+    else
+        SUMMARY+=("FAIL  $name $tag ($log)")
+        N_FAIL=$((N_FAIL + 1))
+    fi
+    grep -E "clips pass|per clip" "$log"
+}
+
+# perf <name> <N_PE_COL> <N_CCL_WORD> <DEPTH_BLOCK_FIFO> <model_dir>: the
+# cycle-level model against the CTM model, with every skip mask.
+perf() {
+    local name=$1 model=$5
+    local bin="$OUT/tkws_perf_$name"
+    if ! g++ -std=c++17 -O2 -march=native -DTKWS_N_PE_COL="$2" -DTKWS_N_CCL_WORD="$3" -DTKWS_DEPTH_BLOCK_FIFO="$4" \
+            -o "$bin" src_model/tkws_perf.cpp src_model/perf_model.cpp src_model/ctm_model.cpp \
+            src_model/ogbcsr.cpp src_model/model_image.cpp; then
+        SUMMARY+=("FAIL  $name tkws_perf build")
+        N_FAIL=$((N_FAIL + 1))
+        return
+    fi
+    local skip early log
+    for skip in 0 "${SKIP[@]}"; do
+        for early in "" -e; do
+            log="$OUT/perf_${name}_${skip}${early}.log"
+            if "$bin" -m "$model" -k "$skip" $early src_hw/sim/mfcc_binary.csv > "$log" 2>&1; then
+                SUMMARY+=("pass  $name tkws_perf -k $skip $early")
+            else
+                SUMMARY+=("FAIL  $name tkws_perf -k $skip $early ($log)")
+                N_FAIL=$((N_FAIL + 1))
+            fi
+        done
+    done
+    echo "== perf $name: $(grep -m1 '^inference' "$OUT/perf_${name}_0.log")"
+}
+
+# regress <name> <N_PE_COL> <N_CCL_WORD> <DEPTH_BLOCK_FIFO> <model_dir>
+regress() {
+    local name=$1 model=$5 skip
+    perf "$@"
+    if ! build "$1" "$2" "$3" "$4"; then
+        SUMMARY+=("FAIL  $name build ($OUT/build_$name.log)")
+        N_FAIL=$((N_FAIL + 1))
+        return
+    fi
+    run "$name" ckpt  "$model"
+    for skip in "${SKIP[@]}"; do
+        run "$name" "skip_$skip" "$model" -k "$skip"
+    done
+    run "$name" early "$model" -e
+    run "$name" vad_pass   "$model" -v 1
+    run "$name" vad_silent "$model" -v 4095
+}
+
+{ build_ogbcsr 5 && "$OUT/tkws_ogbcsr_5" -m model -x "$OUT/ta_include.txt" > /dev/null; } ||
+    { echo "Error: failed to export the TA include list of model"; exit 1; }
+build_model 4 8 4 "$OUT/model_4col" || { echo "Error: failed to build the 4-column model"; exit 1; }
+build_model 8 12 2 "$OUT/model_8col" || { echo "Error: failed to build the 8-column model"; exit 1; }
+
+regress base    5 1 4 model
+if [ -x "$OUT/obj_base/wrap_TsetlinKWS_tb" ]; then
+    run base spi        model -s ${#CLIPS[@]} -r
+    run base spi_packed model -s ${#CLIPS[@]} -p
+fi
+regress ccl2    5 2 4 model
+regress ccl4    5 4 4 model
+regress fifo2   5 1 2 model
+regress fifo8   5 1 8 model
+regress col4    4 1 4 "$OUT/model_4col"
+regress col8    8 1 4 "$OUT/model_8col"
+
+echo
+printf '%s\n' "${SUMMARY[@]}"
+echo "$N_FAIL failed"
+[ "$N_FAIL" -eq 0 ]
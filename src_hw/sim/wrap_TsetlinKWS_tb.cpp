@@ -0,0 +1,463 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "wrap_TsetlinKWS_tb.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Verilator port of wrap_TsetlinKWS_tb.sv for multi-clip regression.
+//       Every clip is an independent simulation (reset, SPI model load, I2S
+//       audio until the first Inf_Done), and the clips run in parallel on
+//       a thread pool. The feature window, class sums and result of every
+//       clip are checked against the golden models, and the inference
+//       cycles against the cycle-level model. The exit status is non-zero
+//       if any clip fails.
+//
+//       The first n_spi clips (default 1) load the model over SPI and check
+//       the banks afterwards, to keep the real load path covered; -p sends
+//       the narrow banks as packed bursts, as the firmware does. They also
+//       read the configuration registers and the first words of every bank
+//       back over MISO, or every bank word with -r. The other
+//       clips restore a checkpoint saved once after a backdoor preload,
+//       which skips the ~8.6 s of simulated SPI load. Every clip prints
+//       its wall time, and the summary the mean per clip of both paths.
+//       After every clip, on either path, the bank CRCs are read and
+//       checked against bank_crcs().
+//
+//       -e sets SPI_EN_EARLY_EXIT: the class sums are then checked up to
+//       the deciding class, and the cycles of every clip against the
+//       cycle-level model run on its feature window.
+//
+//       -k sets SPI_CLASS_SKIP (bit c skips class c): only the remaining
+//       classes are summed and compared.
+//
+//       -v sets SPI_VAD_TH: a clip whose first window has fewer flux bits
+//       must report SPI_VAD_CLASS without an inference.
+//
+//       After the clip, the first record of the result FIFO is read over
+//       MISO and checked against the result and class sums seen at the
+//       argmax. The performance counters are read too, and checked against
+//       the cycles seen by the bench and the column, idle and summation
+//       cycles of the cycle-level model, and the status word against the
+//       result.
+//
+//       The twiddle ROMs are read with $readmemh from the working
+//       directory, so the bench changes into the twiddle directory first.
+//
+//       Usage: wrap_TsetlinKWS_tb [-m model_dir] [-t twiddle_dir] [-j n_thread]
+//                                 [-l n_lead] [-s n_spi] [-p] [-r] [-e] [-k skip_mask]
+//                                 [-v vad_th] [-L list.txt]
+//                                 [clip.wav|audio.csv ...]
+//
+//==============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ctm_model.h"
+#include "fe_model.h"
+#include "kws_bench.h"
+#include "perf_model.h"
+#include "work_pool.h"
+
+namespace fs = std::filesystem;
+
+// Silent samples after a clip before giving up on Inf_Done: enough to fill
+// a whole window and finish the inference.
+static const size_t MAX_SILENCE = (tkws::N_FRAME + 2) * tkws::N_FFT + 1024;
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: wrap_TsetlinKWS_tb [-m model_dir] [-t twiddle_dir] [-j n_thread]\n"
+                         "                          [-l n_lead] [-s n_spi] [-p] [-r] [-e] [-k skip_mask]\n"
+                         "                          [-v vad_th] [-L list.txt]\n"
+                         "                          [clip.wav|audio.csv ...]\n");
+}
+
+static std::vector<std::string> read_list(const std::string &list_file)
+{
+    std::ifstream fin(list_file);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + list_file);
+
+    std::vector<std::string> files;
+    std::string line;
+    while (std::getline(fin, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+            line.pop_back();
+        if (!line.empty())
+            files.push_back(line);
+    }
+    return files;
+}
+
+static std::vector<int16_t> read_clip(const std::string &file_name)
+{
+    if (fs::path(file_name).extension() == ".csv")
+        return tkws::read_audio_csv(file_name);
+    return tkws::read_wav(file_name);
+}
+
+// The result FIFO record expected for the first inference: the class sums
+// in class order, -8192 for the classes skipped or left by an early exit.
+static std::string check_record(const tkws::ResultRecord &rec, const tkws::BenchResult &res,
+                                uint32_t num_class, uint32_t class_en)
+{
+    std::vector<int16_t> score(num_class, -8192);
+    for (uint32_t c = 0, k = 0; c < num_class && k < res.class_sum.size(); c++) {
+        if ((class_en >> c) & 1)
+            score[c] = res.class_sum[k++];
+    }
+    int best = -8192, second = -8192;
+    for (int16_t s : res.class_sum) {
+        second = std::max(second, std::min(best, (int)s));
+        best = std::max(best, (int)s);
+    }
+
+    if (!rec.valid)
+        return ", result FIFO is empty";
+    if (rec.num_class != num_class || rec.result != res.result || rec.frame_cnt != 0 ||
+        rec.margin != best - second || rec.score != score)
+        return ", result FIFO record DIFFERS";
+    return "";
+}
+
+// The performance counters of the first inference against the cycle-level
+// model, all zero for a silent window (stats nullptr). The latency of the
+// feature extractor is only seen by the bench.
+static std::string check_perf_counters(const tkws::PerfCounters &cnt, const tkws::BenchResult &res,
+                                       const tkws::PerfStats *stats)
+{
+    if (!cnt.valid)
+        return ", performance counters are empty";
+
+    tkws::PerfCounters gold;
+    gold.valid      = true;
+    gold.n_pe_col   = tkws::N_PE_COL;
+    gold.cycle      = (uint32_t)res.inf_cycle;
+    gold.decode_cycle = (uint32_t)res.decode_cycle;
+    if (stats) {
+        gold.cycle           = (uint32_t)stats->cycle;
+        gold.decode_cycle    = (uint32_t)stats->decode_cycle;
+        gold.summation_cycle = (uint32_t)stats->summation_cycle;
+        gold.fe_latency      = (uint32_t)res.fe_latency;
+        gold.idle_cycle      = (uint32_t)stats->idle_cycle;
+        for (int i = 0; i < tkws::N_PE_COL; i++) {
+            gold.col_busy[i]  = (uint32_t)stats->col_busy[i];
+            gold.col_wait[i]  = (uint32_t)stats->col_wait[i];
+        }
+    }
+    std::string diff;
+    if (cnt.n_pe_col != gold.n_pe_col || cnt.frame_cnt != 0)
+        diff += " header";
+    if (cnt.cycle != gold.cycle)
+        diff += " cycles " + std::to_string(cnt.cycle) + "/" + std::to_string(gold.cycle);
+    if (cnt.decode_cycle != gold.decode_cycle)
+        diff += " decode " + std::to_string(cnt.decode_cycle) + "/" + std::to_string(gold.decode_cycle);
+    if (cnt.summation_cycle != gold.summation_cycle)
+        diff += " summation " + std::to_string(cnt.summation_cycle) + "/" + std::to_string(gold.summation_cycle);
+    if (cnt.fe_latency != gold.fe_latency)
+        diff += " fe_latency " + std::to_string(cnt.fe_latency) + "/" + std::to_string(gold.fe_latency);
+    if (cnt.idle_cycle != gold.idle_cycle)
+        diff += " idle " + std::to_string(cnt.idle_cycle) + "/" + std::to_string(gold.idle_cycle);
+    for (int i = 0; i < tkws::N_PE_COL; i++) {
+        if (cnt.col_busy[i] != gold.col_busy[i] || cnt.col_wait[i] != gold.col_wait[i])
+            diff += " col" + std::to_string(i) + " " + std::to_string(cnt.col_busy[i]) + "/" + std::to_string(gold.col_busy[i]) +
+                    " busy " + std::to_string(cnt.col_wait[i]) + "/" + std::to_string(gold.col_wait[i]) + " wait";
+    }
+    return diff.empty() ? "" : ", performance counters DIFFER (counter/model):" + diff;
+}
+
+// Words of every bank read back over MISO after an SPI load (-r: all), and
+// the longest read burst used for them.
+static const uint32_t READBACK_WORDS = 8;
+static const uint32_t READBACK_BURST = 2048;
+
+// Polls of the status word while the bank CRCs are computed, ~1 ms each.
+static const int CRC_MAX_POLL = 200;
+
+// The configuration registers (EN_INF set by the load) and the first
+// n_word words of every bank, read back after an SPI load.
+static std::string check_readback(tkws::KwsBench &bench, const tkws::ModelImage &image, uint32_t n_word)
+{
+    const tkws::SpiConfig &conf = image.conf;
+    std::string error;
+
+    const uint32_t n_reg = tkws::CONF_ADDR_KWD_HOLDOFF + 1;
+    std::vector<uint32_t> reg = bench.spi_read(tkws::spi_read_word(tkws::SPI_CMD_CONF_REG, 0, n_reg), n_reg);
+    for (uint32_t a = 0; a < n_reg; a++) {
+        if (reg[a] != (a == 1 ? 1 : conf.read_reg(a))) {
+            error += ", configuration register " + std::to_string(a) + " reads back " + std::to_string(reg[a]);
+            break;
+        }
+    }
+
+    auto check_bank = [&](tkws::SpiCmd cmd, uint32_t bank_sel, uint32_t len, auto word) {
+        const uint32_t n = std::min(len, n_word);
+        for (uint32_t a = 0; a < n; a += READBACK_BURST) {
+            const uint32_t n_rd = std::min(n - a, READBACK_BURST);
+            std::vector<uint32_t> rd = bench.spi_read(tkws::spi_read_word(cmd, bank_sel, n_rd, a), n_rd);
+            for (uint32_t i = 0; i < n_rd; i++) {
+                if (rd[i] != word(a + i)) {
+                    error += ", bank " + std::to_string(cmd) + "/" + std::to_string(bank_sel) + " word " +
+                             std::to_string(a + i) + " reads back " + std::to_string(rd[i]) + ", not " +
+                             std::to_string(word(a + i));
+                    return;
+                }
+            }
+        }
+    };
+    check_bank(tkws::SPI_CMD_BLOCK_BANK, 0, conf.len_block_bank, [&](uint32_t i) { return image.block_idx[i]; });
+    for (int k = 0; k < tkws::N_PE_COL; k++) {
+        check_bank(tkws::SPI_CMD_ROW_BANK, k, conf.len_row_bank[k], [&](uint32_t i) { return (uint32_t)image.row_cnt[k][i]; });
+        check_bank(tkws::SPI_CMD_CCL_BANK, k, conf.len_ccl_bank[k], [&](uint32_t i) { return (uint32_t)image.col_clause_idx[k][i]; });
+    }
+    check_bank(tkws::SPI_CMD_WEIGHT_BANK, 0, conf.len_weight_bank, [&](uint32_t i) { return (uint32_t)image.weight[i] & 0x1FF; });
+    return error;
+}
+
+// The bank CRCs, once the walk started by the last bank or configuration
+// register write is done.
+static std::string check_bank_crcs(tkws::KwsBench &bench, const tkws::ModelImage &image)
+{
+    tkws::SpiStatus st;
+    for (int i = 0; i < CRC_MAX_POLL && !st.crc_valid; i++)
+        st = tkws::parse_status(bench.spi_read(tkws::spi_read_word(tkws::SPI_CMD_READ_REG, tkws::SPI_READ_STATUS, 1), 1)[0]);
+    if (!st.crc_valid)
+        return ", bank CRCs not ready";
+    std::vector<uint32_t> crc = bench.spi_read(
+        tkws::spi_read_word(tkws::SPI_CMD_READ_REG, tkws::SPI_READ_BANK_CRC, tkws::N_BANK), tkws::N_BANK);
+    const std::vector<uint32_t> gold = tkws::bank_crcs(image);
+    for (size_t b = 0; b < crc.size(); b++) {
+        if (crc[b] != gold[b])
+            return ", bank CRCs DIFFER from bank " + std::to_string(b);
+    }
+    return "";
+}
+
+// The status word after the first inference and its result FIFO record.
+static std::string check_status(const tkws::SpiStatus &st, const tkws::BenchResult &res)
+{
+    if (!st.valid || st.busy || st.result_cnt != 0 || st.result != res.result ||
+        st.last_result != res.result || st.done_cnt != 1)
+        return ", status word DIFFERS";
+    return "";
+}
+
+int main(int argc, char **argv)
+{
+    std::string model_dir = "model";
+    std::string twiddle_dir = "src_hw/src/feature_extractor";
+    std::string list_file;
+    std::vector<std::string> files;
+    int n_thread = 0;
+    int n_lead = 0;
+    int n_spi = 1;
+    bool pack = false;
+    bool readback_all = false;
+    bool early_exit = false;
+    long class_skip = -1;
+    long vad_th = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-m") && i + 1 < argc)        model_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-t") && i + 1 < argc)   twiddle_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-j") && i + 1 < argc)   n_thread = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-l") && i + 1 < argc)   n_lead = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)   n_spi = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-p"))                   pack = true;
+        else if (!std::strcmp(argv[i], "-r"))                   readback_all = true;
+        else if (!std::strcmp(argv[i], "-e"))                   early_exit = true;
+        else if (!std::strcmp(argv[i], "-k") && i + 1 < argc)   class_skip = std::strtol(argv[++i], nullptr, 0);
+        else if (!std::strcmp(argv[i], "-v") && i + 1 < argc)   vad_th = std::strtol(argv[++i], nullptr, 0);
+        else if (!std::strcmp(argv[i], "-L") && i + 1 < argc)   list_file = argv[++i];
+        else if (argv[i][0] == '-')                             { usage(); return 1; }
+        else                                                    files.push_back(argv[i]);
+    }
+    if (n_lead < 0 || n_spi < 0 || class_skip < -1 || class_skip > 0xFFFF ||
+        vad_th < -1 || vad_th > 0xFFF) {
+        usage();
+        return 1;
+    }
+
+    try {
+        if (!list_file.empty()) {
+            std::vector<std::string> list = read_list(list_file);
+            files.insert(files.end(), list.begin(), list.end());
+        }
+        if (files.empty())
+            throw std::runtime_error("No clips given");
+
+        tkws::ModelImage image = tkws::load_model(model_dir);
+        early_exit = early_exit || image.conf.en_early_exit;
+        image.conf.en_early_exit = early_exit;
+        if (class_skip >= 0)
+            image.conf.class_skip = (uint32_t)class_skip;
+        if (vad_th >= 0)
+            image.conf.vad_th = (uint32_t)vad_th;
+        const uint32_t class_en = tkws::class_enable(image.conf);
+        tkws::CtmModel model(image);
+        tkws::TwiddleRom rom = tkws::load_twiddle_dir(twiddle_dir);
+        tkws::PerfModel perf(image);
+        const tkws::PerfStats model_stats = perf.run(tkws::FeatureWindow{});
+
+        for (std::string &f : files)
+            f = fs::absolute(f).string();
+        fs::current_path(twiddle_dir);
+
+        // Post-load checkpoint for the clips that do not take the SPI path.
+        const std::string ckpt_file =
+            (fs::temp_directory_path() / ("wrap_TsetlinKWS_tb." + std::to_string(getpid()) + ".ckpt")).string();
+        const bool use_ckpt = files.size() > (size_t)n_spi;
+        double ckpt_sec = 0.0;
+        if (use_ckpt) {
+            auto c0 = std::chrono::steady_clock::now();
+            tkws::KwsBench bench;
+            bench.reset();
+            bench.preload_model(image);
+            bench.save(ckpt_file);
+            ckpt_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - c0).count();
+        }
+
+        tkws::WorkPool pool(n_thread);
+        std::vector<tkws::FeModel> fe(pool.num_thread(), tkws::FeModel(rom, image.conf.flux_th));
+        std::vector<char> pass(files.size(), 0);
+        std::vector<double> wall(files.size(), 0.0);
+        std::mutex print_mutex;
+
+        auto t0 = std::chrono::steady_clock::now();
+        pool.parallel_for(files.size(), 1, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) {
+                const bool spi = i < (size_t)n_spi;
+                auto c0 = std::chrono::steady_clock::now();
+                tkws::KwsBench bench;
+                tkws::BenchResult res;
+                std::string error;
+                try {
+                    std::vector<int16_t> audio(n_lead, 0);
+                    std::vector<int16_t> clip = read_clip(files[i]);
+                    audio.insert(audio.end(), clip.begin(), clip.end());
+
+                    tkws::FeatureWindow gold_window = fe[worker].clip_window(audio.data(), audio.size());
+                    tkws::CtmResult gold = tkws::select_classes(model.infer(gold_window), class_en);
+                    const tkws::PerfStats gold_perf = early_exit ? perf.run(gold_window) : tkws::PerfStats{};
+
+                    if (spi) {
+                        bench.reset();
+                        bench.load_model(image, pack);
+                        if (size_t n = bench.check_banks(image))
+                            error += ", " + std::to_string(n) + " bank words DIFFER after the SPI load";
+                        error += check_readback(bench, image, readback_all ? ~0u : READBACK_WORDS);
+                    } else {
+                        bench.restore(ckpt_file);
+                    }
+                    res = bench.run_clip(audio.data(), audio.size(), MAX_SILENCE);
+
+                    const bool silent = tkws::vad_silent(image.conf, gold_window);
+                    const tkws::PerfStats &stats = early_exit ? gold_perf : model_stats;
+                    if (silent) {
+                        // Not inferred: no window, class sums or cycles to compare.
+                        if (res.result != (int)image.conf.vad_class || res.inf_cycle || !res.class_sum.empty())
+                            error += ", silent window was inferred";
+                    } else {
+                        int n_row_diff = 0;
+                        for (int r = 0; r < tkws::N_ROW; r++)
+                            n_row_diff += res.window[r] != gold_window[r];
+                        if (n_row_diff)
+                            error += ", feature window DIFFERS in " + std::to_string(n_row_diff) + " rows";
+                        // An early exit stops the class sums at the deciding class.
+                        if (early_exit)
+                            gold.class_sum.resize(gold_perf.result.class_sum.size());
+                        if (res.class_sum != gold.class_sum)
+                            error += ", class sums DIFFER";
+                        if (res.result != gold.result)
+                            error += ", result DIFFERS from " + std::to_string(gold.result);
+                        if (res.inf_cycle != stats.cycle)
+                            error += ", cycles DIFFER from " + std::to_string(stats.cycle);
+                        if (res.decode_cycle != stats.decode_cycle)
+                            error += ", decode cycles DIFFER from " + std::to_string(stats.decode_cycle);
+                    }
+
+                    const uint32_t n_word = tkws::result_record_words(image.conf.num_class);
+                    tkws::ResultRecord rec = tkws::parse_result_record(
+                        bench.spi_read(tkws::spi_read_word(tkws::SPI_CMD_RESULT_FIFO, 0, n_word), n_word));
+                    error += check_record(rec, res, image.conf.num_class, class_en);
+                    tkws::PerfCounters cnt = tkws::parse_perf_counters(
+                        bench.spi_read(tkws::spi_read_word(tkws::SPI_CMD_READ_REG, tkws::SPI_READ_PERF_CNT, tkws::PERF_CNT_WORDS),
+                                       tkws::PERF_CNT_WORDS));
+                    error += check_perf_counters(cnt, res, silent ? nullptr : &stats);
+                    error += check_status(tkws::parse_status(bench.spi_read(
+                        tkws::spi_read_word(tkws::SPI_CMD_READ_REG, tkws::SPI_READ_STATUS, 1), 1)[0]), res);
+                    error += check_bank_crcs(bench, image);
+                } catch (const std::exception &e) {
+                    error += std::string(", ") + e.what();
+                }
+                pass[i] = error.empty();
+                wall[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - c0).count();
+
+                std::lock_guard<std::mutex> lock(print_mutex);
+                std::printf("%s: %s, result %d, %llu cycles (decode %llu), %.3f s simulated, %.1f s%s\n", files[i].c_str(),
+                            spi ? (pack ? "packed SPI load" : "SPI load") : "checkpoint", res.result, (unsigned long long)res.inf_cycle,
+                            (unsigned long long)res.decode_cycle, 1e-12 * (double)bench.time_ps(), wall[i],
+                            error.empty() ? ", pass" : error.c_str());
+                std::fflush(stdout);
+            }
+        });
+        auto t1 = std::chrono::steady_clock::now();
+        if (use_ckpt)
+            fs::remove(ckpt_file);
+
+        size_t n_pass = 0;
+        for (char p : pass)
+            n_pass += p;
+        double sec = std::chrono::duration<double>(t1 - t0).count();
+        std::printf("\n%zu/%zu clips pass, %.1f s (%d threads)\n", n_pass, files.size(), sec, pool.num_thread());
+        // Wall time per clip of the two load paths, the checkpoint one
+        // including its share of the preload and save.
+        const size_t n_spi_clip = std::min(files.size(), (size_t)n_spi);
+        if (n_spi_clip)
+            std::printf("SPI load: %.1f s per clip (%zu clips)\n",
+                        std::accumulate(wall.begin(), wall.begin() + n_spi_clip, 0.0) / n_spi_clip, n_spi_clip);
+        if (use_ckpt)
+            std::printf("checkpoint: %.1f s per clip (%zu clips, %.1f s preload and save)\n",
+                        (std::accumulate(wall.begin() + n_spi_clip, wall.end(), 0.0) + ckpt_sec) /
+                            (files.size() - n_spi_clip),
+                        files.size() - n_spi_clip, ckpt_sec);
+        if (n_pass != files.size())
+            throw std::runtime_error(std::to_string(files.size() - n_pass) + " clips failed");
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -41,6 +41,8 @@ timeprecision 1ps;
     parameter DEPTH_ROW_BANK        = 2048  ;
     parameter DEPTH_CCL_BANK        = 4096  ;
     parameter DEPTH_WEIGHT_BANK     = 2048  ;
+    parameter N_CCL_WORD            = 1     ;
+    parameter DEPTH_BLOCK_FIFO      = 4     ;
 
     parameter I2S_DATA_WIDTH        = 24    ;
     parameter Input_INT_BIT_WIDTH   = 12    ;
@@ -80,6 +82,7 @@ timeprecision 1ps;
     logic                       SCK;
     logic                       CS;
     logic                       MOSI;
+    logic                       MISO;
     
     logic [3:0]                 Result;
     logic                       Inf_Done;
@@ -93,10 +96,16 @@ timeprecision 1ps;
     int file, r, i, j, k, m, round, index;
     string line;
     integer status;
-    int conf_count;
+    int conf_count, n_conf;
     int check, feature_check, result_check;
-    
-    logic [31:0]    SPI_CONF_ARRAY [28];
+    int inf_cycle, decode_cycle;
+    bit backdoor;
+    bit fe_bank;
+    
+    // words of spi_config_reg.txt: 7 single registers, the row and CCL length
+    // bursts, the weight length, and at most the early exit, class skip,
+    // stride and VAD bursts (tkws_ogbcsr writes only those that are set)
+    logic [31:0]    SPI_CONF_ARRAY [2*N_PE_COL+27];
     bit             is_valid;
     string          binary_str;
     logic [31:0]    tmp;
@@ -121,8 +130,15 @@ timeprecision 1ps;
     
     logic [31:0] CONF_SPI_EN_INF_ADDR;
     logic [31:0] CONF_SPI_EN_INF_DATA;
+    
+    logic [31:0]    crc;
+    logic [31:0]    crc_gold                    [2*N_PE_COL+2];
         
-    wrap_TsetlinKWS wrap_TsetlinKWS_inst(
+    wrap_TsetlinKWS #(
+        .N_PE_COL           (N_PE_COL           ),
+        .N_CCL_WORD         (N_CCL_WORD         ),
+        .DEPTH_BLOCK_FIFO   (DEPTH_BLOCK_FIFO   )
+    ) wrap_TsetlinKWS_inst(
         .*
     );
     
@@ -136,62 +152,29 @@ timeprecision 1ps;
         forever #1250 sys_clk = ~sys_clk;       // 400khz
     end
     
-    assign BLOCK_IDX_BANK_CONFIG_ADDR      = 32'b1001_000_0010001111111_000000000000;   // 1152
-    
-    assign ROW_CNT_BANK_CONFIG_ADDR[0 ]    = 32'b1010_000_0011000110111_000000000000;   // 1592
-    assign ROW_CNT_BANK_CONFIG_ADDR[1 ]    = 32'b1010_001_0011001010001_000000000000;   // 1618
-    assign ROW_CNT_BANK_CONFIG_ADDR[2 ]    = 32'b1010_010_0011001011010_000000000000;   // 1627
-    assign ROW_CNT_BANK_CONFIG_ADDR[3 ]    = 32'b1010_011_0011001001101_000000000000;   // 1614
-    assign ROW_CNT_BANK_CONFIG_ADDR[4 ]    = 32'b1010_100_0011010000011_000000000000;   // 1668
-    
-    
-    assign CCL_IDX_BANK_CONFIG_ADDR[0 ]    = 32'b1011_000_0110000110110_000000000000;   // 3127
-    assign CCL_IDX_BANK_CONFIG_ADDR[1 ]    = 32'b1011_001_0110000101001_000000000000;   // 3114
-    assign CCL_IDX_BANK_CONFIG_ADDR[2 ]    = 32'b1011_010_0110000011010_000000000000;   // 3099
-    assign CCL_IDX_BANK_CONFIG_ADDR[3 ]    = 32'b1011_011_0110000100011_000000000000;   // 3108
-    assign CCL_IDX_BANK_CONFIG_ADDR[4 ]    = 32'b1011_100_0110001110001_000000000000;   // 3186
+    // burst command {1'b1, cmd, bank_sel, pack, burst_len-1, addr}, the
+    // burst lengths are the word counts of the .dat files
+    assign BLOCK_IDX_BANK_CONFIG_ADDR      = {4'b1001, 3'd0, 1'b0, 12'(LEN_BLOCK_BANK - 1), 12'd0};
     
+    generate
+        for (genvar g = 0; g < N_PE_COL; g++) begin : gen_bank_config_addr
+            assign ROW_CNT_BANK_CONFIG_ADDR[g] = {4'b1010, 3'(g), 1'b0, 12'(LEN_ROW_BANK[g] - 1), 12'd0};
+            assign CCL_IDX_BANK_CONFIG_ADDR[g] = {4'b1011, 3'(g), 1'b0, 12'(LEN_CCL_BANK[g] - 1), 12'd0};
+        end
+    endgenerate
     
-    assign WEIGHT_BANK_CONFIG_ADDR         = 32'b1100_000_0010110011111_000000000000;   // 1440
+    assign WEIGHT_BANK_CONFIG_ADDR         = {4'b1100, 3'd0, 1'b0, 12'(LEN_WEIGHT_BANK - 1), 12'd0};
     
     assign CONF_SPI_EN_INF_ADDR = 32'b1000_000_0000000000000_000000000001;
     assign CONF_SPI_EN_INF_DATA = 32'd1;
     
     
     initial begin
-        LEN_BLOCK_BANK    = 1152;
-        
-        LEN_ROW_BANK[0 ]  = 1592;
-        LEN_ROW_BANK[1 ]  = 1618;
-        LEN_ROW_BANK[2 ]  = 1627;
-        LEN_ROW_BANK[3 ]  = 1614;
-        LEN_ROW_BANK[4 ]  = 1668;
-        
-        row_cnt_file[0 ]  = "row_cnt_bank0.dat";
-        row_cnt_file[1 ]  = "row_cnt_bank1.dat";
-        row_cnt_file[2 ]  = "row_cnt_bank2.dat";
-        row_cnt_file[3 ]  = "row_cnt_bank3.dat";
-        row_cnt_file[4 ]  = "row_cnt_bank4.dat";
-        
-        LEN_CCL_BANK[0 ]  = 3127;
-        LEN_CCL_BANK[1 ]  = 3114;
-        LEN_CCL_BANK[2 ]  = 3099;
-        LEN_CCL_BANK[3 ]  = 3108;
-        LEN_CCL_BANK[4 ]  = 3186;
-      
-        ccl_idx_file[0 ]  = "col_cla_idx_bank0.dat";
-        ccl_idx_file[1 ]  = "col_cla_idx_bank1.dat";
-        ccl_idx_file[2 ]  = "col_cla_idx_bank2.dat";
-        ccl_idx_file[3 ]  = "col_cla_idx_bank3.dat";
-        ccl_idx_file[4 ]  = "col_cla_idx_bank4.dat";
-        
-        LEN_WEIGHT_BANK = 1440;
-    end
-    
-    
-    initial begin
+        backdoor = $test$plusargs("BACKDOOR");
         feature_check = 0;
         result_check = 0;
+        inf_cycle = 0;
+        decode_cycle = 0;
         CS = 1;
         SCK = 0;
         MOSI = 0;
@@ -209,7 +192,7 @@ timeprecision 1ps;
         CS = 0;
         #3000;
         i = 0;
-        repeat (28) begin
+        repeat (n_conf) begin
             j = 0;
             repeat(32) begin
                 MOSI = SPI_CONF_ARRAY[i][31-j];
@@ -227,57 +210,45 @@ timeprecision 1ps;
         
         
         // ------------------------------------------------------------------------
-        // Configure model block index bank
+        // Backdoor: with +BACKDOOR the model banks are preloaded from the .dat
+        // files instead of the ~25k-word SPI bursts below. The configuration
+        // registers above and SPI_EN_INF still go over SPI.
         // ------------------------------------------------------------------------
-        CS = 0;
-        #3000;
-        j = 0;
-        repeat(32) begin
-            MOSI = BLOCK_IDX_BANK_CONFIG_ADDR[31-j];
-            #5120;
-            SCK = 1;
-            #5120;
-            SCK = 0;
-            j = j + 1;
-        end
-        
-        i = 0;
-        repeat (LEN_BLOCK_BANK) begin
-            j = 0;
-            repeat(32) begin
-                MOSI = BLOCK_IDX_BANK_ARRAY[i][31-j];
-                #5120;
-                SCK = 1;
-                #5120;
-                SCK = 0;
-                j = j + 1;
+        if (backdoor) begin
+            // copy the words read from the .dat files, as the SPI bursts write them
+            for (int i = 0; i < LEN_BLOCK_BANK; i++)
+                wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.mem_block_idx_bank_inst.block_idx_bank[i] = BLOCK_IDX_BANK_ARRAY[i][N_PE_CLUSTER-1:0];
+            for (int k = 0; k < N_PE_COL; k++) begin
+                for (int i = 0; i < LEN_ROW_BANK[k]; i++)
+                    wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.mem_row_cnt_bank_inst.row_cnt_bank[k][i] = ROW_CNT_BANK_ARRAY[k][i][5:0];
+                // N_CCL_WORD words per CCL bank line
+                for (int i = 0; i < LEN_CCL_BANK[k]; i++) begin
+                    wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.mem_col_clause_idx_bank_inst.col_clause_idx_bank[k][i / N_CCL_WORD][5*(i % N_CCL_WORD) +: 5] = CCL_IDX_BANK_ARRAY[k][i][4:0];
+                end
             end
-            i = i + 1;
-        end
-        #3000;
-        CS = 1;
-        #10000;
-        
-        // ------------------------------------------------------------------------
-        // Configure model row count bank
-        // ------------------------------------------------------------------------
-        for (int k = 0; k < N_PE_COL; k++) begin
+            for (int i = 0; i < LEN_WEIGHT_BANK; i++)
+                wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.mem_weight_bank_inst.weight_bank[i] = WEIGHT_BANK_ARRAY[i][8:0];
+        end else begin
+            // ------------------------------------------------------------------------
+            // Configure model block index bank
+            // ------------------------------------------------------------------------
             CS = 0;
             #3000;
             j = 0;
             repeat(32) begin
-                MOSI = ROW_CNT_BANK_CONFIG_ADDR[k][31-j];
+                MOSI = BLOCK_IDX_BANK_CONFIG_ADDR[31-j];
                 #5120;
                 SCK = 1;
                 #5120;
                 SCK = 0;
                 j = j + 1;
             end
+        
             i = 0;
-            repeat (LEN_ROW_BANK[k]) begin
+            repeat (LEN_BLOCK_BANK) begin
                 j = 0;
                 repeat(32) begin
-                    MOSI = ROW_CNT_BANK_ARRAY[k][i][31-j];
+                    MOSI = BLOCK_IDX_BANK_ARRAY[i][31-j];
                     #5120;
                     SCK = 1;
                     #5120;
@@ -289,17 +260,82 @@ timeprecision 1ps;
             #3000;
             CS = 1;
             #10000;
-        end
         
-        // ------------------------------------------------------------------------
-        // Configure model ccl index bank
-        // ------------------------------------------------------------------------
-        for (int k = 0; k < N_PE_COL; k++) begin
+            // ------------------------------------------------------------------------
+            // Configure model row count bank
+            // ------------------------------------------------------------------------
+            for (int k = 0; k < N_PE_COL; k++) begin
+                CS = 0;
+                #3000;
+                j = 0;
+                repeat(32) begin
+                    MOSI = ROW_CNT_BANK_CONFIG_ADDR[k][31-j];
+                    #5120;
+                    SCK = 1;
+                    #5120;
+                    SCK = 0;
+                    j = j + 1;
+                end
+                i = 0;
+                repeat (LEN_ROW_BANK[k]) begin
+                    j = 0;
+                    repeat(32) begin
+                        MOSI = ROW_CNT_BANK_ARRAY[k][i][31-j];
+                        #5120;
+                        SCK = 1;
+                        #5120;
+                        SCK = 0;
+                        j = j + 1;
+                    end
+                    i = i + 1;
+                end
+                #3000;
+                CS = 1;
+                #10000;
+            end
+        
+            // ------------------------------------------------------------------------
+            // Configure model ccl index bank
+            // ------------------------------------------------------------------------
+            for (int k = 0; k < N_PE_COL; k++) begin
+                CS = 0;
+                #3000;
+                j = 0;
+                repeat(32) begin
+                    MOSI = CCL_IDX_BANK_CONFIG_ADDR[k][31-j];
+                    #5120;
+                    SCK = 1;
+                    #5120;
+                    SCK = 0;
+                    j = j + 1;
+                end
+                i = 0;
+                repeat (LEN_CCL_BANK[k]) begin
+                    j = 0;
+                    repeat(32) begin
+                        MOSI = CCL_IDX_BANK_ARRAY[k][i][31-j];
+                        #5120;
+                        SCK = 1;
+                        #5120;
+                        SCK = 0;
+                        j = j + 1;
+                    end
+                    i = i + 1;
+                end
+                #3000;
+                CS = 1;
+                #10000;
+            end
+        
+            // ------------------------------------------------------------------------
+            // Configure model weight bank
+            // ------------------------------------------------------------------------
+        
             CS = 0;
             #3000;
             j = 0;
             repeat(32) begin
-                MOSI = CCL_IDX_BANK_CONFIG_ADDR[k][31-j];
+                MOSI = WEIGHT_BANK_CONFIG_ADDR[31-j];
                 #5120;
                 SCK = 1;
                 #5120;
@@ -307,10 +343,10 @@ timeprecision 1ps;
                 j = j + 1;
             end
             i = 0;
-            repeat (LEN_CCL_BANK[k]) begin
+            repeat (LEN_WEIGHT_BANK) begin
                 j = 0;
                 repeat(32) begin
-                    MOSI = CCL_IDX_BANK_ARRAY[k][i][31-j];
+                    MOSI = WEIGHT_BANK_ARRAY[i][31-j];
                     #5120;
                     SCK = 1;
                     #5120;
@@ -324,38 +360,6 @@ timeprecision 1ps;
             #10000;
         end
         
-        // ------------------------------------------------------------------------
-        // Configure model weight bank
-        // ------------------------------------------------------------------------
-        
-        CS = 0;
-        #3000;
-        j = 0;
-        repeat(32) begin
-            MOSI = WEIGHT_BANK_CONFIG_ADDR[31-j];
-            #5120;
-            SCK = 1;
-            #5120;
-            SCK = 0;
-            j = j + 1;
-        end
-        i = 0;
-        repeat (LEN_WEIGHT_BANK) begin
-            j = 0;
-            repeat(32) begin
-                MOSI = WEIGHT_BANK_ARRAY[i][31-j];
-                #5120;
-                SCK = 1;
-                #5120;
-                SCK = 0;
-                j = j + 1;
-            end
-            i = i + 1;
-        end
-        #3000;
-        CS = 1;
-        #10000;
-        
         // ------------------------------------------------------------------------
         // Enable SPI_EN_INF
         // ------------------------------------------------------------------------
@@ -444,19 +448,23 @@ timeprecision 1ps;
         $finish;
     end
     
-    // check the feature bank
+    // check the feature bank: fe_complete hands over bank fe_bank_wsel, which
+    // the binarizer leaves alone until the next hand-over
     always @(posedge wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.fe_complete) begin
         if (feature_check == 0) begin
+            fe_bank = wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.fe_bank_wsel;
             #2500;
             #0.1;
+            if (wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.fe_bank_wsel == fe_bank)
+                $display("Error happen in feature bank %0d: not handed over.", fe_bank);
             m = 0;
             repeat (64) begin
-                if (wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.feature_bank[m] != feature_gold_value[m])
+                if (wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.feature_bank[fe_bank][m] != feature_gold_value[m])
                     $display("Error happen in Row %0d. My: %h. GOLD: %h.", m, 
-                        wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.feature_bank[m], feature_gold_value[m]);
+                        wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.feature_bank[fe_bank][m], feature_gold_value[m]);
                 else
                     $display("Right happen in Row %0d. My: %h. GOLD: %h.", m, 
-                        wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.feature_bank[m], feature_gold_value[m]);
+                        wrap_TsetlinKWS_inst.TsetlinKWS_inst.feature_extractor_inst.feature_module_inst.feature_bank[fe_bank][m], feature_gold_value[m]);
                 m = m + 1;
             end
             feature_check = 1;
@@ -478,6 +486,80 @@ timeprecision 1ps;
         end
     end
     
+    // count the inference cycles (compare with src_model/tkws_perf)
+    always @(posedge sys_clk) begin
+        if (wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.decode_en ||
+            wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.tail_flush_en) begin
+            if (Inf_Done) begin
+                $display("Inference: %0d cycles (decode %0d, tail %0d).", inf_cycle, decode_cycle,
+                    inf_cycle - decode_cycle);
+                inf_cycle = 0;
+                decode_cycle = 0;
+            end else begin
+                inf_cycle = inf_cycle + 1;
+                if (wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.decode_en)
+                    decode_cycle = decode_cycle + 1;
+            end
+        end
+    end
+    
+    // print the per-column counters of perf_counter, taken into its snapshot
+    // one cycle after inf_done (compare with src_model/tkws_perf)
+    always @(posedge wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.inf_done) begin
+        @(posedge sys_clk);
+        #1;
+        $display("Perf counter: %0d cycles, idle %0d.",
+            wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.perf_counter_inst.snap[0],
+            wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.perf_counter_inst.snap[4]);
+        for (int c = 0; c < N_PE_COL; c++)
+            $display("PE column %0d: busy %0d, wait %0d.", c,
+                wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.perf_counter_inst.snap[5 + 2*c],
+                wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.perf_counter_inst.snap[6 + 2*c]);
+    end
+    
+    // CRC-32 of a word taken LSB first, as spi_readback.sv
+    function automatic logic [31:0] crc32_word(input logic [31:0] crc, input logic [31:0] data);
+        logic [31:0] c;
+        c = crc;
+        for (int n = 0; n < 32; n++)
+            c = (c >> 1) ^ ((c[0] ^ data[n])? 32'hEDB88320 : 32'h0);
+        return c;
+    endfunction
+    
+    // check the bank CRCs of spi_readback against the .dat files once the
+    // walk after the last write is done, for the SPI load and +BACKDOOR alike
+    // (compare with bank_crcs() of src_model/model_image.h)
+    always @(posedge wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.spi_readback_inst.crc_valid) begin
+        #1;
+        crc = '1;
+        for (int n = 0; n < LEN_BLOCK_BANK; n++)
+            crc = crc32_word(crc, 32'(BLOCK_IDX_BANK_ARRAY[n][N_PE_CLUSTER-1:0]));
+        crc_gold[0] = ~crc;
+        for (int c = 0; c < N_PE_COL; c++) begin
+            crc = '1;
+            for (int n = 0; n < LEN_ROW_BANK[c]; n++)
+                crc = crc32_word(crc, 32'(ROW_CNT_BANK_ARRAY[c][n][5:0]));
+            crc_gold[1 + c] = ~crc;
+            crc = '1;
+            for (int n = 0; n < LEN_CCL_BANK[c]; n++)
+                crc = crc32_word(crc, 32'(CCL_IDX_BANK_ARRAY[c][n][4:0]));
+            crc_gold[1 + N_PE_COL + c] = ~crc;
+        end
+        crc = '1;
+        for (int n = 0; n < LEN_WEIGHT_BANK; n++)
+            crc = crc32_word(crc, 32'(WEIGHT_BANK_ARRAY[n][8:0]));
+        crc_gold[2*N_PE_COL + 1] = ~crc;
+        
+        for (int b = 0; b < 2*N_PE_COL + 2; b++) begin
+            if (wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.spi_readback_inst.bank_crc[b] != crc_gold[b])
+                $display("Error happen in Bank CRC %0d (%s). My: %h. GOLD: %h.", b, backdoor? "backdoor" : "SPI",
+                    wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.spi_readback_inst.bank_crc[b], crc_gold[b]);
+            else
+                $display("Right happen in Bank CRC %0d (%s). My: %h. GOLD: %h.", b, backdoor? "backdoor" : "SPI",
+                    wrap_TsetlinKWS_inst.TsetlinKWS_inst.tsetlin_machine_accelerator_inst.spi_readback_inst.bank_crc[b], crc_gold[b]);
+        end
+    end
+    
     // ------------------------------------------------------------------------
     // Read "sum_result.csv"
     // ------------------------------------------------------------------------
@@ -571,7 +653,7 @@ timeprecision 1ps;
     // Read "spi_config_reg.txt"
     // ------------------------------------------------------------------------
     initial begin
-        conf_count = 0;
+        n_conf = 0;
         file = $fopen("spi_config_reg.txt", "r");
         if (!file) begin
             $display("Error: Cannot open spi_config_reg.txt file");
@@ -596,19 +678,23 @@ timeprecision 1ps;
             end
 
             // char to logic[31:0]
+            if (is_valid && n_conf == $size(SPI_CONF_ARRAY)) begin
+                $display("Error: spi_config_reg.txt has more than %0d words.", $size(SPI_CONF_ARRAY));
+                $finish;
+            end
             if (is_valid) begin
                 tmp = 0;
                 for (int i = 0; i < 32; i++) begin
                     tmp[31-i] = (line[i] == "1");
                 end
-                SPI_CONF_ARRAY[conf_count] = tmp;
-                conf_count++;
+                SPI_CONF_ARRAY[n_conf] = tmp;
+                n_conf++;
             end
         end
 
         $fclose(file);
-        $display("Read %0d valid configurations:", conf_count);
-        for (int i = 0; i < conf_count; i++) begin
+        $display("Read %0d valid configurations:", n_conf);
+        for (int i = 0; i < n_conf; i++) begin
             $display("SPI_CONF_ARRAY[%0d] = 32'b%032b", i, SPI_CONF_ARRAY[i]);
         end
     end
@@ -628,24 +714,24 @@ timeprecision 1ps;
             line = "";
             r = $fgets(line, file); // read one row
             
-            // Check the first 20 char
+            // Check the first N_PE_CLUSTER char
             is_valid = 1;
-            if (line.len() >= 20) begin
-                for (int i = 0; i < 20; i++) begin
+            if (line.len() >= N_PE_CLUSTER) begin
+                for (int i = 0; i < N_PE_CLUSTER; i++) begin
                     if (line[i] != "0" && line[i] != "1") begin
                         is_valid = 0;
                         break;
                     end
                 end
             end else begin
-                is_valid = 0;  // if len less than 20
+                is_valid = 0;  // if len less than N_PE_CLUSTER
             end
 
             // char to logic[31:0]
-            if (is_valid) begin
+            if (is_valid && conf_count < $size(BLOCK_IDX_BANK_ARRAY)) begin
                 tmp = 0;
-                for (int i = 0; i < 20; i++) begin
-                    tmp[19-i] = (line[i] == "1");
+                for (int i = 0; i < N_PE_CLUSTER; i++) begin
+                    tmp[N_PE_CLUSTER-1-i] = (line[i] == "1");
                 end
                 BLOCK_IDX_BANK_ARRAY[conf_count] = tmp;
                 conf_count++;
@@ -653,6 +739,7 @@ timeprecision 1ps;
         end
 
         $fclose(file);
+        LEN_BLOCK_BANK = conf_count;
         $display("Read %0d valid configurations:", conf_count);
         for (int i = 0; i < 10; i++) begin
             $display("BLOCK_IDX_BANK_ARRAY[%0d] = 32'b%032b", i, BLOCK_IDX_BANK_ARRAY[i]);
@@ -665,9 +752,10 @@ timeprecision 1ps;
     initial begin
         for (int k = 0; k < N_PE_COL; k++) begin
             conf_count = 0;
+            row_cnt_file[k] = $sformatf("row_cnt_bank%0d.dat", k);
             file = $fopen(row_cnt_file[k], "r");
             if (!file) begin
-                $display("Error: Cannot open row_cnt_file.dat file");
+                $display("Error: Cannot open %s file", row_cnt_file[k]);
                 $finish;
             end
 
@@ -689,7 +777,7 @@ timeprecision 1ps;
                 end
 
                 // char to logic[31:0]
-                if (is_valid) begin
+                if (is_valid && conf_count < DEPTH_ROW_BANK) begin
                     tmp = 0;
                     for (int i = 0; i < 6; i++) begin
                         tmp[5-i] = (line[i] == "1");
@@ -700,6 +788,7 @@ timeprecision 1ps;
             end
 
             $fclose(file);
+            LEN_ROW_BANK[k] = conf_count;
             $display("Read %0d valid configurations:", conf_count);
             for (int i = 0; i < 5; i++) begin
                 $display("ROW_CNT_BANK_ARRAY[%0d][%0d] = 32'b%032b", k, i, ROW_CNT_BANK_ARRAY[k][i]);
@@ -713,9 +802,10 @@ timeprecision 1ps;
     initial begin
         for (int k = 0; k < N_PE_COL; k++) begin
             conf_count = 0;
+            ccl_idx_file[k] = $sformatf("col_cla_idx_bank%0d.dat", k);
             file = $fopen(ccl_idx_file[k], "r");
             if (!file) begin
-                $display("Error: Cannot open col_cla_idx_file.dat file");
+                $display("Error: Cannot open %s file", ccl_idx_file[k]);
                 $finish;
             end
 
@@ -737,7 +827,7 @@ timeprecision 1ps;
                 end
 
                 // char to logic[31:0]
-                if (is_valid) begin
+                if (is_valid && conf_count < DEPTH_CCL_BANK) begin
                     tmp = 0;
                     for (int i = 0; i < 5; i++) begin
                         tmp[4-i] = (line[i] == "1");
@@ -748,6 +838,7 @@ timeprecision 1ps;
             end
 
             $fclose(file);
+            LEN_CCL_BANK[k] = conf_count;
             $display("Read %0d valid configurations:", conf_count);
             for (int i = 0; i < 5; i++) begin
                 $display("CCL_IDX_BANK_ARRAY[%0d][%0d] = 32'b%032b", k, i, CCL_IDX_BANK_ARRAY[k][i]);
@@ -778,6 +869,7 @@ timeprecision 1ps;
             end
         end
         $fclose(file);
+        LEN_WEIGHT_BANK = i;
         $display("Read %0d valid configurations:", i);
         for (i = 0; i < 10; i++) begin
             $display("WEIGHT_BANK_ARRAY[%0d] = %0h", i, WEIGHT_BANK_ARRAY[i]);
@@ -38,6 +38,8 @@ module TsetlinKWS #(
     parameter DEPTH_ROW_BANK        = 2048,
     parameter DEPTH_CCL_BANK        = 4096,
     parameter DEPTH_WEIGHT_BANK     = 2048,
+    parameter N_CCL_WORD            = 1,
+    parameter DEPTH_BLOCK_FIFO      = 4,
     
     parameter I2S_DATA_WIDTH        = 24,
     parameter Input_INT_BIT_WIDTH   = 12,
@@ -79,6 +81,7 @@ module TsetlinKWS #(
     input logic                         SCK,
     input logic                         CS,
     input logic                         MOSI,
+    output logic                        MISO,
     
     output logic [3:0]                  Result,
     output logic                        Inf_Done
@@ -88,16 +91,26 @@ module TsetlinKWS #(
     logic                                   feature_bank_ren;
     logic [$clog2(2*N_MEL)-1:0]             feature_rptr;
     logic [N_FRAME-1:0]                     feature_bank_rdata;
+    logic                                   fe_window_done;
     logic                                   fe_complete;
+    logic                                   tma_busy;
+    logic                                   vad_silence;
     
     // spi_slave signals to tsetlin machine model bank 
     logic                                   SPI_WEN_BLOCK_BANK;
+    logic                                   SPI_WEN_CLASS_BANK;
     logic                                   SPI_WEN_ROW_BANK        [N_PE_COL];
     logic                                   SPI_WEN_CCL_BANK        [N_PE_COL];
     logic                                   SPI_WEN_WEIGHT_BANK;
+    logic                                   SPI_WEN_BOUND_BANK;
     logic                                   SPI_WEN_FE_BANK;         
+    logic                                   SPI_WEN_CONF_REG;
+    logic                                   SPI_REN;
+    logic [5:0]                             SPI_RSEL;
     logic [11:0]                            SPI_ADDR;
+    logic [11:0]                            SPI_RADDR;
     logic [31:0]                            SPI_DATA;
+    logic [31:0]                            SPI_RDATA;
     
     // spi_slave signals to tsetlin_machine_accelerator and feature_extractor
     logic                                   SPI_EN_CONF;
@@ -111,6 +124,15 @@ module TsetlinKWS #(
     logic [$clog2(DEPTH_ROW_BANK)-1:0]      SPI_LEN_ROW_BANK        [N_PE_COL];
     logic [$clog2(DEPTH_CCL_BANK)-1:0]      SPI_LEN_CCL_BANK        [N_PE_COL];
     logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   SPI_LEN_WEIGHT_BANK;
+    logic                                   SPI_EN_EARLY_EXIT;
+    logic [15:0]                            SPI_CLASS_SKIP;
+    logic [5:0]                             SPI_INF_STRIDE;
+    logic [11:0]                            SPI_VAD_TH;
+    logic [3:0]                             SPI_VAD_CLASS;
+    logic                                   SPI_EN_KWD;
+    logic [5:0]                             SPI_KWD_WINDOW;
+    logic [5:0]                             SPI_KWD_RUN;
+    logic [5:0]                             SPI_KWD_HOLDOFF;
     
     
     feature_extractor #(
@@ -161,12 +183,17 @@ module TsetlinKWS #(
         .SPI_EN_INF                     (SPI_EN_INF             ),
         .SPI_EN_FE                      (SPI_EN_FE              ),
         .SPI_FLUX_TH                    (SPI_FLUX_TH            ),
+        .SPI_INF_STRIDE                 (SPI_INF_STRIDE         ),
+        .SPI_VAD_TH                     (SPI_VAD_TH             ),
         
         // accelerator signals ------------------------------------------------
         .feature_bank_ren               (feature_bank_ren       ),
         .feature_rptr                   (feature_rptr           ),
         .feature_bank_rdata             (feature_bank_rdata     ),
-        .fe_complete                    (fe_complete            )
+        .tma_busy                       (tma_busy               ),
+        .fe_window_done                 (fe_window_done         ),
+        .fe_complete                    (fe_complete            ),
+        .vad_silence                    (vad_silence            )
     );
     
     
@@ -179,25 +206,37 @@ module TsetlinKWS #(
         .DEPTH_BLOCK_BANK               (DEPTH_BLOCK_BANK       ),
         .DEPTH_ROW_BANK                 (DEPTH_ROW_BANK         ),
         .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK         ),
-        .DEPTH_WEIGHT_BANK              (DEPTH_WEIGHT_BANK      )
+        .DEPTH_WEIGHT_BANK              (DEPTH_WEIGHT_BANK      ),
+        .N_CCL_WORD                     (N_CCL_WORD             ),
+        .DEPTH_BLOCK_FIFO               (DEPTH_BLOCK_FIFO       )
 
     ) tsetlin_machine_accelerator_inst(
         .clk                            (sys_clk                ),
         .rst_n                          (sys_rst_n              ),
         
         // feature bank signals -----------------------------------------------
+        .fe_window_done                 (fe_window_done         ),
         .fe_complete                    (fe_complete            ),
+        .vad_silence                    (vad_silence            ),
         .feature_bank_rdata             (feature_bank_rdata     ),
         .feature_bank_ren               (feature_bank_ren       ),
         .feature_rptr                   (feature_rptr           ),
+        .tma_busy                       (tma_busy               ),
         
         // spi_slave signals --------------------------------------------------
         .SPI_WEN_BLOCK_BANK             (SPI_WEN_BLOCK_BANK     ),
+        .SPI_WEN_CLASS_BANK             (SPI_WEN_CLASS_BANK     ),
         .SPI_WEN_ROW_BANK               (SPI_WEN_ROW_BANK       ),
         .SPI_WEN_CCL_BANK               (SPI_WEN_CCL_BANK       ),
         .SPI_WEN_WEIGHT_BANK            (SPI_WEN_WEIGHT_BANK    ),
+        .SPI_WEN_BOUND_BANK             (SPI_WEN_BOUND_BANK     ),
+        .SPI_WEN_CONF_REG               (SPI_WEN_CONF_REG       ),
+        .SPI_REN                        (SPI_REN                ),
+        .SPI_RSEL                       (SPI_RSEL               ),
         .SPI_ADDR                       (SPI_ADDR               ),
+        .SPI_RADDR                      (SPI_RADDR              ),
         .SPI_DATA                       (SPI_DATA               ),
+        .SPI_RDATA                      (SPI_RDATA              ),
         
         // spi_slave Configuration registers ----------------------------------
         .SPI_NUM_CLASS                  (SPI_NUM_CLASS          ),
@@ -207,6 +246,13 @@ module TsetlinKWS #(
         .SPI_LEN_ROW_BANK               (SPI_LEN_ROW_BANK       ),
         .SPI_LEN_CCL_BANK               (SPI_LEN_CCL_BANK       ),
         .SPI_LEN_WEIGHT_BANK            (SPI_LEN_WEIGHT_BANK    ),
+        .SPI_EN_EARLY_EXIT              (SPI_EN_EARLY_EXIT      ),
+        .SPI_CLASS_SKIP                 (SPI_CLASS_SKIP         ),
+        .SPI_VAD_CLASS                  (SPI_VAD_CLASS          ),
+        .SPI_EN_KWD                     (SPI_EN_KWD             ),
+        .SPI_KWD_WINDOW                 (SPI_KWD_WINDOW         ),
+        .SPI_KWD_RUN                    (SPI_KWD_RUN            ),
+        .SPI_KWD_HOLDOFF                (SPI_KWD_HOLDOFF        ),
         
         // result signals -----------------------------------------------------
         .Result                         (Result                 ),
@@ -226,19 +272,29 @@ module TsetlinKWS #(
         .SCK                            (SCK                    ),
         .CS                             (CS                     ),
         .MOSI                           (MOSI                   ),
+        .MISO                           (MISO                   ),
         
         // System inputs ------------------------------------------------------
         .rst_n                          (sys_rst_n              ),
         
         // outputs to system --------------------------------------------------
         .SPI_WEN_BLOCK_BANK             (SPI_WEN_BLOCK_BANK     ),
+        .SPI_WEN_CLASS_BANK             (SPI_WEN_CLASS_BANK     ),
         .SPI_WEN_ROW_BANK               (SPI_WEN_ROW_BANK       ),
         .SPI_WEN_CCL_BANK               (SPI_WEN_CCL_BANK       ),
         .SPI_WEN_WEIGHT_BANK            (SPI_WEN_WEIGHT_BANK    ),
+        .SPI_WEN_BOUND_BANK             (SPI_WEN_BOUND_BANK     ),
         .SPI_WEN_FE_BANK                (SPI_WEN_FE_BANK        ),
+        .SPI_WEN_CONF_REG               (SPI_WEN_CONF_REG       ),
+        .SPI_REN                        (SPI_REN                ),
+        .SPI_RSEL                       (SPI_RSEL               ),
         .SPI_ADDR                       (SPI_ADDR               ),
+        .SPI_RADDR                      (SPI_RADDR              ),
         .SPI_DATA                       (SPI_DATA               ),
         
+        // inputs from system -------------------------------------------------
+        .SPI_RDATA                      (SPI_RDATA              ),
+        
         // Configuration registers --------------------------------------------
         .SPI_EN_CONF                    (SPI_EN_CONF            ),
         .SPI_EN_INF                     (SPI_EN_INF             ),
@@ -250,7 +306,16 @@ module TsetlinKWS #(
         .SPI_LEN_BLOCK_BANK             (SPI_LEN_BLOCK_BANK     ),
         .SPI_LEN_ROW_BANK               (SPI_LEN_ROW_BANK       ),
         .SPI_LEN_CCL_BANK               (SPI_LEN_CCL_BANK       ),
-        .SPI_LEN_WEIGHT_BANK            (SPI_LEN_WEIGHT_BANK    )
+        .SPI_LEN_WEIGHT_BANK            (SPI_LEN_WEIGHT_BANK    ),
+        .SPI_EN_EARLY_EXIT              (SPI_EN_EARLY_EXIT      ),
+        .SPI_CLASS_SKIP                 (SPI_CLASS_SKIP         ),
+        .SPI_INF_STRIDE                 (SPI_INF_STRIDE         ),
+        .SPI_VAD_TH                     (SPI_VAD_TH             ),
+        .SPI_VAD_CLASS                  (SPI_VAD_CLASS          ),
+        .SPI_EN_KWD                     (SPI_EN_KWD             ),
+        .SPI_KWD_WINDOW                 (SPI_KWD_WINDOW         ),
+        .SPI_KWD_RUN                    (SPI_KWD_RUN            ),
+        .SPI_KWD_HOLDOFF                (SPI_KWD_HOLDOFF        )
     );
     
     
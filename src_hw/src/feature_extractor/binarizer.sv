@@ -24,6 +24,19 @@
 // 
 // Desc: Binarizing the MFSC-SF feature.
 //
+//       Once the window is full, a new frame completes a window every frame,
+//       but only every SPI_INF_STRIDE-th window (0 and 1: every window) is
+//       written to the feature bank and raises fe_complete. The first window
+//       after SPI_EN_INF always does. The MFCC rows are not sent for the
+//       windows in between; the flux rows are still updated every frame.
+//
+//       Voice activity gate: vad_flux_cnt counts the flux bits set in the
+//       window (the 32x64 flux circular buffer), updated with every new bit
+//       and the bit it replaces. With SPI_VAD_TH non-zero, a window with
+//       fewer flux bits is silent: its MFCC rows are not sent, and it raises
+//       vad_silence instead of fe_complete, so the accelerator reports the
+//       silence class without running the inference.
+//
 //==============================================================================
 
 module binarizer #(
@@ -42,6 +55,8 @@ module binarizer #(
     input logic                         spi_en_fe_system_sync,
     input logic                         spi_en_inf_system_sync,
     input logic [15:0]                  SPI_FLUX_TH,
+    input logic [5:0]                   SPI_INF_STRIDE,
+    input logic [11:0]                  SPI_VAD_TH,
     
     // MFCC cricular buffer signals -------------------------------------------
     input logic [BIT_WIDTH-1:0]         mfcc_cirbuf_rdata0,
@@ -79,7 +94,8 @@ module binarizer #(
     output logic [N_FRAME-1:0]          MEM_FEBANK_D_binarizer,
     
     // Accelerator signals ----------------------------------------------------
-    output logic                        fe_complete
+    output logic                        fe_complete,
+    output logic                        vad_silence
 );
     
     typedef enum logic [2:0] {idle, padding, send_mfcc, send_finish, idle2, receive} state_t;
@@ -91,6 +107,16 @@ module binarizer #(
     logic                       send_flux_en;
     logic                       col_offset_inc_en;
     logic                       fsm_fe_complete;
+    logic [5:0]                 inf_frame_cnt;          // windows since the last fe_complete
+    logic                       inf_frame_hit;
+    
+    // voice activity gate
+    logic [11:0]                vad_flux_cnt;           // flux bits set in the window
+    logic [11:0]                vad_flux_cnt_next;
+    logic                       vad_fill;               // window not yet full: no bit replaced
+    logic                       vad_voiced;
+    logic                       vad_window_voiced;
+    logic                       fsm_vad_silence;
                             
     logic                       spi_en_inf_system_pulse;
     logic                       spi_en_inf_system_sync_d1;
@@ -550,14 +576,18 @@ module binarizer #(
             idle        :   if      (handshaking_flag == 1)                                         n_state = padding;
             padding     :   if      (!spi_en_inf_system_sync)                                       n_state = idle;
                             else if (handshaking_flag_d1 == 1 && row_wcnt == 31 && col_wcnt != 63)  n_state = idle;
-                            else if (handshaking_flag_d1 == 1 && row_wcnt == 31 && col_wcnt == 63)  n_state = send_mfcc;
+                            else if (handshaking_flag_d1 == 1 && row_wcnt == 31 && col_wcnt == 63 && vad_voiced)
+                                                                                                    n_state = send_mfcc;
+                            else if (handshaking_flag_d1 == 1 && row_wcnt == 31 && col_wcnt == 63)  n_state = send_finish;
             send_mfcc   :   if      (!spi_en_inf_system_sync)                                       n_state = idle;
                             else if (send_mfcc_row_rptr == 31 && send_mfcc_col_rcnt == 7)           n_state = send_finish;
             send_finish :                                                                           n_state = idle2;
             idle2       :   if      (!spi_en_inf_system_sync)                                       n_state = idle;
                             else if (handshaking_flag == 1)                                         n_state = receive;
             receive     :   if      (!spi_en_inf_system_sync)                                       n_state = idle;
-                            else if (handshaking_flag_d1 == 1 && row_wcnt == 31)                    n_state = send_mfcc;
+                            else if (handshaking_flag_d1 == 1 && row_wcnt == 31 && inf_frame_hit && vad_voiced)
+                                                                                                    n_state = send_mfcc;
+                            else if (handshaking_flag_d1 == 1 && row_wcnt == 31)                    n_state = send_finish;
             default     :                                                                           n_state = idle;
         endcase
     end
@@ -568,6 +598,7 @@ module binarizer #(
         send_flux_en        = 0;
         col_offset_inc_en   = 0;
         fsm_fe_complete     = 0;
+        fsm_vad_silence     = 0;
         unique case(p_state)
             idle        :   begin
                                 if (handshaking_flag_d1 == 1 && col_wcnt == 63)        send_flux_en = 1;
@@ -579,7 +610,8 @@ module binarizer #(
             send_mfcc   :   send_mfcc_en = 1;
             send_finish :   begin
                                 col_offset_inc_en = 1;
-                                fsm_fe_complete = 1;
+                                fsm_fe_complete = inf_frame_hit && vad_window_voiced;
+                                fsm_vad_silence = inf_frame_hit && !vad_window_voiced;
                             end
             idle2       :   if (handshaking_flag_d1 == 1)                              send_flux_en = 1;
             receive     :   if (handshaking_flag_d1 == 1)                              send_flux_en = 1;
@@ -587,6 +619,58 @@ module binarizer #(
         endcase
     end
     
+    // Inference stride: count the windows completed since the last fe_complete
+    assign inf_frame_hit = (inf_frame_cnt == 0);
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            inf_frame_cnt <= '0;
+        end else if (!spi_en_inf_system_sync) begin
+            inf_frame_cnt <= '0;
+        end else if (p_state == send_finish) begin
+            if (inf_frame_cnt + 1 >= SPI_INF_STRIDE)
+                inf_frame_cnt <= '0;
+            else
+                inf_frame_cnt <= inf_frame_cnt + 1;
+        end
+    end
+    
+    // Voice activity gate: running count of the flux bits in the window. The
+    // bit replaced is read out in the cycle before the write.
+    assign vad_flux_cnt_next = vad_flux_cnt + MEM_FLUX_CIRBUF_BANK_D_int
+                             - (vad_fill ? 1'b0 : flux_cirbuf_rdata[flux_cirbuf_col_wptr]);
+    assign vad_voiced        = (SPI_VAD_TH == 0) || (vad_flux_cnt_next >= SPI_VAD_TH);
+    assign vad_silence       = fsm_vad_silence;
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            vad_flux_cnt <= '0;
+        end else if (!spi_en_inf_system_sync) begin
+            vad_flux_cnt <= '0;
+        end else if (handshaking_flag_d1) begin
+            vad_flux_cnt <= vad_flux_cnt_next;
+        end
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            vad_fill <= 1;
+        end else if (!spi_en_inf_system_sync) begin
+            vad_fill <= 1;
+        end else if (p_state == send_finish) begin
+            vad_fill <= 0;
+        end
+    end
+    
+    // Decision for the window, taken with its last flux bit.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            vad_window_voiced <= 1;
+        end else if (handshaking_flag_d1 && row_wcnt == N_MEL-1) begin
+            vad_window_voiced <= vad_voiced;
+        end
+    end
+    
     // Get inference pulse
     assign spi_en_inf_system_pulse = ~spi_en_inf_system_sync_d1 & spi_en_inf_system_sync;
     
@@ -76,12 +76,17 @@ module feature_extractor #(
     input logic                         SPI_EN_INF,
     input logic                         SPI_EN_FE,
     input logic [15:0]                  SPI_FLUX_TH,
+    input logic [5:0]                   SPI_INF_STRIDE,
+    input logic [11:0]                  SPI_VAD_TH,
     
     // accelerator signals ----------------------------------------------------
     input logic                         feature_bank_ren,
     input logic [$clog2(2*N_MEL)-1:0]   feature_rptr,
     output logic [N_FRAME-1:0]          feature_bank_rdata,
-    output logic                        fe_complete
+    input logic                         tma_busy,
+    output logic                        fe_window_done,
+    output logic                        fe_complete,
+    output logic                        vad_silence
 );
     
     // spi_slave sync signals
@@ -351,6 +356,8 @@ module feature_extractor #(
         .spi_en_fe_system_sync      (spi_en_fe_system_sync      ),
         .spi_en_inf_system_sync     (spi_en_inf_system_sync     ),
         .SPI_FLUX_TH                (SPI_FLUX_TH                ),
+        .SPI_INF_STRIDE             (SPI_INF_STRIDE             ),
+        .SPI_VAD_TH                 (SPI_VAD_TH                 ),
         
         .mfcc_cirbuf_rdata0         (mfcc_cirbuf_rdata0         ),
         .mfcc_cirbuf_rdata1         (mfcc_cirbuf_rdata1         ),
@@ -384,7 +391,8 @@ module feature_extractor #(
         .MEM_FEBANK_A_binarizer     (MEM_FEBANK_A_binarizer     ),
         .MEM_FEBANK_D_binarizer     (MEM_FEBANK_D_binarizer     ),
         
-        .fe_complete                (fe_complete                )
+        .fe_complete                (fe_window_done             ),
+        .vad_silence                (vad_silence                )
     );
     
     feature_module #(
@@ -403,6 +411,9 @@ module feature_extractor #(
         .feature_bank_ren           (feature_bank_ren           ),
         .feature_rptr               (feature_rptr               ),
         .feature_bank_rdata         (feature_bank_rdata         ),
+        .tma_busy                   (tma_busy                   ),
+        .fe_window_done             (fe_window_done             ),
+        .fe_complete                (fe_complete                ),
         
         .MEM_MFCC_CIRBUF_BANK_CEB   (MEM_MFCC_CIRBUF_BANK_CEB   ),
         .MEM_MFCC_CIRBUF_BANK0_WEB  (MEM_MFCC_CIRBUF_BANK0_WEB  ),
@@ -24,6 +24,14 @@
 // 
 // Desc: Feature extractor feature bank module.
 //
+//       The feature bank is a ping-pong pair: the binarizer (or SPI) writes
+//       bank fe_bank_wsel while the accelerator reads the other one, so the
+//       next window is extracted during the inference of the previous one.
+//       A window completed while the accelerator is busy is held pending and
+//       handed over (banks swapped, fe_complete raised) once it is idle. A
+//       pending window is dropped when the binarizer starts overwriting it,
+//       and the newer window is handed over when it completes instead.
+//
 //==============================================================================
 
 module feature_module #(
@@ -43,6 +51,9 @@ module feature_module #(
     input logic                         feature_bank_ren,
     input logic [$clog2(2*N_MEL)-1:0]   feature_rptr,
     output logic [N_FRAME-1:0]          feature_bank_rdata,
+    input logic                         tma_busy,
+    input logic                         fe_window_done,
+    output logic                        fe_complete,
     
     // MFCC cricular buffer signals -------------------------------------------
     input logic                         MEM_MFCC_CIRBUF_BANK_CEB,
@@ -91,19 +102,51 @@ module feature_module #(
     logic [BIT_WIDTH-1:0]       mfcc_circular_buffer_bank7    [0:8*N_MEL-1];
     
     logic [N_FRAME-1:0]         flux_circular_buffer    [0:N_MEL-1];            // ram (w64d32)
-    logic [N_FRAME-1:0]         feature_bank            [0:2*N_MEL-1];          // ram (w64d64)
+    logic [N_FRAME-1:0]         feature_bank            [0:1][0:2*N_MEL-1];     // 2 ram (w64d64)
+    
+    // ping-pong control
+    logic                       fe_bank_wsel;
+    logic                       fe_pending;
+    logic                       fe_bank_swap;
     
-    logic                       MEM_FEBANK_CEB;
+    // write port (binarizer / SPI) and read port (accelerator)
+    logic                       MEM_FEBANK_W_CEB;
     logic [7:0]                 MEM_FEBANK_WEB;
-    logic [$clog2(2*N_MEL)-1:0] MEM_FEBANK_A;
+    logic [$clog2(2*N_MEL)-1:0] MEM_FEBANK_W_A;
     logic [N_FRAME-1:0]         MEM_FEBANK_D;
-    logic [N_FRAME-1:0]         MEM_FEBANK_Q;
     
-    assign feature_bank_rdata = MEM_FEBANK_Q;
+    logic                       MEM_FEBANK_CEB          [0:1];
+    logic [7:0]                 MEM_FEBANK_BANK_WEB     [0:1];
+    logic [$clog2(2*N_MEL)-1:0] MEM_FEBANK_A            [0:1];
+    logic [N_FRAME-1:0]         MEM_FEBANK_Q            [0:1];
+    
+    assign feature_bank_rdata = MEM_FEBANK_Q[!fe_bank_wsel];
+    
+    assign MEM_FEBANK_W_CEB = MEM_FEBANK_CEB_binarizer && !spi_wen_fe_bank_sync;
+    assign MEM_FEBANK_W_A   = (spi_wen_fe_bank_sync)? SPI_ADDR[$clog2(2*N_MEL):1] : MEM_FEBANK_A_binarizer;
+    
+    // Hand the written bank over when the accelerator is idle, but never in
+    // a cycle that writes it.
+    assign fe_bank_swap = (fe_window_done || fe_pending) && !tma_busy && MEM_FEBANK_W_CEB;
+    assign fe_complete  = fe_bank_swap;
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)
+            fe_bank_wsel <= 0;
+        else if (fe_bank_swap)
+            fe_bank_wsel <= !fe_bank_wsel;
+    end
     
-    assign MEM_FEBANK_CEB   = MEM_FEBANK_CEB_binarizer && !spi_wen_fe_bank_sync && !feature_bank_ren;
-    assign MEM_FEBANK_A     = (spi_wen_fe_bank_sync)? SPI_ADDR[$clog2(2*N_MEL):1] : 
-                              (feature_bank_ren)? feature_rptr : MEM_FEBANK_A_binarizer;
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)
+            fe_pending <= 0;
+        else if (fe_bank_swap)
+            fe_pending <= 0;
+        else if (fe_window_done)
+            fe_pending <= 1;
+        else if (!MEM_FEBANK_W_CEB)
+            fe_pending <= 0;
+    end
     
     always_comb begin
         MEM_FEBANK_D = 0;
@@ -216,19 +259,25 @@ module feature_module #(
     //-------------------------------------------------------------------------
     // Feature bank
     //-------------------------------------------------------------------------
-    for (genvar i = 0; i < 8; i++) begin
-        always_ff @(posedge clk) begin
-            if (!MEM_FEBANK_CEB) begin
-                if (!MEM_FEBANK_WEB[i])
-                    feature_bank[MEM_FEBANK_A][i * 8 +: 8] <= MEM_FEBANK_D[i * 8 +: 8];
+    for (genvar b = 0; b < 2; b++) begin
+        assign MEM_FEBANK_CEB[b]      = (fe_bank_wsel == b)? MEM_FEBANK_W_CEB : !feature_bank_ren;
+        assign MEM_FEBANK_BANK_WEB[b] = (fe_bank_wsel == b)? MEM_FEBANK_WEB : '1;
+        assign MEM_FEBANK_A[b]        = (fe_bank_wsel == b)? MEM_FEBANK_W_A : feature_rptr;
+        
+        for (genvar i = 0; i < 8; i++) begin
+            always_ff @(posedge clk) begin
+                if (!MEM_FEBANK_CEB[b]) begin
+                    if (!MEM_FEBANK_BANK_WEB[b][i])
+                        feature_bank[b][MEM_FEBANK_A[b]][i * 8 +: 8] <= MEM_FEBANK_D[i * 8 +: 8];
+                end
             end
         end
-    end
-    
-    always_ff @(posedge clk) begin
-        if (!MEM_FEBANK_CEB) begin
-            if (MEM_FEBANK_WEB)
-                MEM_FEBANK_Q <= feature_bank[MEM_FEBANK_A];
+        
+        always_ff @(posedge clk) begin
+            if (!MEM_FEBANK_CEB[b]) begin
+                if (&MEM_FEBANK_BANK_WEB[b])
+                    MEM_FEBANK_Q[b] <= feature_bank[b][MEM_FEBANK_A[b]];
+            end
         end
     end
     
@@ -24,6 +24,24 @@
 // 
 // Desc: Multi-classification Tsetlin Machine argmax component.
 //
+//       Early exit: *class_bound* holds the largest class_summation each
+//       class can reach (the sum of its positive weights, loaded over SPI).
+//       With SPI_EN_EARLY_EXIT set, the inference ends after class c when
+//       the leader is at least the bound of every class after c. Ties go to
+//       the lower class, so the result is the same as a full inference.
+//
+//       Only the classes set in class_en take part: the inference starts at
+//       the first and ends at the last of them.
+//
+//       vad_result_en (a silent window, no inference) loads SPI_VAD_CLASS as
+//       the result.
+//
+//       class_score holds the class sums of the last inference for the
+//       result FIFO, -8192 for the classes it did not sum, and score_margin
+//       the lead over the second best of them (0 on a tie or a silent
+//       window). Both are registered and held from argmax_done to the next
+//       inference, as result is.
+//
 //==============================================================================
 
 module argmax (
@@ -31,47 +49,137 @@ module argmax (
     input logic                         argmax_ena,
     input logic signed [13:0]           class_summation,
     input logic [3:0]                   class_idx,
+    input logic [15:0]                  class_en,
+    
+    // spi slave signals ------------------------------------------------------
+    input logic                         spi_wen_bound_bank_sync,
+    input logic [11:0]                  SPI_ADDR,
+    input logic [31:0]                  SPI_DATA,
     
     // spi slave Configuration registers --------------------------------------
     input logic [3:0]                   SPI_NUM_CLASS,
+    input logic                         SPI_EN_EARLY_EXIT,
+    input logic                         vad_result_en,
+    input logic [3:0]                   SPI_VAD_CLASS,
     
     output logic [3:0]                  result,
-    output logic                        argmax_done
+    output logic                        argmax_done,
+    output logic                        early_exit,
+    output logic signed [13:0]          class_score     [16],
+    output logic [13:0]                 score_margin
 );
     
     logic signed [13:0]     max_summation;
+    logic signed [13:0]     second_summation;
     logic [3:0]             max_class;
     logic [3:0]             n_class;
     
+    logic signed [13:0]     class_bound     [16];
+    logic signed [13:0]     lead_summation;
+    logic signed [13:0]     lead_second;
+    logic [3:0]             lead_class;
+    logic signed [13:0]     rest_bound;
+    logic                   exit_hit;
+    logic [3:0]             first_class;
+    logic [3:0]             last_class;
+    
     // assign for configuration registers
     assign n_class = SPI_NUM_CLASS;
     
+    always_ff @(posedge clk) begin
+        if (spi_wen_bound_bank_sync)    class_bound[SPI_ADDR[3:0]] <= SPI_DATA[13:0];
+    end
+    
+    // First and last enabled class.
+    always_comb begin
+        first_class = 0;
+        last_class  = 0;
+        for (int j = 15; j >= 0; j--) begin
+            if (j < n_class && class_en[j])
+                first_class = j;
+        end
+        for (int j = 0; j < 16; j++) begin
+            if (j < n_class && class_en[j])
+                last_class = j;
+        end
+    end
+    
+    // Leader after this class, and the best the remaining classes can reach.
+    assign lead_summation   = (class_summation > max_summation)? class_summation : max_summation;
+    assign lead_class       = (class_summation > max_summation)? class_idx : max_class;
+    assign lead_second      = (class_summation > max_summation)?    max_summation :
+                              (class_summation > second_summation)? class_summation : second_summation;
+    
+    always_comb begin
+        rest_bound = {1'b1,13'd0};
+        for (int j = 0; j < 16; j++) begin
+            if (j > class_idx && j < n_class && class_en[j] && class_bound[j] > rest_bound)
+                rest_bound = class_bound[j];
+        end
+    end
+    
+    assign exit_hit = SPI_EN_EARLY_EXIT && argmax_ena && class_idx < last_class && lead_summation >= rest_bound;
+    
     // When enable argmax, read "class_summation".
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
-            max_summation   <= {1'b1,13'd0};
-            max_class       <= 0;
+            max_summation       <= {1'b1,13'd0};
+            max_class           <= 0;
+            second_summation    <= {1'b1,13'd0};
         end else if(argmax_ena && class_summation > max_summation) begin
-            max_summation   <= class_summation;
-            max_class       <= class_idx;
+            max_summation       <= class_summation;
+            max_class           <= class_idx;
+            second_summation    <= max_summation;
         end else if(argmax_done) begin
-            max_summation   <= {1'b1,13'd0};
-            max_class       <= 0;
+            max_summation       <= {1'b1,13'd0};
+            max_class           <= 0;
+            second_summation    <= {1'b1,13'd0};
+        end else if(argmax_ena && class_summation > second_summation) begin
+            second_summation    <= class_summation;
+        end
+    end
+    
+    // Cleared when a new inference starts or a silent window is reported.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if(!rst_n) begin
+            for (int j = 0; j < 16; j++)    class_score[j] <= {1'b1,13'd0};
+        end else if(vad_result_en || (argmax_ena && class_idx == first_class)) begin
+            for (int j = 0; j < 16; j++)    class_score[j] <= {1'b1,13'd0};
+            if (argmax_ena)                 class_score[class_idx] <= class_summation;
+        end else if(argmax_ena) begin
+            class_score[class_idx] <= class_summation;
         end
     end
     
     // When finish an inference, send a "argmax_done" signal.
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
-            argmax_done <= 0;
-            result      <= 0;
-        end else if (argmax_ena && class_idx == n_class - 1) begin
-            argmax_done <= 1;
-            result      <= (class_summation > max_summation)? class_idx : max_class; 
-        end else if (argmax_ena && class_idx == 0) begin    // When start a new inference, set "argmax_done" to 0.
-            argmax_done <= 0;
-            result      <= 0;
+            argmax_done  <= 0;
+            result       <= 0;
+            score_margin <= 0;
+        end else if (vad_result_en) begin
+            argmax_done  <= 1;
+            result       <= SPI_VAD_CLASS;
+            score_margin <= 0;
+        end else if (argmax_ena && class_idx == last_class) begin
+            argmax_done  <= 1;
+            result       <= (class_summation > max_summation)? class_idx : max_class; 
+            score_margin <= lead_summation - lead_second;
+        end else if (exit_hit) begin
+            argmax_done  <= 1;
+            result       <= lead_class;
+            score_margin <= lead_summation - lead_second;
+        end else if (argmax_ena && class_idx == first_class) begin    // When start a new inference, set "argmax_done" to 0.
+            argmax_done  <= 0;
+            result       <= 0;
+            score_margin <= 0;
         end
     end
+    
+    // One-cycle pulse to the controller: stop decoding and flush the datapath.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if(!rst_n)  early_exit <= 0;
+        else        early_exit <= exit_hit;
+    end
 
 endmodule
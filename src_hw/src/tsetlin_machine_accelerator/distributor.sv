@@ -25,6 +25,20 @@
 // Desc: The distributor is used to distribute data between the feature module 
 //       and the PE array.
 //
+//       Each PE column gets N_CCL_WORD lanes, one per CCL word the decoder
+//       issues in a cycle: a literal, its clause index and inversion, and a
+//       lane enable (pe_ena). The lanes of a cycle share the element
+//       (code_pe_stage) but each has its own row of the block.
+//
+//       The two feature rows and position rows of a block are kept per
+//       block FIFO entry of the decoder (DEPTH_BLOCK_FIFO entries, written
+//       in block order), and every PE column reads those of the block in
+//       its PE stage (fifo_slot_ccl_stage), so the columns can work on
+//       different blocks of a round.
+//
+//       flush (an early exit) returns every register to its reset value on
+//       the next clock edge.
+//
 //==============================================================================
 
 module distributor #(
@@ -34,26 +48,31 @@ module distributor #(
     parameter N_PE_COL                  = 5,
     parameter N_ELEMENT                 = 4,
     parameter DEPTH_BLOCK_BANK          = 2048,
-    parameter DEPTH_CCL_BANK            = 4096
+    parameter DEPTH_CCL_BANK            = 4096,
+    parameter N_CCL_WORD                = 1,
+    parameter DEPTH_BLOCK_FIFO          = 4
     
 )(
     input logic                                 clk,
     input logic                                 rst_n,
+    input logic                                 flush,
     
     // tma controller signals -------------------------------------------------
     input logic                                 decode_en,
     
     // OG-BCSR decoder signals ------------------------------------------------
-    input logic [$clog2(DEPTH_BLOCK_BANK)-1:0]  raddr_block_idx_bank,
+    input logic                                 class_skip_last,
     input logic                                 block_stage_ready,
     input logic [N_PE_COL-1:0]                  block_stage_valid,
     input logic                                 row_stage_ready,
     input logic                                 row_stage_valid         [N_PE_COL],
-    input logic                                 row_spad_index          [N_PE_COL],
+    input logic [N_CCL_WORD-1:0]                row_spad_index          [N_PE_COL],
     input logic                                 col_clause_stage_valid  [N_PE_COL],
+    input logic [N_CCL_WORD-1:0]                col_clause_lane_valid   [N_PE_COL],
     input logic                                 col_clause_stage_ready  [N_PE_COL],
-    input logic [4:0]                           col_clause_index        [N_PE_COL], // sync with col_valid
+    input logic [4:0]                           col_clause_index        [N_PE_COL][N_CCL_WORD], // sync with col_valid
     input logic [1:0]                           code_ccl_stage          [N_PE_COL],
+    input logic [$clog2(DEPTH_BLOCK_FIFO)-1:0]  fifo_slot_ccl_stage     [N_PE_COL],
     input logic [$clog2(DEPTH_CCL_BANK)-1:0]    raddr_col_clause_idx_bank_int [N_PE_COL],
     
     // feature bank signals ---------------------------------------------------
@@ -63,16 +82,16 @@ module distributor #(
     
     // downstream signals -----------------------------------------------------
     output logic [1:0]                          code_pe_stage           [N_PE_COL],
-    output logic                                pe_ena                  [N_PE_COL],
+    output logic [N_CCL_WORD-1:0]               pe_ena                  [N_PE_COL],
     output logic [2*N_ELEMENT-1:0]              next_clause_flag_to_PE  [N_PE_COL],
-    output logic                                clause_index            [N_PE_COL],
-    output logic                                inv_en                  [N_PE_COL],
-    output logic [NUMBER_OF_PATCH-1:0]          literal_data            [N_PE_COL],
+    output logic [N_CCL_WORD-1:0]               clause_index            [N_PE_COL],
+    output logic [N_CCL_WORD-1:0]               inv_en                  [N_PE_COL],
+    output logic [NUMBER_OF_PATCH-1:0]          literal_data            [N_PE_COL][N_CCL_WORD],
     output logic                                summation_ena
 );
     
 
-    genvar i;
+    genvar i, j;
     
     // feature bank accessment signals
     logic                       wait_sram;
@@ -80,31 +99,21 @@ module distributor #(
     logic                       r_ctrl_cnt;
     logic                       w_ctrl_cnt;
     
-    // feature bank spad signals
-    logic                       row_spad_index_d1           [N_PE_COL];
-    logic                       spad_w_sel;
-    logic                       spad_r_sel;
-    logic                       block_stage_handshaking_d1;
-    logic                       block_stage_handshaking_d2;
-    logic                       update_block_index_flag;
-    logic [N_FRAME-1:0]         feature_bank_row_data0;
-    logic [N_FRAME-1:0]         feature_bank_row_data1;
-    logic [N_FRAME-1:0]         feature_bank_row_data2;
-    logic [N_FRAME-1:0]         feature_bank_row_data3;
-    logic [N_FRAME-1:0]         feature_bank_data0;
-    logic [N_FRAME-1:0]         feature_bank_data1;
+    // feature bank spad signals, two rows per block FIFO entry
+    logic [N_CCL_WORD-1:0]      row_spad_index_d1           [N_PE_COL];
+    logic [$clog2(DEPTH_BLOCK_FIFO)-1:0] spad_w_slot;
+    logic [N_FRAME-1:0]         feature_spad                [DEPTH_BLOCK_FIFO][2];
     
     // position spad signals
-    logic [NUMBER_OF_PATCH-1:0] position_bank_row_data0;
-    logic [NUMBER_OF_PATCH-1:0] position_bank_row_data1;
-    logic                       reset_pos_data_flag;
-    logic                       update_pos_data_flag;
+    logic [NUMBER_OF_PATCH-1:0] position_row_data;
+    logic [NUMBER_OF_PATCH-1:0] position_spad               [DEPTH_BLOCK_FIFO][2];
     
     // internal signals
-    logic [2:0]                 col_index                   [N_PE_COL];
-    logic [N_FRAME-1:0]         row_data                    [N_PE_COL];
-    logic [NUMBER_OF_PATCH-1:0] pos_data                    [N_PE_COL];
-    logic [NUMBER_OF_PATCH-1:0] literal_data_int            [N_PE_COL];
+    logic [2:0]                 col_index                   [N_PE_COL][N_CCL_WORD];
+    logic [N_FRAME-1:0]         row_data                    [N_PE_COL][N_CCL_WORD];
+    logic [NUMBER_OF_PATCH-1:0] pos_data                    [N_PE_COL][N_CCL_WORD];
+    logic [NUMBER_OF_PATCH-1:0] literal_data_int            [N_PE_COL][N_CCL_WORD];
+    logic                       block_read_flag;
     logic                       next_clause_flag_r;
     logic                       next_clause_flag_c;
     logic                       next_clause_flag_c_d1;
@@ -121,29 +130,34 @@ module distributor #(
 generate
 for (i = 0; i < N_PE_COL; i++) begin
     
-    assign pe_ena[i]        = (col_clause_stage_valid[i] == 1)? 1 : 0;
-    assign clause_index[i]  = col_clause_index[i][4];
-    assign inv_en[i]        = (col_clause_index[i][3] == 1'b1);
-    assign literal_data[i]  = literal_data_int[i];
-    
-    assign col_index[i] = col_clause_index[i][2:0];
-    assign row_data[i] = (row_spad_index_d1[i] == 0)? feature_bank_data0 : feature_bank_data1;
-    assign pos_data[i] = (row_spad_index_d1[i] == 0)? position_bank_row_data0 : position_bank_row_data1;
-    
-    // According to the column index, get the literal_data
-    always_comb begin
-        literal_data_int[i] = '1;
-        unique case(col_index[i])
-            0: literal_data_int[i] = pos_data[i];
-            1: literal_data_int[i] = row_data[i][57:0];
-            2: literal_data_int[i] = row_data[i][58:1];
-            3: literal_data_int[i] = row_data[i][59:2];
-            4: literal_data_int[i] = row_data[i][60:3];
-            5: literal_data_int[i] = row_data[i][61:4];
-            6: literal_data_int[i] = row_data[i][62:5];
-            7: literal_data_int[i] = row_data[i][63:6];
-            default: ;
-        endcase
+    assign pe_ena[i]        = col_clause_lane_valid[i];
+    
+    for (j = 0; j < N_CCL_WORD; j++) begin
+        
+        assign clause_index[i][j]   = col_clause_index[i][j][4];
+        assign inv_en[i][j]         = (col_clause_index[i][j][3] == 1'b1);
+        assign literal_data[i][j]   = literal_data_int[i][j];
+        
+        assign col_index[i][j] = col_clause_index[i][j][2:0];
+        assign row_data[i][j] = feature_spad[fifo_slot_ccl_stage[i]][row_spad_index_d1[i][j]];
+        assign pos_data[i][j] = position_spad[fifo_slot_ccl_stage[i]][row_spad_index_d1[i][j]];
+        
+        // According to the column index, get the literal_data
+        always_comb begin
+            literal_data_int[i][j] = '1;
+            unique case(col_index[i][j])
+                0: literal_data_int[i][j] = pos_data[i][j];
+                1: literal_data_int[i][j] = row_data[i][j][57:0];
+                2: literal_data_int[i][j] = row_data[i][j][58:1];
+                3: literal_data_int[i][j] = row_data[i][j][59:2];
+                4: literal_data_int[i][j] = row_data[i][j][60:3];
+                5: literal_data_int[i][j] = row_data[i][j][61:4];
+                6: literal_data_int[i][j] = row_data[i][j][62:5];
+                7: literal_data_int[i][j] = row_data[i][j][63:6];
+                default: ;
+            endcase
+        end
+        
     end
     
     assign code_pe_stage[i] = code_ccl_stage[i];
@@ -152,20 +166,26 @@ for (i = 0; i < N_PE_COL; i++) begin
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             next_clause_flag_to_PE[i] <= '1;
+        end else if (flush) begin
+            next_clause_flag_to_PE[i] <= '1;
         end else if (next_clause_flag)begin
             next_clause_flag_to_PE[i] <= '1;
-        end else if (pe_ena[i]) begin
-            unique case({code_pe_stage[i], clause_index[i]})
-                3'b00_0: next_clause_flag_to_PE[i][0] <= 0;
-                3'b00_1: next_clause_flag_to_PE[i][1] <= 0;
-                3'b01_0: next_clause_flag_to_PE[i][2] <= 0;
-                3'b01_1: next_clause_flag_to_PE[i][3] <= 0;
-                3'b10_0: next_clause_flag_to_PE[i][4] <= 0;
-                3'b10_1: next_clause_flag_to_PE[i][5] <= 0;
-                3'b11_0: next_clause_flag_to_PE[i][6] <= 0;
-                3'b11_1: next_clause_flag_to_PE[i][7] <= 0;
-                default:   ;
-            endcase
+        end else begin
+            for (int k = 0; k < N_CCL_WORD; k++) begin
+                if (pe_ena[i][k]) begin
+                    unique case({code_pe_stage[i], clause_index[i][k]})
+                        3'b00_0: next_clause_flag_to_PE[i][0] <= 0;
+                        3'b00_1: next_clause_flag_to_PE[i][1] <= 0;
+                        3'b01_0: next_clause_flag_to_PE[i][2] <= 0;
+                        3'b01_1: next_clause_flag_to_PE[i][3] <= 0;
+                        3'b10_0: next_clause_flag_to_PE[i][4] <= 0;
+                        3'b10_1: next_clause_flag_to_PE[i][5] <= 0;
+                        3'b11_0: next_clause_flag_to_PE[i][6] <= 0;
+                        3'b11_1: next_clause_flag_to_PE[i][7] <= 0;
+                        default:   ;
+                    endcase
+                end
+            end
         end
     end
     
@@ -173,6 +193,8 @@ for (i = 0; i < N_PE_COL; i++) begin
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             row_spad_index_d1[i] <= '0;
+        end else if (flush) begin
+            row_spad_index_d1[i] <= '0;
         end else if (row_stage_valid[i] && col_clause_stage_ready[i]) begin
             row_spad_index_d1[i] <= row_spad_index[i];
         end
@@ -190,6 +212,9 @@ endgenerate
         if (!rst_n) begin
             block_stage_row_index   <= 0;
             r_ctrl_cnt              <= 0;
+        end else if (flush) begin
+            block_stage_row_index   <= 0;
+            r_ctrl_cnt              <= 0;
         end else if (decode_en && block_stage_ready && r_ctrl_cnt == 0) begin
             block_stage_row_index   <= block_stage_row_index + 1'b1;
             r_ctrl_cnt              <= 1;
@@ -210,91 +235,50 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             wait_sram <= 0;
+        end else if (flush) begin
+            wait_sram <= 0;
         end else begin
             wait_sram <= feature_bank_ren;
         end
     end
     
-    // Update feature bank row data to spad
+    // Update feature bank row data to the spad of the block FIFO entry,
+    // which moves on after the second row.
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
-            feature_bank_row_data0  <= 0;
-            feature_bank_row_data1  <= 0;
-            feature_bank_row_data2  <= 0;
-            feature_bank_row_data3  <= 0;
             w_ctrl_cnt              <= 0;
-            spad_w_sel              <= 0;
-        end else if (wait_sram == 1 && w_ctrl_cnt == 0 && spad_w_sel == 0) begin
-            feature_bank_row_data0  <= feature_bank_rdata;
-            w_ctrl_cnt              <= ~w_ctrl_cnt;
-        end else if (wait_sram == 1 && w_ctrl_cnt == 1 && spad_w_sel == 0) begin
-            feature_bank_row_data1  <= feature_bank_rdata;
-            w_ctrl_cnt              <= ~w_ctrl_cnt;
-            spad_w_sel              <= ~spad_w_sel;
-        end else if (wait_sram == 1 && w_ctrl_cnt == 0 && spad_w_sel == 1) begin
-            feature_bank_row_data2  <= feature_bank_rdata;
-            w_ctrl_cnt              <= ~w_ctrl_cnt;
-        end else if (wait_sram == 1 && w_ctrl_cnt == 1 && spad_w_sel == 1) begin
-            feature_bank_row_data3  <= feature_bank_rdata;
-            w_ctrl_cnt              <= ~w_ctrl_cnt;
-            spad_w_sel              <= ~spad_w_sel;
-        end
-    end
-  
-    // When "update_block_index_flag" == 1, update "spad_r_sel".
-    assign update_block_index_flag = block_stage_handshaking_d2;
-    
-    // Get the block stage handshaking delay signal.
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
-            block_stage_handshaking_d1 <= 0;
-        end else if (decode_en && block_stage_ready && block_stage_row_index != 0) begin
-            block_stage_handshaking_d1 <= 1;
-        end else begin
-            block_stage_handshaking_d1 <= 0;
-        end
-    end
-    
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
-            block_stage_handshaking_d2 <= 0;
-        end else begin
-            block_stage_handshaking_d2 <= block_stage_handshaking_d1;
+            spad_w_slot             <= '0;
+        end else if (flush) begin
+            w_ctrl_cnt              <= 0;
+            spad_w_slot             <= '0;
+        end else if (wait_sram == 1 && w_ctrl_cnt == 0) begin
+            w_ctrl_cnt              <= 1;
+        end else if (wait_sram == 1 && w_ctrl_cnt == 1) begin
+            w_ctrl_cnt              <= 0;
+            spad_w_slot             <= spad_w_slot + 1'b1;
         end
     end
     
-    // When block stage handshaking, update the spad read selection signal. 
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
-            spad_r_sel <= 0;
-        end else if (update_block_index_flag == 1) begin
-            spad_r_sel <= ~spad_r_sel;
-        end else if (next_clause_flag) begin
-            spad_r_sel <= 0;
+    always_ff @(posedge clk) begin
+        if (wait_sram == 1) begin
+            feature_spad[spad_w_slot][w_ctrl_cnt] <= feature_bank_rdata;
         end
     end
     
-    assign feature_bank_data0 = (spad_r_sel == 0)? feature_bank_row_data0 : feature_bank_row_data2;
-    assign feature_bank_data1 = (spad_r_sel == 0)? feature_bank_row_data1 : feature_bank_row_data3;
-    
     
     //-------------------------------------------------------------------------
     // Update position row data spad
     //-------------------------------------------------------------------------
-    assign reset_pos_data_flag  = next_clause_flag;
-    assign update_pos_data_flag = block_stage_handshaking_d2;
     
-    // FORMAT: {WIN 57, WIN 56, ..., WIN 1, WIN 0}.
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
-            position_bank_row_data0 <= 58'h3FF_FFFF_FFFF_FFFE;
-            position_bank_row_data1 <= 58'h3FF_FFFF_FFFF_FFFC;
-        end else if (reset_pos_data_flag) begin
-            position_bank_row_data0 <= 58'h3FF_FFFF_FFFF_FFFE;
-            position_bank_row_data1 <= 58'h3FF_FFFF_FFFF_FFFC;
-        end else if (update_pos_data_flag) begin
-            position_bank_row_data0 <= position_bank_row_data0 << 2;
-            position_bank_row_data1 <= position_bank_row_data1 << 2;
+    // FORMAT: {WIN 57, WIN 56, ..., WIN 1, WIN 0}. Row r keeps the windows
+    // above r, and block_stage_row_index is the first row of the block + 1
+    // when that row arrives.
+    assign position_row_data = {NUMBER_OF_PATCH{1'b1}} << block_stage_row_index;
+    
+    always_ff @(posedge clk) begin
+        if (wait_sram == 1 && w_ctrl_cnt == 0) begin
+            position_spad[spad_w_slot][0] <= position_row_data;
+            position_spad[spad_w_slot][1] <= position_row_data << 1;
         end
     end
     
@@ -307,11 +291,26 @@ endgenerate
     assign next_clause_flag = next_clause_flag_c || next_clause_last_flag;
     assign summation_ena    = next_clause_flag_c_d1 || next_clause_last_flag;
     
+    // Set after the first block of the inference (which need not be block 0 when classes are skipped).
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            block_read_flag <= 0;
+        end else if (flush) begin
+            block_read_flag <= 0;
+        end else if (!decode_en) begin
+            block_read_flag <= 0;
+        end else if (block_stage_ready) begin
+            block_read_flag <= 1;
+        end
+    end
+    
     // When the block stage handshaking, if row_index == 0, it means a new clause starts to be processed.
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             next_clause_flag_r <= 0;
-        end else if (decode_en && block_stage_ready && block_stage_row_index == 0 && raddr_block_idx_bank != 0) begin
+        end else if (flush) begin
+            next_clause_flag_r <= 0;
+        end else if (decode_en && block_stage_ready && block_stage_row_index == 0 && block_read_flag) begin
             next_clause_flag_r <= 1;
         end else begin
             next_clause_flag_r <= 0;
@@ -322,6 +321,9 @@ endgenerate
         if (!rst_n) begin
             next_clause_flag_c <= 0;
             next_clause_flag_c_d1 <= 0;
+        end else if (flush) begin
+            next_clause_flag_c <= 0;
+            next_clause_flag_c_d1 <= 0;
         end else begin
             next_clause_flag_c <= next_clause_flag_r;
             next_clause_flag_c_d1 <= next_clause_flag_c;
@@ -336,6 +338,8 @@ for (i = 0; i < N_PE_COL; i++) begin
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             col_stage_handshaking_d1[i] <= 0;
+        end else if (flush) begin
+            col_stage_handshaking_d1[i] <= 0;
         end else begin
             col_stage_handshaking_d1[i] <= col_clause_stage_valid[i];
         end
@@ -344,24 +348,26 @@ for (i = 0; i < N_PE_COL; i++) begin
 end
 endgenerate
     
-    assign col_stage_handshaking_d1_total = col_stage_handshaking_d1[0]  || col_stage_handshaking_d1[1] ||
-                                            col_stage_handshaking_d1[2]  || col_stage_handshaking_d1[3] ||
-                                            col_stage_handshaking_d1[4];
+    always_comb begin
+        col_stage_handshaking_d1_total = 0;
+        for (int k = 0; k < N_PE_COL; k++) begin
+            col_stage_handshaking_d1_total = col_stage_handshaking_d1_total || col_stage_handshaking_d1[k];
+        end
+    end
     
     always_comb begin
-        updata_last_clause_flag = 0;
-        if (col_stage_handshaking_d1_total == 1 && 
-                raddr_col_clause_idx_bank_int[0] == 0 && raddr_col_clause_idx_bank_int[1] == 0 &&
-                raddr_col_clause_idx_bank_int[2] == 0 && raddr_col_clause_idx_bank_int[3] == 0 &&
-                raddr_col_clause_idx_bank_int[4] == 0) begin
-            updata_last_clause_flag = 1;
+        updata_last_clause_flag = col_stage_handshaking_d1_total;
+        for (int k = 0; k < N_PE_COL; k++) begin
+            updata_last_clause_flag = updata_last_clause_flag && raddr_col_clause_idx_bank_int[k] == 0;
         end
     end
     
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             next_clause_last_flag <= 0;
-        end else if (updata_last_clause_flag) begin
+        end else if (flush) begin
+            next_clause_last_flag <= 0;
+        end else if (updata_last_clause_flag || class_skip_last) begin
             next_clause_last_flag <= 1;
         end else begin
             next_clause_last_flag <= 0;
@@ -0,0 +1,108 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+// 
+// Licensed under the Solderpad Hardware License v 2.1 (the “License”); 
+// you may not use this file except in compliance with the License, or, 
+// at your option, the Apache License version 2.0. 
+// You may obtain a copy of the License at
+// 
+// https://solderpad.org/licenses/SHL-2.1/
+// 
+// Unless required by applicable law or agreed to in writing, any work 
+// distributed under the License is distributed on an “AS IS” BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and 
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "keyword_decision.sv"
+//
+// Author: Baizhou Lin, University of Southampton
+// 
+// Desc: Keyword decision engine, the result post-processing of the
+//       firmware (main_codec.c) after argmax.
+//
+//       Every inference adds one entry: its result if the previous
+//       inference gave the same one, SPI_VAD_CLASS (silence) otherwise.
+//       A keyword is confirmed when SPI_KWD_RUN entries in a row carry the
+//       same class other than silence; runs are counted within the last
+//       SPI_KWD_WINDOW entries, so a run longer than the window never
+//       completes. After a keyword, the next SPI_KWD_HOLDOFF entries are
+//       forced to silence.
+//
+//       With SPI_EN_KWD set, kwd_done is a one-cycle pulse with the
+//       keyword in kwd_result, which replace Inf_Done and Result at the
+//       pins; the result FIFO still records every inference.
+//
+//==============================================================================
+
+module keyword_decision (
+    input logic                         clk, rst_n,
+    input logic                         inf_done,
+    input logic [3:0]                   result,
+    
+    // spi slave Configuration registers --------------------------------------
+    input logic                         SPI_EN_KWD,
+    input logic [5:0]                   SPI_KWD_WINDOW,
+    input logic [5:0]                   SPI_KWD_RUN,
+    input logic [5:0]                   SPI_KWD_HOLDOFF,
+    input logic [3:0]                   SPI_VAD_CLASS,
+    
+    output logic [3:0]                  kwd_result,
+    output logic                        kwd_done
+);
+    
+    logic [3:0]     last_result;
+    logic [3:0]     entry;
+    logic [3:0]     run_class;
+    logic [5:0]     run_len, run_len_next;
+    logic [5:0]     holdoff_cnt;
+    logic           kwd_hit;
+    
+    // debounced entry of this inference
+    assign entry        = (holdoff_cnt != 0 || result != last_result)? SPI_VAD_CLASS : result;
+    
+    assign run_len_next = (entry != run_class)?         6'd1 :
+                          (run_len < SPI_KWD_WINDOW)?   run_len + 1'b1 : run_len;
+    
+    assign kwd_hit      = SPI_EN_KWD && entry != SPI_VAD_CLASS && run_len_next == SPI_KWD_RUN;
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            last_result <= 0;
+            run_class   <= 0;
+            run_len     <= 0;
+            holdoff_cnt <= 0;
+        end else if (!SPI_EN_KWD) begin
+            last_result <= SPI_VAD_CLASS;
+            run_class   <= SPI_VAD_CLASS;
+            run_len     <= 0;
+            holdoff_cnt <= 0;
+        end else if (inf_done) begin
+            last_result <= result;
+            if (kwd_hit) begin
+                run_class   <= SPI_VAD_CLASS;
+                run_len     <= 0;
+                holdoff_cnt <= SPI_KWD_HOLDOFF;
+            end else begin
+                run_class   <= entry;
+                run_len     <= run_len_next;
+                if (holdoff_cnt != 0)   holdoff_cnt <= holdoff_cnt - 1'b1;
+            end
+        end
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            kwd_done    <= 0;
+            kwd_result  <= 0;
+        end else begin
+            kwd_done    <= inf_done && kwd_hit;
+            if (inf_done && kwd_hit)    kwd_result <= entry;
+        end
+    end
+
+endmodule
@@ -47,11 +47,7 @@ module mem_row_cnt_bank #(
     logic                                       MEM_ROW_BANK_WE     [N_PE_COL];
     logic [$clog2(DEPTH_ROW_BANK)-1:0]          MEM_ROW_BANK_ADDR   [N_PE_COL];
     
-    logic [5:0] row_cnt_bank0    [DEPTH_ROW_BANK];
-    logic [5:0] row_cnt_bank1    [DEPTH_ROW_BANK];
-    logic [5:0] row_cnt_bank2    [DEPTH_ROW_BANK];
-    logic [5:0] row_cnt_bank3    [DEPTH_ROW_BANK];
-    logic [5:0] row_cnt_bank4    [DEPTH_ROW_BANK];
+    logic [5:0] row_cnt_bank     [N_PE_COL][DEPTH_ROW_BANK];
     
     always_comb begin
         for (int i = 0; i < N_PE_COL; i++) begin
@@ -63,37 +59,11 @@ module mem_row_cnt_bank #(
     end
     
     always_ff @(posedge clk) begin
-        if (!MEM_ROW_BANK_CE[0]) begin
-            if (!MEM_ROW_BANK_WE[0])    row_cnt_bank0[MEM_ROW_BANK_ADDR[0]] <= SPI_DATA[5:0];
-            else                        row_cnt_data[0] <= row_cnt_bank0[MEM_ROW_BANK_ADDR[0]];
-        end
-    end
-    
-    always_ff @(posedge clk) begin
-        if (!MEM_ROW_BANK_CE[1]) begin
-            if (!MEM_ROW_BANK_WE[1])    row_cnt_bank1[MEM_ROW_BANK_ADDR[1]] <= SPI_DATA[5:0];
-            else                        row_cnt_data[1] <= row_cnt_bank1[MEM_ROW_BANK_ADDR[1]];
-        end
-    end
-    
-    always_ff @(posedge clk) begin
-        if (!MEM_ROW_BANK_CE[2]) begin
-            if (!MEM_ROW_BANK_WE[2])    row_cnt_bank2[MEM_ROW_BANK_ADDR[2]] <= SPI_DATA[5:0];
-            else                        row_cnt_data[2] <= row_cnt_bank2[MEM_ROW_BANK_ADDR[2]];
-        end
-    end
-    
-    always_ff @(posedge clk) begin
-        if (!MEM_ROW_BANK_CE[3]) begin
-            if (!MEM_ROW_BANK_WE[3])    row_cnt_bank3[MEM_ROW_BANK_ADDR[3]] <= SPI_DATA[5:0];
-            else                        row_cnt_data[3] <= row_cnt_bank3[MEM_ROW_BANK_ADDR[3]];
-        end
-    end
-    
-    always_ff @(posedge clk) begin
-        if (!MEM_ROW_BANK_CE[4]) begin
-            if (!MEM_ROW_BANK_WE[4])    row_cnt_bank4[MEM_ROW_BANK_ADDR[4]] <= SPI_DATA[5:0];
-            else                        row_cnt_data[4] <= row_cnt_bank4[MEM_ROW_BANK_ADDR[4]];
+        for (int i = 0; i < N_PE_COL; i++) begin
+            if (!MEM_ROW_BANK_CE[i]) begin
+                if (!MEM_ROW_BANK_WE[i])    row_cnt_bank[i][MEM_ROW_BANK_ADDR[i]] <= SPI_DATA[5:0];
+                else                        row_cnt_data[i] <= row_cnt_bank[i][MEM_ROW_BANK_ADDR[i]];
+            end
         end
     end
     
@@ -24,19 +24,67 @@
 // 
 // Desc: 3-stage pipeline decompression module.
 //
+//       Class skip: the blocks of a class are contiguous (SPI_NUM_SUM_TIME
+//       rounds of 32), but its row count and CCL index words start at a
+//       data-dependent address, kept per class and column in the class start
+//       table. At the first block of a disabled class the block stage stops,
+//       waits for the row and CCL stages to drain, then moves the three
+//       address pointers to the next class in one cycle. Skipping the last
+//       class moves them to the end of the banks and pulses class_skip_last,
+//       which stands in for the last clause flag of the distributor.
+//
+//       CCL stage: a CCL bank read returns a line of N_CCL_WORD words, and
+//       a column takes up to N_CCL_WORD TAs of its current row count word
+//       per cycle, one per lane. The words of a column are read in order,
+//       so only the first word of a line can need a new read: the bank
+//       output holds the line of the CCL pointer (ccl_line_hit), and when
+//       the lanes run into the next line, that line is read and the rest of
+//       the current one kept in ccl_line_hold. A line is read once, so a
+//       decoded TA costs 1/N_CCL_WORD SRAM reads. After a class skip the
+//       pointer can be in the middle of a line that is not held: the first
+//       cycle then stops at the end of that line.
+//
+//       Block FIFOs: every block read is written to a FIFO per PE column
+//       (its 4-bit element mask), and each column reads its row count words
+//       from its own FIFO head. A column that is done with a block goes on
+//       with the next one without waiting for the others, so the columns
+//       only meet again at the first block of a round, which waits for all
+//       of them to reach their last CCL words (row_stage_ready), as the
+//       summation takes the patch results of the whole round. The FIFOs
+//       share the write pointer, and the distributor keeps the feature and
+//       position rows of every entry (fifo_slot_ccl_stage tells it which).
+//       A block is read once no column needs the entry it overwrites, down
+//       to the PE stage, so a column can be up to DEPTH_BLOCK_FIFO blocks
+//       ahead of the slowest one. A column takes one cycle to step over a
+//       block with no TA matrix of its own.
+//
+//       flush (an early exit) returns every register to its reset value on
+//       the next clock edge.
+//
 //==============================================================================
 
 module ogbcsr_decoder #(
     parameter DEPTH_BLOCK_BANK          = 2048,
     parameter DEPTH_ROW_BANK            = 2048,
     parameter DEPTH_CCL_BANK            = 4096,
-    parameter N_PE_COL                  = 5
+    parameter N_PE_COL                  = 5,
+    parameter N_CCL_WORD                = 1,
+    parameter DEPTH_BLOCK_FIFO          = 4
     
 )(
     input logic                                 clk, rst_n,
+    input logic                                 flush,
     input logic                                 decode_en,
+    input logic [15:0]                          class_en,
+    
+    // spi slave signals ------------------------------------------------------
+    input logic                                 spi_wen_class_bank_sync,
+    input logic [11:0]                          SPI_ADDR,
+    input logic [31:0]                          SPI_DATA,
     
     // spi slave Configuration registers --------------------------------------
+    input logic [3:0]                           SPI_NUM_CLASS,
+    input logic [5:0]                           SPI_NUM_SUM_TIME,
     input logic [$clog2(DEPTH_BLOCK_BANK)-1:0]  SPI_LEN_BLOCK_BANK,
     input logic [$clog2(DEPTH_ROW_BANK)-1:0]    SPI_LEN_ROW_BANK            [N_PE_COL],
     input logic [$clog2(DEPTH_CCL_BANK)-1:0]    SPI_LEN_CCL_BANK            [N_PE_COL],
@@ -52,53 +100,90 @@ module ogbcsr_decoder #(
     output logic [N_PE_COL-1:0]                 ren_row_cnt_bank,
     
     // col and clause index bank signals --------------------------------------
-    input  logic [4:0]                          col_clause_idx_data         [N_PE_COL],
-    output logic [$clog2(DEPTH_CCL_BANK)-1:0]   raddr_col_clause_idx_bank   [N_PE_COL],
+    input  logic [5*N_CCL_WORD-1:0]             col_clause_idx_data         [N_PE_COL],
+    output logic [$clog2(DEPTH_CCL_BANK/N_CCL_WORD)-1:0] raddr_col_clause_idx_bank [N_PE_COL],
     output logic [N_PE_COL-1:0]                 ren_col_clause_idx_bank,
     
     // signals to controller --------------------------------------------------
     output logic                                decoder_finish, 
     
     // signals to distributor -------------------------------------------------
+    output logic                                class_skip_last,
     output logic                                block_stage_ready,
     output logic [N_PE_COL-1:0]                 block_stage_valid,
     output logic                                row_stage_ready,
     output logic                                row_stage_valid             [N_PE_COL],
-    output logic                                row_spad_index              [N_PE_COL],
+    output logic [N_CCL_WORD-1:0]               row_spad_index              [N_PE_COL],
     output logic                                col_clause_stage_ready      [N_PE_COL],
     output logic                                col_clause_stage_valid      [N_PE_COL],
+    output logic [N_CCL_WORD-1:0]               col_clause_lane_valid       [N_PE_COL],
     output logic [1:0]                          code_ccl_stage              [N_PE_COL],
-    output logic [4:0]                          col_clause_index            [N_PE_COL],
+    output logic [$clog2(DEPTH_BLOCK_FIFO)-1:0] fifo_slot_ccl_stage         [N_PE_COL],
+    output logic [4:0]                          col_clause_index            [N_PE_COL][N_CCL_WORD],
     output logic [$clog2(DEPTH_CCL_BANK)-1:0]   raddr_col_clause_idx_bank_int[N_PE_COL]
 );
     
     genvar i;
     
     // block stage signals
-    logic [4*N_PE_COL-1:0]                      block_stage_data;
     logic [4*N_PE_COL-1:0]                      block_stage_data_comb;
-    logic                                       block_stage_valid_in_fwpipe;
     logic                                       block_stage_busy;
     logic [$clog2(DEPTH_BLOCK_BANK)-1:0]        raddr_block_idx_bank_int;
     logic                                       block_wait_sram;
     logic [1:0]                                 code_block_stage            [N_PE_COL];    
     
+    // block FIFO signals, the pointers with one wrap bit
+    logic [3:0]                                 block_fifo                  [N_PE_COL][DEPTH_BLOCK_FIFO];
+    logic [$clog2(DEPTH_BLOCK_FIFO):0]          fifo_wptr;
+    logic [$clog2(DEPTH_BLOCK_FIFO):0]          fifo_rptr                   [N_PE_COL];
+    logic [$clog2(DEPTH_BLOCK_FIFO):0]          fifo_oldest                 [N_PE_COL];
+    logic [$clog2(DEPTH_BLOCK_FIFO):0]          fifo_used                   [N_PE_COL];
+    logic [3:0]                                 fifo_head                   [N_PE_COL];
+    logic [3:0]                                 block_done                  [N_PE_COL];
+    logic [N_PE_COL-1:0]                        fifo_empty;
+    logic [N_PE_COL-1:0]                        fifo_pop;
+    logic [N_PE_COL-1:0]                        fifo_free;
+    logic                                       round_start;
+    
     // row stage signals
     logic [$clog2(DEPTH_ROW_BANK)-1:0]          raddr_row_cnt_bank_int      [N_PE_COL];
     logic                                       row_ren_d1                  [N_PE_COL];
     logic [2:0]                                 ta_counter1_int             [N_PE_COL];
     logic [2:0]                                 ta_counter2_int             [N_PE_COL];
-    logic [N_PE_COL-1:0]                        last_processing_matrix;
     logic [N_PE_COL-1:0]                        row_stage_ready_sub;
     logic [N_PE_COL-1:0]                        row_stage_ready_forwarding;
     logic                                       row_stage_almost_done       [N_PE_COL];
     logic [2:0]                                 ta_counter1                 [N_PE_COL];
     logic [2:0]                                 ta_counter2                 [N_PE_COL];
     logic [1:0]                                 code_row_stage              [N_PE_COL];
+    logic [$clog2(DEPTH_BLOCK_FIFO):0]          fifo_slot_row_stage         [N_PE_COL];
+    logic [$clog2(DEPTH_BLOCK_FIFO):0]          fifo_slot_ccl_stage_int     [N_PE_COL];
+    logic [3:0]                                 ta_remain                   [N_PE_COL];
+    logic [3:0]                                 ta_take1                    [N_PE_COL];
+    logic [3:0]                                 ta_take2                    [N_PE_COL];
 
     // col stage signals
-    logic [4:0]                                 col_clause_stage_data           [N_PE_COL];
-    logic                                       col_clause_stage_valid_in_fwpipe[N_PE_COL];
+    logic [10*N_CCL_WORD-1:0]                   col_clause_stage_data           [N_PE_COL];
+    logic [N_CCL_WORD-1:0]                      col_clause_stage_valid_in_fwpipe[N_PE_COL];
+    logic [3:0]                                 ccl_word_ofs                    [N_PE_COL];
+    logic [3:0]                                 ccl_word_ofs_d1                 [N_PE_COL];
+    logic [3:0]                                 ccl_lane_max                    [N_PE_COL];
+    logic [3:0]                                 ccl_lane_num                    [N_PE_COL];
+    logic                                       ccl_line_hit                    [N_PE_COL];
+    logic                                       ccl_straddle                    [N_PE_COL];
+    logic                                       ccl_straddle_d1                 [N_PE_COL];
+    logic [5*N_CCL_WORD-1:0]                    ccl_line_hold                   [N_PE_COL];
+    
+    // class skip signals
+    logic [$clog2(DEPTH_ROW_BANK)-1:0]          class_row_start             [16][N_PE_COL];
+    logic [$clog2(DEPTH_CCL_BANK)-1:0]          class_ccl_start             [16][N_PE_COL];
+    logic [3:0]                                 block_class;
+    logic [$clog2(DEPTH_BLOCK_BANK)-1:0]        class_block_cnt;
+    logic [$clog2(DEPTH_BLOCK_BANK)-1:0]        class_len_block;
+    logic                                       class_skip;
+    logic                                       class_skip_en;
+    logic                                       pipe_idle;
+    logic [3:0]                                 n_class;
     
     // bank length
     logic [$clog2(DEPTH_BLOCK_BANK)-1:0]        len_block_bank;
@@ -106,37 +191,90 @@ module ogbcsr_decoder #(
     logic [$clog2(DEPTH_CCL_BANK)-1:0]          len_col_clause_bank             [N_PE_COL];
     
     // assign for configuration registers
+    assign n_class                  = SPI_NUM_CLASS;
+    assign class_len_block          = {SPI_NUM_SUM_TIME, 5'd0};     // 32 blocks per round
     assign len_block_bank           = SPI_LEN_BLOCK_BANK;
-    assign len_row_bank[0 ]         = SPI_LEN_ROW_BANK[0 ];
-    assign len_row_bank[1 ]         = SPI_LEN_ROW_BANK[1 ];
-    assign len_row_bank[2 ]         = SPI_LEN_ROW_BANK[2 ];
-    assign len_row_bank[3 ]         = SPI_LEN_ROW_BANK[3 ];
-    assign len_row_bank[4 ]         = SPI_LEN_ROW_BANK[4 ];
-    assign len_col_clause_bank[0 ]  = SPI_LEN_CCL_BANK[0 ];
-    assign len_col_clause_bank[1 ]  = SPI_LEN_CCL_BANK[1 ];
-    assign len_col_clause_bank[2 ]  = SPI_LEN_CCL_BANK[2 ];
-    assign len_col_clause_bank[3 ]  = SPI_LEN_CCL_BANK[3 ];
-    assign len_col_clause_bank[4 ]  = SPI_LEN_CCL_BANK[4 ];
+    assign len_row_bank             = SPI_LEN_ROW_BANK;
+    assign len_col_clause_bank      = SPI_LEN_CCL_BANK;
     
+    if (N_CCL_WORD != 1 && N_CCL_WORD != 2 && N_CCL_WORD != 4) begin : g_n_ccl_word_check
+        $error("ogbcsr_decoder: N_CCL_WORD = %0d, must be 1, 2 or 4", N_CCL_WORD);
+    end
+    
+    if (DEPTH_BLOCK_FIFO < 2 || (DEPTH_BLOCK_FIFO & (DEPTH_BLOCK_FIFO - 1)) != 0) begin : g_depth_block_fifo_check
+        $error("ogbcsr_decoder: DEPTH_BLOCK_FIFO = %0d, must be a power of 2, at least 2", DEPTH_BLOCK_FIFO);
+    end
     
 generate
 for (i = 0; i < N_PE_COL; i++) begin
     
-    assign col_clause_index[i] = col_clause_stage_data[i];
+    // lane j takes word ccl_word_ofs + j of the two lines
+    always_comb begin
+        for (int j = 0; j < N_CCL_WORD; j++) begin
+            col_clause_index[i][j] = col_clause_stage_data[i][5*(ccl_word_ofs_d1[i] + j) +: 5];
+        end
+    end
 
 end
 endgenerate
     
+    //-------------------------------------------------------------------------
+    // Class skip
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk) begin
+        if (spi_wen_class_bank_sync && SPI_ADDR[2:0] < N_PE_COL) begin
+            class_row_start[SPI_ADDR[6:3]][SPI_ADDR[2:0]] <= SPI_DATA[16 +: $clog2(DEPTH_ROW_BANK)];
+            class_ccl_start[SPI_ADDR[6:3]][SPI_ADDR[2:0]] <= SPI_DATA[0  +: $clog2(DEPTH_CCL_BANK)];
+        end
+    end
+    
+    // Count the blocks read of the current class.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            block_class     <= 0;
+            class_block_cnt <= '0;
+        end else if (flush) begin
+            block_class     <= 0;
+            class_block_cnt <= '0;
+        end else if (!decode_en) begin
+            block_class     <= 0;
+            class_block_cnt <= '0;
+        end else if (ren_block_idx_bank && class_block_cnt == class_len_block - 1'b1) begin
+            block_class     <= block_class + 1'b1;
+            class_block_cnt <= '0;
+        end else if (ren_block_idx_bank) begin
+            class_block_cnt <= class_block_cnt + 1'b1;
+        end else if (class_skip_en) begin
+            block_class     <= block_class + 1'b1;
+        end
+    end
+    
+    // Nothing left in the row and CCL stages, so their pointers can move.
+    always_comb begin
+        pipe_idle = !block_wait_sram && (&fifo_empty);
+        for (int k = 0; k < N_PE_COL; k++) begin
+            pipe_idle = pipe_idle && !row_ren_d1[k] && ta_counter1[k] == 0 && ta_counter2[k] == 0 &&
+                        !col_clause_stage_valid[k];
+        end
+    end
+    
+    // Hold the block stage at the first block of a disabled class, and after
+    // a skip to the end of the banks (the block stage is busy there after
+    // the last block of a full inference).
+    assign class_skip       = decode_en && class_block_cnt == 0 && (block_class == n_class || !class_en[block_class]);
+    assign class_skip_en    = class_skip && block_class != n_class && pipe_idle;
+    assign class_skip_last  = class_skip_en && (block_class == n_class - 1'b1);
+    
     //-------------------------------------------------------------------------
     // Block index bank stage
     //-------------------------------------------------------------------------
     assign block_stage_busy = (block_wait_sram == 1);
-    assign block_stage_ready = (!block_stage_busy && row_stage_ready);  // if next stage ready
+    assign block_stage_ready = (!block_stage_busy && row_stage_ready && !class_skip);  // if next stage ready
     
 generate
 for (i = 0; i < N_PE_COL; i++) begin
 
-    assign block_stage_valid[i] = block_stage_valid_in_fwpipe & (|block_stage_data_comb[(4*i) +: 4] );
+    assign block_stage_valid[i] = |block_stage_data_comb[(4*i) +: 4];
     
     // Encoder
     always_comb begin
@@ -153,15 +291,6 @@ for (i = 0; i < N_PE_COL; i++) begin
 end
 endgenerate
     
-    // fw-pipelined
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
-            block_stage_valid_in_fwpipe <= 0;
-        end else if (block_stage_ready == 1) begin
-            block_stage_valid_in_fwpipe <= decode_en;
-        end
-    end
-    
     // ren + addr
     assign ren_block_idx_bank = decode_en && block_stage_ready;
     assign raddr_block_idx_bank = raddr_block_idx_bank_int;
@@ -169,8 +298,12 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             raddr_block_idx_bank_int <= '0;
+        end else if (flush) begin
+            raddr_block_idx_bank_int <= '0;
         end else if (decode_en && block_stage_ready) begin
             raddr_block_idx_bank_int <= raddr_block_idx_bank_int + 1'b1;
+        end else if (class_skip_en) begin
+            raddr_block_idx_bank_int <= raddr_block_idx_bank_int + class_len_block;
         end else if (raddr_block_idx_bank_int == len_block_bank) begin
             raddr_block_idx_bank_int <= '0;
         end else begin
@@ -184,48 +317,90 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n)
             block_wait_sram <= 0;
+        else if (flush)
+            block_wait_sram <= 0;
         else if (ren_block_idx_bank)
             block_wait_sram <= 1;
         else
             block_wait_sram <= 0;
     end
 
-generate
-for (i = 0; i < N_PE_COL; i++) begin
-
-    // data
+    //-------------------------------------------------------------------------
+    // Block FIFOs
+    //-------------------------------------------------------------------------
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
-            block_stage_data[(4*i) +: 4] <= '0;
+            fifo_wptr <= '0;
+        end else if (flush) begin
+            fifo_wptr <= '0;
         end else if (block_wait_sram == 1) begin
-            unique case(code_block_stage[i])
-                2'd0: block_stage_data[(4*i) +: 4] <= {block_idx_data[(4*i+1) +: 3], 1'd0};
-                2'd1: block_stage_data[(4*i) +: 4] <= {block_idx_data[(4*i+2) +: 2], 2'd0};
-                2'd2: block_stage_data[(4*i) +: 4] <= {block_idx_data[(4*i+3) +: 1], 3'd0};
-                2'd3: block_stage_data[(4*i) +: 4] <= 4'd0;
-            endcase
-        end else if (row_stage_ready_sub[i]) begin
-            unique case(code_block_stage[i])
-                2'd0: block_stage_data[(4*i)   +: 1] <= 0;
-                2'd1: block_stage_data[(4*i+1) +: 1] <= 0;
-                2'd2: block_stage_data[(4*i+2) +: 1] <= 0;
-                2'd3: block_stage_data[(4*i+3) +: 1] <= 0;
+            fifo_wptr <= fifo_wptr + 1'b1;
+        end
+    end
+
+generate
+for (i = 0; i < N_PE_COL; i++) begin
+    
+    always_ff @(posedge clk) begin
+        if (block_wait_sram == 1) begin
+            block_fifo[i][fifo_wptr[$clog2(DEPTH_BLOCK_FIFO)-1:0]] <= block_idx_data[(4*i) +: 4];
+        end
+    end
+    
+    // The head, bypassed from the bank while it is written
+    assign fifo_empty[i] = !block_wait_sram && fifo_rptr[i] == fifo_wptr;
+    assign fifo_head[i]  = (fifo_rptr[i] == fifo_wptr)? block_idx_data[(4*i) +: 4] :
+                                                        block_fifo[i][fifo_rptr[i][$clog2(DEPTH_BLOCK_FIFO)-1:0]];
+    
+    assign block_stage_data_comb[(4*i) +: 4] = fifo_empty[i]? 4'd0 : fifo_head[i] & ~block_done[i];
+    
+    // Pop an empty head, or with the read of its last TA matrix.
+    always_comb begin
+        fifo_pop[i] = 0;
+        if (!fifo_empty[i]) begin
+            unique case(block_stage_data_comb[(4*i) +: 4])
+                4'b0000: fifo_pop[i] = 1;
+                4'b0001: fifo_pop[i] = ren_row_cnt_bank[i];
+                4'b0010: fifo_pop[i] = ren_row_cnt_bank[i];
+                4'b0100: fifo_pop[i] = ren_row_cnt_bank[i];
+                4'b1000: fifo_pop[i] = ren_row_cnt_bank[i];
+                default: fifo_pop[i] = 0;
             endcase
-        end else begin
-            block_stage_data[(4*i) +: 4] <= block_stage_data[(4*i) +: 4];
         end
     end
     
-    assign block_stage_data_comb[(4*i) +: 4] = (block_wait_sram == 1)? block_idx_data[(4*i) +: 4] : block_stage_data[(4*i) +: 4];
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            fifo_rptr[i]  <= '0;
+            block_done[i] <= '0;
+        end else if (flush) begin
+            fifo_rptr[i]  <= '0;
+            block_done[i] <= '0;
+        end else if (fifo_pop[i]) begin
+            fifo_rptr[i]  <= fifo_rptr[i] + 1'b1;
+            block_done[i] <= '0;
+        end else if (ren_row_cnt_bank[i]) begin
+            block_done[i] <= block_done[i] | (4'd1 << code_block_stage[i]);
+        end
+    end
+    
+    // The oldest entry the column still needs: in its PE stage, its CCL
+    // stage or at its FIFO head.
+    assign fifo_oldest[i] = col_clause_stage_valid[i]? fifo_slot_ccl_stage_int[i] :
+                            row_stage_valid[i]?        fifo_slot_row_stage[i]     : fifo_rptr[i];
+    assign fifo_used[i]   = fifo_wptr - fifo_oldest[i];
+    assign fifo_free[i]   = (fifo_used[i] < DEPTH_BLOCK_FIFO);
     
 end
 endgenerate
 
-    
     //-------------------------------------------------------------------------
     // Row count bank stage
     //-------------------------------------------------------------------------
-    assign row_stage_ready = (&row_stage_ready_forwarding) && (&last_processing_matrix);
+    // The first block of a round waits for every column to finish the
+    // previous round, the others only for a free entry in every FIFO.
+    assign round_start     = (class_block_cnt[4:0] == 0);
+    assign row_stage_ready = round_start? (&row_stage_ready_forwarding) && (&fifo_empty) : (&fifo_free);
 
 generate
 for (i = 0; i < N_PE_COL; i++) begin
@@ -237,8 +412,12 @@ for (i = 0; i < N_PE_COL; i++) begin
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             raddr_row_cnt_bank_int[i] <= '0;
+        end else if (flush) begin
+            raddr_row_cnt_bank_int[i] <= '0;
         end else if (ren_row_cnt_bank[i]) begin
             raddr_row_cnt_bank_int[i] <= raddr_row_cnt_bank_int[i] + 1'b1;
+        end else if (class_skip_en) begin
+            raddr_row_cnt_bank_int[i] <= class_skip_last? '0 : class_row_start[block_class + 1'b1][i];
         end else if (raddr_row_cnt_bank_int[i] == len_row_bank[i]) begin
             raddr_row_cnt_bank_int[i] <= '0;
         end else begin
@@ -255,41 +434,40 @@ for (i = 0; i < N_PE_COL; i++) begin
     
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
-            code_row_stage[i] <= 0;
+            code_row_stage[i]       <= 0;
+            fifo_slot_row_stage[i]  <= '0;
+        end else if (flush) begin
+            code_row_stage[i]       <= 0;
+            fifo_slot_row_stage[i]  <= '0;
         end else if (row_stage_ready_sub[i] == 1) begin
-            code_row_stage[i] <= code_block_stage[i];
+            code_row_stage[i]       <= code_block_stage[i];
+            fifo_slot_row_stage[i]  <= fifo_rptr[i];
         end
     end
     
-    assign row_stage_ready_forwarding[i] = row_stage_almost_done[i] || (ta_counter1[i] == 1 && ta_counter2[i] == 1) ||
-                                        (ta_counter1[i] == 0 && ta_counter2[i] == 2) || (ta_counter1[i] == 2 && ta_counter2[i] == 0);
+    // The TAs left in this word all go this cycle (almost done) or by the
+    // next one, which then takes all N_CCL_WORD lanes.
+    assign ta_remain[i] = ta_counter1[i] + ta_counter2[i];
     
-    assign row_stage_almost_done[i] = (ta_counter1[i] == 0 && ta_counter2[i] == 1) || (ta_counter1[i] == 1 && ta_counter2[i] == 0) || 
-                                        (ta_counter1[i] == 0 && ta_counter2[i] == 0);   // multi-cycle stage
+    assign row_stage_ready_forwarding[i] = (ta_remain[i] <= ccl_lane_max[i] + N_CCL_WORD);
+    
+    assign row_stage_almost_done[i] = (ta_remain[i] <= ccl_lane_max[i]);   // multi-cycle stage
     
     assign row_stage_ready_sub[i] = (row_stage_almost_done[i] == 1 && col_clause_stage_ready[i]);
     
     assign row_stage_valid[i] = (ta_counter1[i] != 0) || (ta_counter2[i] != 0);
-    assign row_spad_index[i] = (ta_counter1[i] != 0)? 0 : 1;
     
+    // TAs of this cycle, counter 1 first
+    assign ta_take1[i] = (ccl_lane_num[i] < ta_counter1[i])? ccl_lane_num[i] : ta_counter1[i];
+    assign ta_take2[i] = ccl_lane_num[i] - ta_take1[i];
     
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
-            last_processing_matrix[i] <= 0;
-        end else if (row_stage_ready_sub[i]) begin 
-            unique case(block_stage_data_comb[(4*i) +: 4])
-                4'b0000: last_processing_matrix[i] <= 1;
-                4'b0001: last_processing_matrix[i] <= 1;
-                4'b0010: last_processing_matrix[i] <= 1;
-                4'b0100: last_processing_matrix[i] <= 1;
-                4'b1000: last_processing_matrix[i] <= 1;
-                default: last_processing_matrix[i] <= 0;
-            endcase
-        end else begin
-            last_processing_matrix[i] <= last_processing_matrix[i];
+    always_comb begin
+        for (int j = 0; j < N_CCL_WORD; j++) begin
+            row_spad_index[i][j] = (j >= ta_counter1[i]);
         end
     end
     
+    
     // ren
     //assign ren_row_cnt_bank[(4*i) +: 4] = (4'd1 << code_block_stage[i]) & {4{block_stage_valid[i]}} & {4{row_stage_ready_sub[i]}};
     assign ren_row_cnt_bank[i] = block_stage_valid[i] & row_stage_ready_sub[i];
@@ -297,6 +475,8 @@ for (i = 0; i < N_PE_COL; i++) begin
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             row_ren_d1[i] <= 0;
+        end else if (flush) begin
+            row_ren_d1[i] <= 0;
         end else begin
             row_ren_d1[i] <= ren_row_cnt_bank[i];
         end
@@ -306,36 +486,17 @@ for (i = 0; i < N_PE_COL; i++) begin
     assign ta_counter1[i] = (row_ren_d1[i] == 1)? row_cnt_data[i][2:0] : ta_counter1_int[i];
     assign ta_counter2[i] = (row_ren_d1[i] == 1)? row_cnt_data[i][5:3] : ta_counter2_int[i];
     
+    // cnt2 only decreases once cnt1 is zero (ta_take1 covers cnt1 first)
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             ta_counter1_int[i] <= '0;
-        end else if (col_clause_stage_ready[i] == 1) begin
-            if (row_ren_d1[i] == 1 && ta_counter1[i] != 0) begin
-                ta_counter1_int[i] <= ta_counter1[i] - 1;
-            end else if (row_ren_d1[i] == 1 && ta_counter1[i] == 0) begin
-                ta_counter1_int[i] <= '0;
-            end else if (ta_counter1[i] != 0) begin
-                ta_counter1_int[i] <= ta_counter1_int[i] - 1'b1;
-            end
-        end
-    end
-    
-    always_ff @(posedge clk, negedge rst_n) begin
-        if (!rst_n) begin
             ta_counter2_int[i] <= '0;
-        end else if (col_clause_stage_ready[i] == 1 && row_ren_d1[i] == 1) begin  // the first cycle
-            if (ta_counter1[i] != 0) begin  // if cnt1 should be decreased in the first cycle, cnt2 doesn't need to be decreased
-                ta_counter2_int[i] <= ta_counter2[i];
-            end else if (ta_counter1[i] == 0 && ta_counter2[i] != 0) begin     // if cnt1 is zero and cnt2 is not zero, cnt2 should be decreased
-                ta_counter2_int[i] <= ta_counter2[i] - 1'b1;
-            end else begin  // else, cnt2 is zero, doesn't need to be decreased
-                ta_counter2_int[i] <= ta_counter2[i];
-            end
+        end else if (flush) begin
+            ta_counter1_int[i] <= '0;
+            ta_counter2_int[i] <= '0;
         end else if (col_clause_stage_ready[i] == 1) begin
-            if(ta_counter2_int[i] != 0 && ta_counter1[i] == 0)
-                ta_counter2_int[i] <= ta_counter2_int[i] - 1'b1;
-            else
-                ta_counter2_int[i] <= ta_counter2_int[i];
+            ta_counter1_int[i] <= ta_counter1[i] - ta_take1[i][2:0];
+            ta_counter2_int[i] <= ta_counter2[i] - ta_take2[i][2:0];
         end
     end
     
@@ -349,15 +510,26 @@ endgenerate
 generate
 for (i = 0; i < N_PE_COL; i++) begin
     
-    // addr
-    assign raddr_col_clause_idx_bank[i] = raddr_col_clause_idx_bank_int[i];
+    // Word pointer, lanes and line address. With the line held, a read
+    // fetches the next line, which the lanes run into.
+    assign ccl_word_ofs[i]  = raddr_col_clause_idx_bank_int[i] % N_CCL_WORD;
+    assign ccl_lane_max[i]  = ccl_line_hit[i]? N_CCL_WORD : N_CCL_WORD - ccl_word_ofs[i];
+    assign ccl_lane_num[i]  = !row_stage_valid[i]?              '0 :
+                              (ta_remain[i] < ccl_lane_max[i])? ta_remain[i] : ccl_lane_max[i];
+    assign ccl_straddle[i]  = (ccl_word_ofs[i] + ccl_lane_num[i] > N_CCL_WORD);
     
-    // addr register
+    assign raddr_col_clause_idx_bank[i] = raddr_col_clause_idx_bank_int[i] / N_CCL_WORD + ccl_line_hit[i];
+    
+    // word pointer register
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             raddr_col_clause_idx_bank_int[i] <= '0;
-        end else if (ren_col_clause_idx_bank[i]) begin
-            raddr_col_clause_idx_bank_int[i] <= raddr_col_clause_idx_bank_int[i] + 1'b1;
+        end else if (flush) begin
+            raddr_col_clause_idx_bank_int[i] <= '0;
+        end else if (row_stage_valid[i] && col_clause_stage_ready[i]) begin
+            raddr_col_clause_idx_bank_int[i] <= raddr_col_clause_idx_bank_int[i] + ccl_lane_num[i];
+        end else if (class_skip_en) begin
+            raddr_col_clause_idx_bank_int[i] <= class_skip_last? '0 : class_ccl_start[block_class + 1'b1][i];
         end else if (raddr_col_clause_idx_bank_int[i] == len_col_clause_bank[i]) begin
             raddr_col_clause_idx_bank_int[i] <= '0;
         end else begin
@@ -365,6 +537,27 @@ for (i = 0; i < N_PE_COL; i++) begin
         end
     end
     
+    // The bank output holds the line of the word pointer, unless the
+    // pointer has just moved to the first word of a line or jumped.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            ccl_line_hit[i] <= 0;
+        end else if (flush) begin
+            ccl_line_hit[i] <= 0;
+        end else if (row_stage_valid[i] && col_clause_stage_ready[i]) begin
+            ccl_line_hit[i] <= ((raddr_col_clause_idx_bank_int[i] + ccl_lane_num[i]) % N_CCL_WORD != 0);
+        end else if (class_skip_en || raddr_col_clause_idx_bank_int[i] == len_col_clause_bank[i]) begin
+            ccl_line_hit[i] <= 0;
+        end
+    end
+    
+    // Keep the held line while the next one is read.
+    always_ff @(posedge clk) begin
+        if (ren_col_clause_idx_bank[i] && ccl_straddle[i]) begin
+            ccl_line_hold[i] <= col_clause_idx_data[i];
+        end
+    end
+    
 end
 endgenerate  
 
@@ -373,31 +566,47 @@ for (i = 0; i < N_PE_COL; i++) begin
     
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
-            code_ccl_stage[i] <= 0;
+            code_ccl_stage[i]           <= 0;
+            fifo_slot_ccl_stage_int[i]  <= '0;
+            ccl_word_ofs_d1[i]          <= '0;
+            ccl_straddle_d1[i]          <= 0;
+        end else if (flush) begin
+            code_ccl_stage[i]           <= 0;
+            fifo_slot_ccl_stage_int[i]  <= '0;
+            ccl_word_ofs_d1[i]          <= '0;
+            ccl_straddle_d1[i]          <= 0;
         end else begin
-            code_ccl_stage[i] <= code_row_stage[i];
+            code_ccl_stage[i]           <= code_row_stage[i];
+            fifo_slot_ccl_stage_int[i]  <= fifo_slot_row_stage[i];
+            ccl_word_ofs_d1[i]          <= ccl_word_ofs[i];
+            ccl_straddle_d1[i]          <= ccl_straddle[i];
         end
     end
     
+    assign fifo_slot_ccl_stage[i] = fifo_slot_ccl_stage_int[i][$clog2(DEPTH_BLOCK_FIFO)-1:0];
+    
     //assign col_clause_stage_almost_done[i] = 1;   // sigle-cycle stage (ignore this signal)
     assign col_clause_stage_ready[i] = (col_clause_stage_valid[i] == 0) || 1'b1;    // if idle or next cycle can finish operations
-    assign col_clause_stage_valid[i] = col_clause_stage_valid_in_fwpipe[i];
+    assign col_clause_stage_valid[i] = col_clause_stage_valid_in_fwpipe[i][0];
+    assign col_clause_lane_valid[i]  = col_clause_stage_valid_in_fwpipe[i];
     
-    // fw-pipelined
+    // fw-pipelined, one bit per lane
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
-            col_clause_stage_valid_in_fwpipe[i] <= 0;
+            col_clause_stage_valid_in_fwpipe[i] <= '0;
+        end else if (flush) begin
+            col_clause_stage_valid_in_fwpipe[i] <= '0;
         end else if (col_clause_stage_ready[i] == 1) begin
-            col_clause_stage_valid_in_fwpipe[i] <= row_stage_valid[i];
+            col_clause_stage_valid_in_fwpipe[i] <= ~({N_CCL_WORD{1'b1}} << ccl_lane_num[i]);
         end
     end
     
-    // ren
+    // ren: a line not held yet, or the next line
     //assign ren_col_clause_idx_bank[(4*i) +: 4] = (4'd1 << code_row_stage[i]) & {4{row_stage_valid[i]}} & {4{col_clause_stage_ready[i]}};
-    assign ren_col_clause_idx_bank[i] = row_stage_valid[i] & col_clause_stage_ready[i];
+    assign ren_col_clause_idx_bank[i] = row_stage_valid[i] & col_clause_stage_ready[i] & (!ccl_line_hit[i] || ccl_straddle[i]);
     
-    // data
-    assign col_clause_stage_data[i] = col_clause_idx_data[i];
+    // data: the held line, then the line read
+    assign col_clause_stage_data[i] = {col_clause_idx_data[i], ccl_straddle_d1[i]? ccl_line_hold[i] : col_clause_idx_data[i]};
     
 end
 endgenerate  
@@ -24,6 +24,10 @@
 // 
 // Desc: logic computation module.
 //
+//       A PE column takes N_CCL_WORD literals per cycle, all for the same
+//       element: the enabled lanes of each clause are ANDed together, then
+//       into its spad, so both clauses of the element can update at once.
+//
 //==============================================================================
 
 module pe_array #(
@@ -31,16 +35,17 @@ module pe_array #(
     parameter N_FRAME                   = 64,
     parameter NUMBER_OF_PATCH           = 58,
     parameter N_PE_COL                  = 5,
-    parameter N_ELEMENT                 = 4
+    parameter N_ELEMENT                 = 4,
+    parameter N_CCL_WORD                = 1
     
 )(
     input logic                         clk, rst_n,
     input logic [1:0]                   code_pe_stage           [N_PE_COL],
-    input logic                         pe_ena                  [N_PE_COL],
+    input logic [N_CCL_WORD-1:0]        pe_ena                  [N_PE_COL],
     input logic [2*N_ELEMENT-1:0]       next_clause_flag        [N_PE_COL],
-    input logic                         clause_index            [N_PE_COL],
-    input logic                         inv_en                  [N_PE_COL],
-    input logic [NUMBER_OF_PATCH-1:0]   literal_data            [N_PE_COL],
+    input logic [N_CCL_WORD-1:0]        clause_index            [N_PE_COL],
+    input logic [N_CCL_WORD-1:0]        inv_en                  [N_PE_COL],
+    input logic [NUMBER_OF_PATCH-1:0]   literal_data            [N_PE_COL][N_CCL_WORD],
 
     output logic                        patch0_result           [N_ELEMENT*N_PE_COL],
     output logic                        patch1_result           [N_ELEMENT*N_PE_COL]
@@ -59,7 +64,8 @@ module pe_array #(
     for (i = 0; i < N_PE_COL; i++) begin
         pe_col #(
             .NUMBER_OF_PATCH        (NUMBER_OF_PATCH                ),
-            .N_ELEMENT              (N_ELEMENT                      )
+            .N_ELEMENT              (N_ELEMENT                      ),
+            .N_CCL_WORD             (N_CCL_WORD                     )
             
         ) pe_col_inst(  
             .clk                    (clk                            ),
@@ -92,15 +98,16 @@ endmodule
 
 module pe_col #(
     parameter NUMBER_OF_PATCH           = 58,
-    parameter N_ELEMENT                 = 4
+    parameter N_ELEMENT                 = 4,
+    parameter N_CCL_WORD                = 1
 )(
     input logic                         clk, rst_n,
     input logic [1:0]                   code_pe_stage,
-    input logic                         pe_ena,
+    input logic [N_CCL_WORD-1:0]        pe_ena,
     input logic [2*N_ELEMENT-1:0]       next_clause_flag,
-    input logic                         clause_index,
-    input logic                         inv_en,
-    input logic [NUMBER_OF_PATCH-1:0]   literal_data,
+    input logic [N_CCL_WORD-1:0]        clause_index,
+    input logic [N_CCL_WORD-1:0]        inv_en,
+    input logic [NUMBER_OF_PATCH-1:0]   literal_data        [N_CCL_WORD],
     
     output logic                        patch0_result       [N_ELEMENT],
     output logic                        patch1_result       [N_ELEMENT]        
@@ -112,57 +119,64 @@ module pe_col #(
     logic [NUMBER_OF_PATCH-1:0] Pand0_SPad [N_ELEMENT];
     logic [NUMBER_OF_PATCH-1:0] Pand1_SPad [N_ELEMENT];
     
-    logic [NUMBER_OF_PATCH-1:0] patch_window_result, patch_window_result_next;
+    // [0]: clause_index 0, [1]: clause_index 1
+    logic [NUMBER_OF_PATCH-1:0] patch_window_result         [2];
+    logic [NUMBER_OF_PATCH-1:0] patch_window_result_next    [2];
+    logic [NUMBER_OF_PATCH-1:0] literal_and                 [2];
+    logic                       clause_hit                  [2];
+    logic                       next_clause_sel             [2];
     
-    logic [NUMBER_OF_PATCH-1:0] literal_data_post;
-    logic                       next_clause_sel;
+    logic [NUMBER_OF_PATCH-1:0] literal_data_post           [N_CCL_WORD];
     
-    assign literal_data_post = (inv_en) ? ~literal_data : literal_data;
+    always_comb begin
+        for (int j = 0; j < N_CCL_WORD; j++) begin
+            literal_data_post[j] = (inv_en[j]) ? ~literal_data[j] : literal_data[j];
+        end
+    end
+    
+    // AND the enabled lanes of each clause
+    always_comb begin
+        for (int c = 0; c < 2; c++) begin
+            clause_hit[c]   = 0;
+            literal_and[c]  = '1;
+            for (int j = 0; j < N_CCL_WORD; j++) begin
+                if (pe_ena[j] && clause_index[j] == c) begin
+                    clause_hit[c]   = 1;
+                    literal_and[c]  = literal_and[c] & literal_data_post[j];
+                end
+            end
+        end
+    end
     
     // select valid spad to calculate
-    assign patch_window_result = (clause_index == 0)? Pand0_SPad[code_pe_stage] : Pand1_SPad[code_pe_stage];
+    assign patch_window_result[0] = Pand0_SPad[code_pe_stage];
+    assign patch_window_result[1] = Pand1_SPad[code_pe_stage];
     
     // select valid next_clause_flag
-    // Deocder
-    always_comb begin
-        next_clause_sel = 0;
-        unique case({code_pe_stage, clause_index})
-            3'b000: next_clause_sel = next_clause_flag[0];
-            3'b001: next_clause_sel = next_clause_flag[1];
-            3'b010: next_clause_sel = next_clause_flag[2];
-            3'b011: next_clause_sel = next_clause_flag[3];
-            3'b100: next_clause_sel = next_clause_flag[4];
-            3'b101: next_clause_sel = next_clause_flag[5];
-            3'b110: next_clause_sel = next_clause_flag[6];
-            3'b111: next_clause_sel = next_clause_flag[7];
-            default: next_clause_sel = 0;
-        endcase
-    end
+    assign next_clause_sel[0] = next_clause_flag[{code_pe_stage, 1'b0}];
+    assign next_clause_sel[1] = next_clause_flag[{code_pe_stage, 1'b1}];
     
     always_comb begin
-        patch_window_result_next = 0;
-        if (next_clause_sel) begin
-            patch_window_result_next = literal_data_post;
-        end else begin
-            patch_window_result_next = literal_data_post & patch_window_result;
+        for (int c = 0; c < 2; c++) begin
+            if (next_clause_sel[c]) begin
+                patch_window_result_next[c] = literal_and[c];
+            end else begin
+                patch_window_result_next[c] = literal_and[c] & patch_window_result[c];
+            end
         end
     end
     
     // All spad registers are mapped to non-reset D Flip-Flop.
     always_ff @(posedge clk) begin
-        if (pe_ena) begin
-            if (clause_index == 0)  Pand0_SPad[code_pe_stage] <= patch_window_result_next;
-            else                    Pand1_SPad[code_pe_stage] <= patch_window_result_next;
-        end
+        if (clause_hit[0])  Pand0_SPad[code_pe_stage] <= patch_window_result_next[0];
+        if (clause_hit[1])  Pand1_SPad[code_pe_stage] <= patch_window_result_next[1];
     end
     
     // 58b-OR tree
     always_ff @(posedge clk) begin
-        if (pe_ena) begin
-            // seperate 58 bits -> 32+26 bits
-            if (clause_index == 0)  patch0_result[code_pe_stage] <= (|patch_window_result_next[31:0]) || (|patch_window_result_next[57:32]);
-            else                    patch1_result[code_pe_stage] <= (|patch_window_result_next[31:0]) || (|patch_window_result_next[57:32]);
-        end
+        // seperate 58 bits -> 32+26 bits
+        if (clause_hit[0])  patch0_result[code_pe_stage] <= (|patch_window_result_next[0][31:0]) || (|patch_window_result_next[0][57:32]);
+        if (clause_hit[1])  patch1_result[code_pe_stage] <= (|patch_window_result_next[1][31:0]) || (|patch_window_result_next[1][57:32]);
     end
     
 endmodule
@@ -0,0 +1,192 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+// 
+// Licensed under the Solderpad Hardware License v 2.1 (the “License”); 
+// you may not use this file except in compliance with the License, or, 
+// at your option, the Apache License version 2.0. 
+// You may obtain a copy of the License at
+// 
+// https://solderpad.org/licenses/SHL-2.1/
+// 
+// Unless required by applicable law or agreed to in writing, any work 
+// distributed under the License is distributed on an “AS IS” BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and 
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "perf_counter.sv"
+//
+// Author: Baizhou Lin, University of Southampton
+// 
+// Desc: Performance counters, read over SPI (spi_slave.sv, cmd 3'b111,
+//       bank_sel 0).
+//
+//       The counters run over the cycles of an inference (decode_en or
+//       tail_flush_en, up to Inf_Done) and are copied to a snapshot at
+//       every Inf_Done, which SPI reads until the next one. A PE column is
+//       busy with any pe_ena lane set, waiting while another column is
+//       busy and idle while none is, so busy + wait + idle = cycles for
+//       every column. The wait cycles are the load imbalance between the
+//       columns, not stalls of the decoder. The snapshot is read as 6 + 2 * N_PE_COL words:
+//
+//         word 0     {1'b1, 3'b0, N_PE_COL[3:0], 8'b0, frame_cnt[15:0]}
+//         word 1     cycles, decode_en or tail_flush_en
+//         word 2     decode_en cycles
+//         word 3     summation cycles, walking the clauses of a round
+//         word 4     fe_window_done to fe_complete, the cycles the window
+//                    waited for the accelerator to go idle
+//         word 5     cycles with no PE column busy
+//         word 6+2i  PE column i busy cycles (pe_ena duty cycle)
+//         word 7+2i  PE column i wait cycles
+//
+//       frame_cnt numbers the Inf_Done as in the result FIFO. A silent
+//       window reads 0 cycles. Before the first Inf_Done, and beyond the
+//       last word, the words read 0.
+//
+//       spi_ren_perf_sync loads word SPI_RADDR into perf_cnt_rdata. SPI
+//       requests it one frame ahead, so the register is stable while the
+//       SPI clock domain reads it.
+//
+//==============================================================================
+
+module perf_counter #(
+    parameter N_PE_COL                  = 5,
+    parameter N_CCL_WORD                = 1,
+    parameter CNT_WIDTH                 = 20    // 2.6 s at 400 kHz
+    
+)(
+    input logic                         clk, rst_n,
+    input logic                         fe_window_done,
+    input logic                         fe_complete,
+    input logic                         decode_en,
+    input logic                         tail_flush_en,
+    input logic                         inf_done,
+    input logic [N_CCL_WORD-1:0]        pe_ena          [N_PE_COL],
+    input logic                         summation_busy,
+    
+    // spi slave signals ------------------------------------------------------
+    input logic                         spi_ren_perf_sync,
+    input logic [11:0]                  SPI_RADDR,
+    
+    output logic [31:0]                 perf_cnt_rdata
+);
+    
+    localparam CNT_CYCLE        = 0;
+    localparam CNT_DECODE       = 1;
+    localparam CNT_SUMMATION    = 2;
+    localparam CNT_FE_LATENCY   = 3;
+    localparam CNT_IDLE         = 4;
+    localparam CNT_COL          = 5;    // busy and wait of column i at CNT_COL + 2i, + 1
+    localparam N_CNT            = CNT_COL + 2 * N_PE_COL;
+    
+    genvar k;
+    logic [CNT_WIDTH-1:0]   cnt             [N_CNT];
+    logic [CNT_WIDTH-1:0]   snap            [N_CNT];
+    logic [N_CNT-1:0]       cnt_inc;
+    logic [N_PE_COL-1:0]    col_busy;
+    logic                   any_busy;
+    logic                   inf_cycle;
+    logic                   fe_wait;
+    logic [CNT_WIDTH-1:0]   fe_wait_cnt;
+    logic [15:0]            frame_cnt;
+    logic [15:0]            snap_frame_cnt;
+    logic                   snap_valid;
+    logic [31:0]            rd_word;
+    
+    // Inf_Done closes the inference, its cycle is not counted.
+    assign inf_cycle    = (decode_en || tail_flush_en) && !inf_done;
+    
+    always_comb begin
+        for (int i = 0; i < N_PE_COL; i++)
+            col_busy[i] = |pe_ena[i];
+    end
+    
+    assign any_busy     = |col_busy;
+    
+    always_comb begin
+        cnt_inc                 = '0;
+        cnt_inc[CNT_CYCLE]      = inf_cycle;
+        cnt_inc[CNT_DECODE]     = inf_cycle && decode_en;
+        cnt_inc[CNT_SUMMATION]  = inf_cycle && summation_busy;
+        cnt_inc[CNT_IDLE]       = inf_cycle && !any_busy;
+        for (int i = 0; i < N_PE_COL; i++) begin
+            cnt_inc[CNT_COL + 2*i]      = inf_cycle && col_busy[i];
+            cnt_inc[CNT_COL + 2*i + 1]  = inf_cycle && !col_busy[i] && any_busy;
+        end
+    end
+    
+    // Cycles since the last fe_window_done, up to its fe_complete. A window
+    // dropped while pending restarts the count with the next one.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            fe_wait     <= 0;
+            fe_wait_cnt <= '0;
+        end else if (fe_window_done) begin
+            fe_wait     <= !fe_complete;
+            fe_wait_cnt <= 1;
+        end else if (fe_complete) begin
+            fe_wait     <= 0;
+        end else if (fe_wait) begin
+            fe_wait_cnt <= fe_wait_cnt + 1'b1;
+        end
+    end
+    
+generate
+for (k = 0; k < N_CNT; k++) begin
+    
+    if (k == CNT_FE_LATENCY) begin : g_fe_latency
+        // Latched at the fe_complete that starts the inference.
+        always_ff @(posedge clk, negedge rst_n) begin
+            if (!rst_n)             cnt[k] <= '0;
+            else if (fe_complete)   cnt[k] <= fe_window_done? '0 : fe_wait_cnt;
+            else if (inf_done)      cnt[k] <= '0;
+        end
+    end else begin : g_cnt
+        always_ff @(posedge clk, negedge rst_n) begin
+            if (!rst_n)             cnt[k] <= '0;
+            else if (inf_done)      cnt[k] <= '0;
+            else if (cnt_inc[k])    cnt[k] <= cnt[k] + 1'b1;
+        end
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)                 snap[k] <= '0;
+        else if (inf_done)          snap[k] <= cnt[k];
+    end
+    
+end
+endgenerate
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            frame_cnt       <= '0;
+            snap_frame_cnt  <= '0;
+            snap_valid      <= 0;
+        end else if (inf_done) begin
+            frame_cnt       <= frame_cnt + 1'b1;
+            snap_frame_cnt  <= frame_cnt;
+            snap_valid      <= 1;
+        end
+    end
+    
+    always_comb begin
+        if (!snap_valid)
+            rd_word = '0;
+        else if (SPI_RADDR == 0)
+            rd_word = {1'b1, 3'b0, 4'(N_PE_COL), 8'b0, snap_frame_cnt};
+        else if (SPI_RADDR <= N_CNT)
+            rd_word = 32'(snap[SPI_RADDR - 1'b1]);
+        else
+            rd_word = '0;
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)                     perf_cnt_rdata <= '0;
+        else if (spi_ren_perf_sync)     perf_cnt_rdata <= rd_word;
+    end
+
+endmodule
@@ -0,0 +1,148 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+// 
+// Licensed under the Solderpad Hardware License v 2.1 (the “License”); 
+// you may not use this file except in compliance with the License, or, 
+// at your option, the Apache License version 2.0. 
+// You may obtain a copy of the License at
+// 
+// https://solderpad.org/licenses/SHL-2.1/
+// 
+// Unless required by applicable law or agreed to in writing, any work 
+// distributed under the License is distributed on an “AS IS” BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and 
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "result_fifo.sv"
+//
+// Author: Baizhou Lin, University of Southampton
+// 
+// Desc: Result FIFO, read over SPI (spi_slave.sv, cmd 3'b110).
+//
+//       Every Inf_Done writes one record: the result, the top-2 margin and
+//       the class scores of argmax, and a frame counter that counts every
+//       Inf_Done, so a gap shows the records dropped while the FIFO was
+//       full. A record is read as 2 + ceil(n_class/2) words:
+//
+//         word 0   {1'b1, 3'b0, n_class[3:0], result[3:0], 4'b0, frame_cnt[15:0]}
+//         word 1   {18'b0, margin[13:0]}
+//         word 2+k {score[2k+1], score[2k]}, sign extended to 16 bits
+//
+//       Classes not summed (skipped, after an early exit or a silent
+//       window) read -8192, classes from n_class on read 0. An empty FIFO
+//       reads 0, bit 31 tells a record header from it.
+//
+//       spi_ren_result_sync loads the next word into result_fifo_rdata.
+//       SPI requests it one frame ahead, so the register is stable while
+//       the SPI clock domain reads it. result_cnt is the number of records
+//       held, for the status word (spi_readback.sv).
+//
+//==============================================================================
+
+module result_fifo #(
+    parameter DEPTH_RESULT_FIFO         = 4
+    
+)(
+    input logic                         clk, rst_n,
+    input logic                         Inf_Done,
+    input logic [3:0]                   result,
+    input logic [13:0]                  score_margin,
+    input logic signed [13:0]           class_score     [16],
+    
+    // spi slave signals ------------------------------------------------------
+    input logic                         spi_ren_result_sync,
+    
+    // spi slave Configuration registers --------------------------------------
+    input logic [3:0]                   SPI_NUM_CLASS,
+    
+    output logic [31:0]                 result_fifo_rdata,
+    output logic [$clog2(DEPTH_RESULT_FIFO):0] result_cnt
+);
+    
+    localparam AW = $clog2(DEPTH_RESULT_FIFO);
+    
+    logic [3:0]             rec_result      [DEPTH_RESULT_FIFO];
+    logic [3:0]             rec_n_class     [DEPTH_RESULT_FIFO];
+    logic [15:0]            rec_frame_cnt   [DEPTH_RESULT_FIFO];
+    logic [13:0]            rec_margin      [DEPTH_RESULT_FIFO];
+    logic signed [13:0]     rec_score       [DEPTH_RESULT_FIFO][16];
+    
+    logic [AW:0]            wptr, rptr;
+    logic [3:0]             word_idx;       // word of the record at rptr
+    logic [3:0]             last_word;
+    logic [15:0]            frame_cnt;
+    logic                   fifo_empty;
+    logic                   fifo_full;
+    logic [31:0]            head_word;
+    logic [3:0]             score_idx;
+    logic [15:0]            score_lo, score_hi;
+    
+    assign fifo_empty   = (wptr == rptr);
+    assign fifo_full    = (wptr[AW] != rptr[AW]) && (wptr[AW-1:0] == rptr[AW-1:0]);
+    assign result_cnt   = wptr - rptr;
+    assign last_word    = 4'd1 + (({1'b0, rec_n_class[rptr[AW-1:0]]} + 1'b1) >> 1);
+    
+    // Write a record at Inf_Done, drop it when full.
+    always_ff @(posedge clk) begin
+        if (Inf_Done && !fifo_full) begin
+            rec_result[wptr[AW-1:0]]    <= result;
+            rec_n_class[wptr[AW-1:0]]   <= SPI_NUM_CLASS;
+            rec_frame_cnt[wptr[AW-1:0]] <= frame_cnt;
+            rec_margin[wptr[AW-1:0]]    <= score_margin;
+            rec_score[wptr[AW-1:0]]     <= class_score;
+        end
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            wptr        <= '0;
+            frame_cnt   <= '0;
+        end else if (Inf_Done) begin
+            if (!fifo_full) wptr <= wptr + 1'b1;
+            frame_cnt   <= frame_cnt + 1'b1;
+        end
+    end
+    
+    // Read word by word, the record is popped with its last word.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            rptr        <= '0;
+            word_idx    <= '0;
+        end else if (spi_ren_result_sync && !fifo_empty) begin
+            if (word_idx == last_word) begin
+                rptr        <= rptr + 1'b1;
+                word_idx    <= '0;
+            end else begin
+                word_idx    <= word_idx + 1'b1;
+            end
+        end
+    end
+    
+    assign score_idx    = (word_idx - 4'd2) << 1;
+    assign score_lo     = (score_idx < rec_n_class[rptr[AW-1:0]])? 
+                            16'(rec_score[rptr[AW-1:0]][score_idx]) : '0;
+    assign score_hi     = (score_idx + 1'b1 < rec_n_class[rptr[AW-1:0]])? 
+                            16'(rec_score[rptr[AW-1:0]][score_idx + 1'b1]) : '0;
+    
+    always_comb begin
+        if (fifo_empty)
+            head_word = '0;
+        else if (word_idx == 0)
+            head_word = {1'b1, 3'b0, rec_n_class[rptr[AW-1:0]], rec_result[rptr[AW-1:0]], 4'b0, rec_frame_cnt[rptr[AW-1:0]]};
+        else if (word_idx == 1)
+            head_word = {18'b0, rec_margin[rptr[AW-1:0]]};
+        else
+            head_word = {score_hi, score_lo};
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)                     result_fifo_rdata <= '0;
+        else if (spi_ren_result_sync)   result_fifo_rdata <= head_word;
+    end
+
+endmodule
@@ -0,0 +1,304 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0 WITH SHL-2.1
+// 
+// Licensed under the Solderpad Hardware License v 2.1 (the “License”); 
+// you may not use this file except in compliance with the License, or, 
+// at your option, the Apache License version 2.0. 
+// You may obtain a copy of the License at
+// 
+// https://solderpad.org/licenses/SHL-2.1/
+// 
+// Unless required by applicable law or agreed to in writing, any work 
+// distributed under the License is distributed on an “AS IS” BASIS, 
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. 
+// See the License for the specific language governing permissions and 
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "spi_readback.sv"
+//
+// Author: Baizhou Lin, University of Southampton
+// 
+// Desc: System clock side of the SPI reads (spi_slave.sv): the bank
+//       readback, the status word and the bank CRCs, and the read data mux.
+//
+//       A read of cmd 3'b001 to 3'b100 (block index, row count, CCL index
+//       and weight bank, bank_sel as for the writes) loads bank word
+//       SPI_RADDR, zero extended, into spi_rdata. The banks are only read
+//       while the accelerator is idle (tma_busy low): a read during an
+//       inference leaves the previous word, so clear SPI_EN_INF first. The
+//       class start and bound tables (bank_sel 1) read 0.
+//
+//       cmd 3'b111 with bank_sel 1 reads the status word at addr 0:
+//
+//         {1'b1, tma_busy, crc_valid, 2'b0, result_cnt[2:0], Result[3:0],
+//          argmax result[3:0], done_cnt[15:0]}
+//
+//       done_cnt counts the Inf_Done pulses, so polling it replaces the
+//       Inf_Done interrupt; result_cnt is the number of result FIFO records.
+//
+//       cmd 3'b111 with bank_sel 2 reads the CRC-32 of bank b at addr b,
+//       in load order: block index, row count 0 to N_PE_COL-1, CCL index 0
+//       to N_PE_COL-1, weight. The CRC (IEEE 802.3, reflected) runs over
+//       the first SPI_LEN_* words of the bank, each zero extended to 32 bits
+//       and taken LSB first, i.e. as 4 little-endian bytes. Reset, a bank
+//       write and a configuration register write (spi_wen_sync) clear
+//       crc_valid and restart the walk, which reads one word per idle cycle
+//       and sets crc_valid at the end of the last bank.
+//
+//==============================================================================
+
+module spi_readback #(
+    parameter N_PE_COL                  = 5,
+    parameter N_PE_CLUSTER              = 20,
+    parameter DEPTH_BLOCK_BANK          = 2048,
+    parameter DEPTH_ROW_BANK            = 2048,
+    parameter DEPTH_CCL_BANK            = 4096,
+    parameter DEPTH_WEIGHT_BANK         = 2048,
+    parameter N_CCL_WORD                = 1
+    
+)(
+    input logic                                             clk, rst_n,
+    input logic                                             tma_busy,
+    
+    // status signals ---------------------------------------------------------
+    input logic                                             Inf_Done,
+    input logic [3:0]                                       Result,
+    input logic [3:0]                                       argmax_result,
+    input logic [2:0]                                       result_cnt,
+    
+    // bank read ports, shared with the decoder and the summation -------------
+    input logic [N_PE_CLUSTER-1:0]                          block_idx_data,
+    input logic [5:0]                                       row_cnt_data                [N_PE_COL],
+    input logic [5*N_CCL_WORD-1:0]                          col_clause_idx_data         [N_PE_COL],
+    input logic signed [8:0]                                weight_data,
+    output logic [$clog2(DEPTH_BLOCK_BANK)-1:0]             rb_raddr_block_idx_bank,
+    output logic                                            rb_ren_block_idx_bank,
+    output logic [$clog2(DEPTH_ROW_BANK)-1:0]               rb_raddr_row_cnt_bank,
+    output logic [N_PE_COL-1:0]                             rb_ren_row_cnt_bank,
+    output logic [$clog2(DEPTH_CCL_BANK/N_CCL_WORD)-1:0]    rb_raddr_col_clause_idx_bank,
+    output logic [N_PE_COL-1:0]                             rb_ren_col_clause_idx_bank,
+    output logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]            rb_raddr_weight_bank,
+    output logic                                            rb_ren_weight_bank,
+    
+    // spi slave signals ------------------------------------------------------
+    input logic                                             spi_wen_sync,
+    input logic                                             spi_ren_sync,
+    input logic [5:0]                                       SPI_RSEL,
+    input logic [11:0]                                      SPI_RADDR,
+    input logic [31:0]                                      result_fifo_rdata,
+    input logic [31:0]                                      perf_cnt_rdata,
+    
+    // spi slave Configuration registers --------------------------------------
+    input logic [$clog2(DEPTH_BLOCK_BANK)-1:0]              SPI_LEN_BLOCK_BANK,
+    input logic [$clog2(DEPTH_ROW_BANK)-1:0]                SPI_LEN_ROW_BANK            [N_PE_COL],
+    input logic [$clog2(DEPTH_CCL_BANK)-1:0]                SPI_LEN_CCL_BANK            [N_PE_COL],
+    input logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]             SPI_LEN_WEIGHT_BANK,
+    
+    output logic [31:0]                                     spi_rdata
+);
+    
+    localparam cmd_block_bank   = 3'b001;
+    localparam cmd_row_bank     = 3'b010;
+    localparam cmd_ccl_bank     = 3'b011;
+    localparam cmd_weight_bank  = 3'b100;
+    localparam cmd_result_fifo  = 3'b110;
+    localparam cmd_read_reg     = 3'b111;
+    
+    localparam SEL_PERF_CNT     = 3'd0;
+    localparam SEL_STATUS       = 3'd1;
+    localparam SEL_CRC          = 3'd2;
+    
+    // banks in load order: block index, row count, CCL index, weight
+    localparam BANK_ROW         = 1;
+    localparam BANK_CCL         = BANK_ROW + N_PE_COL;
+    localparam BANK_WEIGHT      = BANK_CCL + N_PE_COL;
+    localparam N_BANK           = BANK_WEIGHT + 1;
+    localparam BW               = $clog2(N_BANK);
+    
+    logic [BW-1:0]          spi_bank;
+    logic                   spi_bank_valid;
+    logic                   rd_spi, rd_crc, rd_en;
+    logic [BW-1:0]          rd_bank;
+    logic [11:0]            rd_addr;
+    logic                   rd_spi_d1, rd_crc_d1;
+    logic [BW-1:0]          rd_bank_d1;
+    logic [1:0]             rd_wsel_d1;         // CCL word of the line read
+    logic [31:0]            rd_word;
+    logic [31:0]            bank_rdata;
+    logic [31:0]            reg_rdata;
+    
+    logic [15:0]            done_cnt;
+    logic [31:0]            status_word;
+    
+    logic                   crc_dirty;
+    logic                   crc_busy;
+    logic                   crc_valid;
+    logic [BW-1:0]          crc_bank;
+    logic [11:0]            crc_idx;
+    logic [11:0]            crc_len;
+    logic [31:0]            crc_reg;
+    logic [31:0]            bank_crc        [N_BANK];
+    
+    // CRC-32 of a word taken LSB first
+    function automatic logic [31:0] crc32_word(input logic [31:0] crc, input logic [31:0] data);
+        logic [31:0] c;
+        c = crc;
+        for (int i = 0; i < 32; i++)
+            c = (c >> 1) ^ ((c[0] ^ data[i])? 32'hEDB88320 : 32'h0);
+        return c;
+    endfunction
+    
+    //-------------------------------------------------------------------------
+    // Bank reads: SPI readback first, then the CRC walk, both while idle
+    //-------------------------------------------------------------------------
+    always_comb begin
+        spi_bank_valid  = 0;
+        spi_bank        = '0;
+        unique case (SPI_RSEL[5:3])
+            cmd_block_bank  : begin spi_bank_valid = (SPI_RSEL[2:0] == 0);        spi_bank = '0;                              end
+            cmd_row_bank    : begin spi_bank_valid = (SPI_RSEL[2:0] < N_PE_COL);  spi_bank = BW'(BANK_ROW + SPI_RSEL[2:0]);   end
+            cmd_ccl_bank    : begin spi_bank_valid = (SPI_RSEL[2:0] < N_PE_COL);  spi_bank = BW'(BANK_CCL + SPI_RSEL[2:0]);   end
+            cmd_weight_bank : begin spi_bank_valid = (SPI_RSEL[2:0] == 0);        spi_bank = BW'(BANK_WEIGHT);                end
+            default         : ;
+        endcase
+    end
+    
+    assign rd_spi   = spi_ren_sync && spi_bank_valid && !tma_busy;
+    assign rd_crc   = crc_busy && crc_idx < crc_len && !tma_busy && !rd_spi;
+    assign rd_en    = rd_spi || rd_crc;
+    assign rd_bank  = rd_spi? spi_bank : crc_bank;
+    assign rd_addr  = rd_spi? SPI_RADDR : crc_idx;
+    
+    assign rb_raddr_block_idx_bank      = rd_addr[$clog2(DEPTH_BLOCK_BANK)-1:0];
+    assign rb_raddr_row_cnt_bank        = rd_addr[$clog2(DEPTH_ROW_BANK)-1:0];
+    assign rb_raddr_col_clause_idx_bank = rd_addr[$clog2(DEPTH_CCL_BANK)-1:0] / N_CCL_WORD;
+    assign rb_raddr_weight_bank         = rd_addr[$clog2(DEPTH_WEIGHT_BANK)-1:0];
+    
+    always_comb begin
+        rb_ren_block_idx_bank   = rd_en && rd_bank == 0;
+        rb_ren_weight_bank      = rd_en && rd_bank == BANK_WEIGHT;
+        for (int i = 0; i < N_PE_COL; i++) begin
+            rb_ren_row_cnt_bank[i]          = rd_en && rd_bank == BANK_ROW + i;
+            rb_ren_col_clause_idx_bank[i]   = rd_en && rd_bank == BANK_CCL + i;
+        end
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            rd_spi_d1   <= 0;
+            rd_crc_d1   <= 0;
+            rd_bank_d1  <= '0;
+            rd_wsel_d1  <= '0;
+        end else begin
+            rd_spi_d1   <= rd_spi;
+            rd_crc_d1   <= rd_crc;
+            rd_bank_d1  <= rd_bank;
+            rd_wsel_d1  <= 2'(rd_addr % N_CCL_WORD);
+        end
+    end
+    
+    // word read the cycle before, zero extended
+    always_comb begin
+        rd_word = '0;
+        if (rd_bank_d1 == 0)            rd_word = 32'(block_idx_data);
+        if (rd_bank_d1 == BANK_WEIGHT)  rd_word = {23'b0, weight_data};
+        for (int i = 0; i < N_PE_COL; i++) begin
+            if (rd_bank_d1 == BANK_ROW + i) rd_word = 32'(row_cnt_data[i]);
+            if (rd_bank_d1 == BANK_CCL + i) rd_word = 32'(col_clause_idx_data[i][5*rd_wsel_d1 +: 5]);
+        end
+    end
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)                                 bank_rdata <= '0;
+        else if (spi_ren_sync && !spi_bank_valid)   bank_rdata <= '0;
+        else if (rd_spi_d1)                         bank_rdata <= rd_word;
+    end
+    
+    //-------------------------------------------------------------------------
+    // CRC walk
+    //-------------------------------------------------------------------------
+    always_comb begin
+        crc_len = '0;
+        if (crc_bank == 0)              crc_len = 12'(SPI_LEN_BLOCK_BANK);
+        if (crc_bank == BANK_WEIGHT)    crc_len = 12'(SPI_LEN_WEIGHT_BANK);
+        for (int i = 0; i < N_PE_COL; i++) begin
+            if (crc_bank == BANK_ROW + i)   crc_len = 12'(SPI_LEN_ROW_BANK[i]);
+            if (crc_bank == BANK_CCL + i)   crc_len = 12'(SPI_LEN_CCL_BANK[i]);
+        end
+    end
+    
+    // A bank is closed once its last word is in crc_reg.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n) begin
+            crc_dirty   <= 1;
+            crc_busy    <= 0;
+            crc_valid   <= 0;
+            crc_bank    <= '0;
+            crc_idx     <= '0;
+            crc_reg     <= '1;
+            for (int b = 0; b < N_BANK; b++)
+                bank_crc[b] <= '0;
+        end else if (spi_wen_sync) begin
+            crc_dirty   <= 1;
+            crc_busy    <= 0;
+            crc_valid   <= 0;
+        end else if (crc_dirty) begin
+            if (!tma_busy) begin
+                crc_dirty   <= 0;
+                crc_busy    <= 1;
+                crc_bank    <= '0;
+                crc_idx     <= '0;
+                crc_reg     <= '1;
+            end
+        end else if (crc_busy) begin
+            if (rd_crc_d1)
+                crc_reg <= crc32_word(crc_reg, rd_word);
+            if (rd_crc) begin
+                crc_idx <= crc_idx + 1'b1;
+            end else if (crc_idx == crc_len && !rd_crc_d1) begin
+                bank_crc[crc_bank]  <= ~crc_reg;
+                crc_reg             <= '1;
+                crc_idx             <= '0;
+                if (crc_bank == BANK_WEIGHT) begin
+                    crc_busy    <= 0;
+                    crc_valid   <= 1;
+                end else begin
+                    crc_bank    <= crc_bank + 1'b1;
+                end
+            end
+        end
+    end
+    
+    //-------------------------------------------------------------------------
+    // Status word and read data
+    //-------------------------------------------------------------------------
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)         done_cnt <= '0;
+        else if (Inf_Done)  done_cnt <= done_cnt + 1'b1;
+    end
+    
+    assign status_word = {1'b1, tma_busy, crc_valid, 2'b0, result_cnt, Result, argmax_result, done_cnt};
+    
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)
+            reg_rdata <= '0;
+        else if (spi_ren_sync) begin
+            if (SPI_RSEL[2:0] == SEL_STATUS && SPI_RADDR == 0)      reg_rdata <= status_word;
+            else if (SPI_RSEL[2:0] == SEL_CRC && SPI_RADDR < N_BANK) reg_rdata <= bank_crc[SPI_RADDR];
+            else                                                    reg_rdata <= '0;
+        end
+    end
+    
+    always_comb begin
+        unique case (SPI_RSEL[5:3])
+            cmd_result_fifo : spi_rdata = result_fifo_rdata;
+            cmd_read_reg    : spi_rdata = (SPI_RSEL[2:0] == SEL_PERF_CNT)? perf_cnt_rdata : reg_rdata;
+            default         : spi_rdata = bank_rdata;
+        endcase
+    end
+    
+endmodule
@@ -25,6 +25,46 @@
 // Desc: The SPI interface is used for the master control and configure 
 //       the accelerator.
 //
+//       With a[24] (pack) set in the command word of a row count, CCL index
+//       or weight burst, every 32-bit frame carries several bank words,
+//       LSB first: 5 row counts, 6 CCL indices or 3 weights. *brust_len*
+//       still counts bank words, and the last frame is zero padded. The
+//       words of a frame are written one every two SCK cycles after the
+//       frame, so the last ones complete during the next command word.
+//
+//       A weight burst with bank_sel 1 writes the class bound table used by
+//       the early exit (argmax.sv): one unpacked 14-bit word per class.
+//
+//       A block index burst with bank_sel 1 writes the class start table of
+//       ogbcsr_decoder.sv, which lets SPI_CLASS_SKIP jump over whole classes:
+//       at addr {class, column[2:0]}, the row count address in bits [26:16]
+//       and the CCL index address in bits [11:0] of the first block of the
+//       class.
+//
+//       a[31] clear makes any command a read on MISO, MSB first, changing
+//       on the falling edge of SCK; cmd 3'b110 and 3'b111 are always reads.
+//       The first data frame is a turnaround: it requests word addr from
+//       the system clock domain, and the *brust_len* words follow, each
+//       requested one frame before it is shifted out. A read burst takes at
+//       most 4095 words, ignores the pack flag and does not need
+//       SPI_EN_CONF. SPI_REN carries every request, SPI_RSEL the cmd and
+//       bank_sel and SPI_RADDR the word, both held until the next one.
+//
+//       cmd 3'b000 reads the configuration registers back from this clock
+//       domain, zero extended. cmd 3'b110 reads the result FIFO
+//       (result_fifo.sv), cmd 3'b111 the performance counters
+//       (perf_counter.sv, bank_sel 0), the status word and the bank CRCs
+//       (spi_readback.sv, bank_sel 1 and 2). cmd 3'b001 to 3'b100 read the
+//       block index, row count, CCL index and weight banks back
+//       (spi_readback.sv), the class start and bound tables excepted.
+//       SPI_WEN_CONF_REG pulses at every configuration register write, so
+//       that the bank CRCs follow new bank lengths.
+//
+//       SPI_LEN_ROW_BANK and SPI_LEN_CCL_BANK take one register per column
+//       from config_addr 8, and the registers after them follow at
+//       CONF_ADDR_*: 18 to 27 with 5 columns. The 3-bit bank_sel selects the
+//       row count and CCL bank of a column, so N_PE_COL is at most 8.
+//
 //==============================================================================
 
 module spi_slave #(
@@ -40,20 +80,29 @@ module spi_slave #(
     input logic         SCK,
     input logic         CS,
     input logic         MOSI,
-    //output wire         MISO,
+    output logic        MISO,
     
     // System inputs ----------------------------------------------------------
     input logic         rst_n,
     
     // outputs to system ------------------------------------------------------
     output logic        SPI_WEN_BLOCK_BANK,
+    output logic        SPI_WEN_CLASS_BANK,
     output logic        SPI_WEN_ROW_BANK        [N_PE_COL],
     output logic        SPI_WEN_CCL_BANK        [N_PE_COL],
     output logic        SPI_WEN_WEIGHT_BANK,
+    output logic        SPI_WEN_BOUND_BANK,
     output logic        SPI_WEN_FE_BANK,
+    output logic        SPI_WEN_CONF_REG,
+    output logic        SPI_REN,
+    output logic [5:0]  SPI_RSEL,
     output logic [11:0] SPI_ADDR,
+    output logic [11:0] SPI_RADDR,
     output logic [31:0] SPI_DATA,
     
+    // inputs from system -----------------------------------------------------
+    input logic [31:0]  SPI_RDATA,
+    
     // Configuration registers ------------------------------------------------
     output logic        SPI_EN_CONF,
     output logic        SPI_EN_INF,
@@ -65,7 +114,16 @@ module spi_slave #(
     output logic [$clog2(DEPTH_BLOCK_BANK)-1:0]     SPI_LEN_BLOCK_BANK,
     output logic [$clog2(DEPTH_ROW_BANK)-1:0]       SPI_LEN_ROW_BANK        [N_PE_COL],
     output logic [$clog2(DEPTH_CCL_BANK)-1:0]       SPI_LEN_CCL_BANK        [N_PE_COL],
-    output logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]    SPI_LEN_WEIGHT_BANK
+    output logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]    SPI_LEN_WEIGHT_BANK,
+    output logic        SPI_EN_EARLY_EXIT,
+    output logic [15:0] SPI_CLASS_SKIP,
+    output logic [5:0]  SPI_INF_STRIDE,
+    output logic [11:0] SPI_VAD_TH,
+    output logic [3:0]  SPI_VAD_CLASS,
+    output logic        SPI_EN_KWD,
+    output logic [5:0]  SPI_KWD_WINDOW,
+    output logic [5:0]  SPI_KWD_RUN,
+    output logic [5:0]  SPI_KWD_HOLDOFF
     
 );
     localparam cmd_conf_reg     = 3'b000;
@@ -74,6 +132,34 @@ module spi_slave #(
     localparam cmd_ccl_bank     = 3'b011;
     localparam cmd_weight_bank  = 3'b100;
     localparam cmd_feature_bank = 3'b101;
+    localparam cmd_result_fifo  = 3'b110;
+    localparam cmd_read_reg     = 3'b111;
+    
+    // bank words per packed frame and their width
+    localparam PACK_NUM_ROW     = 5;
+    localparam PACK_NUM_CCL     = 6;
+    localparam PACK_NUM_WEIGHT  = 3;
+    localparam PACK_BITS_ROW    = 6;
+    localparam PACK_BITS_CCL    = 5;
+    localparam PACK_BITS_WEIGHT = 9;
+    
+    // configuration registers after the per-column bank lengths
+    localparam CONF_ADDR_LEN_ROW_BANK       = 8;
+    localparam CONF_ADDR_LEN_CCL_BANK       = CONF_ADDR_LEN_ROW_BANK + N_PE_COL;
+    localparam CONF_ADDR_LEN_WEIGHT_BANK    = CONF_ADDR_LEN_CCL_BANK + N_PE_COL;
+    localparam CONF_ADDR_EN_EARLY_EXIT      = CONF_ADDR_LEN_WEIGHT_BANK + 1;
+    localparam CONF_ADDR_CLASS_SKIP         = CONF_ADDR_LEN_WEIGHT_BANK + 2;
+    localparam CONF_ADDR_INF_STRIDE         = CONF_ADDR_LEN_WEIGHT_BANK + 3;
+    localparam CONF_ADDR_VAD_TH             = CONF_ADDR_LEN_WEIGHT_BANK + 4;
+    localparam CONF_ADDR_VAD_CLASS          = CONF_ADDR_LEN_WEIGHT_BANK + 5;
+    localparam CONF_ADDR_EN_KWD             = CONF_ADDR_LEN_WEIGHT_BANK + 6;
+    localparam CONF_ADDR_KWD_WINDOW         = CONF_ADDR_LEN_WEIGHT_BANK + 7;
+    localparam CONF_ADDR_KWD_RUN            = CONF_ADDR_LEN_WEIGHT_BANK + 8;
+    localparam CONF_ADDR_KWD_HOLDOFF        = CONF_ADDR_LEN_WEIGHT_BANK + 9;
+    
+    if (N_PE_COL > 8) begin : g_n_pe_col_check
+        $error("spi_slave: N_PE_COL = %0d, bank_sel addresses at most 8 columns", N_PE_COL);
+    end
     
     genvar i;
     typedef enum logic {addr_phase, data_phase} state_t;
@@ -90,35 +176,70 @@ module spi_slave #(
     logic wen_ccl_bank;
     logic wen_weight_bank;
     logic wen_feature_bank;
+    logic ren;
+    logic FSM_load_miso;
     
     logic [4:0]     spi_rcnt;
     logic [31:0]    mosi_buffer_comb;
     logic [31:0]    spi_addr;
     logic [31:0]    spi_data;
     logic [31:0]    spi_shift_reg_in;
+    logic [31:0]    spi_shift_reg_out;
     logic [11:0]    spi_receive_num;
-    logic [11:0]    brust_len;      // MSB([24]) does not used.
+    logic [11:0]    brust_len;      // [24] is the pack flag.
     logic [5:0]     config_addr;
     logic [2:0]     bank_sel;
     
+    logic           pack_en;
+    logic [2:0]     pack_num;       // bank words per frame
+    logic [3:0]     pack_bits;
+    logic [2:0]     pack_left;      // words of the current frame still to write
+    logic           pack_wr;
+    logic           pack_wen;
+    logic [4:0]     pack_shift;
+    logic           FSM_load_pack;
+    logic [12:0]    frame_end_num;
+    logic           read_en;
+    logic           read_cmd_comb;  // read_en of the command word being received
+    logic [31:0]    conf_rdata;
+    logic [12:0]    last_num;       // index of the last frame, read bursts add the turnaround
+    
     //-------------------------------------------------------------------------
     // Inputs/Outputs logic
     //-------------------------------------------------------------------------
-    assign SPI_DATA             = spi_data;
+    assign SPI_DATA             = spi_data >> pack_shift;
     assign SPI_ADDR             = spi_addr[11:0] + spi_receive_num;
+    assign SPI_RSEL             = spi_addr[30:25];
     
     always_ff @(posedge SCK, negedge rst_n) begin
         if (!rst_n) begin
             SPI_WEN_BLOCK_BANK  <= 0;
+            SPI_WEN_CLASS_BANK  <= 0;
             SPI_WEN_WEIGHT_BANK <= 0;
+            SPI_WEN_BOUND_BANK  <= 0;
             SPI_WEN_FE_BANK     <= 0;
+            SPI_WEN_CONF_REG    <= 0;
+            SPI_REN             <= 0;
         end else begin
-            SPI_WEN_BLOCK_BANK  <= wen_block_bank;
-            SPI_WEN_WEIGHT_BANK <= wen_weight_bank;
+            SPI_WEN_BLOCK_BANK  <= (bank_sel == 0)? wen_block_bank : 0;
+            SPI_WEN_CLASS_BANK  <= (bank_sel == 1)? wen_block_bank : 0;
+            SPI_WEN_WEIGHT_BANK <= (bank_sel == 0)? wen_weight_bank : 0;
+            SPI_WEN_BOUND_BANK  <= (bank_sel == 1)? wen_weight_bank : 0;
             SPI_WEN_FE_BANK     <= wen_feature_bank;
+            SPI_WEN_CONF_REG    <= FSM_wen_conf_reg;
+            SPI_REN             <= ren;
         end
     end
     
+    // The command word requests word addr, a data frame the word after the
+    // one it loads.
+    always_ff @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)
+            SPI_RADDR <= '0;
+        else if (ren)
+            SPI_RADDR <= (p_state == addr_phase)? mosi_buffer_comb[11:0] : spi_addr[11:0] + spi_receive_num + 1'b1;
+    end
+    
 for (i = 0; i < N_PE_COL; i++) begin
     always_ff @(posedge SCK, negedge rst_n) begin
         if (!rst_n) begin
@@ -135,9 +256,56 @@ end
     // SPI receive logic
     //-------------------------------------------------------------------------
     assign mosi_buffer_comb = {spi_shift_reg_in[30:0], MOSI};
-    assign config_addr      = spi_addr[4:0] + spi_receive_num[4:0];
+    assign config_addr      = spi_addr[5:0] + spi_receive_num[5:0];
     assign bank_sel         = spi_addr[27:25];
     
+    //-------------------------------------------------------------------------
+    // Packed burst: write the remaining words of a frame
+    //-------------------------------------------------------------------------
+    always_comb begin
+        pack_num    = 3'd1;
+        pack_bits   = '0;
+        if (spi_addr[24] && !read_en) begin
+            unique case (spi_addr[30:28])
+                cmd_row_bank    : begin pack_num = PACK_NUM_ROW;    pack_bits = PACK_BITS_ROW;    end
+                cmd_ccl_bank    : begin pack_num = PACK_NUM_CCL;    pack_bits = PACK_BITS_CCL;    end
+                cmd_weight_bank : begin pack_num = PACK_NUM_WEIGHT; pack_bits = PACK_BITS_WEIGHT; end
+                default         : ;
+            endcase
+        end
+    end
+    
+    assign pack_en          = (pack_num != 3'd1);
+    assign pack_wen         = pack_wr && pack_left != 0;
+    
+    // index of the last bank word the current frame can carry
+    assign frame_end_num    = spi_receive_num + pack_num - 1'b1;
+    
+    assign read_en          = !spi_addr[31] || spi_addr[30:28] == cmd_result_fifo || spi_addr[30:28] == cmd_read_reg;
+    assign read_cmd_comb    = !mosi_buffer_comb[31] || mosi_buffer_comb[30:28] == cmd_result_fifo ||
+                                                       mosi_buffer_comb[30:28] == cmd_read_reg;
+    assign last_num         = brust_len + read_en;
+    
+    always_ff @(posedge SCK, negedge rst_n) begin
+        if (!rst_n) begin
+            pack_left   <= '0;
+            pack_wr     <= 0;
+            pack_shift  <= '0;
+        end else if (FSM_update_spi_addr) begin
+            pack_left   <= '0;
+            pack_wr     <= 0;
+            pack_shift  <= '0;
+        end else if (FSM_load_pack) begin
+            pack_left   <= (frame_end_num > brust_len)? brust_len - spi_receive_num : pack_num - 1'b1;
+            pack_wr     <= 0;
+            pack_shift  <= '0;
+        end else if (pack_left != 0) begin
+            pack_wr     <= !pack_wr;
+            if (pack_wr)    pack_left   <= pack_left - 1'b1;
+            else            pack_shift  <= pack_shift + pack_bits;
+        end
+    end
+    
     always_ff @(posedge SCK, negedge rst_n) begin
         if (!rst_n)     spi_rcnt <= '0;
         else if (!CS)   spi_rcnt <= spi_rcnt + 1'b1;
@@ -175,7 +343,7 @@ end
         if (!rst_n) begin
             FSM_inc_rec_num_reg <= 0;
         end else begin
-            FSM_inc_rec_num_reg <= FSM_inc_rec_num;
+            FSM_inc_rec_num_reg <= FSM_inc_rec_num || (pack_wen && SPI_EN_CONF);
         end
     end
     
@@ -189,10 +357,58 @@ end
         end
     end
     
+    //-------------------------------------------------------------------------
+    // SPI transmit logic
+    //-------------------------------------------------------------------------
+    
+    // SPI_RDATA only changes a few system clock cycles after the read
+    // request, well before the next frame loads it.
+    always_ff @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)             spi_shift_reg_out <= '0;
+        else if (FSM_load_miso) spi_shift_reg_out <= (spi_addr[30:28] == cmd_conf_reg)? conf_rdata : SPI_RDATA;
+        else if (!CS)           spi_shift_reg_out <= {spi_shift_reg_out[30:0], 1'b0};
+    end
+    
+    // The master samples MISO on the rising edge of SCK.
+    always_ff @(negedge SCK, negedge rst_n) begin
+        if (!rst_n)     MISO <= 0;
+        else            MISO <= spi_shift_reg_out[31];
+    end
+    
     //-------------------------------------------------------------------------
     // Configuration registers
     //-------------------------------------------------------------------------
     
+    // readback at config_addr, 0 past CONF_ADDR_KWD_HOLDOFF
+    always_comb begin
+        conf_rdata = '0;
+        unique case (config_addr)
+            6'd0                        : conf_rdata = 32'(SPI_EN_CONF);
+            6'd1                        : conf_rdata = 32'(SPI_EN_INF);
+            6'd2                        : conf_rdata = 32'(SPI_EN_FE);
+            6'd3                        : conf_rdata = 32'(SPI_NUM_CLASS);
+            6'd4                        : conf_rdata = 32'(SPI_NUM_CLAUSE);
+            6'd5                        : conf_rdata = 32'(SPI_NUM_SUM_TIME);
+            6'd6                        : conf_rdata = 32'(SPI_FLUX_TH);
+            6'd7                        : conf_rdata = 32'(SPI_LEN_BLOCK_BANK);
+            CONF_ADDR_LEN_WEIGHT_BANK   : conf_rdata = 32'(SPI_LEN_WEIGHT_BANK);
+            CONF_ADDR_EN_EARLY_EXIT     : conf_rdata = 32'(SPI_EN_EARLY_EXIT);
+            CONF_ADDR_CLASS_SKIP        : conf_rdata = 32'(SPI_CLASS_SKIP);
+            CONF_ADDR_INF_STRIDE        : conf_rdata = 32'(SPI_INF_STRIDE);
+            CONF_ADDR_VAD_TH            : conf_rdata = 32'(SPI_VAD_TH);
+            CONF_ADDR_VAD_CLASS         : conf_rdata = 32'(SPI_VAD_CLASS);
+            CONF_ADDR_EN_KWD            : conf_rdata = 32'(SPI_EN_KWD);
+            CONF_ADDR_KWD_WINDOW        : conf_rdata = 32'(SPI_KWD_WINDOW);
+            CONF_ADDR_KWD_RUN           : conf_rdata = 32'(SPI_KWD_RUN);
+            CONF_ADDR_KWD_HOLDOFF       : conf_rdata = 32'(SPI_KWD_HOLDOFF);
+            default                     : ;
+        endcase
+        for (int k = 0; k < N_PE_COL; k++) begin
+            if (config_addr == CONF_ADDR_LEN_ROW_BANK + k)  conf_rdata = 32'(SPI_LEN_ROW_BANK[k]);
+            if (config_addr == CONF_ADDR_LEN_CCL_BANK + k)  conf_rdata = 32'(SPI_LEN_CCL_BANK[k]);
+        end
+    end
+    
     // SPI_EN_CONF(1-bit), config_addr: 0
     always @(posedge SCK, negedge rst_n) begin
         if (!rst_n)                                         SPI_EN_CONF <= '1;
@@ -244,25 +460,79 @@ end
 generate
 for (i = 0; i < N_PE_COL; i++) begin
     
-    // SPI_LEN_ROW_BANK(10-bit), config_addr: 8-12
+    // SPI_LEN_ROW_BANK(10-bit), config_addr: CONF_ADDR_LEN_ROW_BANK + i
     always @(posedge SCK, negedge rst_n) begin
-        if (!rst_n)                                                         SPI_LEN_ROW_BANK[i] <= '0;
-        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == (8+i))   SPI_LEN_ROW_BANK[i] <= mosi_buffer_comb[$clog2(DEPTH_ROW_BANK)-1:0];
+        if (!rst_n)                                                                              SPI_LEN_ROW_BANK[i] <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_LEN_ROW_BANK + i)   SPI_LEN_ROW_BANK[i] <= mosi_buffer_comb[$clog2(DEPTH_ROW_BANK)-1:0];
     end
     
-    // SPI_LEN_CCL_BANK(11-bit), config_addr: 13-17
+    // SPI_LEN_CCL_BANK(11-bit), config_addr: CONF_ADDR_LEN_CCL_BANK + i
     always @(posedge SCK, negedge rst_n) begin
-        if (!rst_n)                                                         SPI_LEN_CCL_BANK[i] <= '0;
-        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == (13+i))  SPI_LEN_CCL_BANK[i] <= mosi_buffer_comb[$clog2(DEPTH_CCL_BANK)-1:0];
+        if (!rst_n)                                                                              SPI_LEN_CCL_BANK[i] <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_LEN_CCL_BANK + i)   SPI_LEN_CCL_BANK[i] <= mosi_buffer_comb[$clog2(DEPTH_CCL_BANK)-1:0];
     end
     
 end
 endgenerate
     
-    // SPI_LEN_WEIGHT_BANK(12-bit), config_addr: 18
+    // SPI_LEN_WEIGHT_BANK(12-bit), config_addr: CONF_ADDR_LEN_WEIGHT_BANK
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_LEN_WEIGHT_BANK <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_LEN_WEIGHT_BANK)    SPI_LEN_WEIGHT_BANK <= mosi_buffer_comb[$clog2(DEPTH_WEIGHT_BANK)-1:0];
+    end
+    
+    // SPI_EN_EARLY_EXIT(1-bit), config_addr: CONF_ADDR_EN_EARLY_EXIT
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_EN_EARLY_EXIT <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_EN_EARLY_EXIT)      SPI_EN_EARLY_EXIT <= mosi_buffer_comb[0];
+    end
+    
+    // SPI_CLASS_SKIP(16-bit), config_addr: CONF_ADDR_CLASS_SKIP
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_CLASS_SKIP <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_CLASS_SKIP)         SPI_CLASS_SKIP <= mosi_buffer_comb[15:0];
+    end
+    
+    // SPI_INF_STRIDE(6-bit), config_addr: CONF_ADDR_INF_STRIDE
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_INF_STRIDE <= 6'd1;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_INF_STRIDE)         SPI_INF_STRIDE <= mosi_buffer_comb[5:0];
+    end
+    
+    // SPI_VAD_TH(12-bit), config_addr: CONF_ADDR_VAD_TH
     always @(posedge SCK, negedge rst_n) begin
-        if (!rst_n)                                                         SPI_LEN_WEIGHT_BANK <= '0;
-        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == 18)      SPI_LEN_WEIGHT_BANK <= mosi_buffer_comb[$clog2(DEPTH_WEIGHT_BANK)-1:0];
+        if (!rst_n)                                                                              SPI_VAD_TH <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_VAD_TH)             SPI_VAD_TH <= mosi_buffer_comb[11:0];
+    end
+    
+    // SPI_VAD_CLASS(4-bit), config_addr: CONF_ADDR_VAD_CLASS
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_VAD_CLASS <= 4'd10;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_VAD_CLASS)          SPI_VAD_CLASS <= mosi_buffer_comb[3:0];
+    end
+    
+    // SPI_EN_KWD(1-bit), config_addr: CONF_ADDR_EN_KWD
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_EN_KWD <= '0;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_EN_KWD)             SPI_EN_KWD <= mosi_buffer_comb[0];
+    end
+    
+    // SPI_KWD_WINDOW(6-bit), config_addr: CONF_ADDR_KWD_WINDOW
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_KWD_WINDOW <= 6'd40;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_KWD_WINDOW)         SPI_KWD_WINDOW <= mosi_buffer_comb[5:0];
+    end
+    
+    // SPI_KWD_RUN(6-bit), config_addr: CONF_ADDR_KWD_RUN
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_KWD_RUN <= 6'd21;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_KWD_RUN)            SPI_KWD_RUN <= mosi_buffer_comb[5:0];
+    end
+    
+    // SPI_KWD_HOLDOFF(6-bit), config_addr: CONF_ADDR_KWD_HOLDOFF
+    always @(posedge SCK, negedge rst_n) begin
+        if (!rst_n)                                                                              SPI_KWD_HOLDOFF <= 6'd40;
+        else if (SPI_EN_CONF && FSM_wen_conf_reg && config_addr == CONF_ADDR_KWD_HOLDOFF)        SPI_KWD_HOLDOFF <= mosi_buffer_comb[5:0];
     end
     
     //-------------------------------------------------------------------------
@@ -285,9 +555,11 @@ endgenerate
                                       mosi_buffer_comb[30:28] == cmd_row_bank     ||
                                       mosi_buffer_comb[30:28] == cmd_ccl_bank     ||
                                       mosi_buffer_comb[30:28] == cmd_weight_bank  ||
-                                      mosi_buffer_comb[30:28] == cmd_feature_bank))     n_state = data_phase;
+                                      mosi_buffer_comb[30:28] == cmd_feature_bank ||
+                                      mosi_buffer_comb[30:28] == cmd_result_fifo  ||
+                                      mosi_buffer_comb[30:28] == cmd_read_reg))         n_state = data_phase;
             data_phase  :   if      (!CS && spi_rcnt == 5'd31 && 
-                                     spi_receive_num == brust_len)                      n_state = addr_phase;
+                                     frame_end_num >= last_num)                         n_state = addr_phase;
             default     :                                                               n_state = addr_phase;
         endcase
     end
@@ -299,11 +571,14 @@ endgenerate
         FSM_flush_rec_num       = 0;
         FSM_inc_rec_num         = 0;
         FSM_wen_conf_reg        = 0;
+        FSM_load_pack           = 0;
         wen_block_bank          = 0;
-        wen_row_bank            = 0;
-        wen_ccl_bank            = 0;
-        wen_weight_bank         = 0;
+        wen_row_bank            = pack_wen && spi_addr[30:28] == cmd_row_bank;
+        wen_ccl_bank            = pack_wen && spi_addr[30:28] == cmd_ccl_bank;
+        wen_weight_bank         = pack_wen && spi_addr[30:28] == cmd_weight_bank;
         wen_feature_bank        = 0;
+        ren                     = 0;
+        FSM_load_miso           = 0;
         
         unique case(p_state)
             addr_phase  :   begin 
@@ -311,13 +586,15 @@ endgenerate
                                     FSM_update_spi_addr     = 1;
                                     FSM_update_brust_len    = 1;
                                     FSM_flush_rec_num       = 1;
+                                    ren                     = read_cmd_comb && mosi_buffer_comb[30:28] != cmd_conf_reg;
                                 end
                             end
             data_phase  :   begin
-                                if (!CS && SPI_EN_CONF && spi_rcnt == 5'd31 && 
-                                            spi_receive_num != brust_len)                       FSM_inc_rec_num     = 1;
+                                if (!CS && (SPI_EN_CONF || read_en) && spi_rcnt == 5'd31 && 
+                                            spi_receive_num != last_num)                        FSM_inc_rec_num     = 1;
                                 if (!CS && spi_rcnt == 5'd31)                                   FSM_update_spi_data = 1;
-                                if (!CS && spi_rcnt == 5'd31) begin
+                                if (!CS && spi_rcnt == 5'd31 && pack_en)                        FSM_load_pack       = 1;
+                                if (!CS && spi_rcnt == 5'd31 && !read_en) begin
                                     if      (spi_addr[30:28] == cmd_conf_reg)                   FSM_wen_conf_reg    = 1;
                                     else if (spi_addr[30:28] == cmd_block_bank)                 wen_block_bank      = 1;
                                     else if (spi_addr[30:28] == cmd_row_bank)                   wen_row_bank        = 1;
@@ -325,6 +602,10 @@ endgenerate
                                     else if (spi_addr[30:28] == cmd_weight_bank)                wen_weight_bank     = 1;
                                     else if (spi_addr[30:28] == cmd_feature_bank)               wen_feature_bank    = 1;
                                 end
+                                if (!CS && spi_rcnt == 5'd31 && read_en) begin
+                                    if (spi_receive_num < brust_len)                            ren                 = (spi_addr[30:28] != cmd_conf_reg);
+                                    if (spi_receive_num <= brust_len)                           FSM_load_miso       = 1;
+                                end
                             end
             default: ;
         endcase
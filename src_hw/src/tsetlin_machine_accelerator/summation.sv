@@ -24,6 +24,16 @@
 // 
 // Desc: Multi-classification Tsetlin Machine summation component.
 //
+//       class_idx steps over the classes disabled by SPI_CLASS_SKIP, one per
+//       cycle, and the weight address over their SPI_NUM_SUM_TIME *
+//       2 * N_PE_CLUSTER weights. Between inferences both rest at 0.
+//
+//       summation_busy is high while the clauses of a round are walked
+//       (perf_counter.sv).
+//
+//       flush (an early exit) returns every register to its reset value on
+//       the next clock edge.
+//
 //==============================================================================
 
 module summation #(
@@ -31,8 +41,10 @@ module summation #(
     parameter DEPTH_WEIGHT_BANK             = 2048
 )(
     input logic                                 clk, rst_n,
+    input logic                                 flush,
     input logic                                 decode_en,
     input logic                                 tail_flush_en,
+    input logic [15:0]                          class_en,
     input logic                                 summation_ena,
     input logic                                 patch0_result       [N_PE_CLUSTER],
     input logic                                 patch1_result       [N_PE_CLUSTER],
@@ -47,7 +59,8 @@ module summation #(
     output logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]raddr_weight_bank,
     output logic                                argmax_ena,
     output logic signed [13:0]                  class_summation,
-    output logic [3:0]                          class_idx
+    output logic [3:0]                          class_idx,
+    output logic                                summation_busy
 );
     
     genvar i;
@@ -55,7 +68,7 @@ module summation #(
     logic                                   clause1_sat         [N_PE_CLUSTER];
     logic                                   one_class_done;
     logic [5:0]                             summation_cnt;
-    logic [5:0]                             clause_cnt;
+    logic [$clog2(2*N_PE_CLUSTER)-1:0]      clause_cnt;
     logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   raddr_weight_bank_int;
     logic                                   ren_weight_bank_d1;
     logic                                   read_weight_flag;
@@ -63,14 +76,21 @@ module summation #(
     logic [3:0]                             n_class;
     logic [5:0]                             n_sum_time;
     logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   len_weight_bank;
+    logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   class_len_weight;
+    logic                                   class_skip;
     
     
     // assign for configuration registers
     assign n_class          = SPI_NUM_CLASS;
     assign n_sum_time       = SPI_NUM_SUM_TIME;
     assign len_weight_bank  = SPI_LEN_WEIGHT_BANK;
+    assign class_len_weight = n_sum_time * (2 * N_PE_CLUSTER);
+    
+    // The current class is disabled: move on to the next one.
+    assign class_skip = (decode_en || tail_flush_en) && !one_class_done && class_idx < n_class && !class_en[class_idx];
     
     assign argmax_ena = one_class_done;
+    assign summation_busy = read_weight_flag;
     // Extend sign-bit.
     assign weight_bank_data_ext = weight_data;
     
@@ -83,6 +103,9 @@ for (i = 0; i < N_PE_CLUSTER; i++) begin
         if(!rst_n) begin
             clause0_sat[i] <= 0;
             clause1_sat[i] <= 0;
+        end else if (flush) begin
+            clause0_sat[i] <= 0;
+            clause1_sat[i] <= 0;
         end else if (summation_ena) begin
             clause0_sat[i] <= patch0_result[i];
             clause1_sat[i] <= patch1_result[i];
@@ -96,6 +119,8 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             summation_cnt <= 0;
+        end else if (flush) begin
+            summation_cnt <= 0;
         end else if (clause_cnt == 2 * N_PE_CLUSTER - 1) begin
             summation_cnt <= summation_cnt + 1;
         end else if (summation_cnt == n_sum_time) begin
@@ -107,6 +132,8 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             one_class_done <= 0;
+        end else if (flush) begin
+            one_class_done <= 0;
         end else if ((decode_en || tail_flush_en) && summation_cnt == n_sum_time) begin
             one_class_done <= 1;
         end else begin
@@ -118,10 +145,14 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n) begin
             class_idx <= 0;
+        end else if (flush) begin
+            class_idx <= 0;
         end else if (one_class_done == 1) begin
             class_idx <= class_idx + 1;
-        end else if (class_idx == n_class) begin
+        end else if (class_idx == n_class || !(decode_en || tail_flush_en)) begin
             class_idx <= 0;
+        end else if (class_skip) begin
+            class_idx <= class_idx + 1;
         end
     end
     
@@ -129,6 +160,8 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
             read_weight_flag <= 0;
+        end else if (flush) begin
+            read_weight_flag <= 0;
         end else if (summation_ena) begin
             read_weight_flag <= 1;
         end else if (clause_cnt == 2 * N_PE_CLUSTER - 1) begin
@@ -139,6 +172,8 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
             clause_cnt <= 0;
+        end else if (flush) begin
+            clause_cnt <= 0;
         end else if (read_weight_flag) begin
             clause_cnt <= clause_cnt + 1;
         end else begin
@@ -151,9 +186,9 @@ endgenerate
     always_comb begin
         ren_weight_bank = 0;
         if (read_weight_flag == 1) begin
-            if (clause_cnt[0] == 0 && clause0_sat[clause_cnt[5:1]] == 1) begin
+            if (clause_cnt[0] == 0 && clause0_sat[clause_cnt[$bits(clause_cnt)-1:1]] == 1) begin
                 ren_weight_bank = 1;
-            end else if (clause_cnt[0] == 1 && clause1_sat[clause_cnt[5:1]] == 1) begin
+            end else if (clause_cnt[0] == 1 && clause1_sat[clause_cnt[$bits(clause_cnt)-1:1]] == 1) begin
                 ren_weight_bank = 1;
             end
         end
@@ -164,10 +199,14 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
             raddr_weight_bank_int <= 0;
+        end else if (flush) begin
+            raddr_weight_bank_int <= 0;
         end else if (read_weight_flag) begin
             raddr_weight_bank_int <= raddr_weight_bank_int + 1;
-        end else if (raddr_weight_bank_int == len_weight_bank) begin
+        end else if (raddr_weight_bank_int == len_weight_bank || !(decode_en || tail_flush_en)) begin
             raddr_weight_bank_int <= 0;
+        end else if (class_skip) begin
+            raddr_weight_bank_int <= raddr_weight_bank_int + class_len_weight;
         end
     end
     
@@ -175,6 +214,8 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
             ren_weight_bank_d1 <= 0;
+        end else if (flush) begin
+            ren_weight_bank_d1 <= 0;
         end else if (ren_weight_bank) begin
             ren_weight_bank_d1 <= 1;
         end else begin
@@ -185,6 +226,8 @@ endgenerate
     always_ff @(posedge clk, negedge rst_n) begin
         if(!rst_n) begin
             class_summation <= '0;
+        end else if (flush) begin
+            class_summation <= '0;
         end else if (ren_weight_bank_d1) begin
             class_summation <= class_summation + weight_data;
         end else if (one_class_done) begin
@@ -24,23 +24,31 @@
 // 
 // Desc: The controller for Tsetlin Machine accelerator.
 //
+//       A silent window (vad_silence) takes one cycle in the silence state:
+//       argmax loads the VAD class and Inf_Done is raised, with no decoding.
+//       One that arrives during an inference is reported after it.
+//
 //==============================================================================
 
 module tma_controller(
     input logic             clk,
     input logic             rst_n,
     input logic             fe_complete,
+    input logic             vad_silence,
     input logic             decoder_finish,
     input logic             argmax_done,
+    input logic             early_exit,
     
     output logic            decode_en,
     output logic            tail_flush_en,
+    output logic            vad_result_en,
     output logic            inf_done
 );
 
-    typedef enum logic [1:0] {idle, inference, wait_finish} state_t;
+    typedef enum logic [1:0] {idle, inference, wait_finish, silence} state_t;
 
     state_t p_state, n_state;
+    logic   vad_pending;
     
     always_ff @(posedge clk, negedge rst_n) begin
         if (!rst_n)
@@ -49,12 +57,25 @@ module tma_controller(
             p_state <= n_state;
     end
     
+    // A silent window during an inference waits for it to finish.
+    always_ff @(posedge clk, negedge rst_n) begin
+        if (!rst_n)
+            vad_pending <= 0;
+        else if (p_state == silence)
+            vad_pending <= 0;
+        else if (vad_silence)
+            vad_pending <= 1;
+    end
+    
     always_comb begin
         n_state = p_state;
         unique case (p_state)
-            idle        :   if (fe_complete == 1)       n_state = inference;
-            inference   :   if (decoder_finish == 1)    n_state = wait_finish;
+            idle        :   if      (fe_complete == 1)                      n_state = inference;
+                            else if (vad_silence == 1 || vad_pending == 1)  n_state = silence;
+            inference   :   if      (early_exit == 1)       n_state = idle;
+                            else if (decoder_finish == 1)   n_state = wait_finish;
             wait_finish :   if (argmax_done == 1)       n_state = idle;
+            silence     :                               n_state = idle;
             default:                                    n_state = idle;
         endcase
     end
@@ -62,14 +83,19 @@ module tma_controller(
     always_comb begin
         decode_en       = 0;
         tail_flush_en   = 0;
+        vad_result_en   = 0;
         inf_done        = 0;
         unique case (p_state)
-            idle        : ;
-            inference   : decode_en     = 1;
+            idle        : if (fe_complete == 0 && (vad_silence == 1 || vad_pending == 1)) vad_result_en = 1;
+            inference   : begin
+                            decode_en     = 1;
+                            if (early_exit == 1) inf_done = 1;
+                          end
             wait_finish : begin 
                             tail_flush_en = 1;
                             if (argmax_done == 1) inf_done = 1;
                           end
+            silence     : inf_done = 1;
             default     : ;
         endcase
     end
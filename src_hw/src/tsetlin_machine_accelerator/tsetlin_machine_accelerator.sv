@@ -24,6 +24,38 @@
 // 
 // Desc: Tsetlin Machine accelerator top module.
 //
+//       With SPI_EN_EARLY_EXIT set, argmax ends the inference as soon as no
+//       remaining class can overtake the leader. The decoder, distributor
+//       and summation are then flushed: early_exit clears them to their
+//       reset values on the next clock edge, the state they return to after
+//       a full inference. The flush is synchronous, and rst_n stays the only
+//       asynchronous reset.
+//
+//       SPI_CLASS_SKIP removes classes from the inference: the decoder jumps
+//       over their blocks, the summation over their weights and argmax only
+//       compares the remaining classes. Skipping every class skips none.
+//
+//       A window the feature extractor finds silent (vad_silence) is not
+//       inferred: decode_en stays low, so the decoder, distributor, PE array
+//       and summation stay idle, and Inf_Done reports SPI_VAD_CLASS.
+//
+//       Every Inf_Done also writes the result, the top-2 margin and the
+//       class scores to result_fifo, which SPI reads a word at a time.
+//
+//       perf_counter counts the cycles of every inference (decoding, PE
+//       column busy/wait/idle, summation) and how long its window waited
+//       after fe_window_done, and keeps them from one Inf_Done to the next
+//       for SPI.
+//
+//       SPI reads (SPI_REN, SPI_RSEL, SPI_RADDR) return SPI_RDATA from
+//       spi_readback, which also reads the banks back, computes their CRCs
+//       and holds the status word. Its bank reads share the read ports of
+//       the decoder and the summation, and only take them while tma_busy is
+//       low.
+//
+//       With SPI_EN_KWD set, keyword_decision post-processes the results and
+//       Inf_Done only rises for a confirmed keyword, which Result then holds.
+//
 //==============================================================================
 
 module tsetlin_machine_accelerator #(
@@ -35,25 +67,37 @@ module tsetlin_machine_accelerator #(
     parameter DEPTH_BLOCK_BANK          = 2048,
     parameter DEPTH_ROW_BANK            = 2048,
     parameter DEPTH_CCL_BANK            = 4096,
-    parameter DEPTH_WEIGHT_BANK         = 2048
+    parameter DEPTH_WEIGHT_BANK         = 2048,
+    parameter N_CCL_WORD                = 1,
+    parameter DEPTH_BLOCK_FIFO          = 4
     
 )(
     input logic                                     clk,
     input logic                                     rst_n,
     
     // feature bank signals ---------------------------------------------------
+    input logic                                     fe_window_done,
     input logic                                     fe_complete,
+    input logic                                     vad_silence,
     input logic [N_FRAME-1:0]                       feature_bank_rdata,
     output logic                                    feature_bank_ren,
     output logic [$clog2(2*N_MEL)-1:0]              feature_rptr,
+    output logic                                    tma_busy,
     
     // spi_slave signals ------------------------------------------------------
     input logic                                     SPI_WEN_BLOCK_BANK,
+    input logic                                     SPI_WEN_CLASS_BANK,
     input logic                                     SPI_WEN_ROW_BANK        [N_PE_COL],
     input logic                                     SPI_WEN_CCL_BANK        [N_PE_COL],
     input logic                                     SPI_WEN_WEIGHT_BANK,
+    input logic                                     SPI_WEN_BOUND_BANK,
+    input logic                                     SPI_WEN_CONF_REG,
+    input logic                                     SPI_REN,
+    input logic [5:0]                               SPI_RSEL,
     input logic [11:0]                              SPI_ADDR,
+    input logic [11:0]                              SPI_RADDR,
     input logic [31:0]                              SPI_DATA,
+    output logic [31:0]                             SPI_RDATA,
     
     // spi_slave Configuration registers --------------------------------------
     input logic [3:0]                               SPI_NUM_CLASS,
@@ -63,6 +107,13 @@ module tsetlin_machine_accelerator #(
     input logic [$clog2(DEPTH_ROW_BANK)-1:0]        SPI_LEN_ROW_BANK        [N_PE_COL],
     input logic [$clog2(DEPTH_CCL_BANK)-1:0]        SPI_LEN_CCL_BANK        [N_PE_COL],
     input logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]     SPI_LEN_WEIGHT_BANK,
+    input logic                                     SPI_EN_EARLY_EXIT,
+    input logic [15:0]                              SPI_CLASS_SKIP,
+    input logic [3:0]                               SPI_VAD_CLASS,
+    input logic                                     SPI_EN_KWD,
+    input logic [5:0]                               SPI_KWD_WINDOW,
+    input logic [5:0]                               SPI_KWD_RUN,
+    input logic [5:0]                               SPI_KWD_HOLDOFF,
     
     // result signals ---------------------------------------------------------
     output logic [3:0]                              Result,
@@ -72,30 +123,45 @@ module tsetlin_machine_accelerator #(
     
     // spi_slave sync signals
     logic                                   spi_wen_block_bank_d1, spi_wen_block_bank_d2, spi_wen_block_bank_d3;
+    logic                                   spi_wen_class_bank_d1, spi_wen_class_bank_d2, spi_wen_class_bank_d3;
     logic [ N_PE_COL-1:0]                   spi_wen_row_bank_d1, spi_wen_row_bank_d2, spi_wen_row_bank_d3;
     logic [ N_PE_COL-1:0]                   spi_wen_ccl_bank_d1, spi_wen_ccl_bank_d2, spi_wen_ccl_bank_d3;
     logic                                   spi_wen_weight_bank_d1, spi_wen_weight_bank_d2, spi_wen_weight_bank_d3;
+    logic                                   spi_wen_bound_bank_d1, spi_wen_bound_bank_d2, spi_wen_bound_bank_d3;
+    logic                                   spi_wen_conf_reg_d1, spi_wen_conf_reg_d2, spi_wen_conf_reg_d3;
+    logic                                   spi_ren_d1, spi_ren_d2, spi_ren_d3;
     
     logic                                   spi_wen_block_bank_sync;
+    logic                                   spi_wen_class_bank_sync;
     logic [ N_PE_COL-1:0]                   spi_wen_row_bank_sync;
     logic [ N_PE_COL-1:0]                   spi_wen_ccl_bank_sync;
     logic                                   spi_wen_weight_bank_sync;
+    logic                                   spi_wen_bound_bank_sync;
+    logic                                   spi_wen_conf_reg_sync;
+    logic                                   spi_ren_sync;
+    logic                                   spi_ren_result_fifo_sync;
+    logic                                   spi_ren_perf_cnt_sync;
     
     // tma controller signals
     logic                                   argmax_done;
+    logic                                   early_exit;
+    logic                                   vad_result_en;
     logic                                   decode_en;
     logic                                   tail_flush_en;
+    logic [15:0]                            class_en;
+    logic                                   inf_done;
     
     // ogbcsr decoder signals 
     logic                                   decoder_finish;
+    logic                                   class_skip_last;
     logic [N_ELEMENT*N_PE_COL-1:0]          block_idx_data;
     logic [$clog2(DEPTH_BLOCK_BANK)-1:0]    raddr_block_idx_bank;
     logic                                   ren_block_idx_bank;
     logic [5:0]                             row_cnt_data                [N_PE_COL];
     logic [$clog2(DEPTH_ROW_BANK)-1:0]      raddr_row_cnt_bank          [N_PE_COL];
     logic [N_PE_COL-1:0]                    ren_row_cnt_bank;
-    logic [4:0]                             col_clause_idx_data         [N_PE_COL];
-    logic [$clog2(DEPTH_CCL_BANK)-1:0]      raddr_col_clause_idx_bank   [N_PE_COL];
+    logic [5*N_CCL_WORD-1:0]                col_clause_idx_data         [N_PE_COL];
+    logic [$clog2(DEPTH_CCL_BANK/N_CCL_WORD)-1:0] raddr_col_clause_idx_bank [N_PE_COL];
     logic [N_PE_COL-1:0]                    ren_col_clause_idx_bank;
     logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   raddr_weight_bank;
     logic                                   ren_weight_bank;
@@ -105,23 +171,26 @@ module tsetlin_machine_accelerator #(
     logic [N_PE_COL-1:0]                    block_stage_valid;
     logic                                   row_stage_ready;
     logic                                   row_stage_valid             [N_PE_COL];
-    logic                                   row_spad_index              [N_PE_COL];
+    logic [N_CCL_WORD-1:0]                  row_spad_index              [N_PE_COL];
     logic                                   col_clause_stage_valid      [N_PE_COL];
+    logic [N_CCL_WORD-1:0]                  col_clause_lane_valid       [N_PE_COL];
     logic                                   col_clause_stage_ready      [N_PE_COL];
     logic [1:0]                             code_ccl_stage              [N_PE_COL];
-    logic [4:0]                             col_clause_index            [N_PE_COL];
+    logic [$clog2(DEPTH_BLOCK_FIFO)-1:0]    fifo_slot_ccl_stage         [N_PE_COL];
+    logic [4:0]                             col_clause_index            [N_PE_COL][N_CCL_WORD];
     logic [$clog2(DEPTH_CCL_BANK)-1:0]      raddr_col_clause_idx_bank_int[N_PE_COL];
     
     // PE array singals
     logic [1:0]                             code_pe_stage               [N_PE_COL];
-    logic                                   pe_ena                      [N_PE_COL];
+    logic [N_CCL_WORD-1:0]                  pe_ena                      [N_PE_COL];
     logic [2*N_ELEMENT-1:0]                 next_clause_flag            [N_PE_COL];
-    logic                                   clause_index                [N_PE_COL];
-    logic                                   inv_en                      [N_PE_COL];
-    logic [NUMBER_OF_PATCH-1:0]             literal_data                [N_PE_COL];
+    logic [N_CCL_WORD-1:0]                  clause_index                [N_PE_COL];
+    logic [N_CCL_WORD-1:0]                  inv_en                      [N_PE_COL];
+    logic [NUMBER_OF_PATCH-1:0]             literal_data                [N_PE_COL][N_CCL_WORD];
     
     // summation singals
     logic                                   summation_ena;
+    logic                                   summation_busy;
     logic                                   patch0_result               [N_ELEMENT*N_PE_COL];
     logic                                   patch1_result               [N_ELEMENT*N_PE_COL];
     
@@ -129,11 +198,55 @@ module tsetlin_machine_accelerator #(
     logic                                   argmax_ena;
     logic signed [13:0]                     class_summation;
     logic [3:0]                             class_idx;
+    logic signed [13:0]                     class_score                 [16];
+    logic [13:0]                            score_margin;
+    logic [3:0]                             argmax_result;
+    
+    // keyword decision signals
+    logic [3:0]                             kwd_result;
+    logic                                   kwd_done;
+    
+    // SPI readback signals
+    logic [31:0]                            result_fifo_rdata;
+    logic [2:0]                             result_cnt;
+    logic [31:0]                            perf_cnt_rdata;
+    logic                                   spi_wen_sync;
+    logic [$clog2(DEPTH_BLOCK_BANK)-1:0]    rb_raddr_block_idx_bank;
+    logic                                   rb_ren_block_idx_bank;
+    logic [$clog2(DEPTH_ROW_BANK)-1:0]      rb_raddr_row_cnt_bank;
+    logic [N_PE_COL-1:0]                    rb_ren_row_cnt_bank;
+    logic [$clog2(DEPTH_CCL_BANK/N_CCL_WORD)-1:0] rb_raddr_col_clause_idx_bank;
+    logic [N_PE_COL-1:0]                    rb_ren_col_clause_idx_bank;
+    logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   rb_raddr_weight_bank;
+    logic                                   rb_ren_weight_bank;
+    
+    // bank read ports, decoder/summation or spi_readback
+    logic [$clog2(DEPTH_BLOCK_BANK)-1:0]    mem_raddr_block_idx_bank;
+    logic                                   mem_ren_block_idx_bank;
+    logic [$clog2(DEPTH_ROW_BANK)-1:0]      mem_raddr_row_cnt_bank      [N_PE_COL];
+    logic [N_PE_COL-1:0]                    mem_ren_row_cnt_bank;
+    logic [$clog2(DEPTH_CCL_BANK/N_CCL_WORD)-1:0] mem_raddr_col_clause_idx_bank [N_PE_COL];
+    logic [N_PE_COL-1:0]                    mem_ren_col_clause_idx_bank;
+    logic [$clog2(DEPTH_WEIGHT_BANK)-1:0]   mem_raddr_weight_bank;
+    logic                                   mem_ren_weight_bank;
     
     
     // sync process
     assign spi_wen_block_bank_sync      = ~spi_wen_block_bank_d3 & spi_wen_block_bank_d2;
+    assign spi_wen_class_bank_sync      = ~spi_wen_class_bank_d3 & spi_wen_class_bank_d2;
     assign spi_wen_weight_bank_sync     = ~spi_wen_weight_bank_d3 & spi_wen_weight_bank_d2;
+    assign spi_wen_bound_bank_sync      = ~spi_wen_bound_bank_d3 & spi_wen_bound_bank_d2;
+    assign spi_wen_conf_reg_sync        = ~spi_wen_conf_reg_d3 & spi_wen_conf_reg_d2;
+    assign spi_ren_sync                 = ~spi_ren_d3 & spi_ren_d2;
+    
+    // SPI_RSEL holds {cmd, bank_sel} of the read burst
+    assign spi_ren_result_fifo_sync     = spi_ren_sync && SPI_RSEL[5:3] == 3'b110;
+    assign spi_ren_perf_cnt_sync        = spi_ren_sync && SPI_RSEL == 6'b111_000;
+    
+    // any write the bank CRCs depend on
+    assign spi_wen_sync                 = spi_wen_block_bank_sync || (|spi_wen_row_bank_sync) ||
+                                          (|spi_wen_ccl_bank_sync) || spi_wen_weight_bank_sync ||
+                                          spi_wen_conf_reg_sync;
     
     always_comb begin
         for (int i = 0; i < N_PE_COL; i++) begin
@@ -147,16 +260,40 @@ module tsetlin_machine_accelerator #(
             spi_wen_block_bank_d1  <= 0;
             spi_wen_block_bank_d2  <= 0;
             spi_wen_block_bank_d3  <= 0;
+            spi_wen_class_bank_d1  <= 0;
+            spi_wen_class_bank_d2  <= 0;
+            spi_wen_class_bank_d3  <= 0;
             spi_wen_weight_bank_d1 <= 0;
             spi_wen_weight_bank_d2 <= 0;
             spi_wen_weight_bank_d3 <= 0;
+            spi_wen_bound_bank_d1  <= 0;
+            spi_wen_bound_bank_d2  <= 0;
+            spi_wen_bound_bank_d3  <= 0;
+            spi_wen_conf_reg_d1    <= 0;
+            spi_wen_conf_reg_d2    <= 0;
+            spi_wen_conf_reg_d3    <= 0;
+            spi_ren_d1             <= 0;
+            spi_ren_d2             <= 0;
+            spi_ren_d3             <= 0;
         end else begin
             spi_wen_block_bank_d1  <= SPI_WEN_BLOCK_BANK;
             spi_wen_block_bank_d2  <= spi_wen_block_bank_d1;
             spi_wen_block_bank_d3  <= spi_wen_block_bank_d2;
+            spi_wen_class_bank_d1  <= SPI_WEN_CLASS_BANK;
+            spi_wen_class_bank_d2  <= spi_wen_class_bank_d1;
+            spi_wen_class_bank_d3  <= spi_wen_class_bank_d2;
             spi_wen_weight_bank_d1 <= SPI_WEN_WEIGHT_BANK;
             spi_wen_weight_bank_d2 <= spi_wen_weight_bank_d1;
             spi_wen_weight_bank_d3 <= spi_wen_weight_bank_d2;
+            spi_wen_bound_bank_d1  <= SPI_WEN_BOUND_BANK;
+            spi_wen_bound_bank_d2  <= spi_wen_bound_bank_d1;
+            spi_wen_bound_bank_d3  <= spi_wen_bound_bank_d2;
+            spi_wen_conf_reg_d1    <= SPI_WEN_CONF_REG;
+            spi_wen_conf_reg_d2    <= spi_wen_conf_reg_d1;
+            spi_wen_conf_reg_d3    <= spi_wen_conf_reg_d2;
+            spi_ren_d1             <= SPI_REN;
+            spi_ren_d2             <= spi_ren_d1;
+            spi_ren_d3             <= spi_ren_d2;
         end
     end
     
@@ -182,28 +319,61 @@ module tsetlin_machine_accelerator #(
         end
     end
     
+    // enabled classes, all of them if SPI_CLASS_SKIP would leave none
+    assign class_en = (&(SPI_CLASS_SKIP | ~((16'd1 << SPI_NUM_CLASS) - 1'b1)))? '1 : ~SPI_CLASS_SKIP;
+    
     tma_controller tma_controller_inst(
         .clk                            (clk                            ),
         .rst_n                          (rst_n                          ),
         .fe_complete                    (fe_complete                    ),
+        .vad_silence                    (vad_silence                    ),
         .decoder_finish                 (decoder_finish                 ),
         .argmax_done                    (argmax_done                    ),
+        .early_exit                     (early_exit                     ),
         
         .decode_en                      (decode_en                      ),
         .tail_flush_en                  (tail_flush_en                  ),
-        .inf_done                       (Inf_Done                       )
+        .vad_result_en                  (vad_result_en                  ),
+        .inf_done                       (inf_done                       )
     );
+    
+    assign tma_busy = decode_en || tail_flush_en;
+    
+    // spi_readback only reads the banks while tma_busy is low
+    assign mem_raddr_block_idx_bank     = rb_ren_block_idx_bank? rb_raddr_block_idx_bank : raddr_block_idx_bank;
+    assign mem_ren_block_idx_bank       = ren_block_idx_bank || rb_ren_block_idx_bank;
+    assign mem_raddr_weight_bank        = rb_ren_weight_bank? rb_raddr_weight_bank : raddr_weight_bank;
+    assign mem_ren_weight_bank          = ren_weight_bank || rb_ren_weight_bank;
+    assign mem_ren_row_cnt_bank         = ren_row_cnt_bank | rb_ren_row_cnt_bank;
+    assign mem_ren_col_clause_idx_bank  = ren_col_clause_idx_bank | rb_ren_col_clause_idx_bank;
+    
+    always_comb begin
+        for (int i = 0; i < N_PE_COL; i++) begin
+            mem_raddr_row_cnt_bank[i]           = rb_ren_row_cnt_bank[i]? rb_raddr_row_cnt_bank : raddr_row_cnt_bank[i];
+            mem_raddr_col_clause_idx_bank[i]    = rb_ren_col_clause_idx_bank[i]? rb_raddr_col_clause_idx_bank : 
+                                                                                 raddr_col_clause_idx_bank[i];
+        end
+    end
 
     ogbcsr_decoder #(
         .DEPTH_BLOCK_BANK               (DEPTH_BLOCK_BANK               ),
         .DEPTH_ROW_BANK                 (DEPTH_ROW_BANK                 ),
         .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK                 ),
-        .N_PE_COL                       (N_PE_COL                       )
+        .N_PE_COL                       (N_PE_COL                       ),
+        .N_CCL_WORD                     (N_CCL_WORD                     ),
+        .DEPTH_BLOCK_FIFO               (DEPTH_BLOCK_FIFO               )
     
     ) ogbcsr_decoder_inst (
         .clk                            (clk                            ),
         .rst_n                          (rst_n                          ),
+        .flush                          (early_exit                     ),
         .decode_en                      (decode_en                      ),
+        .class_en                       (class_en                       ),
+        .spi_wen_class_bank_sync        (spi_wen_class_bank_sync        ),
+        .SPI_ADDR                       (SPI_ADDR                       ),
+        .SPI_DATA                       (SPI_DATA                       ),
+        .SPI_NUM_CLASS                  (SPI_NUM_CLASS                  ),
+        .SPI_NUM_SUM_TIME               (SPI_NUM_SUM_TIME               ),
         .SPI_LEN_BLOCK_BANK             (SPI_LEN_BLOCK_BANK             ),
         .SPI_LEN_ROW_BANK               (SPI_LEN_ROW_BANK               ),
         .SPI_LEN_CCL_BANK               (SPI_LEN_CCL_BANK               ),
@@ -219,6 +389,7 @@ module tsetlin_machine_accelerator #(
         .ren_col_clause_idx_bank        (ren_col_clause_idx_bank        ),
                                                                         
         .decoder_finish                 (decoder_finish                 ),
+        .class_skip_last                (class_skip_last                ),
         .block_stage_ready              (block_stage_ready              ),
         .block_stage_valid              (block_stage_valid              ),
         .row_stage_ready                (row_stage_ready                ),
@@ -226,7 +397,9 @@ module tsetlin_machine_accelerator #(
         .row_spad_index                 (row_spad_index                 ),
         .col_clause_stage_ready         (col_clause_stage_ready         ),
         .col_clause_stage_valid         (col_clause_stage_valid         ),
+        .col_clause_lane_valid          (col_clause_lane_valid          ),
         .code_ccl_stage                 (code_ccl_stage                 ),
+        .fifo_slot_ccl_stage            (fifo_slot_ccl_stage            ),
         .col_clause_index               (col_clause_index               ),
         .raddr_col_clause_idx_bank_int  (raddr_col_clause_idx_bank_int  )
     );
@@ -237,8 +410,8 @@ module tsetlin_machine_accelerator #(
         
     ) mem_block_idx_bank_inst (
         .clk                            (clk                            ),
-        .raddr_block_idx_bank           (raddr_block_idx_bank           ),
-        .ren_block_idx_bank             (ren_block_idx_bank             ),
+        .raddr_block_idx_bank           (mem_raddr_block_idx_bank       ),
+        .ren_block_idx_bank             (mem_ren_block_idx_bank         ),
         .spi_wen_block_bank_sync        (spi_wen_block_bank_sync        ),
         .SPI_ADDR                       (SPI_ADDR                       ),
         .SPI_DATA                       (SPI_DATA                       ),
@@ -252,8 +425,8 @@ module tsetlin_machine_accelerator #(
         
     ) mem_row_cnt_bank_inst (
         .clk                            (clk                            ),
-        .raddr_row_cnt_bank             (raddr_row_cnt_bank             ),
-        .ren_row_cnt_bank               (ren_row_cnt_bank               ),
+        .raddr_row_cnt_bank             (mem_raddr_row_cnt_bank         ),
+        .ren_row_cnt_bank               (mem_ren_row_cnt_bank           ),
         .spi_wen_row_bank_sync          (spi_wen_row_bank_sync          ),
         .SPI_ADDR                       (SPI_ADDR                       ),
         .SPI_DATA                       (SPI_DATA                       ),
@@ -263,12 +436,13 @@ module tsetlin_machine_accelerator #(
 
     mem_col_clause_idx_bank #(
         .N_PE_COL                       (N_PE_COL                       ),
-        .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK                 )
+        .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK                 ),
+        .N_CCL_WORD                     (N_CCL_WORD                     )
         
     ) mem_col_clause_idx_bank_inst (
         .clk                            (clk                            ),
-        .raddr_col_clause_idx_bank      (raddr_col_clause_idx_bank      ),
-        .ren_col_clause_idx_bank        (ren_col_clause_idx_bank        ),
+        .raddr_col_clause_idx_bank      (mem_raddr_col_clause_idx_bank  ),
+        .ren_col_clause_idx_bank        (mem_ren_col_clause_idx_bank    ),
         .spi_wen_ccl_bank_sync          (spi_wen_ccl_bank_sync          ),
         .SPI_ADDR                       (SPI_ADDR                       ),
         .SPI_DATA                       (SPI_DATA                       ),
@@ -281,8 +455,8 @@ module tsetlin_machine_accelerator #(
         
     ) mem_weight_bank_inst(
         .clk                            (clk                            ),
-        .raddr_weight_bank              (raddr_weight_bank              ),
-        .ren_weight_bank                (ren_weight_bank                ),
+        .raddr_weight_bank              (mem_raddr_weight_bank          ),
+        .ren_weight_bank                (mem_ren_weight_bank            ),
         .spi_wen_weight_bank_sync       (spi_wen_weight_bank_sync       ),
         .SPI_ADDR                       (SPI_ADDR                       ),
         .SPI_DATA                       (SPI_DATA                       ),
@@ -297,22 +471,27 @@ module tsetlin_machine_accelerator #(
         .N_PE_COL                       (N_PE_COL                       ),
         .N_ELEMENT                      (N_ELEMENT                      ),
         .DEPTH_BLOCK_BANK               (DEPTH_BLOCK_BANK               ),
-        .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK                 )
+        .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK                 ),
+        .N_CCL_WORD                     (N_CCL_WORD                     ),
+        .DEPTH_BLOCK_FIFO               (DEPTH_BLOCK_FIFO               )
         
     ) distributor_inst (
         .clk                            (clk                            ),
         .rst_n                          (rst_n                          ),
+        .flush                          (early_exit                     ),
         .decode_en                      (decode_en                      ),
-        .raddr_block_idx_bank           (raddr_block_idx_bank           ),
+        .class_skip_last                (class_skip_last                ),
         .block_stage_ready              (block_stage_ready              ),
         .block_stage_valid              (block_stage_valid              ),
         .row_stage_ready                (row_stage_ready                ),
         .row_stage_valid                (row_stage_valid                ),
         .row_spad_index                 (row_spad_index                 ),
         .col_clause_stage_valid         (col_clause_stage_valid         ),
+        .col_clause_lane_valid          (col_clause_lane_valid          ),
         .col_clause_stage_ready         (col_clause_stage_ready         ),
         .col_clause_index               (col_clause_index               ),
         .code_ccl_stage                 (code_ccl_stage                 ),
+        .fifo_slot_ccl_stage            (fifo_slot_ccl_stage            ),
         .raddr_col_clause_idx_bank_int  (raddr_col_clause_idx_bank_int  ),
         
         .feature_bank_rdata             (feature_bank_rdata             ),
@@ -332,7 +511,8 @@ module tsetlin_machine_accelerator #(
         .N_FRAME                        (N_FRAME                        ),
         .NUMBER_OF_PATCH                (NUMBER_OF_PATCH                ),
         .N_PE_COL                       (N_PE_COL                       ),
-        .N_ELEMENT                      (N_ELEMENT                      )
+        .N_ELEMENT                      (N_ELEMENT                      ),
+        .N_CCL_WORD                     (N_CCL_WORD                     )
         
     ) pe_array_inst (
         .clk                            (clk                            ),
@@ -356,8 +536,10 @@ module tsetlin_machine_accelerator #(
     ) summation_inst (
         .clk                            (clk                            ),
         .rst_n                          (rst_n                          ),
+        .flush                          (early_exit                     ),
         .decode_en                      (decode_en                      ),
         .tail_flush_en                  (tail_flush_en                  ),
+        .class_en                       (class_en                       ),
         .summation_ena                  (summation_ena                  ),
         .patch0_result                  (patch0_result                  ),
         .patch1_result                  (patch1_result                  ),
@@ -370,7 +552,8 @@ module tsetlin_machine_accelerator #(
         .raddr_weight_bank              (raddr_weight_bank              ),
         .argmax_ena                     (argmax_ena                     ),
         .class_summation                (class_summation                ),
-        .class_idx                      (class_idx                      )
+        .class_idx                      (class_idx                      ),
+        .summation_busy                 (summation_busy                 )
     );
     
     argmax argmax_inst (
@@ -379,10 +562,115 @@ module tsetlin_machine_accelerator #(
         .argmax_ena                     (argmax_ena                     ),
         .class_summation                (class_summation                ),
         .class_idx                      (class_idx                      ),
+        .class_en                       (class_en                       ),
+        .spi_wen_bound_bank_sync        (spi_wen_bound_bank_sync        ),
+        .SPI_ADDR                       (SPI_ADDR                       ),
+        .SPI_DATA                       (SPI_DATA                       ),
         .SPI_NUM_CLASS                  (SPI_NUM_CLASS                  ),
+        .SPI_EN_EARLY_EXIT              (SPI_EN_EARLY_EXIT              ),
+        .vad_result_en                  (vad_result_en                  ),
+        .SPI_VAD_CLASS                  (SPI_VAD_CLASS                  ),
+        
+        .result                         (argmax_result                  ),
+        .argmax_done                    (argmax_done                    ),
+        .early_exit                     (early_exit                     ),
+        .class_score                    (class_score                    ),
+        .score_margin                   (score_margin                   )
+    );
+    
+    result_fifo result_fifo_inst (
+        .clk                            (clk                            ),
+        .rst_n                          (rst_n                          ),
+        .Inf_Done                       (inf_done                       ),
+        .result                         (argmax_result                  ),
+        .score_margin                   (score_margin                   ),
+        .class_score                    (class_score                    ),
+        .spi_ren_result_sync            (spi_ren_result_fifo_sync       ),
+        .SPI_NUM_CLASS                  (SPI_NUM_CLASS                  ),
+        
+        .result_fifo_rdata              (result_fifo_rdata              ),
+        .result_cnt                     (result_cnt                     )
+    );
+    
+    perf_counter #(
+        .N_PE_COL                       (N_PE_COL                       ),
+        .N_CCL_WORD                     (N_CCL_WORD                     )
+        
+    ) perf_counter_inst (
+        .clk                            (clk                            ),
+        .rst_n                          (rst_n                          ),
+        .fe_window_done                 (fe_window_done                 ),
+        .fe_complete                    (fe_complete                    ),
+        .decode_en                      (decode_en                      ),
+        .tail_flush_en                  (tail_flush_en                  ),
+        .inf_done                       (inf_done                       ),
+        .pe_ena                         (pe_ena                         ),
+        .summation_busy                 (summation_busy                 ),
+        .spi_ren_perf_sync              (spi_ren_perf_cnt_sync          ),
+        .SPI_RADDR                      (SPI_RADDR                      ),
+        
+        .perf_cnt_rdata                 (perf_cnt_rdata                 )
+    );
+    
+    keyword_decision keyword_decision_inst (
+        .clk                            (clk                            ),
+        .rst_n                          (rst_n                          ),
+        .inf_done                       (inf_done                       ),
+        .result                         (argmax_result                  ),
+        .SPI_EN_KWD                     (SPI_EN_KWD                     ),
+        .SPI_KWD_WINDOW                 (SPI_KWD_WINDOW                 ),
+        .SPI_KWD_RUN                    (SPI_KWD_RUN                    ),
+        .SPI_KWD_HOLDOFF                (SPI_KWD_HOLDOFF                ),
+        .SPI_VAD_CLASS                  (SPI_VAD_CLASS                  ),
+        
+        .kwd_result                     (kwd_result                     ),
+        .kwd_done                       (kwd_done                       )
+    );
+    
+    assign Result   = SPI_EN_KWD? kwd_result : argmax_result;
+    assign Inf_Done = SPI_EN_KWD? kwd_done : inf_done;
+    
+    spi_readback #(
+        .N_PE_COL                       (N_PE_COL                       ),
+        .N_PE_CLUSTER                   (N_ELEMENT*N_PE_COL             ),
+        .DEPTH_BLOCK_BANK               (DEPTH_BLOCK_BANK               ),
+        .DEPTH_ROW_BANK                 (DEPTH_ROW_BANK                 ),
+        .DEPTH_CCL_BANK                 (DEPTH_CCL_BANK                 ),
+        .DEPTH_WEIGHT_BANK              (DEPTH_WEIGHT_BANK              ),
+        .N_CCL_WORD                     (N_CCL_WORD                     )
+        
+    ) spi_readback_inst (
+        .clk                            (clk                            ),
+        .rst_n                          (rst_n                          ),
+        .tma_busy                       (tma_busy                       ),
+        .Inf_Done                       (Inf_Done                       ),
+        .Result                         (Result                         ),
+        .argmax_result                  (argmax_result                  ),
+        .result_cnt                     (result_cnt                     ),
+        .block_idx_data                 (block_idx_data                 ),
+        .row_cnt_data                   (row_cnt_data                   ),
+        .col_clause_idx_data            (col_clause_idx_data            ),
+        .weight_data                    (weight_data                    ),
+        .rb_raddr_block_idx_bank        (rb_raddr_block_idx_bank        ),
+        .rb_ren_block_idx_bank          (rb_ren_block_idx_bank          ),
+        .rb_raddr_row_cnt_bank          (rb_raddr_row_cnt_bank          ),
+        .rb_ren_row_cnt_bank            (rb_ren_row_cnt_bank            ),
+        .rb_raddr_col_clause_idx_bank   (rb_raddr_col_clause_idx_bank   ),
+        .rb_ren_col_clause_idx_bank     (rb_ren_col_clause_idx_bank     ),
+        .rb_raddr_weight_bank           (rb_raddr_weight_bank           ),
+        .rb_ren_weight_bank             (rb_ren_weight_bank             ),
+        .spi_wen_sync                   (spi_wen_sync                   ),
+        .spi_ren_sync                   (spi_ren_sync                   ),
+        .SPI_RSEL                       (SPI_RSEL                       ),
+        .SPI_RADDR                      (SPI_RADDR                      ),
+        .result_fifo_rdata              (result_fifo_rdata              ),
+        .perf_cnt_rdata                 (perf_cnt_rdata                 ),
+        .SPI_LEN_BLOCK_BANK             (SPI_LEN_BLOCK_BANK             ),
+        .SPI_LEN_ROW_BANK               (SPI_LEN_ROW_BANK               ),
+        .SPI_LEN_CCL_BANK               (SPI_LEN_CCL_BANK               ),
+        .SPI_LEN_WEIGHT_BANK            (SPI_LEN_WEIGHT_BANK            ),
         
-        .result                         (Result                         ),
-        .argmax_done                    (argmax_done                    )
+        .spi_rdata                      (SPI_RDATA                      )
     );
     
 
@@ -38,6 +38,8 @@ module wrap_TsetlinKWS #(
     parameter DEPTH_ROW_BANK        = 2048,
     parameter DEPTH_CCL_BANK        = 4096,
     parameter DEPTH_WEIGHT_BANK     = 2048,
+    parameter N_CCL_WORD            = 1,
+    parameter DEPTH_BLOCK_FIFO      = 4,
     
     parameter I2S_DATA_WIDTH        = 24,
     parameter Input_INT_BIT_WIDTH   = 12,
@@ -76,6 +78,7 @@ module wrap_TsetlinKWS #(
     input wire                         SCK,
     input wire                         CS,
     input wire                         MOSI,
+    output wire                        MISO,
     
     output wire [3:0]                  Result,
     output wire                        Inf_Done
@@ -113,6 +116,8 @@ module wrap_TsetlinKWS #(
         .DEPTH_ROW_BANK             (DEPTH_ROW_BANK             ),
         .DEPTH_CCL_BANK             (DEPTH_CCL_BANK             ),
         .DEPTH_WEIGHT_BANK          (DEPTH_WEIGHT_BANK          ),
+        .N_CCL_WORD                 (N_CCL_WORD                 ),
+        .DEPTH_BLOCK_FIFO           (DEPTH_BLOCK_FIFO           ),
         
         .I2S_DATA_WIDTH             (I2S_DATA_WIDTH             ),
         .Input_INT_BIT_WIDTH        (Input_INT_BIT_WIDTH        ),
@@ -152,6 +157,7 @@ module wrap_TsetlinKWS #(
         .SCK                        (SCK                        ),
         .CS                         (CS                         ),
         .MOSI                       (MOSI                       ),
+        .MISO                       (MISO                       ),
 
         .Result                     (Result                     ),
         .Inf_Done                   (Inf_Done                   )
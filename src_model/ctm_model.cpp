@@ -0,0 +1,240 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "ctm_model.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: The OG-BCSR banks are decoded once into per-clause literal lists.
+//       Each inference then builds a literal table (58-patch word of every
+//       row/column/inverse literal) for CTM_LANES windows and ANDs the
+//       table rows of each clause lane-parallel with AVX-512/AVX2.
+//
+//==============================================================================
+
+#include "ctm_model.h"
+
+#include <stdexcept>
+
+#include "ogbcsr.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace tkws {
+
+namespace {
+
+// One row of the literal table: the same literal for every lane.
+struct alignas(64) LiteralRow {
+    uint64_t lane[CTM_LANES];
+};
+
+// Position literal of a feature row, {WIN 57, ..., WIN 0}. The distributor
+// starts from 58'h3FF_FFFF_FFFF_FFFE / 58'h3FF_FFFF_FFFF_FFFC and shifts
+// left by 2 per block, i.e. bit p is set when p > row.
+inline uint64_t position_literal(int row)
+{
+    return (row + 1 >= NUMBER_OF_PATCH) ? 0 : (PATCH_MASK << (row + 1)) & PATCH_MASK;
+}
+
+void build_literal_table(LiteralRow *table, const FeatureWindow *const *window, int n_lane)
+{
+    for (int l = 0; l < CTM_LANES; l++) {
+        const FeatureWindow *w = window[l < n_lane ? l : 0];
+        for (int r = 0; r < N_ROW; r++) {
+            for (int c = 0; c < N_LITERAL_COL; c++) {
+                uint64_t lit = (c == 0) ? position_literal(r) : ((*w)[r] >> (c - 1)) & PATCH_MASK;
+                int idx = (r * N_LITERAL_COL + c) << 1;
+                table[idx    ].lane[l] = lit;
+                table[idx + 1].lane[l] = ~lit & PATCH_MASK;
+            }
+        }
+    }
+}
+
+// AND the table rows of one clause, return the per-lane "any patch
+// satisfied" mask (the 58b-OR tree of pe_col).
+inline uint32_t clause_kernel(const LiteralRow *table, const uint16_t *lit, uint32_t n)
+{
+#if defined(__AVX512F__)
+    __m512i acc = _mm512_set1_epi64(-1);
+    for (uint32_t k = 0; k < n; k++) {
+        acc = _mm512_and_si512(acc, _mm512_load_si512((const void *)table[lit[k]].lane));
+        if ((k & 3) == 3 && _mm512_test_epi64_mask(acc, acc) == 0)
+            return 0;
+    }
+    return _mm512_test_epi64_mask(acc, acc);
+#elif defined(__AVX2__)
+    __m256i acc = _mm256_set1_epi64x(-1);
+    for (uint32_t k = 0; k < n; k++) {
+        acc = _mm256_and_si256(acc, _mm256_load_si256((const __m256i *)table[lit[k]].lane));
+        if ((k & 3) == 3 && _mm256_testz_si256(acc, acc))
+            return 0;
+    }
+    __m256i zero = _mm256_cmpeq_epi64(acc, _mm256_setzero_si256());
+    return ~(uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(zero)) & 0xF;
+#else
+    uint64_t acc[CTM_LANES];
+    for (int l = 0; l < CTM_LANES; l++)
+        acc[l] = ~0ULL;
+    for (uint32_t k = 0; k < n; k++) {
+        for (int l = 0; l < CTM_LANES; l++)
+            acc[l] &= table[lit[k]].lane[l];
+    }
+    uint32_t mask = 0;
+    for (int l = 0; l < CTM_LANES; l++)
+        mask |= (uint32_t)(acc[l] != 0) << l;
+    return mask;
+#endif
+}
+
+// class_summation is a 14-bit signed register.
+inline int16_t wrap14(int32_t v)
+{
+    v &= 0x3FFF;
+    return (int16_t)((v & 0x2000) ? v - 0x4000 : v);
+}
+
+} // namespace
+
+CtmModel::CtmModel(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+
+    num_class_    = (int)conf.num_class;
+    num_sum_time_ = (int)conf.num_sum_time;
+
+    if (num_class_ == 0 || num_sum_time_ == 0)
+        throw std::runtime_error("SPI_NUM_CLASS and SPI_NUM_SUM_TIME must be non-zero");
+    if (conf.len_block_bank % N_BLOCK_PER_ROUND != 0)
+        throw std::runtime_error("SPI_LEN_BLOCK_BANK must be a multiple of 32");
+
+    num_round_ = (int)conf.len_block_bank / N_BLOCK_PER_ROUND;
+    if (num_round_ != num_class_ * num_sum_time_)
+        throw std::runtime_error("SPI_LEN_BLOCK_BANK does not match SPI_NUM_CLASS * SPI_NUM_SUM_TIME");
+    if (conf.len_weight_bank == 0)
+        throw std::runtime_error("SPI_LEN_WEIGHT_BANK must be non-zero");
+
+    decode(image);
+}
+
+void CtmModel::decode(const ModelImage &image)
+{
+    const SlotClauses slot = decode_ogbcsr(image);
+    const int n_clause = (int)slot.literal.size();
+
+    literal_.clear();
+    clause_begin_.assign(n_clause + 1, 0);
+
+    for (int c = 0; c < n_clause; c++) {
+        clause_begin_[c] = (uint32_t)literal_.size();
+        literal_.insert(literal_.end(), slot.literal[c].begin(), slot.literal[c].end());
+    }
+    clause_begin_[n_clause] = (uint32_t)literal_.size();
+    weight_ = slot.weight;
+}
+
+void CtmModel::eval_group(const FeatureWindow *const *window, int n_lane, CtmResult *result) const
+{
+    static thread_local LiteralRow table[N_LITERAL];
+    build_literal_table(table, window, n_lane);
+
+    // A clause without any literal in a round is never enabled in the PE,
+    // so its patch result register keeps the value of the previous round.
+    uint32_t sat[N_CLAUSE_PER_ROUND] = {0};
+    int32_t  sum[CTM_LANES] = {0};
+    int16_t  max_sum[CTM_LANES];
+    int      max_class[CTM_LANES] = {0};
+
+    for (int l = 0; l < n_lane; l++) {
+        result[l].class_sum.assign(num_class_, 0);
+        max_sum[l] = -8192;
+    }
+
+    for (int t = 0; t < num_round_; t++) {
+        for (int s = 0; s < N_CLAUSE_PER_ROUND; s++) {
+            const int c = t * N_CLAUSE_PER_ROUND + s;
+            const uint32_t n = clause_begin_[c + 1] - clause_begin_[c];
+
+            if (n != 0)
+                sat[s] = clause_kernel(table, &literal_[clause_begin_[c]], n);
+            if (sat[s] == 0)
+                continue;
+            for (int l = 0; l < n_lane; l++)
+                sum[l] += ((sat[s] >> l) & 0x1) ? weight_[c] : 0;
+        }
+
+        if ((t + 1) % num_sum_time_ == 0) {
+            const int k = t / num_sum_time_;
+            for (int l = 0; l < n_lane; l++) {
+                int16_t v = wrap14(sum[l]);
+                result[l].class_sum[k] = v;
+                // Strict compare: the first maximum wins.
+                if (v > max_sum[l]) {
+                    max_sum[l]   = v;
+                    max_class[l] = k;
+                }
+                sum[l] = 0;
+            }
+        }
+    }
+
+    for (int l = 0; l < n_lane; l++)
+        result[l].result = max_class[l];
+}
+
+CtmResult select_classes(const CtmResult &result, uint32_t class_en)
+{
+    CtmResult sel;
+    int16_t max_sum = -8192;
+
+    for (size_t c = 0; c < result.class_sum.size(); c++) {
+        if (!((class_en >> c) & 0x1))
+            continue;
+        sel.class_sum.push_back(result.class_sum[c]);
+        if (result.class_sum[c] > max_sum) {
+            max_sum    = result.class_sum[c];
+            sel.result = (int)c;
+        }
+    }
+    return sel;
+}
+
+CtmResult CtmModel::infer(const FeatureWindow &window) const
+{
+    CtmResult result;
+    infer_batch(&window, 1, &result);
+    return result;
+}
+
+void CtmModel::infer_batch(const FeatureWindow *window, size_t n, CtmResult *result) const
+{
+    const FeatureWindow *group[CTM_LANES];
+
+    for (size_t i = 0; i < n; i += CTM_LANES) {
+        int n_lane = (n - i < (size_t)CTM_LANES) ? (int)(n - i) : CTM_LANES;
+        for (int l = 0; l < n_lane; l++)
+            group[l] = &window[i + l];
+        eval_group(group, n_lane, &result[i]);
+    }
+}
+
+} // namespace tkws
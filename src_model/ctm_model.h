@@ -0,0 +1,93 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "ctm_model.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Bit-exact golden model of the convolutional Tsetlin Machine
+//       inference core (ogbcsr_decoder, distributor, pe_array, summation
+//       and argmax).
+//
+//==============================================================================
+
+#ifndef __CTM_MODEL_H
+#define __CTM_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "model_image.h"
+
+namespace tkws {
+
+// Literal index: ((row * 8 + col) << 1) | inv, where col 0 is the position
+// literal and col 1-7 are the 58-patch windows of the feature row.
+constexpr int N_LITERAL_COL     = 8;
+constexpr int N_LITERAL         = N_ROW * N_LITERAL_COL * 2;
+
+// Number of windows evaluated together by the SIMD clause kernel.
+#if defined(__AVX512F__)
+constexpr int CTM_LANES         = 8;
+#else
+constexpr int CTM_LANES         = 4;
+#endif
+
+struct CtmResult {
+    std::vector<int16_t>    class_sum;  // SPI_NUM_CLASS entries, 14-bit signed
+    int                     result = 0; // argmax output
+};
+
+// The class sums of the classes set in class_en (class_enable()), in class
+// order as summation.sv produces them, and the argmax over those classes.
+CtmResult select_classes(const CtmResult &result, uint32_t class_en);
+
+class CtmModel {
+public:
+    explicit CtmModel(const ModelImage &image);
+
+    int num_class() const { return num_class_; }
+    int num_round() const { return num_round_; }
+    size_t num_literal() const { return literal_.size(); }
+
+    // Evaluate one feature window.
+    CtmResult infer(const FeatureWindow &window) const;
+
+    // Evaluate n windows, CTM_LANES at a time.
+    void infer_batch(const FeatureWindow *window, size_t n, CtmResult *result) const;
+
+private:
+    // Decode the OG-BCSR banks in the same order as ogbcsr_decoder.sv and
+    // flatten every clause into a list of literal indices.
+    void decode(const ModelImage &image);
+
+    void eval_group(const FeatureWindow *const *window, int n_lane, CtmResult *result) const;
+
+    int                     num_class_      = 0;
+    int                     num_sum_time_   = 0;
+    int                     num_round_      = 0;
+    std::vector<uint16_t>   literal_;       // literal indices of every clause
+    std::vector<uint32_t>   clause_begin_;  // [round * N_CLAUSE_PER_ROUND + slot], size n+1
+    std::vector<int16_t>    weight_;        // [round * N_CLAUSE_PER_ROUND + slot]
+};
+
+} // namespace tkws
+
+#endif
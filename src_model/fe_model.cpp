@@ -0,0 +1,451 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "fe_model.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: The R2SDF pipeline is modelled frame-at-a-time: stage s takes the
+//       256-sample stream in groups of 2 * BUFFER_DEPTH and emits the d
+//       outputs followed by the twiddled c outputs, with the same
+//       INT/FRA_BIT_WIDTH truncation as fft_stage.sv. The butterflies of the
+//       stages with BUFFER_DEPTH >= 8 run 8 lanes wide with AVX2.
+//
+//==============================================================================
+
+#include "fe_model.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace tkws {
+
+namespace {
+
+// Keep the low `width` bits of v as a signed value.
+inline int32_t wrap(int32_t v, int width)
+{
+    return (int32_t)((uint32_t)v << (32 - width)) >> (32 - width);
+}
+
+// fft.sv STAGEn_INT/FRA_BIT_WIDTH, the input being 12.0.
+struct StageWidth {
+    int last_int, last_fra, curr_int, curr_fra;
+};
+
+constexpr StageWidth STAGE_WIDTH[N_FFT_STAGE] = {
+    {12, 0, 12, 1},
+    {12, 1, 13, 1},
+    {13, 1, 13, 1},
+    {13, 1, 13, 1},
+    {13, 1, 14, 1},
+    {14, 1, 14, 0},
+    {14, 0, 14, 0},
+    {14, 0, 15, 0},
+};
+
+// mel_filter.sv band edges. Band i covers bins bank[i] + 1 .. bank[i + 1],
+// the 7-bit bank[0] + 1 wrapping to bin 0.
+constexpr int EVEN_BANK[N_MEL / 2 + 1] = {127, 2, 5, 8, 11, 14, 17, 21, 25, 31, 37, 45, 54, 65, 79, 96, 116};
+constexpr int ODD_BANK[N_MEL / 2 + 1]  = {127, 4, 7, 10, 13, 16, 19, 23, 28, 34, 41, 49, 59, 72, 87, 105, 127};
+
+// One fft_stage over a whole frame. SHIFT = FRA_BIT_WIDTH - Last_FRA_BIT_WIDTH.
+template <int S>
+void fft_stage(const int32_t *re_in, const int32_t *im_in, int32_t *re_out, int32_t *im_out,
+               const TwiddleRom &rom)
+{
+    constexpr StageWidth W  = STAGE_WIDTH[S];
+    constexpr int DEPTH     = N_FFT >> (S + 1);
+    constexpr int CURR      = W.curr_int + W.curr_fra;
+    constexpr int SHIFT     = W.curr_fra - W.last_fra;
+    constexpr int MULT_SHIFT= TW_BIT_WIDTH - 1 - SHIFT;
+    constexpr bool LAST     = S == N_FFT_STAGE - 1;
+
+    const int32_t *tw_re = LAST ? nullptr : rom.re[S].data();
+    const int32_t *tw_im = LAST ? nullptr : rom.im[S].data();
+
+    for (int g = 0; g < N_FFT; g += 2 * DEPTH) {
+        int i = 0;
+#if defined(__AVX2__)
+        if constexpr (DEPTH >= 8 && !LAST) {
+            for (; i < DEPTH; i += 8) {
+                __m256i ar = _mm256_loadu_si256((const __m256i *)&re_in[g + i]);
+                __m256i ai = _mm256_loadu_si256((const __m256i *)&im_in[g + i]);
+                __m256i br = _mm256_loadu_si256((const __m256i *)&re_in[g + DEPTH + i]);
+                __m256i bi = _mm256_loadu_si256((const __m256i *)&im_in[g + DEPTH + i]);
+                __m256i tr = _mm256_loadu_si256((const __m256i *)&tw_re[i]);
+                __m256i ti = _mm256_loadu_si256((const __m256i *)&tw_im[i]);
+
+                __m256i dr = _mm256_add_epi32(ar, br);
+                __m256i di = _mm256_add_epi32(ai, bi);
+                __m256i cr = _mm256_sub_epi32(ar, br);
+                __m256i ci = _mm256_sub_epi32(ai, bi);
+
+                if constexpr (SHIFT >= 0) {
+                    dr = _mm256_slli_epi32(dr, SHIFT);
+                    di = _mm256_slli_epi32(di, SHIFT);
+                } else {
+                    dr = _mm256_srai_epi32(dr, -SHIFT);
+                    di = _mm256_srai_epi32(di, -SHIFT);
+                }
+
+                __m256i mr = _mm256_sub_epi32(_mm256_mullo_epi32(cr, tr), _mm256_mullo_epi32(ci, ti));
+                __m256i mi = _mm256_add_epi32(_mm256_mullo_epi32(cr, ti), _mm256_mullo_epi32(ci, tr));
+                mr = _mm256_srai_epi32(mr, MULT_SHIFT);
+                mi = _mm256_srai_epi32(mi, MULT_SHIFT);
+
+                // Truncate to CURR_WIDTH
+                dr = _mm256_srai_epi32(_mm256_slli_epi32(dr, 32 - CURR), 32 - CURR);
+                di = _mm256_srai_epi32(_mm256_slli_epi32(di, 32 - CURR), 32 - CURR);
+                mr = _mm256_srai_epi32(_mm256_slli_epi32(mr, 32 - CURR), 32 - CURR);
+                mi = _mm256_srai_epi32(_mm256_slli_epi32(mi, 32 - CURR), 32 - CURR);
+
+                _mm256_storeu_si256((__m256i *)&re_out[g + i], dr);
+                _mm256_storeu_si256((__m256i *)&im_out[g + i], di);
+                _mm256_storeu_si256((__m256i *)&re_out[g + DEPTH + i], mr);
+                _mm256_storeu_si256((__m256i *)&im_out[g + DEPTH + i], mi);
+            }
+        }
+#endif
+        for (; i < DEPTH; i++) {
+            // The butterfly is LAST_WIDTH + 1 bits wide, so a + b never overflows.
+            int32_t dr = re_in[g + i] + re_in[g + DEPTH + i];
+            int32_t di = im_in[g + i] + im_in[g + DEPTH + i];
+            int32_t cr = re_in[g + i] - re_in[g + DEPTH + i];
+            int32_t ci = im_in[g + i] - im_in[g + DEPTH + i];
+
+            if constexpr (SHIFT >= 0) {
+                dr = (int32_t)((uint32_t)dr << SHIFT);
+                di = (int32_t)((uint32_t)di << SHIFT);
+            } else {
+                dr >>= -SHIFT;
+                di >>= -SHIFT;
+            }
+            re_out[g + i] = wrap(dr, CURR);
+            im_out[g + i] = wrap(di, CURR);
+
+            if constexpr (LAST) {
+                // No multiplier in the last stage: its c slot carries 0.
+                re_out[g + DEPTH + i] = 0;
+                im_out[g + DEPTH + i] = 0;
+            } else {
+                int32_t mr = cr * tw_re[i] - ci * tw_im[i];
+                int32_t mi = cr * tw_im[i] + ci * tw_re[i];
+                re_out[g + DEPTH + i] = wrap(mr >> MULT_SHIFT, CURR);
+                im_out[g + DEPTH + i] = wrap(mi >> MULT_SHIFT, CURR);
+            }
+        }
+    }
+}
+
+// fft_swap.sv: 14-bit magnitude of a 15-bit value, -16384 folds to 0.
+inline uint32_t abs14(int32_t v)
+{
+    return (uint32_t)(v < 0 ? -v : v) & 0x3FFF;
+}
+
+inline int bitrev7(int v)
+{
+    int r = 0;
+    for (int b = 0; b < 7; b++)
+        r |= ((v >> b) & 0x1) << (6 - b);
+    return r;
+}
+
+} // namespace
+
+TwiddleRom load_twiddle_dir(const std::string &dir)
+{
+    TwiddleRom rom;
+    const std::string base = dir.empty() ? "" : dir + "/";
+
+    for (int s = 0; s < N_FFT_STAGE - 1; s++) {
+        const int depth = N_FFT >> (s + 1);
+        const std::string file_name = base + "twiddle" + std::to_string(depth) + "_table.dat";
+        std::vector<uint32_t> words = read_hex_dat(file_name);
+        if ((int)words.size() < depth)
+            throw std::runtime_error(file_name + " has fewer than " + std::to_string(depth) + " entries");
+
+        for (int k = 0; k < depth; k++) {
+            rom.re[s].push_back((int8_t)((words[k] >> 8) & 0xFF));
+            rom.im[s].push_back((int8_t)(words[k] & 0xFF));
+        }
+    }
+    return rom;
+}
+
+std::vector<int16_t> read_audio_csv(const std::string &file_name)
+{
+    std::ifstream fin(file_name);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file_name);
+
+    std::vector<int16_t> audio;
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (line.empty() || line[0] == '\r')
+            continue;
+        audio.push_back((int16_t)wrap(std::atoi(line.c_str()), AUDIO_BIT_WIDTH));
+    }
+    return audio;
+}
+
+std::vector<int16_t> read_wav(const std::string &file_name)
+{
+    std::ifstream fin(file_name, std::ios::binary);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file_name);
+
+    auto le = [](const unsigned char *p, int n) {
+        uint32_t v = 0;
+        for (int i = n - 1; i >= 0; i--)
+            v = (v << 8) | p[i];
+        return v;
+    };
+
+    unsigned char riff[12];
+    if (!fin.read((char *)riff, 12) || std::string((char *)riff, 4) != "RIFF" ||
+        std::string((char *)riff + 8, 4) != "WAVE")
+        throw std::runtime_error("Not a RIFF/WAVE file: " + file_name);
+
+    uint32_t n_channel = 0, bit_depth = 0;
+    for (;;) {
+        unsigned char head[8];
+        if (!fin.read((char *)head, 8))
+            throw std::runtime_error("No data chunk in " + file_name);
+        const std::string id((char *)head, 4);
+        const uint32_t size = le(head + 4, 4);
+
+        if (id == "fmt ") {
+            std::vector<unsigned char> fmt(size);
+            if (size < 16 || !fin.read((char *)fmt.data(), size))
+                throw std::runtime_error("Bad fmt chunk in " + file_name);
+            n_channel = le(&fmt[2], 2);
+            bit_depth = le(&fmt[14], 2);
+            if (le(&fmt[0], 2) != 1 || bit_depth != 16 || n_channel == 0)
+                throw std::runtime_error("Only 16-bit PCM WAV is supported: " + file_name);
+        } else if (id == "data") {
+            if (n_channel == 0)
+                throw std::runtime_error("data chunk before fmt chunk in " + file_name);
+            std::vector<unsigned char> data(size);
+            fin.read((char *)data.data(), size);
+            const size_t n = (size_t)fin.gcount() / (2 * n_channel);
+
+            std::vector<int16_t> audio(n);
+            for (size_t i = 0; i < n; i++) {
+                int32_t x = (int16_t)le(&data[i * 2 * n_channel], 2);
+                // Arithmetic shift is floor division by 32768.
+                audio[i] = (int16_t)((x * 2047) >> 15);
+            }
+            return audio;
+        } else {
+            fin.seekg(size + (size & 0x1), std::ios::cur);
+        }
+    }
+}
+
+void write_feature_csv(const std::string &file_name, const FeatureWindow &window)
+{
+    std::ofstream fout(file_name);
+    if (!fout)
+        throw std::runtime_error("Failed to open file: " + file_name);
+
+    for (int r = 0; r < N_ROW; r++) {
+        for (int j = 0; j < N_FRAME; j++)
+            fout << (j ? "," : "") << ((window[r] >> j) & 0x1);
+        fout << "\n";
+    }
+}
+
+FeModel::FeModel(const TwiddleRom &rom, uint32_t flux_th)
+    : rom_(rom), flux_th_(flux_th & 0xFFFF)
+{
+}
+
+void FeModel::reset()
+{
+    prev_audio_     = 0;
+    n_frame_sample_ = 0;
+    has_prev_mel_   = false;
+    threshold_.fill(0);
+    flux_cirbuf_.fill(0);
+    n_col_          = 0;
+}
+
+int16_t FeModel::pre_emphasis(int16_t x, int16_t xp)
+{
+    int32_t tmp = (x - xp) + (xp >> 4);
+    int32_t y   = ((tmp >> 13) & 0x1) << 11 | (tmp & 0x7FF);
+    return (int16_t)wrap(y, AUDIO_BIT_WIDTH);
+}
+
+void FeModel::fft(const int16_t *frame, uint16_t *spectrum) const
+{
+    alignas(32) int32_t re[2][N_FFT];
+    alignas(32) int32_t im[2][N_FFT];
+
+    for (int n = 0; n < N_FFT; n++) {
+        re[0][n] = frame[n];
+        im[0][n] = 0;
+    }
+
+    fft_stage<0>(re[0], im[0], re[1], im[1], rom_);
+    fft_stage<1>(re[1], im[1], re[0], im[0], rom_);
+    fft_stage<2>(re[0], im[0], re[1], im[1], rom_);
+    fft_stage<3>(re[1], im[1], re[0], im[0], rom_);
+    fft_stage<4>(re[0], im[0], re[1], im[1], rom_);
+    fft_stage<5>(re[1], im[1], re[0], im[0], rom_);
+    fft_stage<6>(re[0], im[0], re[1], im[1], rom_);
+    fft_stage<7>(re[1], im[1], re[0], im[0], rom_);
+
+    // fft_swap keeps the even stream positions, written at bit-reversed
+    // addresses, and reads them back in natural order.
+    for (int j = 0; j < N_SPECTRUM; j++)
+        spectrum[bitrev7(j)] = (uint16_t)(abs14(re[0][2 * j]) + abs14(im[0][2 * j]));
+}
+
+void FeModel::mel_filter(const uint16_t *spectrum, uint16_t *mel)
+{
+    for (int i = 0; i < N_MEL / 2; i++) {
+        uint32_t even = 0, odd = 0;
+        for (int k = (EVEN_BANK[i] + 1) & 0x7F; k <= EVEN_BANK[i + 1]; k++)
+            even += spectrum[k];
+        for (int k = (ODD_BANK[i] + 1) & 0x7F; k <= ODD_BANK[i + 1]; k++)
+            odd += spectrum[k];
+        mel[2 * i]     = (uint16_t)even;
+        mel[2 * i + 1] = (uint16_t)odd;
+    }
+}
+
+size_t FeModel::push(const int16_t *audio, size_t n, std::vector<FeatureWindow> &window)
+{
+    const size_t n_window = window.size();
+
+    for (size_t i = 0; i < n; i++) {
+        frame_[n_frame_sample_++] = pre_emphasis(audio[i], prev_audio_);
+        prev_audio_ = audio[i];
+
+        if (n_frame_sample_ == N_FFT) {
+            push_frame(window);
+            n_frame_sample_ = 0;
+        }
+    }
+    return window.size() - n_window;
+}
+
+void FeModel::prime(const int16_t *audio, size_t n)
+{
+    if (n != 0)
+        prev_audio_ = audio[n - 1];
+}
+
+size_t FeModel::flush(std::vector<FeatureWindow> &window)
+{
+    static const int16_t silence[N_FFT] = {0};
+    return n_frame_sample_ ? push(silence, N_FFT - n_frame_sample_, window) : 0;
+}
+
+FeatureWindow FeModel::clip_window(const int16_t *audio, size_t n)
+{
+    static const int16_t silence[N_FFT] = {0};
+    std::vector<FeatureWindow> window;
+
+    reset();
+    if (n != 0) {
+        prime(audio, 1);
+        push(audio + 1, n - 1, window);
+    }
+    while (window.empty())
+        push(silence, N_FFT, window);
+    return window[0];
+}
+
+void FeModel::push_frame(std::vector<FeatureWindow> &window)
+{
+    uint16_t spectrum[N_SPECTRUM];
+    uint16_t mel[N_MEL];
+
+    fft(frame_.data(), spectrum);
+    mel_filter(spectrum, mel);
+
+    // ping_pong_buffer: the first frame is only stored, then every frame
+    // produces the saturated sum and the absolute difference (flux) with
+    // the previous one.
+    if (has_prev_mel_) {
+        uint16_t mfcc[N_MEL];
+        uint16_t flux[N_MEL];
+        for (int r = 0; r < N_MEL; r++) {
+            uint32_t sum = (uint32_t)mel[r] + prev_mel_[r];
+            mfcc[r] = (uint16_t)(sum > 0xFFFF ? 0xFFFF : sum);
+            flux[r] = (uint16_t)(mel[r] > prev_mel_[r] ? mel[r] - prev_mel_[r] : prev_mel_[r] - mel[r]);
+        }
+        push_column(mfcc, flux, window);
+    }
+    for (int r = 0; r < N_MEL; r++)
+        prev_mel_[r] = mel[r];
+    has_prev_mel_ = true;
+}
+
+void FeModel::push_column(const uint16_t *mfcc, const uint16_t *flux, std::vector<FeatureWindow> &window)
+{
+    const int  col     = (int)(n_col_ % N_FRAME);
+    const bool padding = n_col_ < N_FRAME;
+
+    for (int r = 0; r < N_MEL; r++) {
+        // Running sum of mfcc >> 6 over the last 64 columns. The bank is
+        // read as 0 for the first column, and nothing is subtracted until
+        // the circular buffer is full.
+        uint16_t ori = (n_col_ == 0) ? 0 : threshold_[r];
+        uint16_t sub = padding ? 0 : (uint16_t)(mfcc_cirbuf_[col][r] >> 6);
+        threshold_[r] = (uint16_t)(ori + (mfcc[r] >> 6) - sub);
+        mfcc_cirbuf_[col][r] = mfcc[r];
+
+        uint64_t flux_bit = flux[r] >= flux_th_;
+        flux_cirbuf_[r] = (flux_cirbuf_[r] & ~(1ULL << col)) | (flux_bit << col);
+    }
+    n_col_++;
+
+    if (n_col_ < N_FRAME)
+        return;
+
+    // send_mfcc: bit j of a row is column (j + col_offset_cnt) % 64, so the
+    // newest column always lands on bit 63.
+    const int offset = (int)((n_col_ - N_FRAME) % N_FRAME);
+    FeatureWindow w{};
+
+    for (int r = 0; r < N_MEL; r++) {
+        uint64_t bits = 0;
+        for (int j = 0; j < N_FRAME; j++) {
+            int c = (j + offset) % N_FRAME;
+            bits |= (uint64_t)(mfcc_cirbuf_[c][r] >= threshold_[r]) << j;
+        }
+        w[r] = bits;
+
+        uint64_t f = flux_cirbuf_[r];
+        w[N_MEL + r] = offset ? (f >> offset) | (f << (N_FRAME - offset)) : f;
+    }
+    window.push_back(w);
+}
+
+} // namespace tkws
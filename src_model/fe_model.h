@@ -0,0 +1,133 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "fe_model.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Bit-exact golden model of the MFSC-SF feature extractor (pre_emp,
+//       fft, fft_swap, mel_filter, ping_pong_buffer and binarizer).
+//
+//==============================================================================
+
+#ifndef __FE_MODEL_H
+#define __FE_MODEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model_image.h"
+
+namespace tkws {
+
+// Feature extractor geometry (feature_extractor.sv parameters)
+constexpr int N_FFT             = 256;
+constexpr int N_FFT_STAGE       = 8;
+constexpr int N_SPECTRUM        = N_FFT / 2;
+constexpr int TW_BIT_WIDTH      = 8;
+constexpr int AUDIO_BIT_WIDTH   = 12;
+constexpr uint32_t DEFAULT_FLUX_TH = 1024;
+
+// Twiddle ROM of stage s (0-6): BUFFER_DEPTH = 128 >> s entries, hex[15:8]
+// is the real part and hex[7:0] the imaginary part.
+struct TwiddleRom {
+    std::array<std::vector<int32_t>, N_FFT_STAGE - 1> re;
+    std::array<std::vector<int32_t>, N_FFT_STAGE - 1> im;
+};
+
+// Load twiddle128_table.dat ... twiddle2_table.dat from a directory.
+TwiddleRom load_twiddle_dir(const std::string &dir);
+
+// Read an audio_data.csv file: one 12-bit signed sample per line.
+std::vector<int16_t> read_audio_csv(const std::string &file_name);
+
+// Read a 16-bit PCM WAV file (first channel) and scale it to the 12-bit
+// i2s samples used for audio_data.csv: floor(x * 2047 / 32768).
+std::vector<int16_t> read_wav(const std::string &file_name);
+
+// Write a feature window in the mfcc_binary.csv format.
+void write_feature_csv(const std::string &file_name, const FeatureWindow &window);
+
+class FeModel {
+public:
+    explicit FeModel(const TwiddleRom &rom, uint32_t flux_th = DEFAULT_FLUX_TH);
+
+    // Clear the pipeline state, as after rst_n / spi_en_inf deassertion.
+    void reset();
+
+    // Feed 12-bit audio samples (one per LRCLK). A feature window is
+    // appended to `window` at every fe_complete; returns the number added.
+    size_t push(const int16_t *audio, size_t n, std::vector<FeatureWindow> &window);
+
+    // Shift samples through pre_emp without framing them. In
+    // wrap_TsetlinKWS_tb.sv the first frame starts at data_in[1], so
+    // data_in[0] only primes the pre-emphasis register.
+    void prime(const int16_t *audio, size_t n);
+
+    // Complete a partial frame with silent samples, as the testbench does
+    // after the last clip sample. Returns the number of windows added.
+    size_t flush(std::vector<FeatureWindow> &window);
+
+    // Reset, then feed one clip the way wrap_TsetlinKWS_tb.sv does: the
+    // first sample primes pre_emp and silence follows the clip until the
+    // first fe_complete. Returns that window.
+    FeatureWindow clip_window(const int16_t *audio, size_t n);
+
+    // Number of binarizer columns (ping-pong outputs) seen since reset.
+    uint64_t num_column() const { return n_col_; }
+
+    // pre_emp.sv: y = {tmp[13], tmp[10:0]}, tmp = x - xp + (xp >>> 4).
+    static int16_t pre_emphasis(int16_t x, int16_t xp);
+
+    // fft.sv + fft_swap.sv: one 256-sample frame of pre-emphasised audio to
+    // the 128-bin |Re| + |Im| spectrum in natural bin order.
+    void fft(const int16_t *frame, uint16_t *spectrum) const;
+
+    // mel_filter.sv: 32 bands, mel[2i] = even band i, mel[2i + 1] = odd band i.
+    static void mel_filter(const uint16_t *spectrum, uint16_t *mel);
+
+private:
+    void push_frame(std::vector<FeatureWindow> &window);
+    void push_column(const uint16_t *mfcc, const uint16_t *flux, std::vector<FeatureWindow> &window);
+
+    const TwiddleRom               &rom_;
+    uint32_t                        flux_th_;
+
+    // pre_emp / data_buf
+    int16_t                         prev_audio_ = 0;
+    std::array<int16_t, N_FFT>      frame_{};
+    int                             n_frame_sample_ = 0;
+
+    // ping_pong_buffer
+    std::array<uint16_t, N_MEL>     prev_mel_{};
+    bool                            has_prev_mel_ = false;
+
+    // binarizer
+    std::array<std::array<uint16_t, N_MEL>, N_FRAME> mfcc_cirbuf_{};
+    std::array<uint64_t, N_MEL>     flux_cirbuf_{};
+    std::array<uint16_t, N_MEL>     threshold_{};
+    uint64_t                        n_col_ = 0;
+};
+
+} // namespace tkws
+
+#endif
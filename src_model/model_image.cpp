@@ -0,0 +1,655 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "model_image.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Readers for the model bank files and the SPI configuration script.
+//
+//==============================================================================
+
+#include "model_image.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace tkws {
+
+static std::ifstream open_or_throw(const std::string &file_name)
+{
+    std::ifstream fin(file_name);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file_name);
+    return fin;
+}
+
+void SpiConfig::write_reg(uint32_t config_addr, uint32_t data)
+{
+    // SPI_EN_CONF gates every other register, as in spi_slave.sv.
+    if (config_addr == 0) {
+        en_conf = data & 0x1;
+        return;
+    }
+    if (!en_conf)
+        return;
+
+    switch (config_addr) {
+        case 1:                         en_inf          = data & 0x1;      break;
+        case 2:                         en_fe           = data & 0x1;      break;
+        case 3:                         num_class       = data & 0xF;      break;
+        case 4:                         num_clause      = data & 0xFF;     break;
+        case 5:                         num_sum_time    = data & 0x3F;     break;
+        case 6:                         flux_th         = data & 0xFFFF;   break;
+        case 7:                         len_block_bank  = data & 0x7FF;    break;
+        case CONF_ADDR_LEN_WEIGHT_BANK: len_weight_bank = data & 0x7FF;    break;
+        case CONF_ADDR_EN_EARLY_EXIT:   en_early_exit   = data & 0x1;      break;
+        case CONF_ADDR_CLASS_SKIP:      class_skip      = data & 0xFFFF;   break;
+        case CONF_ADDR_INF_STRIDE:      inf_stride      = data & 0x3F;     break;
+        case CONF_ADDR_VAD_TH:          vad_th          = data & 0xFFF;    break;
+        case CONF_ADDR_VAD_CLASS:       vad_class       = data & 0xF;      break;
+        case CONF_ADDR_EN_KWD:          en_kwd          = data & 0x1;      break;
+        case CONF_ADDR_KWD_WINDOW:      kwd_window      = data & 0x3F;     break;
+        case CONF_ADDR_KWD_RUN:         kwd_run         = data & 0x3F;     break;
+        case CONF_ADDR_KWD_HOLDOFF:     kwd_holdoff     = data & 0x3F;     break;
+        default:
+            if (config_addr >= CONF_ADDR_LEN_ROW_BANK && config_addr < CONF_ADDR_LEN_CCL_BANK)
+                len_row_bank[config_addr - CONF_ADDR_LEN_ROW_BANK] = data & 0x7FF;
+            else if (config_addr >= CONF_ADDR_LEN_CCL_BANK && config_addr < CONF_ADDR_LEN_WEIGHT_BANK)
+                len_ccl_bank[config_addr - CONF_ADDR_LEN_CCL_BANK] = data & 0xFFF;
+            break;
+    }
+}
+
+uint32_t SpiConfig::read_reg(uint32_t config_addr) const
+{
+    switch (config_addr) {
+        case 0:                         return en_conf;
+        case 1:                         return en_inf;
+        case 2:                         return en_fe;
+        case 3:                         return num_class;
+        case 4:                         return num_clause;
+        case 5:                         return num_sum_time;
+        case 6:                         return flux_th;
+        case 7:                         return len_block_bank;
+        case CONF_ADDR_LEN_WEIGHT_BANK: return len_weight_bank;
+        case CONF_ADDR_EN_EARLY_EXIT:   return en_early_exit;
+        case CONF_ADDR_CLASS_SKIP:      return class_skip;
+        case CONF_ADDR_INF_STRIDE:      return inf_stride;
+        case CONF_ADDR_VAD_TH:          return vad_th;
+        case CONF_ADDR_VAD_CLASS:       return vad_class;
+        case CONF_ADDR_EN_KWD:          return en_kwd;
+        case CONF_ADDR_KWD_WINDOW:      return kwd_window;
+        case CONF_ADDR_KWD_RUN:         return kwd_run;
+        case CONF_ADDR_KWD_HOLDOFF:     return kwd_holdoff;
+        default:
+            if (config_addr >= CONF_ADDR_LEN_ROW_BANK && config_addr < CONF_ADDR_LEN_CCL_BANK)
+                return len_row_bank[config_addr - CONF_ADDR_LEN_ROW_BANK];
+            if (config_addr >= CONF_ADDR_LEN_CCL_BANK && config_addr < CONF_ADDR_LEN_WEIGHT_BANK)
+                return len_ccl_bank[config_addr - CONF_ADDR_LEN_CCL_BANK];
+            return 0;
+    }
+}
+
+std::vector<uint32_t> read_binary_dat(const std::string &file_name, int bit_len)
+{
+    std::ifstream fin = open_or_throw(file_name);
+    std::vector<uint32_t> data;
+    std::string line;
+
+    while (std::getline(fin, line)) {
+        if ((int)line.size() < bit_len)
+            continue;
+
+        bool valid = true;
+        uint32_t value = 0;
+        for (int i = 0; i < bit_len; i++) {
+            if (line[i] != '0' && line[i] != '1') {
+                valid = false;
+                break;
+            }
+            value = (value << 1) | (line[i] == '1');
+        }
+        if (valid)
+            data.push_back(value);
+    }
+    return data;
+}
+
+std::vector<uint32_t> read_hex_dat(const std::string &file_name)
+{
+    std::ifstream fin = open_or_throw(file_name);
+    std::vector<uint32_t> data;
+    std::string line;
+
+    while (std::getline(fin, line)) {
+        if (line.empty() || !std::isxdigit((unsigned char)line[0]))
+            continue;
+        data.push_back((uint32_t)std::stoul(line, nullptr, 16));
+    }
+    return data;
+}
+
+SpiConfig read_spi_config(const std::string &file_name)
+{
+    std::vector<uint32_t> words = read_binary_dat(file_name, 32);
+    SpiConfig conf;
+
+    // Same addr_phase/data_phase walk as the spi_slave FSM. Only cmd 000
+    // (configuration register) bursts are expected in this file.
+    size_t i = 0;
+    while (i < words.size()) {
+        uint32_t addr_word = words[i++];
+        uint32_t cmd       = (addr_word >> 28) & 0x7;
+        uint32_t burst_len = ((addr_word >> 12) & 0xFFF) + 1;
+
+        for (uint32_t n = 0; n < burst_len && i < words.size(); n++, i++) {
+            if (cmd == 0)
+                conf.write_reg(((addr_word & 0x3F) + n) & 0x3F, words[i]);
+        }
+    }
+    return conf;
+}
+
+ModelImage load_model_dir(const std::string &dir)
+{
+    ModelImage model;
+    const std::string base = dir.empty() ? "" : dir + "/";
+
+    if (std::ifstream(base + "row_cnt_bank" + std::to_string(N_PE_COL) + ".dat"))
+        throw std::runtime_error("Model directory has more than " + std::to_string(N_PE_COL) + " PE columns");
+    model.conf = read_spi_config(base + "spi_config_reg.txt");
+    model.block_idx = read_binary_dat(base + "block_idx_bank.dat", BLOCK_IDX_BITS);
+
+    for (int i = 0; i < N_PE_COL; i++) {
+        for (uint32_t v : read_binary_dat(base + "row_cnt_bank" + std::to_string(i) + ".dat", ROW_CNT_BITS))
+            model.row_cnt[i].push_back((uint8_t)v);
+        for (uint32_t v : read_binary_dat(base + "col_cla_idx_bank" + std::to_string(i) + ".dat", CCL_IDX_BITS))
+            model.col_clause_idx[i].push_back((uint8_t)v);
+    }
+
+    // Weights are stored as 9-bit two's complement.
+    for (uint32_t v : read_hex_dat(base + "weight_bank.dat"))
+        model.weight.push_back((int16_t)((v & 0x100) ? (int)(v & 0x1FF) - 512 : (int)(v & 0x1FF)));
+
+    if (model.block_idx.size() < model.conf.len_block_bank)
+        throw std::runtime_error("block_idx_bank.dat is shorter than SPI_LEN_BLOCK_BANK");
+    for (int i = 0; i < N_PE_COL; i++) {
+        if (model.row_cnt[i].size() < model.conf.len_row_bank[i])
+            throw std::runtime_error("row_cnt_bank" + std::to_string(i) + ".dat is shorter than SPI_LEN_ROW_BANK");
+        if (model.col_clause_idx[i].size() < model.conf.len_ccl_bank[i])
+            throw std::runtime_error("col_cla_idx_bank" + std::to_string(i) + ".dat is shorter than SPI_LEN_CCL_BANK");
+    }
+    if (model.weight.size() < model.conf.len_weight_bank)
+        throw std::runtime_error("weight_bank.dat is shorter than SPI_LEN_WEIGHT_BANK");
+
+    return model;
+}
+
+std::vector<uint32_t> spi_config_words(const SpiConfig &conf)
+{
+    std::vector<uint32_t> words;
+
+    auto burst = [&](uint32_t addr, const std::vector<uint32_t> &data) {
+        words.push_back(spi_write_word(SPI_CMD_CONF_REG, 0, (uint32_t)data.size(), addr));
+        words.insert(words.end(), data.begin(), data.end());
+    };
+
+    burst(0,  {conf.en_conf});
+    burst(2,  {conf.en_fe});
+    burst(3,  {conf.num_class});
+    burst(4,  {conf.num_clause});
+    burst(5,  {conf.num_sum_time});
+    burst(6,  {conf.flux_th});
+    burst(7,  {conf.len_block_bank});
+    burst(CONF_ADDR_LEN_ROW_BANK, {conf.len_row_bank.begin(), conf.len_row_bank.end()});
+    burst(CONF_ADDR_LEN_CCL_BANK, {conf.len_ccl_bank.begin(), conf.len_ccl_bank.end()});
+    burst(CONF_ADDR_LEN_WEIGHT_BANK, {conf.len_weight_bank});
+    if (conf.en_early_exit)
+        burst(CONF_ADDR_EN_EARLY_EXIT, {conf.en_early_exit});
+    if (conf.class_skip)
+        burst(CONF_ADDR_CLASS_SKIP, {conf.class_skip});
+    if (conf.inf_stride > 1)
+        burst(CONF_ADDR_INF_STRIDE, {conf.inf_stride});
+    if (conf.vad_th || conf.vad_class != VAD_CLASS_RESET)
+        burst(CONF_ADDR_VAD_TH, {conf.vad_th, conf.vad_class});
+    if (conf.en_kwd)
+        burst(CONF_ADDR_EN_KWD, {conf.en_kwd, conf.kwd_window, conf.kwd_run, conf.kwd_holdoff});
+    return words;
+}
+
+std::vector<std::vector<uint32_t>> spi_load_transactions(const ModelImage &image, bool pack)
+{
+    const SpiConfig &conf = image.conf;
+    std::vector<std::vector<uint32_t>> trans;
+
+    trans.push_back(spi_config_words(conf));
+
+    // word(i) returns bank word i; a packed frame holds 32 / bits words, LSB first
+    auto bank = [&](SpiCmd cmd, uint32_t bank_sel, uint32_t len, uint32_t bits, auto word) {
+        const uint32_t n = pack ? 32 / bits : 1;
+        std::vector<uint32_t> words{spi_write_word(cmd, bank_sel, len, 0, n > 1)};
+        words.reserve(1 + (len + n - 1) / n);
+        for (uint32_t i = 0; i < len; i += n) {
+            uint32_t frame = 0;
+            for (uint32_t k = 0; k < n && i + k < len; k++)
+                frame |= (uint32_t)word(i + k) << (k * bits);
+            words.push_back(frame);
+        }
+        trans.push_back(std::move(words));
+    };
+
+    bank(SPI_CMD_BLOCK_BANK, 0, conf.len_block_bank, BLOCK_IDX_BITS,
+         [&](uint32_t i) { return image.block_idx[i]; });
+    for (int k = 0; k < N_PE_COL; k++)
+        bank(SPI_CMD_ROW_BANK, k, conf.len_row_bank[k], ROW_CNT_BITS,
+             [&](uint32_t i) { return image.row_cnt[k][i]; });
+    for (int k = 0; k < N_PE_COL; k++)
+        bank(SPI_CMD_CCL_BANK, k, conf.len_ccl_bank[k], CCL_IDX_BITS,
+             [&](uint32_t i) { return image.col_clause_idx[k][i]; });
+    bank(SPI_CMD_WEIGHT_BANK, 0, conf.len_weight_bank, WEIGHT_BITS,
+         [&](uint32_t i) { return (uint32_t)image.weight[i] & 0x1FF; });
+
+    if (conf.num_sum_time && conf.len_block_bank == N_BLOCK_PER_ROUND * conf.num_sum_time * conf.num_class) {
+        std::vector<ClassStart> start = class_starts(image);
+        std::vector<uint32_t> table{spi_write_word(SPI_CMD_BLOCK_BANK, 1, 8 * (uint32_t)start.size(), 0)};
+        for (const ClassStart &s : start) {
+            for (int k = 0; k < 8; k++)
+                table.push_back(k < N_PE_COL ? s.row[k] << 16 | s.ccl[k] : 0);
+        }
+        trans.push_back(std::move(table));
+    }
+
+    if (conf.en_early_exit) {
+        std::vector<int16_t> bound = class_bounds(image);
+        std::vector<uint32_t> words{spi_write_word(SPI_CMD_WEIGHT_BANK, 1, (uint32_t)bound.size(), 0)};
+        for (int16_t b : bound)
+            words.push_back((uint32_t)b & 0x3FFF);
+        trans.push_back(std::move(words));
+    }
+
+    return trans;
+}
+
+std::vector<int16_t> class_bounds(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+    const uint32_t n_weight = N_CLAUSE_PER_ROUND * conf.num_sum_time;
+    std::vector<int16_t> bound(conf.num_class);
+
+    for (uint32_t c = 0; c < conf.num_class; c++) {
+        int32_t pos = 0, neg = 0;
+        for (uint32_t i = c * n_weight; i < (c + 1) * n_weight && conf.len_weight_bank; i++) {
+            int16_t w = image.weight[i % conf.len_weight_bank];
+            (w > 0 ? pos : neg) += w;
+        }
+        bound[c] = (int16_t)((pos > 8191 || neg < -8192) ? 8191 : pos);
+    }
+    return bound;
+}
+
+std::vector<ClassStart> class_starts(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+    const uint32_t class_len_block = N_BLOCK_PER_ROUND * conf.num_sum_time;
+    std::vector<ClassStart> start(conf.num_class);
+    ClassStart addr;
+
+    // Each set bit of a block word takes one row count word, which takes
+    // ta_counter1 + ta_counter2 CCL index words.
+    for (uint32_t b = 0; b < conf.len_block_bank && b < image.block_idx.size(); b++) {
+        if (class_len_block && b % class_len_block == 0 && b / class_len_block < conf.num_class)
+            start[b / class_len_block] = addr;
+        for (int k = 0; k < N_PE_COL; k++) {
+            for (int e = 0; e < N_ELEMENT; e++) {
+                if (!((image.block_idx[b] >> (N_ELEMENT * k + e)) & 0x1))
+                    continue;
+                const uint8_t row = addr.row[k] < image.row_cnt[k].size() ? image.row_cnt[k][addr.row[k]] : 0;
+                addr.row[k]++;
+                addr.ccl[k] += (row & 0x7) + ((row >> 3) & 0x7);
+            }
+        }
+    }
+    return start;
+}
+
+uint32_t class_enable(const SpiConfig &conf)
+{
+    const uint32_t all = (1u << conf.num_class) - 1;
+    return (conf.class_skip & all) == all ? all : ~conf.class_skip & all;
+}
+
+bool vad_silent(const SpiConfig &conf, const FeatureWindow &window)
+{
+    uint32_t n_flux = 0;
+    for (int r = N_MEL; r < N_ROW; r++)
+        n_flux += (uint32_t)__builtin_popcountll(window[r]);
+    return conf.vad_th && n_flux < conf.vad_th;
+}
+
+uint32_t result_record_words(uint32_t num_class)
+{
+    return 2 + (num_class + 1) / 2;
+}
+
+ResultRecord parse_result_record(const std::vector<uint32_t> &words)
+{
+    ResultRecord rec;
+    if (words.empty() || !(words[0] >> 31))
+        return rec;
+
+    rec.valid       = true;
+    rec.num_class   = (words[0] >> 24) & 0xF;
+    rec.result      = (words[0] >> 20) & 0xF;
+    rec.frame_cnt   = words[0] & 0xFFFF;
+    if (words.size() < result_record_words(rec.num_class))
+        throw std::runtime_error("Truncated result record");
+    rec.margin      = words[1] & 0x3FFF;
+    for (uint32_t c = 0; c < rec.num_class; c++)
+        rec.score.push_back((int16_t)(words[2 + c / 2] >> (16 * (c % 2))));
+    return rec;
+}
+
+PerfCounters parse_perf_counters(const std::vector<uint32_t> &words)
+{
+    PerfCounters cnt;
+    if (words.empty() || !(words[0] >> 31))
+        return cnt;
+    if (words.size() < PERF_CNT_WORDS)
+        throw std::runtime_error("Truncated performance counters");
+
+    cnt.valid           = true;
+    cnt.n_pe_col        = (words[0] >> 24) & 0xF;
+    cnt.frame_cnt       = words[0] & 0xFFFF;
+    cnt.cycle           = words[1];
+    cnt.decode_cycle    = words[2];
+    cnt.summation_cycle = words[3];
+    cnt.fe_latency      = words[4];
+    cnt.idle_cycle      = words[5];
+    for (int i = 0; i < N_PE_COL; i++) {
+        cnt.col_busy[i]  = words[6 + 2 * i];
+        cnt.col_wait[i]  = words[7 + 2 * i];
+    }
+    return cnt;
+}
+
+SpiStatus parse_status(uint32_t word)
+{
+    SpiStatus st;
+    if (!(word >> 31))
+        return st;
+
+    st.valid        = true;
+    st.busy         = (word >> 30) & 1;
+    st.crc_valid    = (word >> 29) & 1;
+    st.result_cnt   = (word >> 24) & 0x7;
+    st.result       = (word >> 20) & 0xF;
+    st.last_result  = (word >> 16) & 0xF;
+    st.done_cnt     = word & 0xFFFF;
+    return st;
+}
+
+uint32_t crc32(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+// The low bits bits of a word; the block index word is 32 bits wide on 8
+// columns, where 1u << 32 would be undefined.
+static uint32_t bit_mask(int bits)
+{
+    return bits < 32 ? (1u << bits) - 1 : 0xFFFFFFFFu;
+}
+
+// len words of a bank, masked to its width; words past the end read 0.
+template <typename T>
+static uint32_t bank_crc(const std::vector<T> &bank, uint32_t len, int bits)
+{
+    std::vector<uint8_t> bytes(4 * (size_t)len, 0);
+    for (uint32_t i = 0; i < len && i < bank.size(); i++) {
+        const uint32_t w = (uint32_t)bank[i] & bit_mask(bits);
+        for (int k = 0; k < 4; k++)
+            bytes[4 * i + k] = (w >> (8 * k)) & 0xFF;
+    }
+    return crc32(bytes.data(), bytes.size());
+}
+
+std::vector<uint32_t> bank_crcs(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+    std::vector<uint32_t> crc;
+
+    crc.push_back(bank_crc(image.block_idx, conf.len_block_bank, BLOCK_IDX_BITS));
+    for (int i = 0; i < N_PE_COL; i++)
+        crc.push_back(bank_crc(image.row_cnt[i], conf.len_row_bank[i], ROW_CNT_BITS));
+    for (int i = 0; i < N_PE_COL; i++)
+        crc.push_back(bank_crc(image.col_clause_idx[i], conf.len_ccl_bank[i], CCL_IDX_BITS));
+    crc.push_back(bank_crc(image.weight, conf.len_weight_bank, WEIGHT_BITS));
+    return crc;
+}
+
+static void put16(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint32_t get16(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static size_t packed_bytes(uint32_t len, int bits)
+{
+    return 4 * (((size_t)len * bits + 31) / 32);
+}
+
+// Payload size of the banks described by the length registers.
+static size_t payload_size(const SpiConfig &conf)
+{
+    size_t size = packed_bytes(conf.len_block_bank, BLOCK_IDX_BITS);
+    for (int i = 0; i < N_PE_COL; i++)
+        size += packed_bytes(conf.len_row_bank[i], ROW_CNT_BITS);
+    for (int i = 0; i < N_PE_COL; i++)
+        size += packed_bytes(conf.len_ccl_bank[i], CCL_IDX_BITS);
+    return size + packed_bytes(conf.len_weight_bank, WEIGHT_BITS);
+}
+
+std::vector<uint8_t> pack_model(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+    std::vector<uint8_t> file(MODEL_FILE_HEADER_SIZE, 0);
+    file.reserve(MODEL_FILE_HEADER_SIZE + payload_size(conf));
+
+    auto pack = [&](auto data, uint32_t len, int bits) {
+        uint64_t acc = 0;
+        int n = 0;
+        for (uint32_t i = 0; i < len; i++) {
+            acc |= (uint64_t)((uint32_t)data(i) & bit_mask(bits)) << n;
+            n += bits;
+            if (n >= 32) {
+                uint8_t word[4];
+                put32(word, (uint32_t)acc);
+                file.insert(file.end(), word, word + 4);
+                acc >>= 32;
+                n -= 32;
+            }
+        }
+        if (n > 0) {
+            uint8_t word[4];
+            put32(word, (uint32_t)acc);
+            file.insert(file.end(), word, word + 4);
+        }
+    };
+
+    pack([&](uint32_t i) { return image.block_idx[i]; }, conf.len_block_bank, BLOCK_IDX_BITS);
+    for (int k = 0; k < N_PE_COL; k++)
+        pack([&](uint32_t i) { return image.row_cnt[k][i]; }, conf.len_row_bank[k], ROW_CNT_BITS);
+    for (int k = 0; k < N_PE_COL; k++)
+        pack([&](uint32_t i) { return image.col_clause_idx[k][i]; }, conf.len_ccl_bank[k], CCL_IDX_BITS);
+    pack([&](uint32_t i) { return image.weight[i]; }, conf.len_weight_bank, WEIGHT_BITS);
+
+    uint8_t *h = file.data();
+    const size_t size = file.size() - MODEL_FILE_HEADER_SIZE;
+    put32(h + 0, MODEL_FILE_MAGIC);
+    put16(h + 4, MODEL_FILE_VERSION);
+    put16(h + 6, MODEL_FILE_HEADER_SIZE);
+    put16(h + 8, N_PE_COL);
+    put32(h + 12, (uint32_t)size);
+    put32(h + 16, crc32(h + MODEL_FILE_HEADER_SIZE, size));
+    for (int i = 0; i < N_CONF_REG; i++)
+        put32(h + 32 + 4 * i, i == 1 ? 0 : conf.read_reg(i));     // EN_INF is set after the load
+    put32(h + 28, crc32(h, MODEL_FILE_HEADER_SIZE));
+    return file;
+}
+
+ModelImage unpack_model(const uint8_t *data, size_t size)
+{
+    if (size < MODEL_FILE_HEADER_SIZE || get32(data) != MODEL_FILE_MAGIC)
+        throw std::runtime_error("Not a TsetlinKWS model file");
+    if (get16(data + 4) != MODEL_FILE_VERSION || get16(data + 6) != MODEL_FILE_HEADER_SIZE)
+        throw std::runtime_error("Unsupported model file version " + std::to_string(get16(data + 4)));
+    if (get16(data + 8) != N_PE_COL)
+        throw std::runtime_error("Model file is built for " + std::to_string(get16(data + 8)) + " PE columns");
+
+    uint8_t header[MODEL_FILE_HEADER_SIZE];
+    std::copy(data, data + MODEL_FILE_HEADER_SIZE, header);
+    put32(header + 28, 0);
+    if (crc32(header, MODEL_FILE_HEADER_SIZE) != get32(data + 28))
+        throw std::runtime_error("Model file header CRC mismatch");
+
+    ModelImage image;
+    for (int i = 0; i < N_CONF_REG; i++)
+        image.conf.write_reg(i, get32(data + 32 + 4 * i));
+
+    const uint8_t *payload = data + MODEL_FILE_HEADER_SIZE;
+    const size_t size_payload = get32(data + 12);
+    if (size_payload != size - MODEL_FILE_HEADER_SIZE || size_payload != payload_size(image.conf))
+        throw std::runtime_error("Model file payload size does not match the bank lengths");
+    if (crc32(payload, size_payload) != get32(data + 16))
+        throw std::runtime_error("Model file payload CRC mismatch");
+
+    // Every bank ends on a word boundary, so the banks unpack back to back.
+    auto unpack = [&](auto &bank, uint32_t len, int bits) {
+        uint64_t acc = 0;
+        int n = 0;
+        bank.resize(len);
+        for (uint32_t i = 0; i < len; i++) {
+            if (n < bits) {
+                acc |= (uint64_t)get32(payload) << n;
+                payload += 4;
+                n += 32;
+            }
+            bank[i] = (typename std::decay_t<decltype(bank)>::value_type)(acc & bit_mask(bits));
+            acc >>= bits;
+            n -= bits;
+        }
+    };
+
+    const SpiConfig &conf = image.conf;
+    unpack(image.block_idx, conf.len_block_bank, BLOCK_IDX_BITS);
+    for (int k = 0; k < N_PE_COL; k++)
+        unpack(image.row_cnt[k], conf.len_row_bank[k], ROW_CNT_BITS);
+    for (int k = 0; k < N_PE_COL; k++)
+        unpack(image.col_clause_idx[k], conf.len_ccl_bank[k], CCL_IDX_BITS);
+    std::vector<uint16_t> weight;
+    unpack(weight, conf.len_weight_bank, WEIGHT_BITS);
+    for (uint16_t v : weight)
+        image.weight.push_back((int16_t)((v & 0x100) ? (int)v - 512 : (int)v));
+
+    return image;
+}
+
+void write_model_file(const ModelImage &image, const std::string &file_name)
+{
+    std::vector<uint8_t> file = pack_model(image);
+    std::ofstream fout(file_name, std::ios::binary);
+    if (!fout || !fout.write((const char *)file.data(), file.size()))
+        throw std::runtime_error("Failed to create file: " + file_name);
+}
+
+ModelImage read_model_file(const std::string &file_name)
+{
+    std::ifstream fin(file_name, std::ios::binary);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file_name);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+    return unpack_model(file.data(), file.size());
+}
+
+ModelImage load_model(const std::string &path)
+{
+    std::ifstream fin(path, std::ios::binary);
+    char magic[4] = {0};
+    if (fin && fin.read(magic, 4) && get32((const uint8_t *)magic) == MODEL_FILE_MAGIC)
+        return read_model_file(path);
+    return load_model_dir(path);
+}
+
+FeatureWindow read_feature_csv(const std::string &file_name)
+{
+    std::ifstream fin = open_or_throw(file_name);
+    FeatureWindow window{};
+    std::string line;
+    int row = 0;
+
+    while (row < N_ROW && std::getline(fin, line)) {
+        std::stringstream ss(line);
+        std::string cell;
+        int bit = 0;
+        uint64_t value = 0;
+        while (bit < N_FRAME && std::getline(ss, cell, ',')) {
+            if (cell.find('1') != std::string::npos)
+                value |= 1ULL << bit;
+            bit++;
+        }
+        if (bit != N_FRAME)
+            throw std::runtime_error("Incorrect feature file format at row " + std::to_string(row));
+        window[row++] = value;
+    }
+    if (row != N_ROW)
+        throw std::runtime_error("Feature file has fewer than 64 rows: " + file_name);
+    return window;
+}
+
+} // namespace tkws
@@ -0,0 +1,334 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "model_image.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Host-side view of the model banks and SPI configuration registers,
+//       loaded from the ASCII files in model/ or the packed model.tkm.
+//
+//==============================================================================
+
+#ifndef __MODEL_IMAGE_H
+#define __MODEL_IMAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tkws {
+
+// Hardware geometry (tsetlin_machine_accelerator.sv parameters). Build with
+// -DTKWS_N_PE_COL=n for an n-column accelerator (-GN_PE_COL=n in Verilator).
+#ifndef TKWS_N_PE_COL
+#define TKWS_N_PE_COL 5
+#endif
+
+constexpr int N_MEL             = 32;
+constexpr int N_FRAME           = 64;
+constexpr int N_ROW             = 2 * N_MEL;
+constexpr int NUMBER_OF_PATCH   = 58;
+constexpr int N_PE_COL          = TKWS_N_PE_COL;
+constexpr int N_ELEMENT         = 4;
+constexpr int N_PE_CLUSTER      = N_PE_COL * N_ELEMENT;
+constexpr int N_CLAUSE_PER_ROUND= 2 * N_PE_CLUSTER;
+constexpr int N_ROW_PER_BLOCK   = 2;
+constexpr int N_BLOCK_PER_ROUND = N_ROW / N_ROW_PER_BLOCK;
+constexpr uint64_t PATCH_MASK   = (1ULL << NUMBER_OF_PATCH) - 1;
+
+// Bank word widths (mem_*_bank.sv)
+constexpr int BLOCK_IDX_BITS    = N_PE_CLUSTER;
+constexpr int ROW_CNT_BITS      = 6;
+constexpr int CCL_IDX_BITS      = 5;
+constexpr int WEIGHT_BITS       = 9;
+
+// bank_sel is 3 bits and the block index word is 32 bits at most.
+static_assert(N_PE_COL >= 1 && N_PE_COL <= 8, "N_PE_COL must be 1 to 8");
+
+// CCL words per CCL bank read, and TAs a PE column takes per cycle
+// (N_CCL_WORD of ogbcsr_decoder.sv). Build with -DTKWS_N_CCL_WORD=n
+// (-GN_CCL_WORD=n in Verilator). The bank contents do not depend on it.
+#ifndef TKWS_N_CCL_WORD
+#define TKWS_N_CCL_WORD 1
+#endif
+
+constexpr int N_CCL_WORD        = TKWS_N_CCL_WORD;
+
+static_assert(N_CCL_WORD == 1 || N_CCL_WORD == 2 || N_CCL_WORD == 4, "N_CCL_WORD must be 1, 2 or 4");
+
+// Blocks a PE column can run ahead of the slowest one within a round
+// (DEPTH_BLOCK_FIFO of ogbcsr_decoder.sv). Build with
+// -DTKWS_DEPTH_BLOCK_FIFO=n (-GDEPTH_BLOCK_FIFO=n in Verilator).
+#ifndef TKWS_DEPTH_BLOCK_FIFO
+#define TKWS_DEPTH_BLOCK_FIFO 4
+#endif
+
+constexpr int DEPTH_BLOCK_FIFO  = TKWS_DEPTH_BLOCK_FIFO;
+
+static_assert(DEPTH_BLOCK_FIFO >= 2 && (DEPTH_BLOCK_FIFO & (DEPTH_BLOCK_FIFO - 1)) == 0,
+              "DEPTH_BLOCK_FIFO must be a power of 2, at least 2");
+
+// SPI_VAD_CLASS after reset. A model with another silence class writes it
+// even with the voice activity gate off, as keyword_decision.sv uses it too.
+constexpr uint32_t VAD_CLASS_RESET = 10;
+
+// config_addr of the registers from the per-column bank lengths on
+// (spi_slave.sv CONF_ADDR_*): 8, 13, 18 to 27 with 5 columns.
+constexpr uint32_t CONF_ADDR_LEN_ROW_BANK       = 8;
+constexpr uint32_t CONF_ADDR_LEN_CCL_BANK       = CONF_ADDR_LEN_ROW_BANK + N_PE_COL;
+constexpr uint32_t CONF_ADDR_LEN_WEIGHT_BANK    = CONF_ADDR_LEN_CCL_BANK + N_PE_COL;
+constexpr uint32_t CONF_ADDR_EN_EARLY_EXIT      = CONF_ADDR_LEN_WEIGHT_BANK + 1;
+constexpr uint32_t CONF_ADDR_CLASS_SKIP         = CONF_ADDR_LEN_WEIGHT_BANK + 2;
+constexpr uint32_t CONF_ADDR_INF_STRIDE         = CONF_ADDR_LEN_WEIGHT_BANK + 3;
+constexpr uint32_t CONF_ADDR_VAD_TH             = CONF_ADDR_LEN_WEIGHT_BANK + 4;
+constexpr uint32_t CONF_ADDR_VAD_CLASS          = CONF_ADDR_LEN_WEIGHT_BANK + 5;
+constexpr uint32_t CONF_ADDR_EN_KWD             = CONF_ADDR_LEN_WEIGHT_BANK + 6;
+constexpr uint32_t CONF_ADDR_KWD_WINDOW         = CONF_ADDR_LEN_WEIGHT_BANK + 7;
+constexpr uint32_t CONF_ADDR_KWD_RUN            = CONF_ADDR_LEN_WEIGHT_BANK + 8;
+constexpr uint32_t CONF_ADDR_KWD_HOLDOFF        = CONF_ADDR_LEN_WEIGHT_BANK + 9;
+
+// SPI configuration registers (spi_slave.sv, config_addr 0 to CONF_ADDR_KWD_HOLDOFF)
+struct SpiConfig {
+    bool        en_conf         = true;
+    bool        en_inf          = false;
+    bool        en_fe           = true;
+    uint32_t    num_class       = 0;
+    uint32_t    num_clause      = 0;
+    uint32_t    num_sum_time    = 0;
+    uint32_t    flux_th         = 0;
+    uint32_t    len_block_bank  = 0;
+    std::array<uint32_t, N_PE_COL> len_row_bank{};
+    std::array<uint32_t, N_PE_COL> len_ccl_bank{};
+    uint32_t    len_weight_bank = 0;
+    bool        en_early_exit   = false;
+    uint32_t    class_skip      = 0;    // bit c skips class c
+    uint32_t    inf_stride      = 1;    // infer every inf_stride-th window, 0 as 1
+    uint32_t    vad_th          = 0;    // flux bits a window needs to be inferred, 0: off
+    uint32_t    vad_class       = VAD_CLASS_RESET;  // result of a silent window, the silence class
+    bool        en_kwd          = false;    // keyword decision in hardware
+    uint32_t    kwd_window      = 40;   // results a run must fit in
+    uint32_t    kwd_run         = 21;   // equal results confirming a keyword
+    uint32_t    kwd_holdoff     = 40;   // results ignored after a keyword
+
+    void write_reg(uint32_t config_addr, uint32_t data);
+    uint32_t read_reg(uint32_t config_addr) const;
+};
+
+// SPI address phase word (spi_slave.sv):
+// A[31] r/w | A[30:28] cmd | A[27:25] bank_sel | A[24] pack | A[23:12] burst_len - 1 | A[11:0] addr
+// A[31] clear reads on MISO: the configuration registers and the block
+// index, row count, CCL index and weight banks read back.
+enum SpiCmd : uint32_t {
+    SPI_CMD_CONF_REG        = 0,
+    SPI_CMD_BLOCK_BANK      = 1,
+    SPI_CMD_ROW_BANK        = 2,
+    SPI_CMD_CCL_BANK        = 3,
+    SPI_CMD_WEIGHT_BANK     = 4,
+    SPI_CMD_FEATURE_BANK    = 5,
+    SPI_CMD_RESULT_FIFO     = 6,    // read only
+    SPI_CMD_READ_REG        = 7,    // read only, bank_sel SpiReadReg
+};
+
+// bank_sel of SPI_CMD_READ_REG
+enum SpiReadReg : uint32_t {
+    SPI_READ_PERF_CNT       = 0,    // perf_counter.sv
+    SPI_READ_STATUS         = 1,    // status word, spi_readback.sv
+    SPI_READ_BANK_CRC       = 2,    // CRC of bank b at addr b, spi_readback.sv
+};
+
+// With the pack flag, a row count, CCL index or weight burst carries several
+// bank words per 32-bit frame, LSB first; burst_len still counts bank words.
+constexpr uint32_t SPI_PACK_FLAG = 1u << 24;
+
+inline uint32_t spi_write_word(SpiCmd cmd, uint32_t bank_sel, uint32_t burst_len, uint32_t addr, bool pack = false)
+{
+    return 0x80000000u | (uint32_t)cmd << 28 | (bank_sel & 0x7) << 25 | (pack ? SPI_PACK_FLAG : 0) |
+           ((burst_len - 1) & 0xFFF) << 12 | (addr & 0xFFF);
+}
+
+// A read burst answers with one turnaround frame, then burst_len words.
+inline uint32_t spi_read_word(SpiCmd cmd, uint32_t bank_sel, uint32_t burst_len, uint32_t addr = 0)
+{
+    return spi_write_word(cmd, bank_sel, burst_len, addr) & 0x7FFFFFFFu;
+}
+
+// Contents of every model bank, one entry per SRAM word.
+struct ModelImage {
+    SpiConfig                                   conf;
+    std::vector<uint32_t>                       block_idx;      // BLOCK_IDX_BITS
+    std::array<std::vector<uint8_t>, N_PE_COL>  row_cnt;        // 6-bit
+    std::array<std::vector<uint8_t>, N_PE_COL>  col_clause_idx; // 5-bit
+    std::vector<int16_t>                        weight;         // 9-bit signed
+};
+
+// The SPI words of spi_config_reg.txt: one write burst per register group,
+// EN_INF left clear. The optional registers (EN_EARLY_EXIT, CLASS_SKIP,
+// INF_STRIDE, the VAD gate and the keyword decision) are only sent when set.
+std::vector<uint32_t> spi_config_words(const SpiConfig &conf);
+
+// Early exit bound of every class (argmax.sv): the sum of the positive
+// weights of its slice of the weight bank, i.e. the largest class_summation
+// it can reach. 8191 when the 14-bit class_summation could wrap.
+std::vector<int16_t> class_bounds(const ModelImage &image);
+
+// Row count and CCL index address of the first block of every class, per PE
+// column: the class start table of ogbcsr_decoder.sv, used to skip classes.
+struct ClassStart {
+    std::array<uint32_t, N_PE_COL>  row{};
+    std::array<uint32_t, N_PE_COL>  ccl{};
+};
+std::vector<ClassStart> class_starts(const ModelImage &image);
+
+// Classes taking part in an inference: all but the ones in SPI_CLASS_SKIP,
+// or all of them if it skips every class (tsetlin_machine_accelerator.sv).
+uint32_t class_enable(const SpiConfig &conf);
+
+// SPI transactions (one CS low period each) that load a model, in the order
+// of initial_TMA() and wrap_TsetlinKWS_tb.sv: the configuration registers,
+// then the block index, row count, column/clause index and weight banks,
+// the class start table (block burst, bank_sel 1, addr {class, column[2:0]})
+// and with EN_EARLY_EXIT the class bound table (weight burst, bank_sel 1).
+// Setting EN_INF is left to the caller. With pack, the row count, CCL index
+// and weight banks are sent as packed bursts.
+std::vector<std::vector<uint32_t>> spi_load_transactions(const ModelImage &image, bool pack = false);
+
+// One 64x64 binary feature window: row r, bit j = feature_bank[r][j].
+using FeatureWindow = std::array<uint64_t, N_ROW>;
+
+// Voice activity gate of binarizer.sv: with SPI_VAD_TH set, a window with
+// fewer flux bits (rows N_MEL and up) is not inferred and reports
+// SPI_VAD_CLASS.
+bool vad_silent(const SpiConfig &conf, const FeatureWindow &window);
+
+// One record of the result FIFO (result_fifo.sv), written at every Inf_Done:
+// a header word, the top-2 margin and two 16-bit class scores per word.
+struct ResultRecord {
+    bool                    valid = false;  // header bit 31, clear if the FIFO was empty
+    uint32_t                num_class = 0;
+    int                     result = -1;
+    uint32_t                frame_cnt = 0;  // counts every Inf_Done, records dropped when full included
+    int                     margin = 0;     // lead over the second best class
+    std::vector<int16_t>    score;          // -8192 for the classes not summed
+};
+
+uint32_t result_record_words(uint32_t num_class);
+ResultRecord parse_result_record(const std::vector<uint32_t> &words);
+
+// Performance counters of the last inference (perf_counter.sv), copied at
+// every Inf_Done. A PE column is busy with pe_ena set, waiting while another
+// column is busy and idle while none is.
+struct PerfCounters {
+    bool                            valid = false;  // header bit 31, clear before the first Inf_Done
+    uint32_t                        n_pe_col = 0;
+    uint32_t                        frame_cnt = 0;  // Inf_Done number, as in the result FIFO
+    uint32_t                        cycle = 0;      // decode_en or tail_flush_en
+    uint32_t                        decode_cycle = 0;
+    uint32_t                        summation_cycle = 0;
+    uint32_t                        fe_latency = 0; // fe_window_done to fe_complete
+    uint32_t                        idle_cycle = 0;
+    std::array<uint32_t, N_PE_COL>  col_busy{};
+    std::array<uint32_t, N_PE_COL>  col_wait{};
+};
+
+constexpr uint32_t PERF_CNT_WORDS = 6 + 2 * N_PE_COL;
+PerfCounters parse_perf_counters(const std::vector<uint32_t> &words);
+
+// Status word (spi_readback.sv). done_cnt counts the Inf_Done pulses, so a
+// change means a new Result.
+struct SpiStatus {
+    bool                            valid = false;  // bit 31, always set by the chip
+    bool                            busy = false;   // tma_busy
+    bool                            crc_valid = false;  // bank CRCs up to date
+    uint32_t                        result_cnt = 0; // result FIFO records
+    int                             result = -1;    // Result pin
+    int                             last_result = -1;   // argmax of the last inference
+    uint32_t                        done_cnt = 0;
+};
+
+SpiStatus parse_status(uint32_t word);
+
+// Bank b of the bank CRCs and the firmware: the block index bank, the row
+// count banks, the CCL index banks, then the weight bank.
+constexpr uint32_t N_BANK = 2 + 2 * N_PE_COL;
+
+// CRC-32 of every bank as the chip computes it (spi_readback.sv): over the
+// first SPI_LEN_* words, each zero extended to 32 bits and taken as 4
+// little-endian bytes.
+std::vector<uint32_t> bank_crcs(const ModelImage &image);
+
+// Parse a "binary string per line" .dat file. Lines that do not start with
+// bit_len '0'/'1' characters are skipped, as in sd_read_binary().
+std::vector<uint32_t> read_binary_dat(const std::string &file_name, int bit_len);
+
+// Parse a "hex per line" .dat file, as in sd_read_hex().
+std::vector<uint32_t> read_hex_dat(const std::string &file_name);
+
+// Replay the SPI words of spi_config_reg.txt into the configuration registers.
+SpiConfig read_spi_config(const std::string &file_name);
+
+// Load spi_config_reg.txt and all bank files from a model directory.
+ModelImage load_model_dir(const std::string &dir);
+
+// Packed model container, read by the firmware with one f_read. All fields
+// are little-endian:
+//
+//   0    u32   magic "TKWM"
+//   4    u16   version
+//   6    u16   header size (160)
+//   8    u16   N_PE_COL
+//   10   u16   reserved
+//   12   u32   payload size in bytes
+//   16   u32   payload CRC-32
+//   20   u32   reserved [2]
+//   28   u32   header CRC-32, computed with this field set to 0
+//   32   u32   configuration registers [N_CONF_REG], indexed by config_addr
+//
+// N_CONF_REG is 32 up to 7 columns, so the header is 160 bytes there. The
+// payload holds the banks in SPI load order (block index, row count 0 to
+// N_PE_COL-1, column/clause index 0 to N_PE_COL-1, weight), SPI_LEN_* words each. Every bank
+// is packed LSB first into 32-bit words at its bit width and starts on a
+// word boundary.
+constexpr uint32_t MODEL_FILE_MAGIC         = 0x4D574B54;
+constexpr uint16_t MODEL_FILE_VERSION       = 1;
+constexpr int      N_CONF_REG               = CONF_ADDR_KWD_HOLDOFF < 32 ? 32 : CONF_ADDR_KWD_HOLDOFF + 1;
+constexpr uint32_t MODEL_FILE_HEADER_SIZE   = 32 + 4 * N_CONF_REG;
+constexpr const char *MODEL_FILE_NAME       = "model.tkm";
+
+// CRC-32 (IEEE 802.3), as computed by the firmware.
+uint32_t crc32(const uint8_t *data, size_t size);
+
+std::vector<uint8_t> pack_model(const ModelImage &image);
+ModelImage unpack_model(const uint8_t *data, size_t size);
+
+void write_model_file(const ModelImage &image, const std::string &file_name);
+ModelImage read_model_file(const std::string &file_name);
+
+// Load a model directory (ASCII bank files) or a model.tkm file.
+ModelImage load_model(const std::string &path);
+
+// Read a feature window in the mfcc_binary.csv format (64 rows of 64
+// comma-separated bits, bit 0 first).
+FeatureWindow read_feature_csv(const std::string &file_name);
+
+} // namespace tkws
+
+#endif
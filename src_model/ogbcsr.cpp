@@ -0,0 +1,730 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "ogbcsr.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: A block (2 feature rows) of a round costs the decoder the CCL words
+//       of its busiest PE column, and the slot of a clause inside its class
+//       does not change the class sum. The balancer therefore bin-packs the
+//       clauses of each class into (round, column) bins of 8 slots against
+//       the per-block column loads, pairs the clauses of a bin into PE
+//       clusters within the 3-bit ta_counter limit, and finally permutes
+//       the columns of every round to even out the bank lengths.
+//
+//==============================================================================
+
+#include "ogbcsr.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace tkws {
+
+namespace {
+
+constexpr int N_SLOT_PER_COL = N_ELEMENT * 2;
+
+std::ofstream create_or_throw(const std::string &file_name)
+{
+    std::ofstream fout(file_name);
+    if (!fout)
+        throw std::runtime_error("Failed to create file: " + file_name);
+    return fout;
+}
+
+std::string to_binary(uint32_t value, int bit_len)
+{
+    std::string s(bit_len, '0');
+    for (int i = 0; i < bit_len; i++)
+        s[bit_len - 1 - i] = ((value >> i) & 0x1) ? '1' : '0';
+    return s;
+}
+
+// CCL word order inside a row: inv, then col, then clause index.
+bool ccl_less(uint8_t a, uint8_t b)
+{
+    int ka = ((a >> 3) & 0x1) << 4 | (a & 0x7) << 1 | ((a >> 4) & 0x1);
+    int kb = ((b >> 3) & 0x1) << 4 | (b & 0x7) << 1 | ((b >> 4) & 0x1);
+    return ka < kb;
+}
+
+// Includes of one clause per feature row and per block.
+struct ClauseLoad {
+    std::array<uint8_t, N_ROW>              row{};
+    std::array<uint8_t, N_BLOCK_PER_ROUND>  block{};
+    int                                     total = 0;
+};
+
+ClauseLoad clause_load(const std::vector<uint16_t> &literal)
+{
+    ClauseLoad load;
+    for (uint16_t lit : literal) {
+        load.row[literal_row(lit)]++;
+        load.block[literal_row(lit) / N_ROW_PER_BLOCK]++;
+        load.total++;
+    }
+    return load;
+}
+
+// Row words of a PE cluster holding clauses a and b, or INFEASIBLE_PAIR if
+// a row would exceed MAX_ROW_TA_CNT.
+constexpr int INFEASIBLE_PAIR = 1 << 16;
+
+int pair_row_word(const ClauseLoad &a, const ClauseLoad &b)
+{
+    for (int r = 0; r < N_ROW; r++) {
+        if (a.row[r] + b.row[r] > MAX_ROW_TA_CNT)
+            return INFEASIBLE_PAIR;
+    }
+    int n = 0;
+    for (int j = 0; j < N_BLOCK_PER_ROUND; j++)
+        n += (a.block[j] + b.block[j]) != 0;
+    return n;
+}
+
+// Pair the clauses of a bin into PE clusters with the fewest row words
+// (bitmask DP over the N_SLOT_PER_COL members).
+struct Pairing {
+    std::vector<std::pair<int, int>>    pair;
+    int                                 row_word = 0;
+};
+
+Pairing pair_clauses(const std::vector<int> &member, const std::vector<std::vector<int>> &pair_word)
+{
+    const int n = (int)member.size();
+    const int full = (1 << n) - 1;
+    std::vector<int> best(full + 1, INFEASIBLE_PAIR);
+    std::vector<int> choice(full + 1, -1);
+    best[0] = 0;
+
+    // Masks with an even number of members, lowest free member paired first.
+    for (int mask = 1; mask <= full; mask++) {
+        int first = __builtin_ctz(mask);
+        for (int k = first + 1; k < n; k++) {
+            if (!((mask >> k) & 0x1))
+                continue;
+            int rest = mask & ~(1 << first) & ~(1 << k);
+            int cost = best[rest] + pair_word[member[first]][member[k]];
+            if (cost < best[mask]) {
+                best[mask] = cost;
+                choice[mask] = k;
+            }
+        }
+    }
+
+    Pairing p;
+    p.row_word = best[full];
+    for (int mask = full; mask && choice[mask] >= 0;) {
+        int first = __builtin_ctz(mask);
+        p.pair.emplace_back(member[first], member[choice[mask]]);
+        mask &= ~(1 << first) & ~(1 << choice[mask]);
+    }
+    return p;
+}
+
+// One class: (round, column) bins of N_SLOT_PER_COL clauses.
+class ClassBalancer {
+public:
+    ClassBalancer(const std::vector<ClauseLoad> &load, int num_sum_time)
+        : load_(load), n_bin_(num_sum_time * N_PE_COL), bin_load_(n_bin_), bin_row_word_(n_bin_, 0),
+          member_(n_bin_), bin_of_(load.size()), pair_word_(load.size(), std::vector<int>(load.size()))
+    {
+        for (size_t a = 0; a < load.size(); a++) {
+            for (size_t b = a + 1; b < load.size(); b++)
+                pair_word_[a][b] = pair_word_[b][a] = pair_row_word(load[a], load[b]);
+        }
+    }
+
+    // Greedy placement, largest clause first, then pairwise swaps until no
+    // swap shortens the class, or keeps its length and saves row words.
+    void run()
+    {
+        std::vector<int> order(load_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](int a, int b) { return load_[a].total > load_[b].total; });
+
+        for (int c : order) {
+            int best = -1;
+            long best_delta = 0, best_total = 0;
+            for (int b = 0; b < n_bin_; b++) {
+                if ((int)member_[b].size() == N_SLOT_PER_COL)
+                    continue;
+                long before = round_cost(b / N_PE_COL);
+                add(c, b);
+                long delta = round_cost(b / N_PE_COL) - before;
+                remove(c, b);
+                long total = bin_total(b);
+                if (best < 0 || delta < best_delta || (delta == best_delta && total < best_total)) {
+                    best = b;
+                    best_delta = delta;
+                    best_total = total;
+                }
+            }
+            add(c, best);
+        }
+        for (int b = 0; b < n_bin_; b++)
+            bin_row_word_[b] = pair_clauses(member_[b], pair_word_).row_word;
+
+        for (int pass = 0; pass < 64; pass++) {
+            bool improved = false;
+            for (int a = 0; a < (int)load_.size(); a++) {
+                for (int b = a + 1; b < (int)load_.size(); b++) {
+                    if (bin_of_[a] != bin_of_[b] && try_swap(a, b))
+                        improved = true;
+                }
+            }
+            if (!improved)
+                break;
+        }
+    }
+
+    const std::vector<int> &member(int bin) const { return member_[bin]; }
+
+    Pairing pairing(int bin) const { return pair_clauses(member_[bin], pair_word_); }
+
+private:
+    void add(int c, int b)
+    {
+        for (int j = 0; j < N_BLOCK_PER_ROUND; j++)
+            bin_load_[b][j] += load_[c].block[j];
+        member_[b].push_back(c);
+        bin_of_[c] = b;
+    }
+
+    void remove(int c, int b)
+    {
+        for (int j = 0; j < N_BLOCK_PER_ROUND; j++)
+            bin_load_[b][j] -= load_[c].block[j];
+        member_[b].erase(std::find(member_[b].begin(), member_[b].end(), c));
+    }
+
+    long bin_total(int b) const
+    {
+        return std::accumulate(bin_load_[b].begin(), bin_load_[b].end(), 0L);
+    }
+
+    // Sum over the blocks of the busiest column.
+    long round_cost(int r) const
+    {
+        long cost = 0;
+        for (int j = 0; j < N_BLOCK_PER_ROUND; j++) {
+            int max_load = 0;
+            for (int i = 0; i < N_PE_COL; i++)
+                max_load = std::max(max_load, bin_load_[r * N_PE_COL + i][j]);
+            cost += max_load;
+        }
+        return cost;
+    }
+
+    bool try_swap(int a, int b)
+    {
+        const int ba = bin_of_[a], bb = bin_of_[b];
+        const int ra = ba / N_PE_COL, rb = bb / N_PE_COL;
+
+        long cost_before = round_cost(ra) + (ra != rb ? round_cost(rb) : 0);
+        long word_before = bin_row_word_[ba] + bin_row_word_[bb];
+        remove(a, ba);
+        remove(b, bb);
+        add(a, bb);
+        add(b, ba);
+        long cost_after = round_cost(ra) + (ra != rb ? round_cost(rb) : 0);
+
+        if (cost_after <= cost_before) {
+            int word_a = pair_clauses(member_[ba], pair_word_).row_word;
+            int word_b = pair_clauses(member_[bb], pair_word_).row_word;
+            if (cost_after < cost_before || word_a + word_b < word_before) {
+                bin_row_word_[ba] = word_a;
+                bin_row_word_[bb] = word_b;
+                return true;
+            }
+        }
+
+        remove(a, bb);
+        remove(b, ba);
+        add(a, ba);
+        add(b, bb);
+        return false;
+    }
+
+    const std::vector<ClauseLoad>                      &load_;
+    int                                                 n_bin_;
+    std::vector<std::array<int, N_BLOCK_PER_ROUND>>     bin_load_;
+    std::vector<int>                                    bin_row_word_;
+    std::vector<std::vector<int>>                       member_;
+    std::vector<int>                                    bin_of_;
+    std::vector<std::vector<int>>                       pair_word_;     // row words of a clause pair
+};
+
+} // namespace
+
+SlotClauses decode_ogbcsr(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+
+    if (conf.num_class == 0 || conf.num_sum_time == 0)
+        throw std::runtime_error("SPI_NUM_CLASS and SPI_NUM_SUM_TIME must be non-zero");
+    if (conf.len_block_bank % N_BLOCK_PER_ROUND != 0)
+        throw std::runtime_error("SPI_LEN_BLOCK_BANK must be a multiple of 32");
+    if (conf.len_block_bank / N_BLOCK_PER_ROUND != conf.num_class * conf.num_sum_time)
+        throw std::runtime_error("SPI_LEN_BLOCK_BANK does not match SPI_NUM_CLASS * SPI_NUM_SUM_TIME");
+    if (conf.len_weight_bank == 0)
+        throw std::runtime_error("SPI_LEN_WEIGHT_BANK must be non-zero");
+
+    SlotClauses slot;
+    slot.num_class    = (int)conf.num_class;
+    slot.num_sum_time = (int)conf.num_sum_time;
+
+    const int n_clause = (int)(conf.len_block_bank / N_BLOCK_PER_ROUND) * N_CLAUSE_PER_ROUND;
+    slot.literal.assign(n_clause, {});
+    slot.weight.assign(n_clause, 0);
+
+    uint32_t raddr_row[N_PE_COL] = {0};
+    uint32_t raddr_ccl[N_PE_COL] = {0};
+
+    for (uint32_t b = 0; b < conf.len_block_bank; b++) {
+        const int round = b / N_BLOCK_PER_ROUND;
+        const int row0  = (b % N_BLOCK_PER_ROUND) * N_ROW_PER_BLOCK;
+        const uint32_t block = image.block_idx[b];
+
+        for (int i = 0; i < N_PE_COL; i++) {
+            for (int e = 0; e < N_ELEMENT; e++) {
+                if (!((block >> (N_ELEMENT * i + e)) & 0x1))
+                    continue;
+
+                // One row count word per active TA matrix: cnt1 for the
+                // first row of the block, cnt2 for the second.
+                uint8_t row_cnt = image.row_cnt[i][raddr_row[i]];
+                raddr_row[i] = (raddr_row[i] + 1 == conf.len_row_bank[i]) ? 0 : raddr_row[i] + 1;
+
+                const int ta_cnt[N_ROW_PER_BLOCK] = {row_cnt & 0x7, (row_cnt >> 3) & 0x7};
+                for (int s = 0; s < N_ROW_PER_BLOCK; s++) {
+                    for (int k = 0; k < ta_cnt[s]; k++) {
+                        uint8_t ccl = image.col_clause_idx[i][raddr_ccl[i]];
+                        raddr_ccl[i] = (raddr_ccl[i] + 1 == conf.len_ccl_bank[i]) ? 0 : raddr_ccl[i] + 1;
+
+                        int clause_index = (ccl >> 4) & 0x1;
+                        int inv          = (ccl >> 3) & 0x1;
+                        int col          = ccl & 0x7;
+                        int slot_index   = (i * N_ELEMENT + e) * 2 + clause_index;
+                        int lit          = (((row0 + s) * 8 + col) << 1) | inv;
+
+                        slot.literal[round * N_CLAUSE_PER_ROUND + slot_index].push_back((uint16_t)lit);
+                    }
+                }
+            }
+        }
+    }
+
+    // The weight address advances per clause whether satisfied or not.
+    for (int c = 0; c < n_clause; c++)
+        slot.weight[c] = image.weight[c % conf.len_weight_bank];
+
+    return slot;
+}
+
+ModelImage encode_ogbcsr(const SlotClauses &slot, const SpiConfig &conf)
+{
+    const int n_round = slot.num_class * slot.num_sum_time;
+    if (n_round == 0 || (int)slot.literal.size() != n_round * N_CLAUSE_PER_ROUND ||
+        slot.weight.size() != slot.literal.size())
+        throw std::runtime_error("Clause list does not match num_class * num_sum_time rounds");
+
+    ModelImage image;
+    image.conf = conf;
+    image.conf.num_class    = slot.num_class;
+    image.conf.num_sum_time = slot.num_sum_time;
+
+    for (int t = 0; t < n_round; t++) {
+        // Includes of every clause slot, per feature row.
+        std::vector<std::vector<uint8_t>> row_ccl(N_CLAUSE_PER_ROUND * N_ROW);
+        for (int s = 0; s < N_CLAUSE_PER_ROUND; s++) {
+            for (uint16_t lit : slot.literal[t * N_CLAUSE_PER_ROUND + s]) {
+                if (literal_row(lit) >= N_ROW)
+                    throw std::runtime_error("Literal index out of range: " + std::to_string(lit));
+                uint8_t ccl = (uint8_t)((s & 0x1) << 4 | literal_inv(lit) << 3 | literal_col(lit));
+                row_ccl[s * N_ROW + literal_row(lit)].push_back(ccl);
+            }
+        }
+
+        for (int j = 0; j < N_BLOCK_PER_ROUND; j++) {
+            uint32_t block = 0;
+            for (int i = 0; i < N_PE_COL; i++) {
+                for (int e = 0; e < N_ELEMENT; e++) {
+                    const int s0 = (i * N_ELEMENT + e) * 2;
+                    int cnt[N_ROW_PER_BLOCK];
+                    std::vector<uint8_t> ccl[N_ROW_PER_BLOCK];
+
+                    for (int r = 0; r < N_ROW_PER_BLOCK; r++) {
+                        const int row = j * N_ROW_PER_BLOCK + r;
+                        ccl[r] = row_ccl[s0 * N_ROW + row];
+                        ccl[r].insert(ccl[r].end(), row_ccl[(s0 + 1) * N_ROW + row].begin(),
+                                      row_ccl[(s0 + 1) * N_ROW + row].end());
+                        std::sort(ccl[r].begin(), ccl[r].end(), ccl_less);
+                        cnt[r] = (int)ccl[r].size();
+                        if (cnt[r] > MAX_ROW_TA_CNT)
+                            throw std::runtime_error("Round " + std::to_string(t) + " PE cluster " +
+                                                     std::to_string(i * N_ELEMENT + e) + " has " +
+                                                     std::to_string(cnt[r]) + " includes in row " +
+                                                     std::to_string(row) + ", more than ta_counter can hold");
+                    }
+                    if (cnt[0] + cnt[1] == 0)
+                        continue;
+
+                    block |= 1u << (N_ELEMENT * i + e);
+                    image.row_cnt[i].push_back((uint8_t)(cnt[1] << 3 | cnt[0]));
+                    for (int r = 0; r < N_ROW_PER_BLOCK; r++)
+                        image.col_clause_idx[i].insert(image.col_clause_idx[i].end(), ccl[r].begin(), ccl[r].end());
+                }
+            }
+            image.block_idx.push_back(block);
+        }
+    }
+    image.weight = slot.weight;
+
+    // The length registers are one bit narrower than the bank addresses.
+    auto check_len = [](size_t len, uint32_t depth, const std::string &name) {
+        if (len == 0 || len >= depth)
+            throw std::runtime_error(name + " length " + std::to_string(len) + " does not fit in " +
+                                     std::to_string(depth) + " words");
+        return (uint32_t)len;
+    };
+    image.conf.len_block_bank = check_len(image.block_idx.size(), DEPTH_BLOCK_BANK, "Block index bank");
+    for (int i = 0; i < N_PE_COL; i++) {
+        image.conf.len_row_bank[i] = check_len(image.row_cnt[i].size(), DEPTH_ROW_BANK,
+                                               "Row count bank " + std::to_string(i));
+        image.conf.len_ccl_bank[i] = check_len(image.col_clause_idx[i].size(), DEPTH_CCL_BANK,
+                                               "Column/clause index bank " + std::to_string(i));
+    }
+    image.conf.len_weight_bank = check_len(image.weight.size(), DEPTH_WEIGHT_BANK, "Weight bank");
+
+    return image;
+}
+
+void write_model_dir(const ModelImage &image, const std::string &dir)
+{
+    const std::string base = dir.empty() ? "" : dir + "/";
+    const SpiConfig &conf = image.conf;
+
+    {
+        std::ofstream fout = create_or_throw(base + "block_idx_bank.dat");
+        for (uint32_t v : image.block_idx)
+            fout << to_binary(v, 4 * N_PE_COL) << "\n";
+    }
+    for (int i = 0; i < N_PE_COL; i++) {
+        std::ofstream frow = create_or_throw(base + "row_cnt_bank" + std::to_string(i) + ".dat");
+        for (uint8_t v : image.row_cnt[i])
+            frow << to_binary(v, 6) << "\n";
+        std::ofstream fccl = create_or_throw(base + "col_cla_idx_bank" + std::to_string(i) + ".dat");
+        for (uint8_t v : image.col_clause_idx[i])
+            fccl << to_binary(v, 5) << "\n";
+    }
+    {
+        std::ofstream fout = create_or_throw(base + "weight_bank.dat");
+        char hex[8];
+        for (int16_t v : image.weight) {
+            std::snprintf(hex, sizeof(hex), "%X", (unsigned)v & 0x1FF);
+            fout << hex << "\n";
+        }
+    }
+
+    // spi_config_reg.txt: an address phase word (cmd 000) followed by the
+    // data phase words of its burst.
+    std::ofstream fout = create_or_throw(base + "spi_config_reg.txt");
+    fout << "// SPI format:\n"
+            "// BIT  | A[31] |  A[30:28] |  A[27:25] |  A[24:12]     |  A[11:0] |\n"
+            "// FUNC | r/w   |  cmd      |  bank_sel |  brust_len    |  addr    |\n"
+            "//      | 0/1   |           |           |  offset of -1 |          |\n"
+            "\n";
+
+    auto burst = [&](const std::string &label, uint32_t addr, const std::vector<uint32_t> &data) {
+        uint32_t word = spi_write_word(SPI_CMD_CONF_REG, 0, (uint32_t)data.size(), addr);
+        std::string bin = to_binary(word, 32);
+        fout << bin << "    // " << label << "32'b" << bin.substr(0, 4) << "_" << bin.substr(4, 3) << "_"
+             << bin.substr(7, 13) << "_" << bin.substr(20, 12) << "\n";
+        for (uint32_t v : data)
+            fout << to_binary(v, 32) << "    // " << v << "\n";
+    };
+
+    burst("SPI_EN_CONF(1-bit), config_addr: 0,      ", 0, {conf.en_conf});
+    burst("SPI_EN_FE(1-bit), config_addr: 2,        ", 2, {conf.en_fe});
+    burst("SPI_NUM_CLASS(4-bit), config_addr: 3,    ", 3, {conf.num_class});
+    burst("SPI_NUM_CLAUSE(8-bit), config_addr: 4,   ", 4, {conf.num_clause});
+    burst("SPI_NUM_SUM_TIME(6-bit), config_addr: 5, ", 5, {conf.num_sum_time});
+    burst("SPI_FLUX_TH(16-bit), config_addr: 6,     ", 6, {conf.flux_th});
+    burst("SPI_LEN_BLOCK_BANK(11-bit), config_addr: 7,  ", 7, {conf.len_block_bank});
+    // "config_addr: 8-12, " for a burst of n registers at addr
+    auto at = [](uint32_t addr, uint32_t n) {
+        return "config_addr: " + std::to_string(addr) + (n > 1 ? "-" + std::to_string(addr + n - 1) : "") + ", ";
+    };
+    burst("SPI_LEN_ROW_BANK(11-bit), " + at(CONF_ADDR_LEN_ROW_BANK, N_PE_COL), CONF_ADDR_LEN_ROW_BANK,
+          std::vector<uint32_t>(conf.len_row_bank.begin(), conf.len_row_bank.end()));
+    burst("SPI_LEN_CCL_BANK(12-bit), " + at(CONF_ADDR_LEN_CCL_BANK, N_PE_COL), CONF_ADDR_LEN_CCL_BANK,
+          std::vector<uint32_t>(conf.len_ccl_bank.begin(), conf.len_ccl_bank.end()));
+    burst("SPI_LEN_WEIGHT_BANK(11-bit), " + at(CONF_ADDR_LEN_WEIGHT_BANK, 1), CONF_ADDR_LEN_WEIGHT_BANK,
+          {conf.len_weight_bank});
+    if (conf.en_early_exit)
+        burst("SPI_EN_EARLY_EXIT(1-bit), " + at(CONF_ADDR_EN_EARLY_EXIT, 1), CONF_ADDR_EN_EARLY_EXIT,
+              {conf.en_early_exit});
+    if (conf.class_skip)
+        burst("SPI_CLASS_SKIP(16-bit), " + at(CONF_ADDR_CLASS_SKIP, 1), CONF_ADDR_CLASS_SKIP, {conf.class_skip});
+    if (conf.inf_stride > 1)
+        burst("SPI_INF_STRIDE(6-bit), " + at(CONF_ADDR_INF_STRIDE, 1), CONF_ADDR_INF_STRIDE, {conf.inf_stride});
+    if (conf.vad_th || conf.vad_class != VAD_CLASS_RESET)
+        burst("SPI_VAD_TH(12-bit), SPI_VAD_CLASS(4-bit), " + at(CONF_ADDR_VAD_TH, 2), CONF_ADDR_VAD_TH,
+              {conf.vad_th, conf.vad_class});
+
+    write_model_file(image, base + MODEL_FILE_NAME);
+}
+
+ClauseSet read_ta_include(const std::string &file_name, int num_class)
+{
+    std::ifstream fin(file_name);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file_name);
+    if (num_class <= 0)
+        throw std::runtime_error("Number of classes must be positive");
+
+    ClauseSet clause;
+    std::string line;
+    int line_no = 0;
+    while (std::getline(fin, line)) {
+        line_no++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line.compare(start, 2, "//") == 0 || line[start] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        int weight;
+        if (!(ss >> weight) || weight < -256 || weight > 255)
+            throw std::runtime_error(file_name + ":" + std::to_string(line_no) + ": expected a 9-bit weight");
+
+        std::vector<uint16_t> literal;
+        int lit;
+        while (ss >> lit) {
+            if (lit < 0 || lit >= N_ROW * 16)
+                throw std::runtime_error(file_name + ":" + std::to_string(line_no) + ": literal out of range");
+            literal.push_back((uint16_t)lit);
+        }
+        std::sort(literal.begin(), literal.end());
+        literal.erase(std::unique(literal.begin(), literal.end()), literal.end());
+
+        clause.literal.push_back(literal);
+        clause.weight.push_back((int16_t)weight);
+    }
+
+    if (clause.literal.empty() || clause.literal.size() % num_class != 0)
+        throw std::runtime_error(file_name + ": clause count is not a multiple of the class count");
+    clause.num_class  = num_class;
+    clause.num_clause = (int)clause.literal.size() / num_class;
+    return clause;
+}
+
+void write_ta_include(const std::string &file_name, const ClauseSet &clause)
+{
+    std::ofstream fout = create_or_throw(file_name);
+    fout << "// TA include list: " << clause.num_class << " classes x " << clause.num_clause << " clauses\n"
+         << "// <weight> <literal> ..., literal = ((row * 8 + col) << 1) | inv\n";
+
+    for (size_t c = 0; c < clause.literal.size(); c++) {
+        fout << clause.weight[c];
+        for (uint16_t lit : clause.literal[c])
+            fout << " " << lit;
+        fout << "\n";
+    }
+}
+
+SlotClauses place_sequential(const ClauseSet &clause, int num_sum_time)
+{
+    const int n_slot = num_sum_time * N_CLAUSE_PER_ROUND;
+    if (clause.num_clause > n_slot)
+        throw std::runtime_error(std::to_string(clause.num_clause) + " clauses per class do not fit in " +
+                                 std::to_string(num_sum_time) + " rounds");
+
+    SlotClauses slot;
+    slot.num_class    = clause.num_class;
+    slot.num_sum_time = num_sum_time;
+    slot.literal.assign(clause.num_class * n_slot, {});
+    slot.weight.assign(clause.num_class * n_slot, 0);
+
+    for (int k = 0; k < clause.num_class; k++) {
+        for (int m = 0; m < clause.num_clause; m++) {
+            slot.literal[k * n_slot + m] = clause.literal[k * clause.num_clause + m];
+            slot.weight[k * n_slot + m]  = clause.weight[k * clause.num_clause + m];
+        }
+    }
+    return slot;
+}
+
+ClauseSet gather_clauses(const SlotClauses &slot)
+{
+    ClauseSet clause;
+    clause.num_class  = slot.num_class;
+    clause.num_clause = slot.num_sum_time * N_CLAUSE_PER_ROUND;
+    clause.literal    = slot.literal;
+    clause.weight     = slot.weight;
+    return clause;
+}
+
+SlotClauses balance_ogbcsr(const ClauseSet &clause, int num_sum_time)
+{
+    const int n_slot = num_sum_time * N_CLAUSE_PER_ROUND;
+    SlotClauses seq = place_sequential(clause, num_sum_time);
+
+    // An empty clause is never enabled in the PE and keeps the patch result
+    // of the previous round, so moving one with a non-zero weight would
+    // change the class sums.
+    for (size_t c = 0; c < seq.literal.size(); c++) {
+        if (seq.literal[c].empty() && seq.weight[c] != 0)
+            throw std::runtime_error("Clause " + std::to_string(c % n_slot) + " of class " +
+                                     std::to_string(c / n_slot) + " has no include but a non-zero weight");
+    }
+
+    SlotClauses slot;
+    slot.num_class    = clause.num_class;
+    slot.num_sum_time = num_sum_time;
+    slot.literal.assign(seq.literal.size(), {});
+    slot.weight.assign(seq.weight.size(), 0);
+
+    // Bank length of every column so far: {CCL words, row words}.
+    std::array<long, N_PE_COL> len_ccl{}, len_row{};
+
+    for (int k = 0; k < clause.num_class; k++) {
+        std::vector<ClauseLoad> load(n_slot);
+        for (int m = 0; m < n_slot; m++)
+            load[m] = clause_load(seq.literal[k * n_slot + m]);
+
+        ClassBalancer balancer(load, num_sum_time);
+        balancer.run();
+
+        for (int r = 0; r < num_sum_time; r++) {
+            struct Bin {
+                Pairing pairing;
+                long    ccl = 0;
+            } bin[N_PE_COL];
+
+            for (int i = 0; i < N_PE_COL; i++) {
+                const std::vector<int> &member = balancer.member(r * N_PE_COL + i);
+                bin[i].pairing = balancer.pairing(r * N_PE_COL + i);
+                if (bin[i].pairing.row_word >= INFEASIBLE_PAIR)
+                    throw std::runtime_error("Clauses of class " + std::to_string(k) +
+                                             " cannot be paired within the ta_counter limit");
+                for (int m : member)
+                    bin[i].ccl += load[m].total;
+            }
+
+            // Largest bin to the column with the shortest banks.
+            int bin_order[N_PE_COL], col_order[N_PE_COL];
+            std::iota(bin_order, bin_order + N_PE_COL, 0);
+            std::iota(col_order, col_order + N_PE_COL, 0);
+            std::stable_sort(bin_order, bin_order + N_PE_COL, [&](int a, int b) {
+                return bin[a].ccl != bin[b].ccl ? bin[a].ccl > bin[b].ccl
+                                                : bin[a].pairing.row_word > bin[b].pairing.row_word;
+            });
+            std::stable_sort(col_order, col_order + N_PE_COL, [&](int a, int b) {
+                return len_ccl[a] != len_ccl[b] ? len_ccl[a] < len_ccl[b] : len_row[a] < len_row[b];
+            });
+
+            for (int n = 0; n < N_PE_COL; n++) {
+                const Bin &src = bin[bin_order[n]];
+                const int i = col_order[n];
+                len_ccl[i] += src.ccl;
+                len_row[i] += src.pairing.row_word;
+
+                for (int e = 0; e < N_ELEMENT; e++) {
+                    const int round = k * num_sum_time + r;
+                    const int s0 = round * N_CLAUSE_PER_ROUND + (i * N_ELEMENT + e) * 2;
+                    const auto &p = src.pairing.pair[e];
+                    slot.literal[s0]     = seq.literal[k * n_slot + p.first];
+                    slot.weight[s0]      = seq.weight[k * n_slot + p.first];
+                    slot.literal[s0 + 1] = seq.literal[k * n_slot + p.second];
+                    slot.weight[s0 + 1]  = seq.weight[k * n_slot + p.second];
+                }
+            }
+        }
+    }
+    return slot;
+}
+
+DecodeCost estimate_decode_cost(const ModelImage &image)
+{
+    const SpiConfig &conf = image.conf;
+    DecodeCost cost;
+    uint32_t raddr_row[N_PE_COL] = {0};
+
+    // Per column: the cycle its next TA matrix can be read (issue), the
+    // cycle its FIFO head moves to the next block (head), and per block the
+    // cycle it is done with the FIFO entry (entry_free, a running maximum).
+    int64_t issue[N_PE_COL], head[N_PE_COL];
+    std::vector<std::array<int64_t, N_PE_COL>> entry_free(conf.len_block_bank);
+    std::fill_n(issue, N_PE_COL, 0);
+    std::fill_n(head, N_PE_COL, 0);
+    int64_t read = -MIN_BLOCK_CYCLE;
+
+    for (uint32_t b = 0; b < conf.len_block_bank; b++) {
+        // Block read: MIN_BLOCK_CYCLE after the previous one, a free FIFO
+        // entry, and at the first block of a round, every column at its
+        // last CCL words (row_stage_ready).
+        read += MIN_BLOCK_CYCLE;
+        for (int i = 0; i < N_PE_COL; i++) {
+            if (b % N_BLOCK_PER_ROUND == 0)
+                read = std::max({read, head[i], issue[i] - 1});
+            else if (b >= (uint32_t)DEPTH_BLOCK_FIFO)
+                read = std::max(read, entry_free[b - DEPTH_BLOCK_FIFO][i]);
+        }
+
+        uint32_t max_ccl = 0;
+        for (int i = 0; i < N_PE_COL; i++) {
+            uint32_t ccl = 0;
+            int64_t cycle = std::max(read + 1, head[i]);
+            int64_t done = cycle + 1;
+            head[i] = cycle + 1;
+            for (int e = 0; e < N_ELEMENT; e++) {
+                if (!((image.block_idx[b] >> (N_ELEMENT * i + e)) & 0x1))
+                    continue;
+                uint8_t row_cnt = image.row_cnt[i][raddr_row[i]];
+                raddr_row[i] = (raddr_row[i] + 1 == conf.len_row_bank[i]) ? 0 : raddr_row[i] + 1;
+                uint32_t n_ta = (row_cnt & 0x7) + ((row_cnt >> 3) & 0x7);
+                ccl += n_ta;
+
+                // read, then N_CCL_WORD words a cycle in the next cycles
+                const int64_t x = std::max(cycle, issue[i]);
+                issue[i] = x + (n_ta + N_CCL_WORD - 1) / N_CCL_WORD;
+                head[i]  = x + 1;
+                done     = issue[i] + 2;
+                cycle    = x;
+            }
+            entry_free[b][i] = std::max(done, b > 0 ? entry_free[b - 1][i] : 0);
+            max_ccl = std::max(max_ccl, ccl);
+        }
+        cost.ccl_cycle += max_ccl;
+    }
+    cost.cycle = (conf.len_block_bank ? read : 0) + DECODE_FILL_CYCLE;
+    cost.len_row_bank = conf.len_row_bank;
+    cost.len_ccl_bank = conf.len_ccl_bank;
+    return cost;
+}
+
+} // namespace tkws
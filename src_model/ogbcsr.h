@@ -0,0 +1,128 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "ogbcsr.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: OG-BCSR encoder/decoder between clause literal lists and the model
+//       banks, and the clause-to-PE-column load balancer.
+//
+//==============================================================================
+
+#ifndef __OGBCSR_H
+#define __OGBCSR_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model_image.h"
+
+namespace tkws {
+
+// Bank depths (tsetlin_machine_accelerator.sv parameters)
+constexpr uint32_t DEPTH_BLOCK_BANK  = 2048;
+constexpr uint32_t DEPTH_ROW_BANK    = 2048;
+constexpr uint32_t DEPTH_CCL_BANK    = 4096;
+constexpr uint32_t DEPTH_WEIGHT_BANK = 2048;
+
+// ta_counter1/2 are 3 bits: at most 7 includes of a PE cluster per row.
+constexpr int MAX_ROW_TA_CNT         = 7;
+
+// Decoder cycles: a block read takes MIN_BLOCK_CYCLE (the read and its
+// SRAM wait). The block FIFOs let every PE column work through the blocks
+// of a round at its own rate, N_CCL_WORD CCL words a cycle with each TA
+// matrix rounded up, up to DEPTH_BLOCK_FIFO blocks ahead of the slowest
+// column. The first block of a round waits for every column to reach its
+// last CCL words. decoder_finish follows the last block read, whose CCL
+// words drain under tail_flush_en, so the last block only costs
+// DECODE_FILL_CYCLE (its read and decoder_finish).
+constexpr int MIN_BLOCK_CYCLE        = 2;
+constexpr int DECODE_FILL_CYCLE      = 2;
+
+// Literal index, shared with the CTM model: ((row * 8 + col) << 1) | inv,
+// col 0 being the position literal and col 1-7 the 58-patch windows.
+inline int literal_row(uint16_t lit) { return lit >> 4; }
+inline int literal_col(uint16_t lit) { return (lit >> 1) & 0x7; }
+inline int literal_inv(uint16_t lit) { return lit & 0x1; }
+
+// Clauses in PE slot order: clause [round * N_CLAUSE_PER_ROUND + slot], with
+// slot = (col * 4 + element) * 2 + clause_index and round = class *
+// num_sum_time + sum_time.
+struct SlotClauses {
+    int                                 num_class       = 0;
+    int                                 num_sum_time    = 0;
+    std::vector<std::vector<uint16_t>>  literal;
+    std::vector<int16_t>                weight;
+};
+
+// Clauses of a trained model, class-major (class k clause m at
+// [k * num_clause + m]), as read from a TA include file.
+struct ClauseSet {
+    int                                 num_class       = 0;
+    int                                 num_clause      = 0;
+    std::vector<std::vector<uint16_t>>  literal;
+    std::vector<int16_t>                weight;
+};
+
+// Walk the banks in the ogbcsr_decoder.sv order.
+SlotClauses decode_ogbcsr(const ModelImage &image);
+
+// Build the banks and the length registers. conf supplies the remaining
+// registers (SPI_EN_*, SPI_FLUX_TH). Throws if a bank or ta_counter
+// would overflow.
+ModelImage encode_ogbcsr(const SlotClauses &slot, const SpiConfig &conf);
+
+// Write spi_config_reg.txt, all bank files in the model/ format and the
+// packed model.tkm.
+void write_model_dir(const ModelImage &image, const std::string &dir);
+
+// Read a TA include file: one clause per line, class-major,
+// "<weight> <literal> <literal> ...".
+ClauseSet read_ta_include(const std::string &file_name, int num_class);
+
+// Write the clauses of a model in the TA include file format.
+void write_ta_include(const std::string &file_name, const ClauseSet &clause);
+
+// Slot order <-> class-major order. Slots of a class are taken in order.
+SlotClauses place_sequential(const ClauseSet &clause, int num_sum_time);
+ClauseSet   gather_clauses(const SlotClauses &slot);
+
+// Assign clauses to rounds, PE columns and PE clusters so that the
+// slowest column of every block and the longest bank are as short as
+// possible. Class sums are unchanged.
+SlotClauses balance_ogbcsr(const ClauseSet &clause, int num_sum_time);
+
+// Expected ogbcsr_decoder cycles (decode_en high) for one inference, see
+// MIN_BLOCK_CYCLE: the block reads are scheduled column by column. Matches
+// the cycle-level model in perf_model.h.
+struct DecodeCost {
+    uint64_t                        cycle           = 0;
+    uint64_t                        ccl_cycle       = 0;    // sum of the busiest-column CCL words
+    std::array<uint32_t, N_PE_COL>  len_row_bank{};
+    std::array<uint32_t, N_PE_COL>  len_ccl_bank{};
+};
+
+DecodeCost estimate_decode_cost(const ModelImage &image);
+
+} // namespace tkws
+
+#endif
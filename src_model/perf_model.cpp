@@ -0,0 +1,598 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "perf_model.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Every cycle first evaluates the combinational signals from the
+//       current registers, then computes the next value of every register,
+//       following the always_comb / always_ff blocks of the RTL. The SRAMs
+//       are modelled as 1-cycle synchronous reads holding their output.
+//
+//==============================================================================
+
+#include "perf_model.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace tkws {
+
+namespace {
+
+constexpr int ADDR_MASK_BLOCK   = 2048 - 1;     // $clog2(DEPTH_BLOCK_BANK) bits
+constexpr int ADDR_MASK_ROW     = 2048 - 1;
+constexpr int ADDR_MASK_CCL     = 4096 - 1;
+constexpr int ADDR_MASK_WEIGHT  = 2048 - 1;
+constexpr uint32_t FIFO_PTR_MASK = 2 * DEPTH_BLOCK_FIFO - 1;   // one wrap bit
+
+// Abort a run that never reaches Inf_Done (inconsistent length registers).
+constexpr uint64_t MAX_CYCLE    = 1ULL << 24;
+
+enum TmaState { TMA_IDLE, TMA_INFERENCE, TMA_WAIT_FINISH };
+
+struct Reg {
+    // tma_controller
+    TmaState    state                       = TMA_IDLE;
+
+    // SRAM outputs
+    uint32_t    block_idx_data              = 0;
+    uint8_t     row_cnt_data[N_PE_COL]      = {};
+    uint32_t    ccl_data[N_PE_COL]          = {};     // N_CCL_WORD words
+    int16_t     weight_data                 = 0;
+    uint64_t    feature_bank_rdata          = 0;
+
+    // ogbcsr_decoder, block stage and block FIFOs
+    uint32_t    raddr_block                 = 0;
+    bool        block_wait_sram             = false;
+    uint8_t     block_fifo[N_PE_COL][DEPTH_BLOCK_FIFO] = {};
+    uint32_t    fifo_wptr                   = 0;
+    uint32_t    fifo_rptr[N_PE_COL]         = {};
+    uint8_t     block_done[N_PE_COL]        = {};
+    uint32_t    block_class                 = 0;
+    uint32_t    class_block_cnt             = 0;
+
+    // ogbcsr_decoder, row stage
+    uint32_t    raddr_row[N_PE_COL]         = {};
+    uint8_t     code_row_stage[N_PE_COL]    = {};
+    uint32_t    slot_row_stage[N_PE_COL]    = {};
+    bool        row_ren_d1[N_PE_COL]        = {};
+    uint8_t     ta_counter1_int[N_PE_COL]   = {};
+    uint8_t     ta_counter2_int[N_PE_COL]   = {};
+
+    // ogbcsr_decoder, column and clause index stage
+    uint32_t    raddr_ccl[N_PE_COL]         = {};     // word pointer
+    uint8_t     code_ccl_stage[N_PE_COL]    = {};
+    uint32_t    slot_ccl_stage[N_PE_COL]    = {};
+    uint8_t     ccl_valid[N_PE_COL]         = {};     // one bit per lane
+    bool        ccl_line_hit[N_PE_COL]      = {};
+    uint32_t    ccl_line_hold[N_PE_COL]     = {};
+    uint8_t     ccl_word_ofs_d1[N_PE_COL]   = {};
+    bool        ccl_straddle_d1[N_PE_COL]   = {};
+
+    // distributor
+    uint32_t    row_index                   = 0;
+    bool        r_ctrl_cnt                  = false;
+    bool        wait_sram                   = false;
+    uint64_t    feature_row[DEPTH_BLOCK_FIFO][2]  = {};
+    uint64_t    position[DEPTH_BLOCK_FIFO][2]     = {};
+    bool        w_ctrl_cnt                  = false;
+    uint32_t    spad_w_slot                 = 0;
+    bool        block_read_flag             = false;
+    bool        next_clause_flag_r          = false;
+    bool        next_clause_flag_c          = false;
+    bool        next_clause_flag_c_d1       = false;
+    bool        col_handshaking_d1[N_PE_COL]= {};
+    bool        next_clause_last_flag       = false;
+    uint8_t     next_clause_to_pe[N_PE_COL] = {};     // 0xFF at reset, see Reg()
+    uint8_t     row_spad_index_d1[N_PE_COL] = {};     // one bit per lane
+
+    // pe_array: [column][clause_index][element]
+    uint64_t    pand[N_PE_COL][2][N_ELEMENT]    = {};
+    bool        patch[N_PE_COL][2][N_ELEMENT]   = {};
+
+    // summation
+    bool        clause_sat[2][N_PE_CLUSTER] = {};
+    uint32_t    summation_cnt               = 0;
+    bool        one_class_done              = false;
+    uint32_t    class_idx                   = 0;
+    bool        read_weight_flag            = false;
+    uint32_t    clause_cnt                  = 0;
+    uint32_t    raddr_weight                = 0;
+    bool        ren_weight_d1               = false;
+    int16_t     class_summation             = 0;
+
+    // argmax
+    int16_t     max_summation               = -8192;
+    uint32_t    max_class                   = 0;
+    bool        argmax_done                 = false;
+    uint32_t    result                      = 0;
+    bool        early_exit                  = false;
+
+    Reg() { std::fill_n(next_clause_to_pe, N_PE_COL, 0xFF); }
+};
+
+inline int16_t wrap14(int32_t v)
+{
+    v &= 0x3FFF;
+    return (int16_t)((v & 0x2000) ? v - 0x4000 : v);
+}
+
+// Priority encoder of the block stage: index of the lowest set bit.
+inline uint8_t lowest_bit(uint8_t v)
+{
+    for (uint8_t k = 0; k < N_ELEMENT; k++) {
+        if ((v >> k) & 0x1)
+            return k;
+    }
+    return 0;
+}
+
+template <typename T>
+inline T read_bank(const std::vector<T> &bank, uint32_t addr)
+{
+    return addr < bank.size() ? bank[addr] : T(0);
+}
+
+// Line of the CCL bank, word j at bits 5j.
+inline uint32_t read_ccl_line(const std::vector<uint8_t> &bank, uint32_t line)
+{
+    uint32_t data = 0;
+    for (int j = 0; j < N_CCL_WORD; j++)
+        data |= (uint32_t)read_bank(bank, line * N_CCL_WORD + j) << (CCL_IDX_BITS * j);
+    return data;
+}
+
+} // namespace
+
+double PerfStats::pe_utilization() const
+{
+    uint64_t busy = 0;
+    for (uint64_t b : col_busy)
+        busy += b;
+    return cycle ? (double)busy / ((double)cycle * N_PE_COL) : 0.0;
+}
+
+PerfModel::PerfModel(const ModelImage &image)
+    : image_(image), class_bound_(class_bounds(image)), class_start_(class_starts(image)),
+      class_en_(class_enable(image.conf))
+{
+    const SpiConfig &conf = image.conf;
+
+    if (conf.num_class == 0 || conf.num_sum_time == 0)
+        throw std::runtime_error("SPI_NUM_CLASS and SPI_NUM_SUM_TIME must be non-zero");
+    if (conf.len_block_bank == 0 || conf.len_block_bank % N_BLOCK_PER_ROUND != 0)
+        throw std::runtime_error("SPI_LEN_BLOCK_BANK must be a non-zero multiple of 32");
+    if (conf.len_block_bank / N_BLOCK_PER_ROUND != conf.num_class * conf.num_sum_time)
+        throw std::runtime_error("SPI_LEN_BLOCK_BANK does not match SPI_NUM_CLASS * SPI_NUM_SUM_TIME");
+}
+
+PerfStats PerfModel::run(const FeatureWindow &window) const
+{
+    const SpiConfig &conf = image_.conf;
+    const uint32_t class_len_block  = N_BLOCK_PER_ROUND * conf.num_sum_time;
+    const uint32_t class_len_weight = N_CLAUSE_PER_ROUND * conf.num_sum_time;
+    uint32_t first_class = 0, last_class = 0;
+    for (uint32_t c = conf.num_class; c-- > 0;) {
+        if ((class_en_ >> c) & 0x1)
+            first_class = c;
+    }
+    for (uint32_t c = 0; c < conf.num_class; c++) {
+        if ((class_en_ >> c) & 0x1)
+            last_class = c;
+    }
+    PerfStats stats;
+    Reg q;
+
+    for (uint64_t t = 0;; t++) {
+        if (t == MAX_CYCLE)
+            throw std::runtime_error("Inference did not finish, check the bank length registers");
+
+        Reg d = q;
+
+        //---------------------------------------------------------------------
+        // Combinational signals
+        //---------------------------------------------------------------------
+        const bool fe_complete   = (t == 0);
+        const bool decode_en     = (q.state == TMA_INFERENCE);
+        const bool tail_flush_en = (q.state == TMA_WAIT_FINISH);
+        const bool inf_done      = (tail_flush_en && q.argmax_done) || (decode_en && q.early_exit);
+
+        // ogbcsr_decoder
+        uint8_t block_comb[N_PE_COL], code_block[N_PE_COL];
+        uint8_t ta_counter1[N_PE_COL], ta_counter2[N_PE_COL];
+        bool block_valid[N_PE_COL], ready_sub[N_PE_COL], row_valid[N_PE_COL];
+        bool ren_row[N_PE_COL], fifo_pop[N_PE_COL];
+        uint8_t row_spad_index[N_PE_COL], ccl_word_ofs[N_PE_COL], lane_num[N_PE_COL];
+        bool ccl_straddle[N_PE_COL], ren_ccl[N_PE_COL];
+        bool round_ready = true, fifo_ready = true;
+        bool pipe_idle = !q.block_wait_sram;
+
+        for (int i = 0; i < N_PE_COL; i++) {
+            // The head of the FIFO, bypassed from the bank as it is written.
+            const bool head_arriving = q.block_wait_sram && q.fifo_rptr[i] == q.fifo_wptr;
+            const bool fifo_empty    = !q.block_wait_sram && q.fifo_rptr[i] == q.fifo_wptr;
+            const uint8_t head       = head_arriving ? (q.block_idx_data >> (N_ELEMENT * i)) & 0xF
+                                                     : q.block_fifo[i][q.fifo_rptr[i] % DEPTH_BLOCK_FIFO];
+            block_comb[i]  = fifo_empty ? 0 : head & ~q.block_done[i];
+            code_block[i]  = lowest_bit(block_comb[i]);
+            block_valid[i] = block_comb[i] != 0;
+
+            ta_counter1[i] = q.row_ren_d1[i] ? (q.row_cnt_data[i] & 0x7) : q.ta_counter1_int[i];
+            ta_counter2[i] = q.row_ren_d1[i] ? ((q.row_cnt_data[i] >> 3) & 0x7) : q.ta_counter2_int[i];
+
+            // Up to N_CCL_WORD lanes, fewer at the end of a line not held.
+            const int c1 = ta_counter1[i], c2 = ta_counter2[i];
+            ccl_word_ofs[i]        = q.raddr_ccl[i] % N_CCL_WORD;
+            const int lane_max     = q.ccl_line_hit[i] ? N_CCL_WORD : N_CCL_WORD - ccl_word_ofs[i];
+            const bool almost_done = (c1 + c2 <= lane_max);
+            const bool forwarding  = (c1 + c2 <= lane_max + N_CCL_WORD);
+
+            ready_sub[i]      = almost_done;    // col_clause_stage_ready is always 1
+            row_valid[i]      = (c1 != 0) || (c2 != 0);
+            ren_row[i]        = block_valid[i] && ready_sub[i];
+            fifo_pop[i]       = !fifo_empty && (block_comb[i] == 0 ||
+                                                (ren_row[i] && (block_comb[i] & (block_comb[i] - 1)) == 0));
+            pipe_idle         = pipe_idle && fifo_empty && !q.row_ren_d1[i] && c1 == 0 && c2 == 0 &&
+                                !q.ccl_valid[i];
+
+            // Entries still needed by the column, down to the one in its PE
+            // stage: the block read must not overwrite the oldest.
+            const uint32_t oldest = q.ccl_valid[i] ? q.slot_ccl_stage[i] :
+                                    row_valid[i]   ? q.slot_row_stage[i] : q.fifo_rptr[i];
+            fifo_ready  = fifo_ready && ((q.fifo_wptr - oldest) & FIFO_PTR_MASK) < DEPTH_BLOCK_FIFO;
+            round_ready = round_ready && fifo_empty && forwarding;
+
+            lane_num[i]       = row_valid[i] ? std::min(c1 + c2, lane_max) : 0;
+            ccl_straddle[i]   = ccl_word_ofs[i] + lane_num[i] > N_CCL_WORD;
+            ren_ccl[i]        = row_valid[i] && (!q.ccl_line_hit[i] || ccl_straddle[i]);
+            row_spad_index[i] = 0;
+            for (int j = c1; j < N_CCL_WORD; j++)
+                row_spad_index[i] |= 1u << j;
+        }
+
+        // Class skip: hold the block stage at the first block of a disabled
+        // class, then jump once the row and CCL stages have drained.
+        const bool class_skip       = decode_en && q.class_block_cnt == 0 &&
+                                      (q.block_class == conf.num_class || !((class_en_ >> q.block_class) & 0x1));
+        const bool class_skip_en    = class_skip && q.block_class != conf.num_class && pipe_idle;
+        const bool class_skip_last  = class_skip_en && q.block_class + 1 == conf.num_class;
+
+        // The first block of a round waits for every column to finish the
+        // previous round, the others only for a free FIFO entry.
+        const bool row_stage_ready   = (q.class_block_cnt % N_BLOCK_PER_ROUND == 0) ? round_ready : fifo_ready;
+        const bool block_stage_ready = !q.block_wait_sram && row_stage_ready && !class_skip;
+        const bool ren_block         = decode_en && block_stage_ready;
+        const bool decoder_finish    = decode_en && q.raddr_block == conf.len_block_bank;
+
+        // distributor
+        const bool feature_bank_ren  = ren_block || q.r_ctrl_cnt;
+        const bool next_clause_flag  = q.next_clause_flag_c || q.next_clause_last_flag;
+        const bool summation_ena     = q.next_clause_flag_c_d1 || q.next_clause_last_flag;
+
+        bool col_handshaking = false, ccl_addr_zero = true, any_busy = false;
+        for (int i = 0; i < N_PE_COL; i++) {
+            col_handshaking = col_handshaking || q.col_handshaking_d1[i];
+            ccl_addr_zero   = ccl_addr_zero && q.raddr_ccl[i] == 0;
+            any_busy        = any_busy || q.ccl_valid[i];
+        }
+        const bool update_last_clause_flag = col_handshaking && ccl_addr_zero;
+
+        // summation
+        const bool ren_weight = q.read_weight_flag && q.clause_cnt < 2 * N_PE_CLUSTER &&
+                                q.clause_sat[q.clause_cnt & 0x1][q.clause_cnt >> 1];
+
+        //---------------------------------------------------------------------
+        // Statistics
+        //---------------------------------------------------------------------
+        if (inf_done) {
+            stats.result.result = (int)q.result;
+            stats.early_exit    = q.early_exit;
+            break;
+        }
+        if (decode_en || tail_flush_en) {
+            stats.cycle++;
+            stats.decode_cycle += decode_en;
+            stats.tail_cycle   += tail_flush_en;
+            stats.block_stall  += decode_en && !q.block_wait_sram && !row_stage_ready;
+            stats.round_stall  += decode_en && !q.block_wait_sram && !row_stage_ready &&
+                                  q.class_block_cnt % N_BLOCK_PER_ROUND == 0;
+            stats.idle_cycle   += !any_busy;
+            stats.block_read   += ren_block;
+            for (int i = 0; i < N_PE_COL; i++)
+                stats.ccl_read += ren_ccl[i];
+            stats.summation    += summation_ena;
+            stats.summation_cycle += q.read_weight_flag;
+            stats.weight_read  += ren_weight;
+            for (int i = 0; i < N_PE_COL; i++) {
+                stats.col_busy[i]  += q.ccl_valid[i] != 0;
+                stats.col_wait[i]  += !q.ccl_valid[i] && any_busy;
+            }
+        }
+        if (q.one_class_done)
+            stats.result.class_sum.push_back(q.class_summation);
+
+        //---------------------------------------------------------------------
+        // tma_controller
+        //---------------------------------------------------------------------
+        if (q.state == TMA_IDLE && fe_complete)              d.state = TMA_INFERENCE;
+        else if (q.state == TMA_INFERENCE && q.early_exit)   d.state = TMA_IDLE;
+        else if (q.state == TMA_INFERENCE && decoder_finish) d.state = TMA_WAIT_FINISH;
+        else if (q.state == TMA_WAIT_FINISH && q.argmax_done) d.state = TMA_IDLE;
+
+        //---------------------------------------------------------------------
+        // ogbcsr_decoder and the model banks
+        //---------------------------------------------------------------------
+        if (ren_block) {
+            d.raddr_block    = (q.raddr_block + 1) & ADDR_MASK_BLOCK;
+            d.block_idx_data = read_bank(image_.block_idx, q.raddr_block);
+        } else if (class_skip_en) {
+            d.raddr_block = (q.raddr_block + class_len_block) & ADDR_MASK_BLOCK;
+        } else if (q.raddr_block == conf.len_block_bank) {
+            d.raddr_block = 0;
+        }
+        d.block_wait_sram = ren_block;
+        if (q.block_wait_sram)
+            d.fifo_wptr = (q.fifo_wptr + 1) & FIFO_PTR_MASK;
+
+        if (!decode_en) {
+            d.block_class     = 0;
+            d.class_block_cnt = 0;
+        } else if (ren_block && q.class_block_cnt + 1 == class_len_block) {
+            d.block_class     = (q.block_class + 1) & 0xF;
+            d.class_block_cnt = 0;
+        } else if (ren_block) {
+            d.class_block_cnt = (q.class_block_cnt + 1) & ADDR_MASK_BLOCK;
+        } else if (class_skip_en) {
+            d.block_class     = (q.block_class + 1) & 0xF;
+        }
+        const ClassStart *next_start = class_skip_en && !class_skip_last ? &class_start_[q.block_class + 1] : nullptr;
+
+        for (int i = 0; i < N_PE_COL; i++) {
+            if (q.block_wait_sram)
+                d.block_fifo[i][q.fifo_wptr % DEPTH_BLOCK_FIFO] = (q.block_idx_data >> (N_ELEMENT * i)) & 0xF;
+
+            if (fifo_pop[i]) {
+                d.fifo_rptr[i]  = (q.fifo_rptr[i] + 1) & FIFO_PTR_MASK;
+                d.block_done[i] = 0;
+            } else if (ren_row[i]) {
+                d.block_done[i] = q.block_done[i] | (1u << code_block[i]);
+            }
+
+            if (ready_sub[i]) {
+                d.code_row_stage[i] = code_block[i];
+                d.slot_row_stage[i] = q.fifo_rptr[i];
+            }
+
+            if (ren_row[i]) {
+                d.raddr_row[i]    = (q.raddr_row[i] + 1) & ADDR_MASK_ROW;
+                d.row_cnt_data[i] = read_bank(image_.row_cnt[i], q.raddr_row[i]);
+            } else if (class_skip_en) {
+                d.raddr_row[i] = next_start ? next_start->row[i] & ADDR_MASK_ROW : 0;
+            } else if (q.raddr_row[i] == conf.len_row_bank[i]) {
+                d.raddr_row[i] = 0;
+            }
+            d.row_ren_d1[i] = ren_row[i];
+
+            // the lanes take cnt1 first
+            const uint8_t take1 = std::min(lane_num[i], ta_counter1[i]);
+            d.ta_counter1_int[i] = ta_counter1[i] - take1;
+            d.ta_counter2_int[i] = ta_counter2[i] - (lane_num[i] - take1);
+
+            if (ren_ccl[i]) {
+                const uint32_t line = q.raddr_ccl[i] / N_CCL_WORD + q.ccl_line_hit[i];
+                d.ccl_data[i] = read_ccl_line(image_.col_clause_idx[i], line);
+                if (ccl_straddle[i])
+                    d.ccl_line_hold[i] = q.ccl_data[i];
+            }
+            if (row_valid[i]) {
+                d.raddr_ccl[i]    = (q.raddr_ccl[i] + lane_num[i]) & ADDR_MASK_CCL;
+                d.ccl_line_hit[i] = (q.raddr_ccl[i] + lane_num[i]) % N_CCL_WORD != 0;
+            } else if (class_skip_en) {
+                d.raddr_ccl[i]    = next_start ? next_start->ccl[i] & ADDR_MASK_CCL : 0;
+                d.ccl_line_hit[i] = false;
+            } else if (q.raddr_ccl[i] == conf.len_ccl_bank[i]) {
+                d.raddr_ccl[i]    = 0;
+                d.ccl_line_hit[i] = false;
+            }
+            d.code_ccl_stage[i]  = q.code_row_stage[i];
+            d.slot_ccl_stage[i]  = q.slot_row_stage[i];
+            d.ccl_valid[i]       = (uint8_t)((1u << lane_num[i]) - 1);
+            d.ccl_word_ofs_d1[i] = ccl_word_ofs[i];
+            d.ccl_straddle_d1[i] = ccl_straddle[i];
+        }
+
+        //---------------------------------------------------------------------
+        // distributor
+        //---------------------------------------------------------------------
+        if (ren_block && !q.r_ctrl_cnt) {
+            d.row_index  = (q.row_index + 1) % N_ROW;
+            d.r_ctrl_cnt = true;
+        } else if (q.r_ctrl_cnt) {
+            d.row_index  = (q.row_index + 1) % N_ROW;
+            d.r_ctrl_cnt = false;
+        }
+        if (feature_bank_ren)
+            d.feature_bank_rdata = window[q.row_index];
+        d.wait_sram = feature_bank_ren;
+
+        // The rows of a block go to its FIFO entry, with the position rows:
+        // row_index is the first row of the block + 1 at its first word.
+        if (q.wait_sram) {
+            const uint32_t slot = q.spad_w_slot % DEPTH_BLOCK_FIFO;
+            d.feature_row[slot][q.w_ctrl_cnt] = q.feature_bank_rdata;
+            if (!q.w_ctrl_cnt) {
+                const uint64_t pos = q.row_index < 64 ? (PATCH_MASK << q.row_index) & PATCH_MASK : 0;
+                d.position[slot][0] = pos;
+                d.position[slot][1] = (pos << 1) & PATCH_MASK;
+            }
+            d.w_ctrl_cnt = !q.w_ctrl_cnt;
+            if (q.w_ctrl_cnt)
+                d.spad_w_slot = (q.spad_w_slot + 1) % DEPTH_BLOCK_FIFO;
+        }
+
+        if (!decode_en)
+            d.block_read_flag = false;
+        else if (block_stage_ready)
+            d.block_read_flag = true;
+
+        d.next_clause_flag_r    = ren_block && q.row_index == 0 && q.block_read_flag;
+        d.next_clause_flag_c    = q.next_clause_flag_r;
+        d.next_clause_flag_c_d1 = q.next_clause_flag_c;
+        d.next_clause_last_flag = update_last_clause_flag || class_skip_last;
+
+        //---------------------------------------------------------------------
+        // distributor -> pe_array
+        //---------------------------------------------------------------------
+        for (int i = 0; i < N_PE_COL; i++) {
+            d.col_handshaking_d1[i] = q.ccl_valid[i] & 0x1;
+            if (row_valid[i])
+                d.row_spad_index_d1[i] = row_spad_index[i];
+
+            // The lanes of both clauses of the element, each ANDed in once.
+            const int code = q.code_ccl_stage[i];
+            const uint64_t window = ((uint64_t)q.ccl_data[i] << (CCL_IDX_BITS * N_CCL_WORD)) |
+                                    (q.ccl_straddle_d1[i] ? q.ccl_line_hold[i] : q.ccl_data[i]);
+            bool hit[2] = {false, false};
+            uint64_t lit_and[2] = {PATCH_MASK, PATCH_MASK};
+
+            for (int j = 0; j < N_CCL_WORD; j++) {
+                if (!((q.ccl_valid[i] >> j) & 0x1))
+                    continue;
+                const uint32_t ccl      = (window >> (CCL_IDX_BITS * (q.ccl_word_ofs_d1[i] + j))) & 0x1F;
+                const int clause_index  = (ccl >> 4) & 0x1;
+                const int spad          = (q.row_spad_index_d1[i] >> j) & 0x1;
+                const int slot          = q.slot_ccl_stage[i] % DEPTH_BLOCK_FIFO;
+                const uint64_t row      = q.feature_row[slot][spad];
+                const int col           = ccl & 0x7;
+                uint64_t lit            = (col == 0) ? q.position[slot][spad] : (row >> (col - 1)) & PATCH_MASK;
+                if ((ccl >> 3) & 0x1)
+                    lit = ~lit & PATCH_MASK;
+
+                hit[clause_index]     = true;
+                lit_and[clause_index] &= lit;
+                if (!next_clause_flag)
+                    d.next_clause_to_pe[i] &= ~(1u << ((code << 1) | clause_index));
+            }
+            if (next_clause_flag)
+                d.next_clause_to_pe[i] = 0xFF;
+
+            for (int c = 0; c < 2; c++) {
+                if (!hit[c])
+                    continue;
+                const bool next_clause_sel = (q.next_clause_to_pe[i] >> ((code << 1) | c)) & 0x1;
+                const uint64_t pand = next_clause_sel ? lit_and[c] : lit_and[c] & q.pand[i][c][code];
+                d.pand[i][c][code]  = pand;
+                d.patch[i][c][code] = pand != 0;
+            }
+        }
+
+        //---------------------------------------------------------------------
+        // summation and argmax
+        //---------------------------------------------------------------------
+        if (summation_ena) {
+            for (int i = 0; i < N_PE_COL; i++) {
+                for (int e = 0; e < N_ELEMENT; e++) {
+                    d.clause_sat[0][i * N_ELEMENT + e] = q.patch[i][0][e];
+                    d.clause_sat[1][i * N_ELEMENT + e] = q.patch[i][1][e];
+                }
+            }
+        }
+
+        if (q.clause_cnt == 2 * N_PE_CLUSTER - 1)
+            d.summation_cnt = (q.summation_cnt + 1) & 0x3F;
+        else if (q.summation_cnt == conf.num_sum_time)
+            d.summation_cnt = 0;
+
+        d.one_class_done = (decode_en || tail_flush_en) && q.summation_cnt == conf.num_sum_time;
+
+        // step over the disabled classes and their weights
+        const bool class_step = (decode_en || tail_flush_en) && !q.one_class_done && q.class_idx < conf.num_class &&
+                                !((class_en_ >> q.class_idx) & 0x1);
+
+        if (q.one_class_done)
+            d.class_idx = (q.class_idx + 1) & 0xF;
+        else if (q.class_idx == conf.num_class || !(decode_en || tail_flush_en))
+            d.class_idx = 0;
+        else if (class_step)
+            d.class_idx = q.class_idx + 1;
+
+        if (summation_ena)
+            d.read_weight_flag = true;
+        else if (q.clause_cnt == 2 * N_PE_CLUSTER - 1)
+            d.read_weight_flag = false;
+
+        d.clause_cnt = q.read_weight_flag ? (q.clause_cnt + 1) & 0x3F : 0;
+
+        if (q.read_weight_flag)
+            d.raddr_weight = (q.raddr_weight + 1) & ADDR_MASK_WEIGHT;
+        else if (q.raddr_weight == conf.len_weight_bank || !(decode_en || tail_flush_en))
+            d.raddr_weight = 0;
+        else if (class_step)
+            d.raddr_weight = (q.raddr_weight + class_len_weight) & ADDR_MASK_WEIGHT;
+
+        if (ren_weight)
+            d.weight_data = read_bank(image_.weight, q.raddr_weight);
+        d.ren_weight_d1 = ren_weight;
+
+        if (q.ren_weight_d1)
+            d.class_summation = wrap14(q.class_summation + q.weight_data);
+        else if (q.one_class_done)
+            d.class_summation = 0;
+
+        // argmax_ena = one_class_done; early exit once the leader reaches the
+        // bound of every remaining class
+        const bool     lead       = q.class_summation > q.max_summation;
+        const int16_t  lead_sum   = lead ? q.class_summation : q.max_summation;
+        int16_t        rest_bound = -8192;
+        for (uint32_t j = q.class_idx + 1; j < conf.num_class && j < class_bound_.size(); j++) {
+            if ((class_en_ >> j) & 0x1)
+                rest_bound = std::max(rest_bound, class_bound_[j]);
+        }
+        const bool exit_hit = conf.en_early_exit && q.one_class_done && q.class_idx < last_class &&
+                              lead_sum >= rest_bound;
+
+        if (q.one_class_done && q.class_summation > q.max_summation) {
+            d.max_summation = q.class_summation;
+            d.max_class     = q.class_idx;
+        } else if (q.argmax_done) {
+            d.max_summation = -8192;
+            d.max_class     = 0;
+        }
+
+        if (q.one_class_done && q.class_idx == last_class) {
+            d.argmax_done = true;
+            d.result      = (q.class_summation > q.max_summation) ? q.class_idx : q.max_class;
+        } else if (exit_hit) {
+            d.argmax_done = true;
+            d.result      = lead ? q.class_idx : q.max_class;
+        } else if (q.one_class_done && q.class_idx == first_class) {
+            d.argmax_done = false;
+            d.result      = 0;
+        }
+        d.early_exit = exit_hit;
+
+        q = d;
+    }
+
+    return stats;
+}
+
+} // namespace tkws
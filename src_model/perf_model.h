@@ -0,0 +1,101 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "perf_model.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Cycle-level model of the Tsetlin Machine accelerator datapath
+//       (tma_controller, ogbcsr_decoder, distributor, pe_array, summation
+//       and argmax), register for register.
+//
+//==============================================================================
+
+#ifndef __PERF_MODEL_H
+#define __PERF_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "ctm_model.h"
+#include "model_image.h"
+
+namespace tkws {
+
+// System clock of the accelerator (clock_div_40m_2_400k.v).
+constexpr double SYS_CLK_HZ = 400e3;
+
+struct PerfStats {
+    // Cycles from fe_complete to Inf_Done, i.e. the cycles with decode_en
+    // or tail_flush_en set. decode_cycle + tail_cycle = cycle. With early
+    // exit, Inf_Done can come during decode_en.
+    uint64_t                        cycle           = 0;
+    uint64_t                        decode_cycle    = 0;
+    uint64_t                        tail_cycle      = 0;
+
+    // Cycles with the block stage stalled by the row stage (row_stage_ready
+    // low) while decoding: a block FIFO full, or at the first block of a
+    // round (round_stall), a column not done with the previous round.
+    // Cycles with no PE column enabled.
+    uint64_t                        block_stall     = 0;
+    uint64_t                        round_stall     = 0;
+    uint64_t                        idle_cycle      = 0;
+
+    // Per PE column: cycles with pe_ena set, and cycles spent idle while
+    // another column is busy.
+    std::array<uint64_t, N_PE_COL>  col_busy{};
+    std::array<uint64_t, N_PE_COL>  col_wait{};
+
+    uint64_t                        block_read      = 0;
+    uint64_t                        ccl_read        = 0;    // CCL bank lines, all columns
+    uint64_t                        summation       = 0;    // summation_ena pulses
+    uint64_t                        summation_cycle = 0;    // summation_busy cycles, the rounds walked
+    uint64_t                        weight_read     = 0;    // satisfied clauses
+
+    CtmResult                       result;                 // class sums at argmax_ena
+    bool                            early_exit      = false;
+
+    // Busy cycles of all PE columns over the cycles of the inference.
+    double pe_utilization() const;
+    double latency_ms(double clk_hz = SYS_CLK_HZ) const { return 1e3 * (double)cycle / clk_hz; }
+};
+
+class PerfModel {
+public:
+    explicit PerfModel(const ModelImage &image);
+
+    // Run one inference on a feature window, from the fe_complete pulse to
+    // Inf_Done. The timing does not depend on the window unless
+    // SPI_EN_EARLY_EXIT is set; the class sums come out of the modelled PE
+    // array and summation datapath, and stop at the deciding class on an
+    // early exit. The classes skipped by SPI_CLASS_SKIP produce no class
+    // sum.
+    PerfStats run(const FeatureWindow &window) const;
+
+private:
+    ModelImage              image_;
+    std::vector<int16_t>    class_bound_;
+    std::vector<ClassStart> class_start_;
+    uint32_t                class_en_;
+};
+
+} // namespace tkws
+
+#endif
@@ -0,0 +1,225 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_eval.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Evaluate a model on a directory of WAV clips with the feature
+//       extractor and CTM golden models, sharding the clips over a
+//       work-stealing thread pool. Reports the per-class accuracy, the
+//       confusion matrix and the throughput.
+//
+//       The dataset is laid out as in Speech Commands, dataset/<label>/*.wav.
+//       Labels outside the keyword list count as "unknown", and
+//       _background_noise_ is skipped. With -L, only the clips of a list
+//       file (e.g. testing_list.txt, one <label>/<file>.wav per line) are used.
+//
+//       Usage: tkws_eval [-m model_dir] [-t twiddle_dir] [-j n_thread]
+//                        [-l n_lead] [-L list.txt] dataset_dir
+//
+//==============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ctm_model.h"
+#include "fe_model.h"
+#include "work_pool.h"
+
+namespace fs = std::filesystem;
+
+// Same class order as label[] in src_sw/main_codec.c.
+static const char *const LABEL[] = {"yes", "no", "up", "down", "left", "right", "on", "off",
+                                    "stop", "go", "silence", "unknown"};
+static const int N_LABEL = sizeof(LABEL) / sizeof(LABEL[0]);
+static const int LABEL_SILENCE = 10;
+static const int LABEL_UNKNOWN = 11;
+
+// Clips per work item: one CTM batch after featurizing them.
+static const size_t CLIP_GRAIN = 16;
+
+struct Clip {
+    std::string path;
+    int         label;
+};
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: tkws_eval [-m model_dir] [-t twiddle_dir] [-j n_thread]\n"
+                         "                 [-l n_lead] [-L list.txt] dataset_dir\n");
+}
+
+static int label_index(const std::string &name)
+{
+    for (int k = 0; k < N_LABEL; k++) {
+        if (name == LABEL[k])
+            return k;
+    }
+    return (name == "_silence_") ? LABEL_SILENCE : LABEL_UNKNOWN;
+}
+
+static std::vector<Clip> scan_dataset(const std::string &dir)
+{
+    std::vector<Clip> clip;
+
+    for (const fs::directory_entry &d : fs::directory_iterator(dir)) {
+        const std::string name = d.path().filename().string();
+        if (!d.is_directory() || name == "_background_noise_")
+            continue;
+        for (const fs::directory_entry &f : fs::directory_iterator(d.path())) {
+            if (f.is_regular_file() && f.path().extension() == ".wav")
+                clip.push_back({f.path().string(), label_index(name)});
+        }
+    }
+    std::sort(clip.begin(), clip.end(), [](const Clip &a, const Clip &b) { return a.path < b.path; });
+    return clip;
+}
+
+static std::vector<Clip> read_clip_list(const std::string &dir, const std::string &list_file)
+{
+    std::ifstream fin(list_file);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + list_file);
+
+    std::vector<Clip> clip;
+    std::string line;
+    while (std::getline(fin, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+            line.pop_back();
+        if (line.empty())
+            continue;
+        size_t slash = line.find('/');
+        if (slash == std::string::npos)
+            throw std::runtime_error("Expected <label>/<file>.wav in " + list_file + ": " + line);
+        clip.push_back({(fs::path(dir) / line).string(), label_index(line.substr(0, slash))});
+    }
+    return clip;
+}
+
+int main(int argc, char **argv)
+{
+    std::string model_dir = "model";
+    std::string twiddle_dir = "src_hw/src/feature_extractor";
+    std::string list_file;
+    std::string dataset_dir;
+    int n_thread = 0;
+    int n_lead = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-m") && i + 1 < argc)        model_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-t") && i + 1 < argc)   twiddle_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-j") && i + 1 < argc)   n_thread = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-l") && i + 1 < argc)   n_lead = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-L") && i + 1 < argc)   list_file = argv[++i];
+        else if (argv[i][0] == '-' || !dataset_dir.empty())     { usage(); return 1; }
+        else                                                    dataset_dir = argv[i];
+    }
+    if (dataset_dir.empty() || n_lead < 0) {
+        usage();
+        return 1;
+    }
+
+    try {
+        tkws::ModelImage image = tkws::load_model(model_dir);
+        tkws::CtmModel model(image);
+        tkws::TwiddleRom rom = tkws::load_twiddle_dir(twiddle_dir);
+
+        if (model.num_class() > N_LABEL)
+            throw std::runtime_error("SPI_NUM_CLASS is larger than the label list");
+
+        std::vector<Clip> clip = list_file.empty() ? scan_dataset(dataset_dir)
+                                                   : read_clip_list(dataset_dir, list_file);
+        if (clip.empty())
+            throw std::runtime_error("No WAV clips found in " + dataset_dir);
+
+        tkws::WorkPool pool(n_thread);
+        std::vector<tkws::FeModel> fe(pool.num_thread(), tkws::FeModel(rom, image.conf.flux_th));
+        std::vector<int> predict(clip.size(), -1);
+
+        auto t0 = std::chrono::steady_clock::now();
+        pool.parallel_for(clip.size(), CLIP_GRAIN, [&](size_t begin, size_t end, int worker) {
+            std::vector<tkws::FeatureWindow> window;
+            std::vector<int16_t> audio;
+
+            for (size_t i = begin; i < end; i++) {
+                audio.assign(n_lead, 0);
+                std::vector<int16_t> wav = tkws::read_wav(clip[i].path);
+                audio.insert(audio.end(), wav.begin(), wav.end());
+                window.push_back(fe[worker].clip_window(audio.data(), audio.size()));
+            }
+
+            std::vector<tkws::CtmResult> result(window.size());
+            model.infer_batch(window.data(), window.size(), result.data());
+            for (size_t i = begin; i < end; i++)
+                predict[i] = result[i - begin].result;
+        });
+        auto t1 = std::chrono::steady_clock::now();
+
+        // confusion[true][predicted]
+        const int n_class = model.num_class();
+        std::vector<std::vector<int>> confusion(N_LABEL, std::vector<int>(n_class, 0));
+        int n_correct = 0;
+        for (size_t i = 0; i < clip.size(); i++) {
+            confusion[clip[i].label][predict[i]]++;
+            n_correct += clip[i].label == predict[i];
+        }
+
+        std::printf("%-8s %7s %7s %8s\n", "class", "clips", "correct", "accuracy");
+        for (int k = 0; k < N_LABEL; k++) {
+            int n = 0;
+            for (int p = 0; p < n_class; p++)
+                n += confusion[k][p];
+            if (n == 0)
+                continue;
+            int correct = k < n_class ? confusion[k][k] : 0;
+            std::printf("%-8s %7d %7d %7.2f%%\n", LABEL[k], n, correct, 100.0 * correct / n);
+        }
+
+        std::printf("\nconfusion matrix (row: label, column: prediction)\n%-8s", "");
+        for (int p = 0; p < n_class; p++)
+            std::printf(" %7.7s", LABEL[p]);
+        std::printf("\n");
+        for (int k = 0; k < N_LABEL; k++) {
+            std::printf("%-8s", LABEL[k]);
+            for (int p = 0; p < n_class; p++)
+                std::printf(" %7d", confusion[k][p]);
+            std::printf("\n");
+        }
+
+        double sec = std::chrono::duration<double>(t1 - t0).count();
+        std::printf("\naccuracy %.2f%% (%d/%zu)\n", 100.0 * n_correct / clip.size(), n_correct, clip.size());
+        std::printf("%zu clips in %.3f s, %.0f clips/s (%d threads)\n",
+                    clip.size(), sec, clip.size() / sec, pool.num_thread());
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
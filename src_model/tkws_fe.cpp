@@ -0,0 +1,130 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_fe.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Run the feature extractor golden model on an audio_data.csv file,
+//       write the first feature window in the mfcc_binary.csv format and
+//       optionally classify every window with the CTM golden model.
+//
+//       Usage: tkws_fe [-t twiddle_dir] [-f flux_th] [-o feature.csv]
+//                      [-m model_dir] [-b n_repeat] audio_data.csv
+//
+//==============================================================================
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ctm_model.h"
+#include "fe_model.h"
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: tkws_fe [-t twiddle_dir] [-f flux_th] [-o feature.csv]\n"
+                         "               [-m model_dir] [-b n_repeat] audio_data.csv\n");
+}
+
+int main(int argc, char **argv)
+{
+    std::string twiddle_dir = "src_hw/src/feature_extractor";
+    std::string model_dir;
+    std::string out_file;
+    std::string audio_file;
+    uint32_t flux_th = tkws::DEFAULT_FLUX_TH;
+    int n_repeat = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-t") && i + 1 < argc)        twiddle_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-f") && i + 1 < argc)   flux_th = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-o") && i + 1 < argc)   out_file = argv[++i];
+        else if (!std::strcmp(argv[i], "-m") && i + 1 < argc)   model_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-b") && i + 1 < argc)   n_repeat = std::atoi(argv[++i]);
+        else if (argv[i][0] == '-' || !audio_file.empty())      { usage(); return 1; }
+        else                                                    audio_file = argv[i];
+    }
+    if (audio_file.empty()) {
+        usage();
+        return 1;
+    }
+
+    try {
+        tkws::TwiddleRom rom = tkws::load_twiddle_dir(twiddle_dir);
+        std::vector<int16_t> audio = tkws::read_audio_csv(audio_file);
+        if (audio.empty())
+            throw std::runtime_error("No audio samples in " + audio_file);
+
+        tkws::FeModel fe(rom, flux_th);
+        std::vector<tkws::FeatureWindow> windows;
+        fe.prime(audio.data(), 1);
+        fe.push(audio.data() + 1, audio.size() - 1, windows);
+        fe.flush(windows);
+
+        std::printf("%s: %zu samples, %llu columns, %zu windows\n", audio_file.c_str(), audio.size(),
+                    (unsigned long long)fe.num_column(), windows.size());
+
+        if (!out_file.empty()) {
+            if (windows.empty())
+                throw std::runtime_error("Audio is too short for a feature window");
+            tkws::write_feature_csv(out_file, windows[0]);
+        }
+
+        if (!model_dir.empty()) {
+            tkws::CtmModel model(tkws::load_model(model_dir));
+            std::vector<tkws::CtmResult> results(windows.size());
+            model.infer_batch(windows.data(), windows.size(), results.data());
+
+            for (size_t i = 0; i < windows.size(); i++) {
+                std::printf("window %zu: result %d, class_summation [", i, results[i].result);
+                for (int k = 0; k < model.num_class(); k++)
+                    std::printf("%s%d", k ? ", " : "", results[i].class_sum[k]);
+                std::printf("]\n");
+            }
+        }
+
+        // Throughput: featurize the clip n_repeat times from reset.
+        if (n_repeat > 0) {
+            std::vector<tkws::FeatureWindow> bench;
+            auto t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < n_repeat; r++) {
+                fe.reset();
+                bench.clear();
+                fe.prime(audio.data(), 1);
+                fe.push(audio.data() + 1, audio.size() - 1, bench);
+                fe.flush(bench);
+            }
+            auto t1 = std::chrono::steady_clock::now();
+
+            double sec = std::chrono::duration<double>(t1 - t0).count();
+            std::printf("%d clips in %.3f s, %.0f clips/s\n", n_repeat, sec, n_repeat / sec);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
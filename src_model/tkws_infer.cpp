@@ -0,0 +1,101 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_infer.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Run the CTM golden model on feature windows (mfcc_binary.csv format)
+//       and print the class summations and argmax result.
+//
+//       Usage: tkws_infer [-m model_dir] [-b n_repeat] feature.csv ...
+//
+//==============================================================================
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "ctm_model.h"
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: tkws_infer [-m model_dir] [-b n_repeat] feature.csv ...\n");
+}
+
+int main(int argc, char **argv)
+{
+    std::string model_dir = "model";
+    int n_repeat = 0;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-m") && i + 1 < argc)        model_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-b") && i + 1 < argc)   n_repeat = std::atoi(argv[++i]);
+        else if (argv[i][0] == '-')                             { usage(); return 1; }
+        else                                                    files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        usage();
+        return 1;
+    }
+
+    try {
+        tkws::CtmModel model(tkws::load_model(model_dir));
+
+        std::vector<tkws::FeatureWindow> windows;
+        for (const std::string &f : files)
+            windows.push_back(tkws::read_feature_csv(f));
+
+        std::vector<tkws::CtmResult> results(windows.size());
+        model.infer_batch(windows.data(), windows.size(), results.data());
+
+        for (size_t i = 0; i < windows.size(); i++) {
+            std::printf("%s: result %d, class_summation [", files[i].c_str(), results[i].result);
+            for (int k = 0; k < model.num_class(); k++)
+                std::printf("%s%d", k ? ", " : "", results[i].class_sum[k]);
+            std::printf("]\n");
+        }
+
+        // Throughput: replicate the inputs n_repeat times.
+        if (n_repeat > 0) {
+            std::vector<tkws::FeatureWindow> bench;
+            for (int r = 0; r < n_repeat; r++)
+                bench.insert(bench.end(), windows.begin(), windows.end());
+            std::vector<tkws::CtmResult> bench_results(bench.size());
+
+            auto t0 = std::chrono::steady_clock::now();
+            model.infer_batch(bench.data(), bench.size(), bench_results.data());
+            auto t1 = std::chrono::steady_clock::now();
+
+            double sec = std::chrono::duration<double>(t1 - t0).count();
+            std::printf("%zu windows in %.3f s, %.0f windows/s (%d lanes)\n",
+                        bench.size(), sec, bench.size() / sec, tkws::CTM_LANES);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_ogbcsr.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: OG-BCSR compressor. Builds the model banks and spi_config_reg.txt
+//       from a TA include file (or re-balances an existing model directory)
+//       with the clauses load balanced across the PE columns, and reports
+//       the bank lengths and decoder cycles against the current split.
+//       -e sets SPI_EN_EARLY_EXIT in the written model, -r SPI_INF_STRIDE
+//       (infer every n-th window) and -v SPI_VAD_TH (flux bits a window
+//       needs to be inferred).
+//
+//       Usage: tkws_ogbcsr (-m model_dir | -i ta_include.txt -k n_class)
+//                          [-s n_sum_time] [-f flux_th] [-n] [-e] [-r stride] [-v vad_th]
+//                          [-o out_dir]
+//                          [-x ta_include.txt]
+//
+//==============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ctm_model.h"
+#include "ogbcsr.h"
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: tkws_ogbcsr (-m model_dir | -i ta_include.txt -k n_class)\n"
+                         "                   [-s n_sum_time] [-f flux_th] [-n] [-e] [-r stride] [-v vad_th]\n"
+                         "                   [-o out_dir]\n"
+                         "                   [-x ta_include.txt]\n");
+}
+
+static void print_cost(const char *name, const tkws::DecodeCost &cost)
+{
+    uint32_t max_row = *std::max_element(cost.len_row_bank.begin(), cost.len_row_bank.end());
+    uint32_t max_ccl = *std::max_element(cost.len_ccl_bank.begin(), cost.len_ccl_bank.end());
+
+    std::printf("%-9s row bank [", name);
+    for (int i = 0; i < tkws::N_PE_COL; i++)
+        std::printf("%s%u", i ? ", " : "", cost.len_row_bank[i]);
+    std::printf("] max %u, CCL bank [", max_row);
+    for (int i = 0; i < tkws::N_PE_COL; i++)
+        std::printf("%s%u", i ? ", " : "", cost.len_ccl_bank[i]);
+    std::printf("] max %u, decoder %llu cycles\n", max_ccl, (unsigned long long)cost.cycle);
+}
+
+// The new banks must give the same class sums as the old ones.
+static int compare_models(const tkws::ModelImage &a, const tkws::ModelImage &b, int n_window)
+{
+    tkws::CtmModel ma(a), mb(b);
+    std::mt19937_64 rng(1);
+    std::vector<tkws::FeatureWindow> window(n_window);
+    for (tkws::FeatureWindow &w : window) {
+        for (uint64_t &row : w)
+            row = rng();
+    }
+
+    std::vector<tkws::CtmResult> ra(n_window), rb(n_window);
+    ma.infer_batch(window.data(), window.size(), ra.data());
+    mb.infer_batch(window.data(), window.size(), rb.data());
+
+    int n_diff = 0;
+    for (int i = 0; i < n_window; i++)
+        n_diff += ra[i].class_sum != rb[i].class_sum;
+    return n_diff;
+}
+
+int main(int argc, char **argv)
+{
+    std::string model_dir, include_file, out_dir, export_file;
+    int n_class = 0;
+    int n_sum_time = 3;
+    uint32_t flux_th = 1024;
+    bool sequential = false;
+    bool early_exit = false;
+    int inf_stride = -1;
+    int vad_th = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-m") && i + 1 < argc)        model_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-i") && i + 1 < argc)   include_file = argv[++i];
+        else if (!std::strcmp(argv[i], "-k") && i + 1 < argc)   n_class = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)   n_sum_time = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-f") && i + 1 < argc)   flux_th = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-o") && i + 1 < argc)   out_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-x") && i + 1 < argc)   export_file = argv[++i];
+        else if (!std::strcmp(argv[i], "-r") && i + 1 < argc)   inf_stride = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-v") && i + 1 < argc)   vad_th = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-n"))                   sequential = true;
+        else if (!std::strcmp(argv[i], "-e"))                   early_exit = true;
+        else                                                    { usage(); return 1; }
+    }
+    if (model_dir.empty() == include_file.empty() || (!include_file.empty() && n_class <= 0) ||
+        n_sum_time <= 0 || inf_stride < -1 || inf_stride > 63 ||
+        vad_th < -1 || vad_th > 4095) {
+        usage();
+        return 1;
+    }
+
+    try {
+        tkws::ModelImage current;
+        tkws::ClauseSet clause;
+        tkws::SpiConfig conf;
+
+        if (!model_dir.empty()) {
+            current = tkws::load_model(model_dir);
+            tkws::SlotClauses slot = tkws::decode_ogbcsr(current);
+            clause = tkws::gather_clauses(slot);
+            n_sum_time = slot.num_sum_time;
+            conf = current.conf;
+        } else {
+            clause = tkws::read_ta_include(include_file, n_class);
+            conf.flux_th = flux_th;
+            conf.num_clause = (uint32_t)clause.num_clause;
+            current = tkws::encode_ogbcsr(tkws::place_sequential(clause, n_sum_time), conf);
+        }
+
+        if (!export_file.empty())
+            tkws::write_ta_include(export_file, clause);
+
+        tkws::ModelImage balanced = sequential ? current
+                                               : tkws::encode_ogbcsr(tkws::balance_ogbcsr(clause, n_sum_time), conf);
+
+        tkws::DecodeCost before = tkws::estimate_decode_cost(current);
+        tkws::DecodeCost after  = tkws::estimate_decode_cost(balanced);
+        print_cost("current:", before);
+        print_cost("balanced:", after);
+
+        double saving = 100.0 * ((double)before.cycle - (double)after.cycle) / (double)before.cycle;
+        std::printf("decoder cycles %llu -> %llu (%.2f%% saved), busiest-column CCL words %llu -> %llu\n",
+                    (unsigned long long)before.cycle, (unsigned long long)after.cycle, saving,
+                    (unsigned long long)before.ccl_cycle, (unsigned long long)after.ccl_cycle);
+
+        int n_diff = compare_models(current, balanced, 256);
+        std::printf("class summations %s on 256 random windows\n", n_diff ? "DIFFER" : "match");
+        if (n_diff)
+            throw std::runtime_error("Balanced banks do not reproduce the class summations");
+
+        if (early_exit)
+            balanced.conf.en_early_exit = true;
+        if (inf_stride >= 0)
+            balanced.conf.inf_stride = (uint32_t)inf_stride;
+        if (vad_th >= 0)
+            balanced.conf.vad_th = (uint32_t)vad_th;
+        if (!out_dir.empty())
+            tkws::write_model_dir(balanced, out_dir);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_perf.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Predict the inference latency of a model with the cycle-level model
+//       of the accelerator: cycles per inference, per-column busy and wait
+//       cycles and PE utilization. The class sums of every feature window
+//       given are checked against the CTM golden model.
+//
+//       -e sets SPI_EN_EARLY_EXIT (or the model does): the cycles then
+//       depend on the features, and are reported per feature window.
+//
+//       -k sets SPI_CLASS_SKIP (bit c skips class c): the skipped classes
+//       are left out of the cycles and of the class sums.
+//
+//       Usage: tkws_perf [-m model_dir] [-c clk_hz] [-e] [-k skip_mask] [feature.csv ...]
+//
+//==============================================================================
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ctm_model.h"
+#include "ogbcsr.h"
+#include "perf_model.h"
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: tkws_perf [-m model_dir] [-c clk_hz] [-e] [-k skip_mask] [feature.csv ...]\n");
+}
+
+static void print_stats(const tkws::PerfStats &s, const tkws::DecodeCost &cost, double clk_hz)
+{
+    std::printf("inference   %8llu cycles, %.3f ms at %.0f kHz\n",
+                (unsigned long long)s.cycle, s.latency_ms(clk_hz), clk_hz / 1e3);
+    std::printf("  decode    %8llu cycles (OG-BCSR estimate %llu)\n",
+                (unsigned long long)s.decode_cycle, (unsigned long long)cost.cycle);
+    std::printf("  tail      %8llu cycles\n", (unsigned long long)s.tail_cycle);
+    std::printf("  block     %8llu reads, %llu row stage stall cycles (%llu at round starts, DEPTH_BLOCK_FIFO %d)\n",
+                (unsigned long long)s.block_read, (unsigned long long)s.block_stall,
+                (unsigned long long)s.round_stall, tkws::DEPTH_BLOCK_FIFO);
+    uint64_t n_ta = 0;
+    for (uint32_t len : cost.len_ccl_bank)
+        n_ta += len;
+    std::printf("  CCL       %8llu reads for %llu TAs (N_CCL_WORD %d)\n",
+                (unsigned long long)s.ccl_read, (unsigned long long)n_ta, tkws::N_CCL_WORD);
+    std::printf("  PE idle   %8llu cycles\n", (unsigned long long)s.idle_cycle);
+    std::printf("  summation %8llu rounds in %llu cycles, %llu weight reads\n",
+                (unsigned long long)s.summation, (unsigned long long)s.summation_cycle,
+                (unsigned long long)s.weight_read);
+
+    std::printf("\n%-6s %8s %8s %8s %7s\n", "column", "CCL", "busy", "wait", "util");
+    for (int i = 0; i < tkws::N_PE_COL; i++) {
+        std::printf("%-6d %8u %8llu %8llu %6.2f%%\n", i, cost.len_ccl_bank[i],
+                    (unsigned long long)s.col_busy[i], (unsigned long long)s.col_wait[i],
+                    100.0 * (double)s.col_busy[i] / (double)s.cycle);
+    }
+    std::printf("PE utilization %.2f%%\n", 100.0 * s.pe_utilization());
+}
+
+int main(int argc, char **argv)
+{
+    std::string model_dir = "model";
+    double clk_hz = tkws::SYS_CLK_HZ;
+    bool early_exit = false;
+    long class_skip = -1;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-m") && i + 1 < argc)        model_dir = argv[++i];
+        else if (!std::strcmp(argv[i], "-c") && i + 1 < argc)   clk_hz = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "-e"))                   early_exit = true;
+        else if (!std::strcmp(argv[i], "-k") && i + 1 < argc)   class_skip = std::strtol(argv[++i], nullptr, 0);
+        else if (argv[i][0] == '-')                             { usage(); return 1; }
+        else                                                    files.push_back(argv[i]);
+    }
+    if (clk_hz <= 0 || class_skip < -1 || class_skip > 0xFFFF) {
+        usage();
+        return 1;
+    }
+
+    try {
+        tkws::ModelImage image = tkws::load_model(model_dir);
+        tkws::CtmModel model(image);
+        early_exit = early_exit || image.conf.en_early_exit;
+        if (class_skip >= 0)
+            image.conf.class_skip = (uint32_t)class_skip;
+        const uint32_t class_en = tkws::class_enable(image.conf);
+
+        // Without early exit the timing does not depend on the features.
+        image.conf.en_early_exit = false;
+        tkws::PerfStats stats = tkws::PerfModel(image).run(tkws::FeatureWindow{});
+        print_stats(stats, tkws::estimate_decode_cost(image), clk_hz);
+
+        image.conf.en_early_exit = early_exit;
+        tkws::PerfModel perf(image);
+
+        int n_diff = 0;
+        for (const std::string &f : files) {
+            tkws::FeatureWindow window = tkws::read_feature_csv(f);
+            tkws::PerfStats s = perf.run(window);
+            tkws::CtmResult gold = tkws::select_classes(model.infer(window), class_en);
+
+            // An early exit stops the class sums at the deciding class.
+            const size_t n_sum = s.result.class_sum.size();
+            bool match = n_sum <= gold.class_sum.size() && s.result.result == gold.result &&
+                         std::equal(s.result.class_sum.begin(), s.result.class_sum.end(), gold.class_sum.begin()) &&
+                         (s.early_exit ? s.cycle < stats.cycle : s.cycle == stats.cycle && n_sum == gold.class_sum.size());
+            std::printf("%s: result %d, class sums %s the golden model", f.c_str(), s.result.result,
+                        match ? "match" : "DIFFER from");
+            if (early_exit)
+                std::printf(", %llu cycles (%.1f%%)%s", (unsigned long long)s.cycle,
+                            100.0 * (double)s.cycle / (double)stats.cycle, s.early_exit ? ", early exit" : "");
+            std::printf("\n");
+            n_diff += !match;
+        }
+        if (n_diff)
+            throw std::runtime_error("Cycle-level model does not match the golden model");
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
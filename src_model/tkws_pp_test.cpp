@@ -0,0 +1,212 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_pp_test.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Unit tests of the keyword decision of the firmware
+//       (src_sw/post_process.c). Checks the parameter range of pp_init(),
+//       then replays every stream fixture and compares the confirmed
+//       keywords with the expected ones. A fixture is a result stream in
+//       the format of tkws_replay, with two directives in its comments:
+//
+//         #! param <window> <run> <holdoff> <silence>
+//         #! keyword <result index> <class>
+//
+//       Each stream is replayed twice, the second time after pp_reset().
+//       The exit status is non-zero if any test fails.
+//
+//       Usage: tkws_pp_test fixture.txt...
+//
+//==============================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "post_process.h"
+
+typedef std::vector<std::pair<size_t, int>> keyword_list;
+
+struct fixture_t {
+    pp_param_t              param;
+    keyword_list            keyword;
+    std::vector<uint8_t>    stream;
+};
+
+static fixture_t read_fixture(const std::string &file)
+{
+    std::ifstream fin(file);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file);
+
+    fixture_t fx;
+    bool has_param = false;
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (line.compare(0, 2, "#!") == 0) {
+            std::istringstream ss(line.substr(2));
+            std::string key;
+            ss >> key;
+            if (key == "param") {
+                int w, r, h, s;
+                if (!(ss >> w >> r >> h >> s))
+                    throw std::runtime_error("Bad param line in " + file + ": " + line);
+                fx.param.window = w;
+                fx.param.run = r;
+                fx.param.holdoff = h;
+                fx.param.silence_class = s;
+                has_param = true;
+            } else if (key == "keyword") {
+                size_t idx;
+                int k;
+                if (!(ss >> idx >> k))
+                    throw std::runtime_error("Bad keyword line in " + file + ": " + line);
+                fx.keyword.emplace_back(idx, k);
+            } else {
+                throw std::runtime_error("Unknown directive in " + file + ": " + line);
+            }
+            continue;
+        }
+
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        std::istringstream ss(line);
+        long v;
+        while (ss >> v) {
+            if (v < 0 || v >= PP_MAX_CLASS)
+                throw std::runtime_error("Result out of range in " + file + ": " + std::to_string(v));
+            fx.stream.push_back(static_cast<uint8_t>(v));
+        }
+        if (!ss.eof())
+            throw std::runtime_error("Expected results in " + file + ": " + line);
+    }
+    if (!has_param)
+        throw std::runtime_error("No param line in " + file);
+    return fx;
+}
+
+static keyword_list replay(post_process_t *pp, const std::vector<uint8_t> &stream)
+{
+    keyword_list keyword;
+    for (size_t i = 0; i < stream.size(); i++) {
+        int k = pp_push(pp, stream[i]);
+        if (k >= 0)
+            keyword.emplace_back(i, k);
+    }
+    return keyword;
+}
+
+static std::string to_string(const keyword_list &keyword)
+{
+    std::string s;
+    for (const auto &k : keyword)
+        s += " " + std::to_string(k.first) + ":" + std::to_string(k.second);
+    return s.empty() ? " none" : s;
+}
+
+// pp_init() takes the ranges of the SPI registers and rejects the rest
+// without touching the state.
+static int test_init_range()
+{
+    const pp_param_t valid[] = {
+        {10, 40, 21, 40},
+        {0, 1, 1, 0},
+        {PP_MAX_CLASS - 1, PP_MAX_WINDOW, PP_MAX_WINDOW, PP_MAX_WINDOW},
+    };
+    const pp_param_t invalid[] = {
+        {PP_MAX_CLASS, 40, 21, 40},         // silence class beyond 4 bits
+        {10, 0, 21, 40},                    // empty window
+        {10, PP_MAX_WINDOW + 1, 21, 40},
+        {10, 40, 0, 40},                    // empty run
+        {10, 40, PP_MAX_WINDOW + 1, 40},
+        {10, 40, 21, PP_MAX_WINDOW + 1},
+    };
+    int n_fail = 0;
+
+    for (const pp_param_t &p : valid) {
+        post_process_t pp;
+        if (pp_init(&pp, &p) != 0) {
+            std::printf("FAIL pp_init rejects silence %d window %d run %d holdoff %d\n",
+                        p.silence_class, p.window, p.run, p.holdoff);
+            n_fail++;
+        }
+    }
+    for (const pp_param_t &p : invalid) {
+        post_process_t pp, ref;
+        std::memset(&pp, 0xa5, sizeof pp);
+        std::memcpy(&ref, &pp, sizeof pp);
+        if (pp_init(&pp, &p) != -1 || std::memcmp(&pp, &ref, sizeof pp) != 0) {
+            std::printf("FAIL pp_init accepts silence %d window %d run %d holdoff %d\n",
+                        p.silence_class, p.window, p.run, p.holdoff);
+            n_fail++;
+        }
+    }
+    std::printf("%s pp_init range\n", n_fail ? "FAIL" : "PASS");
+    return n_fail != 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: tkws_pp_test fixture.txt...\n");
+        return 1;
+    }
+
+    int n_fail = test_init_range();
+    int n_test = 1;
+
+    for (int i = 1; i < argc; i++) {
+        n_test++;
+        try {
+            fixture_t fx = read_fixture(argv[i]);
+            post_process_t pp;
+            if (pp_init(&pp, &fx.param) != 0)
+                throw std::runtime_error("Keyword decision parameter out of range");
+
+            keyword_list first = replay(&pp, fx.stream);
+            pp_reset(&pp);
+            keyword_list second = replay(&pp, fx.stream);
+
+            if (first != fx.keyword || second != fx.keyword) {
+                std::printf("FAIL %s\n  expected%s\n  got     %s\n", argv[i],
+                            to_string(fx.keyword).c_str(),
+                            to_string(first != fx.keyword ? first : second).c_str());
+                n_fail++;
+            } else {
+                std::printf("PASS %s: %zu results, %zu keywords\n", argv[i], fx.stream.size(), fx.keyword.size());
+            }
+        } catch (const std::exception &e) {
+            std::printf("FAIL %s: %s\n", argv[i], e.what());
+            n_fail++;
+        }
+    }
+
+    std::printf("\n%d of %d tests passed\n", n_test - n_fail, n_test);
+    return n_fail != 0;
+}
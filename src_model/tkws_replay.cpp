@@ -0,0 +1,168 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "tkws_replay.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Replay recorded result streams through the keyword decision of the
+//       firmware (src_sw/post_process.c, the same code that runs on the
+//       Zynq and bit-exact with keyword_decision.sv), to tune its parameters
+//       offline. A stream file holds the inference results in order, as
+//       integers separated by white space; '#' starts a comment. Every file
+//       starts from reset. Prints each confirmed keyword with the index of
+//       the result that confirmed it, the keywords per class and the
+//       replay throughput.
+//
+//       -w, -r, -H and -s set SPI_KWD_WINDOW, SPI_KWD_RUN, SPI_KWD_HOLDOFF
+//       and SPI_VAD_CLASS (defaults: the reset values). -n replays every
+//       stream n times for the throughput, -q only prints the totals.
+//
+//       Usage: tkws_replay [-w window] [-r run] [-H holdoff] [-s silence]
+//                          [-n repeat] [-q] stream.txt...
+//
+//==============================================================================
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "post_process.h"
+
+// Same class order as label[] in src_sw/main_codec.c.
+static const char *const LABEL[] = {"yes", "no", "up", "down", "left", "right", "on", "off",
+                                    "stop", "go", "silence", "unknown"};
+static const int N_LABEL = sizeof(LABEL) / sizeof(LABEL[0]);
+
+static void usage()
+{
+    std::fprintf(stderr, "Usage: tkws_replay [-w window] [-r run] [-H holdoff] [-s silence]\n"
+                         "                   [-n repeat] [-q] stream.txt...\n");
+}
+
+static std::vector<uint8_t> read_stream(const std::string &file)
+{
+    std::ifstream fin(file);
+    if (!fin)
+        throw std::runtime_error("Failed to open file: " + file);
+
+    std::vector<uint8_t> stream;
+    std::string line;
+    while (std::getline(fin, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        const char *p = line.c_str();
+        char *end;
+        for (long v = std::strtol(p, &end, 10); end != p; v = std::strtol(p, &end, 10)) {
+            if (v < 0 || v >= PP_MAX_CLASS)
+                throw std::runtime_error("Result out of range in " + file + ": " + std::to_string(v));
+            stream.push_back(static_cast<uint8_t>(v));
+            p = end;
+        }
+        while (*p == ' ' || *p == '\t' || *p == '\r')
+            p++;
+        if (*p != '\0')
+            throw std::runtime_error("Expected results in " + file + ": " + line);
+    }
+    return stream;
+}
+
+int main(int argc, char **argv)
+{
+    pp_param_t param = {10, 40, 21, 40};
+    std::vector<std::string> files;
+    int n_repeat = 1;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-w") && i + 1 < argc)        param.window = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-r") && i + 1 < argc)   param.run = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-H") && i + 1 < argc)   param.holdoff = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)   param.silence_class = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-n") && i + 1 < argc)   n_repeat = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-q"))                   quiet = true;
+        else if (argv[i][0] == '-')                             { usage(); return 1; }
+        else                                                    files.push_back(argv[i]);
+    }
+    if (files.empty() || n_repeat < 1) {
+        usage();
+        return 1;
+    }
+
+    try {
+        post_process_t pp;
+        if (pp_init(&pp, &param) != 0)
+            throw std::runtime_error("Keyword decision parameter out of range");
+
+        std::vector<std::vector<uint8_t>> stream;
+        for (const std::string &f : files)
+            stream.push_back(read_stream(f));
+
+        std::vector<long> n_keyword(PP_MAX_CLASS, 0);
+        long n_result = 0;
+        for (size_t f = 0; f < stream.size(); f++) {
+            pp_reset(&pp);
+            for (size_t i = 0; i < stream[f].size(); i++) {
+                int keyword = pp_push(&pp, stream[f][i]);
+                if (keyword < 0)
+                    continue;
+                n_keyword[keyword]++;
+                if (!quiet)
+                    std::printf("%s:%zu %s\n", files[f].c_str(), i,
+                                keyword < N_LABEL ? LABEL[keyword] : std::to_string(keyword).c_str());
+            }
+            n_result += stream[f].size();
+        }
+
+        std::printf("%-8s %8s\n", "class", "keywords");
+        for (int k = 0; k < PP_MAX_CLASS; k++) {
+            if (n_keyword[k] != 0)
+                std::printf("%-8s %8ld\n", k < N_LABEL ? LABEL[k] : std::to_string(k).c_str(), n_keyword[k]);
+        }
+
+        // Throughput of the replay alone, over n_repeat passes.
+        long n_hit = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < n_repeat; r++) {
+            for (const std::vector<uint8_t> &s : stream) {
+                pp_reset(&pp);
+                for (uint8_t result : s)
+                    n_hit += pp_push(&pp, result) >= 0;
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        double sec = std::chrono::duration<double>(t1 - t0).count();
+        std::printf("\n%ld results in %zu streams, %ld keywords\n", n_result, stream.size(), n_hit / n_repeat);
+        std::printf("%ld results in %.3f s, %.1f M results/s\n",
+                    n_result * n_repeat, sec, sec > 0 ? n_result * n_repeat / sec / 1e6 : 0.0);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
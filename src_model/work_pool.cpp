@@ -0,0 +1,130 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "work_pool.cpp"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Work-stealing parallel for on std::thread.
+//
+//==============================================================================
+
+#include "work_pool.h"
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tkws {
+
+namespace {
+
+struct WorkQueue {
+    std::mutex                              lock;
+    std::deque<std::pair<size_t, size_t>>   chunk;
+};
+
+bool pop_front(WorkQueue &q, std::pair<size_t, size_t> &c)
+{
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.chunk.empty())
+        return false;
+    c = q.chunk.front();
+    q.chunk.pop_front();
+    return true;
+}
+
+bool steal_back(WorkQueue &q, std::pair<size_t, size_t> &c)
+{
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.chunk.empty())
+        return false;
+    c = q.chunk.back();
+    q.chunk.pop_back();
+    return true;
+}
+
+} // namespace
+
+WorkPool::WorkPool(int n_thread)
+{
+    if (n_thread <= 0)
+        n_thread = (int)std::thread::hardware_concurrency();
+    n_thread_ = n_thread > 0 ? n_thread : 1;
+}
+
+void WorkPool::parallel_for(size_t n, size_t grain, const WorkFn &fn) const
+{
+    if (n == 0)
+        return;
+    if (grain == 0)
+        grain = 1;
+
+    const size_t n_chunk = (n + grain - 1) / grain;
+    const int n_worker = (size_t)n_thread_ < n_chunk ? n_thread_ : (int)n_chunk;
+
+    // Deal contiguous runs of chunks to the workers, so that without any
+    // stealing each thread walks its own part of the range in order.
+    std::vector<std::unique_ptr<WorkQueue>> queue;
+    for (int w = 0; w < n_worker; w++)
+        queue.emplace_back(new WorkQueue);
+    for (size_t c = 0; c < n_chunk; c++) {
+        size_t begin = c * grain;
+        size_t end   = (begin + grain < n) ? begin + grain : n;
+        queue[c * n_worker / n_chunk]->chunk.emplace_back(begin, end);
+    }
+
+    std::exception_ptr error;
+    std::mutex error_lock;
+
+    auto worker = [&](int w) {
+        std::pair<size_t, size_t> c;
+        for (;;) {
+            bool found = pop_front(*queue[w], c);
+            for (int k = 1; !found && k < n_worker; k++)
+                found = steal_back(*queue[(w + k) % n_worker], c);
+            if (!found)
+                return;
+
+            try {
+                fn(c.first, c.second, w);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(error_lock);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> thread;
+    for (int w = 1; w < n_worker; w++)
+        thread.emplace_back(worker, w);
+    worker(0);
+    for (std::thread &t : thread)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace tkws
@@ -0,0 +1,59 @@
+//==============================================================================
+// Copyright (c) 2024-2025 Baizhou Lin
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//==============================================================================
+//
+// Project: TsetlinKWS - a keyword spotting accelerator based on Tsetlin Machine
+//
+// Module: "work_pool.h"
+//
+// Author: Baizhou Lin, University of Southampton
+//
+// Desc: Work-stealing parallel for. The index range is split into chunks
+//       that are dealt to per-worker deques; a worker pops its own chunks
+//       from the front and steals from the back of the others when empty,
+//       so long clips or slow cores do not leave the other threads idle.
+//
+//==============================================================================
+
+#ifndef __WORK_POOL_H
+#define __WORK_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace tkws {
+
+// Body of a parallel_for: process [begin, end) on thread `worker`.
+using WorkFn = std::function<void(size_t begin, size_t end, int worker)>;
+
+class WorkPool {
+public:
+    // n_thread = 0 selects std::thread::hardware_concurrency().
+    explicit WorkPool(int n_thread = 0);
+
+    int num_thread() const { return n_thread_; }
+
+    // Run fn over [0, n) in chunks of `grain` indices and wait for all of
+    // them. The first exception thrown by a chunk is rethrown here.
+    void parallel_for(size_t n, size_t grain, const WorkFn &fn) const;
+
+private:
+    int n_thread_;
+};
+
+} // namespace tkws
+
+#endif
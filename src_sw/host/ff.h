@@ -0,0 +1,47 @@
+#ifndef __HOST_FF_H
+#define __HOST_FF_H
+
+// FatFs over a local directory: the TF card is TKWS_SD_DIR (default ".").
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "xil_types.h"
+
+#define FF_MAX_SS                   512
+#define FM_FAT32                    0x02
+#define FA_READ                     0x01
+
+typedef char            TCHAR;
+typedef unsigned char   BYTE;
+typedef unsigned int    UINT;
+typedef uint32_t        FSIZE_t;
+
+typedef enum {
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_INT_ERR,
+    FR_NOT_READY,
+    FR_NO_FILE,
+    FR_NO_PATH,
+    FR_INVALID_NAME
+} FRESULT;
+
+typedef struct {
+    u8  mounted;
+} FATFS;
+
+typedef struct {
+    FILE       *fp;
+    FSIZE_t     obj_size;
+} FIL;
+
+#define f_size(fp)                  ((fp)->obj_size)
+
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt);
+FRESULT f_mkfs(const TCHAR *path, BYTE opt, u32 au, void *work, UINT len);
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode);
+FRESULT f_close(FIL *fp);
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br);
+TCHAR *f_gets(TCHAR *buff, int len, FIL *fp);
+
+#endif
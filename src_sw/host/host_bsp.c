@@ -0,0 +1,538 @@
+// Linux backend of the Xilinx BSP and FatFs calls used by the firmware, so
+// that main_codec.c, spi_config.c, tf_card.c and tkws_model.c build and run
+// unchanged on a host (-Isrc_sw/host):
+//
+//   TKWS_SD_DIR     directory standing in for the TF card (default ".")
+//   TKWS_RESULTS    result stream raised on Inf_Done/EMIO, in the format of
+//                   tkws_replay; the firmware exits at its end
+//   TKWS_RESULT_US  simulated time between two results (default 16000, one
+//                   frame)
+//   TKWS_SPI_LOG    file recording every SPI transaction, one per line as
+//                   big-endian hex words
+//
+// Interrupts are raised from wfi(), one per call: the coalescing timer if it
+// expires first, otherwise the next result. The boot and model load time, the
+// SPI traffic and the post-processing time are reported on stderr at exit.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xtime_l.h"
+#include "xpseudo_asm.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xgpiops.h"
+#include "xgpio.h"
+#include "xiicps.h"
+#include "xspips.h"
+#include "ff.h"
+
+#define HOST_EMIO_RESULT_0          54      // EMIO_RESULT_0 in main_codec.c
+
+typedef struct {
+    u64 transfer;
+    u64 byte;
+} spi_count_t;
+
+static const char      *sd_dir = ".";
+static FILE            *spi_log = NULL;
+static u8              *result = NULL;
+static u64              n_result = 0;
+static u64              result_idx = 0;
+static u64              result_period = 0;      // XTime counts
+
+static XTime            sim_time = 0;
+static XScuGic         *gic = NULL;
+static XScuTimer       *timer = NULL;           // last started
+static u32              inf_done = 0;
+static u8               emio_result = 0;
+static u8               spi_prescaler = XSPIPS_CLK_PRESCALE_256;
+
+static spi_count_t      spi_total = {0, 0};
+static spi_count_t      spi_boot = {0, 0};
+static u64              n_intr = 0;
+static int              booted = 0;
+static double           t_start, t_boot;
+
+
+static double host_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void load_results(const char *file)
+{
+    FILE *fp = fopen(file, "r");
+    char *line = NULL;
+    size_t line_cap = 0;
+    u64 cap = 0;
+
+    if (fp == NULL) {
+        fprintf(stderr, "host: failed to open %s\n", file);
+        exit(1);
+    }
+    while (getline(&line, &line_cap, fp) != -1) {
+        char *p = line;
+        char *end;
+        char *hash = strchr(line, '#');
+
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+        for (long v = strtol(p, &end, 10); end != p; v = strtol(p, &end, 10)) {
+            if (v < 0 || v > 15) {
+                fprintf(stderr, "host: result out of range in %s: %ld\n", file, v);
+                exit(1);
+            }
+            if (n_result == cap) {
+                cap = cap ? 2 * cap : 4096;
+                result = realloc(result, cap);
+            }
+            result[n_result++] = (u8)v;
+            p = end;
+        }
+    }
+    free(line);
+    fclose(fp);
+}
+
+__attribute__((constructor)) static void host_init()
+{
+    const char *env;
+
+    t_start = host_now();
+    if ((env = getenv("TKWS_SD_DIR")) != NULL) {
+        sd_dir = env;
+    }
+    if ((env = getenv("TKWS_RESULTS")) != NULL) {
+        load_results(env);
+    }
+    env = getenv("TKWS_RESULT_US");
+    result_period = (u64)(env ? strtoull(env, NULL, 10) : 16000) * COUNTS_PER_SECOND / 1000000;
+    if ((env = getenv("TKWS_SPI_LOG")) != NULL && (spi_log = fopen(env, "w")) == NULL) {
+        fprintf(stderr, "host: failed to open %s\n", env);
+        exit(1);
+    }
+}
+
+static void host_report()
+{
+    double t_end = host_now();
+    double sck = (double)XPAR_XSPIPS_0_SPI_CLK_FREQ_HZ / (2u << spi_prescaler);
+    double t_run = t_end - t_boot;
+
+    fflush(stdout);
+    fprintf(stderr, "host: boot and model load %.3f ms, %llu SPI transfers, %llu bytes (%.3f s at %.2f kHz SCK)\n",
+            (t_boot - t_start) * 1e3, (unsigned long long)spi_boot.transfer,
+            (unsigned long long)spi_boot.byte, spi_boot.byte * 8 / sck, sck / 1e3);
+    fprintf(stderr, "host: %llu results in %.3f ms, %.2f M results/s, %llu interrupts, %llu SPI transfers, %.3f s simulated\n",
+            (unsigned long long)result_idx, t_run * 1e3, t_run > 0 ? result_idx / t_run / 1e6 : 0.0,
+            (unsigned long long)n_intr, (unsigned long long)(spi_total.transfer - spi_boot.transfer),
+            (double)sim_time / COUNTS_PER_SECOND);
+    if (spi_log != NULL) {
+        fclose(spi_log);
+    }
+}
+
+static void raise_intr(u32 Int_Id)
+{
+    if (gic != NULL && gic->Enabled[Int_Id] && gic->Handler[Int_Id] != NULL) {
+        gic->Handler[Int_Id](gic->CallBackRef[Int_Id]);
+    }
+}
+
+void host_wfi(void)
+{
+    u64 next = (result_idx + 1) * result_period;
+
+    if (!booted) {
+        booted = 1;
+        t_boot = host_now();
+        spi_boot = spi_total;
+    }
+    n_intr++;
+
+    if (timer != NULL && timer->Started && (result_idx == n_result || timer->Expiry <= next)) {
+        if (timer->Expiry > sim_time) {
+            sim_time = timer->Expiry;
+        }
+        timer->Started = timer->AutoReload;
+        timer->Expiry = sim_time + timer->Load;
+        if (timer->IntrEnabled) {
+            raise_intr(XPAR_SCUTIMER_INTR);
+        }
+    } else if (result_idx < n_result) {
+        sim_time = next;
+        emio_result = result[result_idx++];
+        inf_done = 1;
+        raise_intr(XPAR_FABRIC_GPIO_0_VEC_ID);
+        inf_done = 0;
+    } else {
+        host_report();
+        exit(0);
+    }
+}
+
+void XTime_GetTime(XTime *Xtime_Global)
+{
+    *Xtime_Global = sim_time;
+}
+
+
+/********************************* Interrupts ********************************/
+void Xil_ExceptionInit(void) {}
+void Xil_ExceptionRegisterHandler(u32 Exception_id, Xil_ExceptionHandler Handler, void *Data)
+{
+    (void)Exception_id;
+    (void)Handler;
+    (void)Data;
+}
+void Xil_ExceptionEnable(void) {}
+void Xil_ExceptionDisable(void) {}
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId)
+{
+    static XScuGic_Config config = {0, 0};
+    (void)DeviceId;
+    return &config;
+}
+
+int XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr, u32 EffectiveAddr)
+{
+    (void)ConfigPtr;
+    (void)EffectiveAddr;
+    memset(InstancePtr, 0, sizeof *InstancePtr);
+    gic = InstancePtr;
+    return XST_SUCCESS;
+}
+
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger)
+{
+    (void)InstancePtr;
+    (void)Int_Id;
+    (void)Priority;
+    (void)Trigger;
+}
+
+int XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id, Xil_ExceptionHandler Handler, void *CallBackRef)
+{
+    if (Int_Id >= XSCUGIC_MAX_NUM_INTR_INPUTS) {
+        return XST_FAILURE;
+    }
+    InstancePtr->Handler[Int_Id] = Handler;
+    InstancePtr->CallBackRef[Int_Id] = CallBackRef;
+    return XST_SUCCESS;
+}
+
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id)
+{
+    InstancePtr->Enabled[Int_Id] = 1;
+}
+
+void XScuGic_InterruptHandler(XScuGic *InstancePtr)
+{
+    (void)InstancePtr;
+}
+
+
+/********************************** Timer ************************************/
+// Counts at CPU_CLK/2, the rate of XTime, so loads are in XTime counts.
+XScuTimer_Config *XScuTimer_LookupConfig(u16 DeviceId)
+{
+    static XScuTimer_Config config = {0, 0};
+    (void)DeviceId;
+    return &config;
+}
+
+int XScuTimer_CfgInitialize(XScuTimer *InstancePtr, XScuTimer_Config *ConfigPtr, u32 EffectiveAddress)
+{
+    (void)ConfigPtr;
+    (void)EffectiveAddress;
+    memset(InstancePtr, 0, sizeof *InstancePtr);
+    return XST_SUCCESS;
+}
+
+void XScuTimer_LoadTimer(XScuTimer *InstancePtr, u32 Value)
+{
+    InstancePtr->Load = Value;
+    InstancePtr->Expiry = sim_time + Value;
+}
+
+void XScuTimer_Start(XScuTimer *InstancePtr)
+{
+    InstancePtr->Started = 1;
+    timer = InstancePtr;
+}
+
+void XScuTimer_Stop(XScuTimer *InstancePtr)
+{
+    InstancePtr->Started = 0;
+}
+
+void XScuTimer_EnableAutoReload(XScuTimer *InstancePtr)       { InstancePtr->AutoReload = 1; }
+void XScuTimer_DisableAutoReload(XScuTimer *InstancePtr)      { InstancePtr->AutoReload = 0; }
+void XScuTimer_EnableInterrupt(XScuTimer *InstancePtr)        { InstancePtr->IntrEnabled = 1; }
+
+void XScuTimer_ClearInterruptStatus(XScuTimer *InstancePtr)
+{
+    (void)InstancePtr;
+}
+
+
+/*********************************** GPIO ************************************/
+XGpioPs_Config *XGpioPs_LookupConfig(u16 DeviceId)
+{
+    static XGpioPs_Config config = {0, 0};
+    (void)DeviceId;
+    return &config;
+}
+
+int XGpioPs_CfgInitialize(XGpioPs *InstancePtr, XGpioPs_Config *ConfigPtr, u32 EffectiveAddr)
+{
+    (void)ConfigPtr;
+    (void)EffectiveAddr;
+    InstancePtr->IsReady = 1;
+    return XST_SUCCESS;
+}
+
+void XGpioPs_SetDirectionPin(XGpioPs *InstancePtr, u32 Pin, u32 Direction)
+{
+    (void)InstancePtr;
+    (void)Pin;
+    (void)Direction;
+}
+
+// Result on EMIO_RESULT_0-3, held until the next result as on the board
+u32 XGpioPs_ReadPin(XGpioPs *InstancePtr, u32 Pin)
+{
+    (void)InstancePtr;
+    if (Pin < HOST_EMIO_RESULT_0 || Pin > HOST_EMIO_RESULT_0 + 3) {
+        return 0;
+    }
+    return (emio_result >> (Pin - HOST_EMIO_RESULT_0)) & 1;
+}
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId)
+{
+    (void)DeviceId;
+    memset(InstancePtr, 0, sizeof *InstancePtr);
+    InstancePtr->IsReady = 1;
+    return XST_SUCCESS;
+}
+
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask)
+{
+    (void)InstancePtr;
+    (void)Channel;
+    (void)DirectionMask;
+}
+
+// Inf_Done, high while its interrupt is raised
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel)
+{
+    (void)InstancePtr;
+    (void)Channel;
+    return inf_done;
+}
+
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr)
+{
+    (void)InstancePtr;
+}
+
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask)      { InstancePtr->InterruptMask |= Mask; }
+void XGpio_InterruptDisable(XGpio *InstancePtr, u32 Mask)     { InstancePtr->InterruptMask &= ~Mask; }
+
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask)
+{
+    (void)InstancePtr;
+    (void)Mask;
+}
+
+
+/************************************ I2C ************************************/
+XIicPs_Config *XIicPs_LookupConfig(u16 DeviceId)
+{
+    static XIicPs_Config config = {0, 0};
+    (void)DeviceId;
+    return &config;
+}
+
+int XIicPs_CfgInitialize(XIicPs *InstancePtr, XIicPs_Config *ConfigPtr, u32 EffectiveAddr)
+{
+    (void)ConfigPtr;
+    (void)EffectiveAddr;
+    InstancePtr->IsReady = 1;
+    return XST_SUCCESS;
+}
+
+int XIicPs_SetSClk(XIicPs *InstancePtr, u32 FsclHz)
+{
+    (void)InstancePtr;
+    (void)FsclHz;
+    return XST_SUCCESS;
+}
+
+int XIicPs_MasterSendPolled(XIicPs *InstancePtr, u8 *MsgPtr, int ByteCount, u16 SlaveAddr)
+{
+    (void)InstancePtr;
+    (void)MsgPtr;
+    (void)ByteCount;
+    (void)SlaveAddr;
+    return XST_SUCCESS;
+}
+
+int XIicPs_BusIsBusy(XIicPs *InstancePtr)
+{
+    (void)InstancePtr;
+    return 0;
+}
+
+
+/************************************ SPI ************************************/
+XSpiPs_Config *XSpiPs_LookupConfig(u16 DeviceId)
+{
+    static XSpiPs_Config config = {0, 0};
+    (void)DeviceId;
+    return &config;
+}
+
+int XSpiPs_CfgInitialize(XSpiPs *InstancePtr, XSpiPs_Config *ConfigPtr, u32 EffectiveAddr)
+{
+    (void)ConfigPtr;
+    (void)EffectiveAddr;
+    memset(InstancePtr, 0, sizeof *InstancePtr);
+    return XST_SUCCESS;
+}
+
+int XSpiPs_SelfTest(XSpiPs *InstancePtr)
+{
+    (void)InstancePtr;
+    return XST_SUCCESS;
+}
+
+int XSpiPs_SetSlaveSelect(XSpiPs *InstancePtr, u8 SlaveSel)
+{
+    (void)InstancePtr;
+    (void)SlaveSel;
+    return XST_SUCCESS;
+}
+
+int XSpiPs_SetOptions(XSpiPs *InstancePtr, u32 Options)
+{
+    InstancePtr->Options = Options;
+    return XST_SUCCESS;
+}
+
+int XSpiPs_SetClkPrescaler(XSpiPs *InstancePtr, u8 Prescaler)
+{
+    InstancePtr->Prescaler = Prescaler;
+    spi_prescaler = Prescaler;
+    return XST_SUCCESS;
+}
+
+void XSpiPs_SetStatusHandler(XSpiPs *InstancePtr, void *CallBackRef, XSpiPs_StatusHandler FuncPtr)
+{
+    InstancePtr->StatusHandler = FuncPtr;
+    InstancePtr->StatusRef = CallBackRef;
+}
+
+void XSpiPs_InterruptHandler(XSpiPs *InstancePtr)
+{
+    (void)InstancePtr;
+}
+
+int XSpiPs_Transfer(XSpiPs *InstancePtr, u8 *SendBufPtr, u8 *RecvBufPtr, u32 ByteCount)
+{
+    spi_total.transfer += 1;
+    spi_total.byte += ByteCount;
+    if (spi_log != NULL) {
+        for (u32 i = 0; i < ByteCount; i++) {
+            fprintf(spi_log, (i % 4 == 0) ? (i ? " %02x" : "%02x") : "%02x", SendBufPtr[i]);
+        }
+        fputc('\n', spi_log);
+    }
+    if (RecvBufPtr != NULL) {
+        memset(RecvBufPtr, 0, ByteCount);
+    }
+    if (InstancePtr->StatusHandler != NULL) {
+        InstancePtr->StatusHandler(InstancePtr->StatusRef, XST_SPI_TRANSFER_DONE, ByteCount);
+    }
+    return XST_SUCCESS;
+}
+
+
+/*********************************** FatFs ***********************************/
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt)
+{
+    FILE *fp;
+    char name[4096];
+
+    (void)path;
+    (void)opt;
+
+    // the directory must exist
+    snprintf(name, sizeof name, "%s/.", sd_dir);
+    if ((fp = fopen(name, "r")) == NULL) {
+        return FR_NOT_READY;
+    }
+    fclose(fp);
+    fs->mounted = 1;
+    return FR_OK;
+}
+
+FRESULT f_mkfs(const TCHAR *path, BYTE opt, u32 au, void *work, UINT len)
+{
+    (void)path;
+    (void)opt;
+    (void)au;
+    (void)work;
+    (void)len;
+    return FR_NOT_READY;
+}
+
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode)
+{
+    char name[4096];
+    long size;
+
+    (void)mode;
+
+    if (strncmp(path, "0:/", 3) == 0) {
+        path += 3;
+    }
+    snprintf(name, sizeof name, "%s/%s", sd_dir, path);
+    if ((fp->fp = fopen(name, "rb")) == NULL) {
+        return FR_NO_FILE;
+    }
+    fseek(fp->fp, 0, SEEK_END);
+    size = ftell(fp->fp);
+    fseek(fp->fp, 0, SEEK_SET);
+    fp->obj_size = size < 0 ? 0 : (FSIZE_t)size;
+    return FR_OK;
+}
+
+FRESULT f_close(FIL *fp)
+{
+    fclose(fp->fp);
+    fp->fp = NULL;
+    return FR_OK;
+}
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+    *br = (UINT)fread(buff, 1, btr, fp->fp);
+    return ferror(fp->fp) ? FR_DISK_ERR : FR_OK;
+}
+
+TCHAR *f_gets(TCHAR *buff, int len, FIL *fp)
+{
+    return fgets(buff, len, fp->fp);
+}
@@ -0,0 +1,8 @@
+#ifndef __HOST_SLEEP_H
+#define __HOST_SLEEP_H
+
+// Board delays (codec start-up) are skipped on the host.
+static inline unsigned sleep(unsigned seconds) { (void)seconds; return 0; }
+static inline int usleep(unsigned long useconds) { (void)useconds; return 0; }
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef __HOST_XGPIO_H
+#define __HOST_XGPIO_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XGPIO_IR_CH1_MASK           0x1
+
+typedef struct {
+    u32 IsReady;
+    u32 InterruptMask;
+} XGpio;
+
+int XGpio_Initialize(XGpio *InstancePtr, u16 DeviceId);
+void XGpio_SetDataDirection(XGpio *InstancePtr, unsigned Channel, u32 DirectionMask);
+u32 XGpio_DiscreteRead(XGpio *InstancePtr, unsigned Channel);
+void XGpio_InterruptGlobalEnable(XGpio *InstancePtr);
+void XGpio_InterruptEnable(XGpio *InstancePtr, u32 Mask);
+void XGpio_InterruptDisable(XGpio *InstancePtr, u32 Mask);
+void XGpio_InterruptClear(XGpio *InstancePtr, u32 Mask);
+
+#endif
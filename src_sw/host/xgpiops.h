@@ -0,0 +1,21 @@
+#ifndef __HOST_XGPIOPS_H
+#define __HOST_XGPIOPS_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+typedef struct {
+    u16 DeviceId;
+    u32 BaseAddr;
+} XGpioPs_Config;
+
+typedef struct {
+    u32 IsReady;
+} XGpioPs;
+
+XGpioPs_Config *XGpioPs_LookupConfig(u16 DeviceId);
+int XGpioPs_CfgInitialize(XGpioPs *InstancePtr, XGpioPs_Config *ConfigPtr, u32 EffectiveAddr);
+void XGpioPs_SetDirectionPin(XGpioPs *InstancePtr, u32 Pin, u32 Direction);
+u32 XGpioPs_ReadPin(XGpioPs *InstancePtr, u32 Pin);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef __HOST_XIICPS_H
+#define __HOST_XIICPS_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+typedef struct {
+    u16 DeviceId;
+    u32 BaseAddress;
+} XIicPs_Config;
+
+typedef struct {
+    u32 IsReady;
+} XIicPs;
+
+// The codec is not modelled: writes are accepted and dropped.
+XIicPs_Config *XIicPs_LookupConfig(u16 DeviceId);
+int XIicPs_CfgInitialize(XIicPs *InstancePtr, XIicPs_Config *ConfigPtr, u32 EffectiveAddr);
+int XIicPs_SetSClk(XIicPs *InstancePtr, u32 FsclHz);
+int XIicPs_MasterSendPolled(XIicPs *InstancePtr, u8 *MsgPtr, int ByteCount, u16 SlaveAddr);
+int XIicPs_BusIsBusy(XIicPs *InstancePtr);
+
+#endif
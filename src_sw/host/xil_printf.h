@@ -0,0 +1,9 @@
+#ifndef __HOST_XIL_PRINTF_H
+#define __HOST_XIL_PRINTF_H
+
+#include <stdio.h>
+
+#define xil_printf                  printf
+#define print(s)                    fputs((s), stdout)
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef __HOST_XPARAMETERS_H
+#define __HOST_XPARAMETERS_H
+
+// Device IDs and interrupt IDs of the Pynq-Z2 design (section 3 of the
+// README), with the clocks the host backend uses for its timing.
+#define XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ     140000000
+#define XPAR_XSPIPS_0_SPI_CLK_FREQ_HZ           25000000
+
+#define XPAR_XGPIOPS_0_DEVICE_ID                0
+#define XPAR_XSPIPS_0_DEVICE_ID                 0
+#define XPAR_XIICPS_0_DEVICE_ID                 0
+#define XPAR_AXI_GPIO_0_DEVICE_ID               0
+#define XPAR_SCUGIC_SINGLE_DEVICE_ID            0
+#define XPAR_XSCUTIMER_0_DEVICE_ID              0
+
+#define XPAR_SCUTIMER_INTR                      29
+#define XPAR_XSPIPS_0_INTR                      58
+#define XPAR_FABRIC_GPIO_0_VEC_ID               61
+
+#endif
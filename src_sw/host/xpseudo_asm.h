@@ -0,0 +1,10 @@
+#ifndef __HOST_XPSEUDO_ASM_H
+#define __HOST_XPSEUDO_ASM_H
+
+// Delivers the next simulated interrupt, and exits at the end of the
+// result stream.
+void host_wfi(void);
+
+#define wfi()                       host_wfi()
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef __HOST_XSCUGIC_H
+#define __HOST_XSCUGIC_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xil_exception.h"
+
+#define XSCUGIC_MAX_NUM_INTR_INPUTS 95
+
+typedef struct {
+    u16 DeviceId;
+    u32 CpuBaseAddress;
+} XScuGic_Config;
+
+typedef struct {
+    Xil_ExceptionHandler    Handler[XSCUGIC_MAX_NUM_INTR_INPUTS];
+    void                   *CallBackRef[XSCUGIC_MAX_NUM_INTR_INPUTS];
+    u8                      Enabled[XSCUGIC_MAX_NUM_INTR_INPUTS];
+} XScuGic;
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId);
+int XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr, u32 EffectiveAddr);
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger);
+int XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id, Xil_ExceptionHandler Handler, void *CallBackRef);
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_InterruptHandler(XScuGic *InstancePtr);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __HOST_XSCUTIMER_H
+#define __HOST_XSCUTIMER_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+typedef struct {
+    u16 DeviceId;
+    u32 BaseAddr;
+} XScuTimer_Config;
+
+typedef struct {
+    u32 Load;
+    u8  AutoReload;
+    u8  IntrEnabled;
+    u8  Started;
+    u64 Expiry;                             // simulated time
+} XScuTimer;
+
+XScuTimer_Config *XScuTimer_LookupConfig(u16 DeviceId);
+int XScuTimer_CfgInitialize(XScuTimer *InstancePtr, XScuTimer_Config *ConfigPtr, u32 EffectiveAddress);
+void XScuTimer_LoadTimer(XScuTimer *InstancePtr, u32 Value);
+void XScuTimer_Start(XScuTimer *InstancePtr);
+void XScuTimer_Stop(XScuTimer *InstancePtr);
+void XScuTimer_EnableAutoReload(XScuTimer *InstancePtr);
+void XScuTimer_DisableAutoReload(XScuTimer *InstancePtr);
+void XScuTimer_EnableInterrupt(XScuTimer *InstancePtr);
+void XScuTimer_ClearInterruptStatus(XScuTimer *InstancePtr);
+
+#endif
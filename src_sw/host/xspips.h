@@ -0,0 +1,38 @@
+#ifndef __HOST_XSPIPS_H
+#define __HOST_XSPIPS_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XSPIPS_MASTER_OPTION            0x1
+#define XSPIPS_FORCE_SSELECT_OPTION     0x10
+#define XSPIPS_CLK_PRESCALE_256         0x07
+
+typedef void (*XSpiPs_StatusHandler)(void *CallBackRef, u32 StatusEvent, u32 ByteCount);
+
+typedef struct {
+    u16 DeviceId;
+    u32 BaseAddress;
+} XSpiPs_Config;
+
+typedef struct {
+    u32                     Options;
+    u8                      Prescaler;
+    XSpiPs_StatusHandler    StatusHandler;
+    void                   *StatusRef;
+} XSpiPs;
+
+XSpiPs_Config *XSpiPs_LookupConfig(u16 DeviceId);
+int XSpiPs_CfgInitialize(XSpiPs *InstancePtr, XSpiPs_Config *ConfigPtr, u32 EffectiveAddr);
+int XSpiPs_SelfTest(XSpiPs *InstancePtr);
+int XSpiPs_SetOptions(XSpiPs *InstancePtr, u32 Options);
+int XSpiPs_SetClkPrescaler(XSpiPs *InstancePtr, u8 Prescaler);
+int XSpiPs_SetSlaveSelect(XSpiPs *InstancePtr, u8 SlaveSel);
+void XSpiPs_SetStatusHandler(XSpiPs *InstancePtr, void *CallBackRef, XSpiPs_StatusHandler FuncPtr);
+void XSpiPs_InterruptHandler(XSpiPs *InstancePtr);
+
+// Completes at once: the words are recorded (TKWS_SPI_LOG), MISO reads 0
+// (an empty result FIFO) and the status handler is called before returning.
+int XSpiPs_Transfer(XSpiPs *InstancePtr, u8 *SendBufPtr, u8 *RecvBufPtr, u32 ByteCount);
+
+#endif
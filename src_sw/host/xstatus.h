@@ -0,0 +1,8 @@
+#ifndef __HOST_XSTATUS_H
+#define __HOST_XSTATUS_H
+
+#define XST_SUCCESS                 0
+#define XST_FAILURE                 1
+#define XST_SPI_TRANSFER_DONE       1151
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef __HOST_XTIME_L_H
+#define __HOST_XTIME_L_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+
+typedef u64 XTime;
+
+#define COUNTS_PER_SECOND           (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+
+// Simulated time: advanced by the result stream, not by the host clock.
+void XTime_GetTime(XTime *Xtime_Global);
+
+#endif
@@ -6,12 +6,16 @@
 #include "xtime_l.h"
 #include "xgpio.h"
 #include "xscugic.h"
+#include "xscutimer.h"
 #include "xil_exception.h"
+#include "xpseudo_asm.h"
 #include "tf_card.h"
 #include "xspips.h"
 #include "spi_config.h"
 #include "xiicps.h"
 #include "adau1761.h"
+#include "result_ring.h"
+#include "post_process.h"
 
 // Device ID
 #define GPIOPS_ID           XPAR_XGPIOPS_0_DEVICE_ID
@@ -19,7 +23,10 @@
 #define IIC_DEVICE_ID       XPAR_XIICPS_0_DEVICE_ID
 #define AXI_GPIO_DEVICE_ID  XPAR_AXI_GPIO_0_DEVICE_ID
 #define SCUGIC_ID           XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define SCUTIMER_ID         XPAR_XSCUTIMER_0_DEVICE_ID
 #define AXI_GPIO_INT_ID     XPAR_FABRIC_GPIO_0_VEC_ID
+#define SPI_INT_ID          XPAR_XSPIPS_0_INTR
+#define SCUTIMER_INT_ID     XPAR_SCUTIMER_INTR
 
 #define PL_DONE_CHANNEL1    1
 #define PL_DONE_CH1_MASK    XGPIO_IR_CH1_MASK
@@ -30,17 +37,46 @@
 #define EMIO_RESULT_2       56
 #define EMIO_RESULT_3       57
 
+// Post-processing lengths in frames; with an inference stride of n they are
+// divided by n, as one result arrives every n frames.
 #define WINDOW_SIZE                 40
 #define FILL_SILENCE_MAX_CNT        40
 #define DETECTING_CONS_RESULT_CNT   20
 
+// 1: the accelerator confirms the keywords (keyword_decision.sv) and only
+// interrupts for them; 0: every result is post-processed here, with the same
+// decision in post_process.c.
+#ifndef HW_KEYWORD_DECISION
+#define HW_KEYWORD_DECISION         1
+#endif
+
+// 1: the main loop polls done_cnt of the SPI status word every
+// POLL_INTERVAL_US instead of taking the Inf_Done interrupt, and reads Result
+// from it instead of the EMIO pins. A poll that sees done_cnt advance by more
+// than one counts the results in between as dropped.
+#ifndef POLL_INF_DONE
+#define POLL_INF_DONE               0
+#endif
+#define POLL_INTERVAL_US            2000
+
+// Interrupt coalescing: the main loop sleeps until RESULT_COALESCE_CNT results
+// are queued, or until RESULT_COALESCE_TIMEOUT_US after the first one of a
+// batch. Confirmed keywords are rare, so they are handled one by one.
+#define RESULT_COALESCE_CNT         (HW_KEYWORD_DECISION ? 1 : 4)
+#define RESULT_COALESCE_TIMEOUT_US  100000
+#define COALESCE_TIMER_LOAD         (RESULT_COALESCE_TIMEOUT_US * (XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2 / 1000000))
+
 const char* label[] = {"yes", "no", "up", "down", "left", "right", "on", "off", "stop", "go", "silence", "unknown"};
 
 
 /************************** Function declaration *****************************/
 int setup_interrupt_system(XScuGic *gic_inst_ptr, XGpio *axi_gpio_inst_ptr, u16 AXI_GpioIntrId);
 static void intr_handler(void *CallbackRef);
+int setup_coalesce_timer(XScuGic *gic_inst_ptr, XScuTimer *timer_inst_ptr, u16 TimerIntrId);
+static void timer_intr_handler(void *CallbackRef);
 int initial_spi_system(XSpiPs *SpiInstancePtr, u16 SpiDeviceId);
+static int scale_post_processing();
+static void poll_inf_done();
 void init_ADAU1761();
 void ADAU1761_Write_Reg(u16 reg_addr, u16 length, u8 reg_data[]);
 
@@ -53,44 +89,32 @@ XIicPs_Config *I2c_Config;
 XGpioPs gpiops_inst;
 XGpio axi_gpio_inst;
 XScuGic scugic_inst;
+XScuTimer scutimer_inst;
 XSpiPs SpiInstance;
 XIicPs Iic;
 
-int inference_finish_flag = 0;
-
-typedef enum {
-    detecting,
-    fill_silence
-} sys_state;
+// Results queued by intr_handler, drained by the main loop
+result_ring_t result_ring;
+volatile int coalesce_timeout = 0;
 
-sys_state current_state = detecting;
+post_process_t post_process;
 
-u8 print_flag = 0;
-u8 fill_silence_cnt = 0;
-u8 consecutive_time = 0;
-u8 consecutive_result = 0;
+u8 post_stride = 0;
+int window_size = WINDOW_SIZE;
+int fill_silence_max_cnt = FILL_SILENCE_MAX_CNT;
+int detecting_cons_result_cnt = DETECTING_CONS_RESULT_CNT;
 
 
 int main()
 {
     int status;
-    int window_idx = 0;
-    u8 result_window[WINDOW_SIZE];
-    u8 result_bit[4];
+    int keyword;
     u8 result;
-    u8 result_count[12] = {0};
-    u8 max_result, max_result_count;
-    u8 last_result;
+    result_event_t event;
+    u32 dropped = 0;
     
     printf("Start Tsetlin Machine Accelerator for Keyword Spotting!\n\r");
     
-    for (int i = 0; i < WINDOW_SIZE; i++) {
-        result_window[i] = 10;
-    }
-
-    result_count[10] = WINDOW_SIZE;
-    last_result = 10;
-    
     XGpioPs_Config *gpiops_cfg_ptr;
 
     // Initial GPIO
@@ -134,8 +158,18 @@ int main()
         xil_printf("Setup interrupt system Finished!\r\n");
     }
     
+    status = setup_coalesce_timer(&scugic_inst, &scutimer_inst, SCUTIMER_INT_ID);
+    if (status != XST_SUCCESS) {
+        xil_printf("Setup coalescing timer failed\r\n");
+        return XST_FAILURE;
+    }
+    
     // READ DATA FROM TF CARD
-    read_model_data();
+    status = read_model_data();
+    if (status != XST_SUCCESS) {
+        xil_printf("Failed to read TM model!\r\n");
+        return XST_FAILURE;
+    }
     
     // initial SPI
     status = initial_spi_system(&SpiInstance, SPI_DEVICE_ID);
@@ -146,6 +180,12 @@ int main()
         xil_printf("Setup SPI Finished!\r\n");
     }
     
+    status = setup_spi_interrupt(&scugic_inst, &SpiInstance, SPI_INT_ID);
+    if (status != XST_SUCCESS) {
+        xil_printf("Setup SPI interrupt Failed!\r\n");
+        return XST_FAILURE;
+    }
+    
     xil_printf("Loading TM model...\r\n");
     
     status = initial_TMA(&SpiInstance);
@@ -155,118 +195,127 @@ int main()
 	} else {
         xil_printf("TsetlinKWS initialization Finished!\r\n");
     }
+    
+    if (scale_post_processing() != XST_SUCCESS) {
+        xil_printf("Post-processing setup Failed!\r\n");
+        return XST_FAILURE;
+    }
 
     xil_printf("Please speak:{yes, no, up, down, left, right, on, off, stop, go}\r\n");
 
     int print_cnt = 0;
     while(1){
 
-        if (inference_finish_flag == 1){
-            inference_finish_flag = 0;
-            
-            // get result
-            result_bit[0] = XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_0);
-            result_bit[1] = XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_1);
-            result_bit[2] = XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_2);
-            result_bit[3] = XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_3);
-            result = ((result_bit[3] << 3) | (result_bit[2] << 2) | (result_bit[1] << 1) | (result_bit[0] << 0));
-            
-            // pop one elements
-            result_count[result_window[window_idx]] -= 1;
-            
-            // Only when two identical results are detected consecutively, update the element.
-            if (result == last_result) {
-                // update elements
-                result_window[window_idx] = result;
-            } else {
-                result_window[window_idx] = 10;
-            }
+        // Poll until a batch is due, which skips the sleep below.
+        while (POLL_INF_DONE && result_ring_count(&result_ring) < RESULT_COALESCE_CNT && !coalesce_timeout) {
+            poll_inf_done();
+        }
 
-            // Fill in the "silence" result within the waiting time after a trigger to prevent "unknown" false alarms.
-            if (current_state == fill_silence) {
-                result_window[window_idx] = 10;
-            }
-            
-            // update count
-            result_count[result_window[window_idx]] += 1;
-            
-            // update index
-            window_idx += 1;
-            if (window_idx == WINDOW_SIZE){
-                window_idx = 0;
-            }
+        // Sleep until a batch is due. Interrupts are masked between the check
+        // and WFI, which still wakes on a pending interrupt, so a result queued
+        // in between is not missed.
+        Xil_ExceptionDisable();
+        while (result_ring_count(&result_ring) < RESULT_COALESCE_CNT && !coalesce_timeout) {
+            wfi();
+            Xil_ExceptionEnable();
+            Xil_ExceptionDisable();
+        }
+        XScuTimer_Stop(&scutimer_inst);
+        coalesce_timeout = 0;
+        Xil_ExceptionEnable();
+
+        if (result_ring.dropped != dropped) {
+            dropped = result_ring.dropped;
+            printf("Result ring full, %lu results dropped\n\r", (unsigned long)dropped);
+        }
+
+        while (result_ring_pop(&result_ring, &event)){
+            result = event.result;
             
-            // calculate average result
-            max_result = 0;
-            max_result_count = 0;
-            for (int i = 0; i < 12; i++){
-                if (result_count[i] > max_result_count){
-                    max_result = i;
-                    max_result_count = result_count[i];
-                }
+            // (Re)start the post-processing when the inference stride changes,
+            // in keyword_decision.sv or in post_process.
+            if (get_inf_stride() != post_stride && scale_post_processing() != XST_SUCCESS) {
+                printf("Post-processing setup Failed!\n\r");
             }
             
-            int start_idx;
-
-            start_idx = window_idx;
-            consecutive_time = 0;
-            consecutive_result = result_window[window_idx];
-            for (int i = 0; i < WINDOW_SIZE; i++) {
-
-                if (consecutive_result == result_window[start_idx]) {
-                    consecutive_time += 1;
-                } else {
-                    // reset timer
-                    consecutive_result = result_window[start_idx];
-                    consecutive_time = 0;
-                }
-
-                if (consecutive_time == DETECTING_CONS_RESULT_CNT && consecutive_result != 10 && current_state == detecting){
-                    print_flag = 1;
-                    break;
-                }
-
-                start_idx ++;
-                if (start_idx == WINDOW_SIZE) {
-                    start_idx = 0;
-                }
+            // Only confirmed keywords interrupt.
+            if (HW_KEYWORD_DECISION) {
+                printf("[%lu ms] Detect: %s\n\r", (unsigned long)(event.timestamp / (COUNTS_PER_SECOND / 1000)), label[result]);
+                continue;
             }
             
-            
-            switch (current_state){
-                case detecting:
-                    fill_silence_cnt = 0;
-                    if (print_flag) {
-                        printf("yes:%d, no:%d, up:%d, down:%d, left:%d, right:%d, on:%d, off:%d, stop:%d, go:%d, silence:%d, unknown:%d\r\n",
-                                result_count[0], result_count[1], result_count[2], result_count[3], result_count[4], result_count[5],
-                                result_count[6], result_count[7], result_count[8], result_count[9], result_count[10], result_count[11]);
-
-                        printf("Detect: %s\n\r", label[consecutive_result]);
-                    }
-
-                    break;
-                case fill_silence:
-                    fill_silence_cnt += 1;
-                    print_flag = 0;
-
-                    break;
+            keyword = pp_push(&post_process, result);
+            if (keyword >= 0) {
+                printf("yes:%d, no:%d, up:%d, down:%d, left:%d, right:%d, on:%d, off:%d, stop:%d, go:%d, silence:%d, unknown:%d\r\n",
+                        post_process.hist[0], post_process.hist[1], post_process.hist[2], post_process.hist[3],
+                        post_process.hist[4], post_process.hist[5], post_process.hist[6], post_process.hist[7],
+                        post_process.hist[8], post_process.hist[9], post_process.hist[10], post_process.hist[11]);
+
+                printf("[%lu ms] Detect: %s\n\r", (unsigned long)(event.timestamp / (COUNTS_PER_SECOND / 1000)), label[keyword]);
             }
+        }
+    }
+}
 
-            switch (current_state){
-                case detecting:
-                    if (print_flag == 1)
-                        current_state = fill_silence;
-                    break;
-                case fill_silence:
-                    if (fill_silence_cnt == FILL_SILENCE_MAX_CNT)
-                        current_state = detecting;
-                    break;
-                default:current_state = detecting; break;
-            }
-            
-            last_result = result;
+// Post-processing lengths for the current inference stride, sent to
+// keyword_decision.sv or set in post_process. DETECTING_CONS_RESULT_CNT
+// counts the repeats after the first result of a run, a run of one more.
+static int scale_post_processing()
+{
+    pp_param_t param;
+
+    post_stride = get_inf_stride();
+    window_size = WINDOW_SIZE / post_stride;
+    fill_silence_max_cnt = FILL_SILENCE_MAX_CNT / post_stride;
+    detecting_cons_result_cnt = DETECTING_CONS_RESULT_CNT / post_stride;
+    if (window_size == 0) {
+        window_size = 1;
+    }
+    if (fill_silence_max_cnt == 0) {
+        fill_silence_max_cnt = 1;
+    }
+    if (detecting_cons_result_cnt == 0) {
+        detecting_cons_result_cnt = 1;
+    }
+    if (HW_KEYWORD_DECISION) {
+        return set_keyword_decision(&SpiInstance, window_size, detecting_cons_result_cnt + 1, fill_silence_max_cnt);
+    }
+
+    param.silence_class = Model.header->conf_reg[CONF_ADDR_VAD_CLASS];     // SPI_VAD_CLASS, as keyword_decision.sv
+    param.window = window_size;
+    param.run = detecting_cons_result_cnt + 1;
+    param.holdoff = fill_silence_max_cnt;
+    return (pp_init(&post_process, &param) == 0) ? XST_SUCCESS : XST_FAILURE;
+}
+
+// Queue the result of the inferences since the last poll from the status
+// word, and wait POLL_INTERVAL_US for the next poll. The first poll only
+// takes done_cnt, which is not cleared by a restart of the firmware.
+static void poll_inf_done()
+{
+    static int started = 0;
+    static u16 done_cnt;
+    tkws_status_t status;
+    XTime timestamp;
+
+    if (read_status(&SpiInstance, &status) != XST_SUCCESS || !status.valid) {
+        usleep(POLL_INTERVAL_US);
+        return;
+    }
+    if (!started) {
+        started = 1;
+        done_cnt = status.done_cnt;
+    } else if (status.done_cnt != done_cnt) {
+        XTime_GetTime(&timestamp);
+        result_ring.dropped += (u16)(status.done_cnt - done_cnt - 1);
+        done_cnt = status.done_cnt;
+        if (result_ring_count(&result_ring) == 0) {
+            XScuTimer_LoadTimer(&scutimer_inst, COALESCE_TIMER_LOAD);
+            XScuTimer_Start(&scutimer_inst);
         }
+        result_ring_push(&result_ring, timestamp, status.result);
     }
+    usleep(POLL_INTERVAL_US);
 }
 
 int initial_spi_system(XSpiPs *SpiInstancePtr, u16 SpiDeviceId)
@@ -319,25 +368,71 @@ int setup_interrupt_system(XScuGic *gic_inst_ptr, XGpio *axi_gpio_inst_ptr, u16
     XScuGic_Enable(gic_inst_ptr, AXI_GpioIntrId);
 
     XGpio_SetDataDirection(axi_gpio_inst_ptr, PL_DONE_CHANNEL1, 1);
-    XGpio_InterruptEnable(axi_gpio_inst_ptr, PL_DONE_CH1_MASK);
-    XGpio_InterruptGlobalEnable(axi_gpio_inst_ptr);
+    if (!POLL_INF_DONE) {
+        XGpio_InterruptEnable(axi_gpio_inst_ptr, PL_DONE_CH1_MASK);
+        XGpio_InterruptGlobalEnable(axi_gpio_inst_ptr);
+    }
 
     return XST_SUCCESS;
 
 }
 
+// Both edges of Inf_Done interrupt, the falling one reads 0. Result is held
+// until the next Inf_Done, so it is read here and queued with the time.
 void intr_handler(void *CallbackRef)
 {
-
     XGpio *GpioPtr = (XGpio *)CallbackRef;
-    usleep(0.3);
+    XTime timestamp;
+    u8 result;
+
     if (XGpio_DiscreteRead(GpioPtr, PL_DONE_CHANNEL1) == 1) {
-        XGpio_InterruptDisable(GpioPtr, PL_DONE_CH1_MASK);
-        inference_finish_flag = 1;
+        XTime_GetTime(&timestamp);
+        result = ((XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_3) << 3) |
+                  (XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_2) << 2) |
+                  (XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_1) << 1) |
+                  (XGpioPs_ReadPin(&gpiops_inst, EMIO_RESULT_0) << 0));
+
+        // The first result of a batch starts the coalescing timeout.
+        if (result_ring_count(&result_ring) == 0) {
+            XScuTimer_LoadTimer(&scutimer_inst, COALESCE_TIMER_LOAD);
+            XScuTimer_Start(&scutimer_inst);
+        }
+        result_ring_push(&result_ring, timestamp, result);
     }
 
     XGpio_InterruptClear(GpioPtr, PL_DONE_CH1_MASK);
-    XGpio_InterruptEnable(GpioPtr, PL_DONE_CH1_MASK);
+}
+
+// One-shot private timer, restarted by intr_handler for every batch
+int setup_coalesce_timer(XScuGic *gic_inst_ptr, XScuTimer *timer_inst_ptr, u16 TimerIntrId)
+{
+    int Status;
+    XScuTimer_Config *TimerConfig;
+
+    TimerConfig = XScuTimer_LookupConfig(SCUTIMER_ID);
+    Status = XScuTimer_CfgInitialize(timer_inst_ptr, TimerConfig, TimerConfig->BaseAddr);
+    if (Status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    XScuTimer_DisableAutoReload(timer_inst_ptr);
+
+    Status = XScuGic_Connect(gic_inst_ptr, TimerIntrId,
+                    (Xil_ExceptionHandler) timer_intr_handler, (void *) timer_inst_ptr);
+    if (Status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    XScuGic_Enable(gic_inst_ptr, TimerIntrId);
+    XScuTimer_EnableInterrupt(timer_inst_ptr);
+
+    return XST_SUCCESS;
+}
+
+void timer_intr_handler(void *CallbackRef)
+{
+    XScuTimer *TimerPtr = (XScuTimer *)CallbackRef;
+
+    XScuTimer_ClearInterruptStatus(TimerPtr);
+    coalesce_timeout = 1;
 }
 
 
@@ -0,0 +1,73 @@
+#include "post_process.h"
+
+
+int pp_init(post_process_t *pp, const pp_param_t *param)
+{
+    if (param->silence_class >= PP_MAX_CLASS || param->window == 0 || param->window > PP_MAX_WINDOW ||
+        param->run == 0 || param->run > PP_MAX_WINDOW || param->holdoff > PP_MAX_WINDOW) {
+        return -1;
+    }
+    pp->param = *param;
+    pp_reset(pp);
+    return 0;
+}
+
+void pp_reset(post_process_t *pp)
+{
+    u8 silence = pp->param.silence_class;
+
+    for (int i = 0; i < PP_MAX_CLASS; i++) {
+        pp->hist[i] = 0;
+    }
+    for (int i = 0; i < pp->param.window; i++) {
+        pp->entry[i] = silence;
+    }
+    pp->hist[silence] = pp->param.window;
+    pp->entry_idx = 0;
+    pp->last_result = silence;
+    pp->run_class = silence;
+    pp->run_len = 0;
+    pp->holdoff_cnt = 0;
+}
+
+int pp_push(post_process_t *pp, u8 result)
+{
+    u8 silence = pp->param.silence_class;
+    u8 entry;
+    u8 run_len;
+
+    result &= PP_MAX_CLASS - 1;
+
+    // Debounce: a result counts once it repeats, and not during the holdoff.
+    entry = (pp->holdoff_cnt != 0 || result != pp->last_result) ? silence : result;
+    pp->last_result = result;
+
+    // Replace the oldest entry of the window.
+    pp->hist[pp->entry[pp->entry_idx]] -= 1;
+    pp->entry[pp->entry_idx] = entry;
+    pp->hist[entry] += 1;
+    pp->entry_idx = (pp->entry_idx + 1 == pp->param.window) ? 0 : pp->entry_idx + 1;
+
+    // A run longer than the window saturates and never completes.
+    if (entry != pp->run_class) {
+        run_len = 1;
+    } else if (pp->run_len < pp->param.window) {
+        run_len = pp->run_len + 1;
+    } else {
+        run_len = pp->run_len;
+    }
+
+    if (entry != silence && run_len == pp->param.run) {
+        pp->run_class = silence;
+        pp->run_len = 0;
+        pp->holdoff_cnt = pp->param.holdoff;
+        return entry;
+    }
+
+    pp->run_class = entry;
+    pp->run_len = run_len;
+    if (pp->holdoff_cnt != 0) {
+        pp->holdoff_cnt -= 1;
+    }
+    return -1;
+}
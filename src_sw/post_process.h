@@ -0,0 +1,53 @@
+#ifndef __POST_PROCESS_H
+#define __POST_PROCESS_H
+
+#include "xil_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming keyword decision on the inference results, bit-exact with
+// keyword_decision.sv. Every result adds one entry: the result if the
+// previous one was the same, the silence class otherwise. A keyword is
+// confirmed when run entries in a row carry the same class other than
+// silence, counted within the last window entries; the next holdoff entries
+// are then forced to silence. Each result costs O(1): the run length and
+// the per-class histogram of the window are updated, never rescanned.
+// Builds for the Zynq and, with -Isrc_sw/host, for Linux (tkws_replay).
+#define PP_MAX_CLASS                16          // 4-bit results
+#define PP_MAX_WINDOW               63          // 6-bit SPI_KWD_WINDOW
+
+typedef struct {
+    u8  silence_class;                      // SPI_VAD_CLASS
+    u8  window;                             // SPI_KWD_WINDOW, 1 to PP_MAX_WINDOW
+    u8  run;                                // SPI_KWD_RUN, at least 1
+    u8  holdoff;                            // SPI_KWD_HOLDOFF
+} pp_param_t;
+
+typedef struct {
+    pp_param_t  param;
+    u8          entry[PP_MAX_WINDOW];       // last window entries, circular
+    u8          hist[PP_MAX_CLASS];         // entries per class in the window
+    u8          entry_idx;                  // oldest entry
+    u8          last_result;
+    u8          run_class;
+    u8          run_len;
+    u8          holdoff_cnt;
+} post_process_t;
+
+// Set the parameters and reset. Returns 0 on success, -1 if a parameter is
+// out of range (the state is then left unchanged).
+int pp_init(post_process_t *pp, const pp_param_t *param);
+
+// Back to the state after SPI_EN_KWD is set: a window of silence.
+void pp_reset(post_process_t *pp);
+
+// Add one result. Returns the confirmed keyword, or -1.
+int pp_push(post_process_t *pp, u8 result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
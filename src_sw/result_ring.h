@@ -0,0 +1,64 @@
+#ifndef __RESULT_RING_H
+#define __RESULT_RING_H
+
+#include "xil_types.h"
+
+// Lock-free single-producer/single-consumer ring of inference results. The
+// Inf_Done interrupt handler is the only writer of head and the main loop the
+// only writer of tail, so neither side needs to mask interrupts. One slot is
+// kept free to tell a full ring from an empty one.
+#define RESULT_RING_SIZE            64          // power of two
+
+// Orders the slot access against the index update that publishes it.
+#define RESULT_RING_BARRIER()       __sync_synchronize()
+
+typedef struct {
+    u64 timestamp;                              // XTime at Inf_Done
+    u8  result;
+} result_event_t;
+
+typedef struct {
+    result_event_t  event[RESULT_RING_SIZE];
+    volatile u32    head;                       // next slot written
+    volatile u32    tail;                       // next slot read
+    volatile u32    dropped;                    // results lost to a full ring
+} result_ring_t;
+
+static inline u32 result_ring_count(const result_ring_t *ring)
+{
+    return (ring->head - ring->tail) & (RESULT_RING_SIZE - 1);
+}
+
+// Producer side. Returns 0 and counts the result as dropped if the ring is full.
+static inline int result_ring_push(result_ring_t *ring, u64 timestamp, u8 result)
+{
+    u32 head = ring->head;
+    u32 next = (head + 1) & (RESULT_RING_SIZE - 1);
+
+    if (next == ring->tail) {
+        ring->dropped += 1;
+        return 0;
+    }
+    ring->event[head].timestamp = timestamp;
+    ring->event[head].result = result;
+    RESULT_RING_BARRIER();
+    ring->head = next;
+    return 1;
+}
+
+// Consumer side. Returns 0 if the ring is empty.
+static inline int result_ring_pop(result_ring_t *ring, result_event_t *event)
+{
+    u32 tail = ring->tail;
+
+    if (tail == ring->head) {
+        return 0;
+    }
+    RESULT_RING_BARRIER();
+    *event = ring->event[tail];
+    RESULT_RING_BARRIER();
+    ring->tail = (tail + 1) & (RESULT_RING_SIZE - 1);
+    return 1;
+}
+
+#endif
@@ -1,179 +1,371 @@
 #include "spi_config.h"
+#include "sleep.h"
 
-char* BLOCK_IDX_BANK_CONFIG_ADDR    = "10010000010001111111000000000000";
-char* ROW_CNT_BANK0_CONFIG_ADDR     = "10100000011000110111000000000000";
-char* ROW_CNT_BANK1_CONFIG_ADDR     = "10100010011001010001000000000000";
-char* ROW_CNT_BANK2_CONFIG_ADDR     = "10100100011001011010000000000000";
-char* ROW_CNT_BANK3_CONFIG_ADDR     = "10100110011001001101000000000000";
-char* ROW_CNT_BANK4_CONFIG_ADDR     = "10101000011010000011000000000000";
+#define CONF_SPI_EN_INF_ADDR        0x80000001
+#define CONF_SPI_EN_INF_DATA        0x00000001
+#define CONF_SPI_CLASS_SKIP_ADDR    (0x80000000 | CONF_ADDR_CLASS_SKIP)
+#define CONF_SPI_INF_STRIDE_ADDR    (0x80000000 | CONF_ADDR_INF_STRIDE)
+#define CONF_INF_STRIDE_MAX         63
+#define CONF_SPI_KWD_ADDR           (0x80000000 | (3 << 12) | CONF_ADDR_EN_KWD)     // 4-register burst
+#define CONF_KWD_MAX                63
+#define SPI_CMD_RESULT_FIFO         6
+#define SPI_CMD_READ_REG            7
+#define SPI_READ_PERF_CNT           0           // bank_sel of SPI_CMD_READ_REG
+#define SPI_READ_STATUS             1
+#define SPI_READ_BANK_CRC           2
+#define RESULT_MAX_WORDS            (2 + 16 / 2)
+#define PERF_CNT_WORDS              (6 + 2 * MODEL_N_PE_COL)
+#define SPI_READ_MAX_WORDS          (PERF_CNT_WORDS > RESULT_MAX_WORDS ? PERF_CNT_WORDS : RESULT_MAX_WORDS)
+#define CRC_POLL_US                 1000
+#define CRC_MAX_POLL                500         // the shipped model takes ~66 ms
 
-char* CCL_IDX_BANK0_CONFIG_ADDR     = "10110000110000110110000000000000";
-char* CCL_IDX_BANK1_CONFIG_ADDR     = "10110010110000101001000000000000";
-char* CCL_IDX_BANK2_CONFIG_ADDR     = "10110100110000011010000000000000";
-char* CCL_IDX_BANK3_CONFIG_ADDR     = "10110110110000100011000000000000";
-char* CCL_IDX_BANK4_CONFIG_ADDR     = "10111000110001110001000000000000";
+// 1: initial_TMA() skips the bank load when the bank CRCs of the accelerator
+// match the model. Off until the CRC walk of spi_readback.sv has been
+// simulated: a wrong match would leave a stale model in the banks.
+#ifndef SKIP_MATCHING_BANKS
+#define SKIP_MATCHING_BANKS         0
+#endif
 
-char* WEIGHT_BANK0_CONFIG_ADDR      = "11000000010110011111000000000000";
+// Interrupt-driven transfer state, updated by spi_status_handler()
+static volatile int spi_busy = 0;
+static volatile int spi_error = 0;
 
-char* CONF_SPI_EN_INF_ADDR          = "10000000000000000000000000000001";
-char* CONF_SPI_EN_INF_DATA          = "00000000000000000000000000000001";
+// SPI_INF_STRIDE as last written (0 is sent as, and read back as, 1)
+static u8 inf_stride = 1;
 
+// MISO reads: command, turnaround and data words
+static u8 Spi_Rx_Buffer[(2 + SPI_READ_MAX_WORDS) * 4];
 
-uint32_t binary_str_to_uint32(char *str) {
-    uint32_t result = 0;
-    for (int i = 0; i < 32; i++) {
-        if (str[i] == '1') {
-            result |= (1 << (31 - i));
-        }
+
+static void spi_status_handler(void *CallBackRef, u32 StatusEvent, u32 ByteCount)
+{
+    (void)CallBackRef;
+    (void)ByteCount;
+    if (StatusEvent != XST_SPI_TRANSFER_DONE) {
+        spi_error = 1;
     }
-    return result;
+    spi_busy = 0;
 }
 
+// Start a transfer; the previous one must have completed (spi_wait).
+// RecvBuffer takes the MISO bytes, or NULL.
+static int spi_start(XSpiPs *SpiPtr, u8 *Buffer, u8 *RecvBuffer, u32 ByteCount)
+{
+    int Status;
 
-void read_model_data(){    
-    sd_read_binary("feature_bank_data.txt",     (u8*)Conf_feature_bank_Buffer, 32, 129      );
-    sd_read_binary(CONF_REG_FILE_NAME,          (u8*)Conf_reg_Buffer,   32, LEN_CONF_REG    );
-    sd_read_binary(CONF_BLOCK_BANK_FILE_NAME,   (u8*)Conf_block_Buffer, 20, LEN_BLOCK_BANK  );
-    sd_read_binary(CONF_ROW_BANK0_FILE_NAME,    (u8*)Conf_row_Buffer0,  6, LEN_ROW_BANK0    );
-    sd_read_binary(CONF_ROW_BANK1_FILE_NAME,    (u8*)Conf_row_Buffer1,  6, LEN_ROW_BANK1    );
-    sd_read_binary(CONF_ROW_BANK2_FILE_NAME,    (u8*)Conf_row_Buffer2,  6, LEN_ROW_BANK2    );
-    sd_read_binary(CONF_ROW_BANK3_FILE_NAME,    (u8*)Conf_row_Buffer3,  6, LEN_ROW_BANK3    );
-    sd_read_binary(CONF_ROW_BANK4_FILE_NAME,    (u8*)Conf_row_Buffer4,  6, LEN_ROW_BANK4    );
-    
-    sd_read_binary(CONF_CCL_BANK0_FILE_NAME,    (u8*)Conf_ccl_Buffer0,  5, LEN_CCL_BANK0    );
-    sd_read_binary(CONF_CCL_BANK1_FILE_NAME,    (u8*)Conf_ccl_Buffer1,  5, LEN_CCL_BANK1    );
-    sd_read_binary(CONF_CCL_BANK2_FILE_NAME,    (u8*)Conf_ccl_Buffer2,  5, LEN_CCL_BANK2    );
-    sd_read_binary(CONF_CCL_BANK3_FILE_NAME,    (u8*)Conf_ccl_Buffer3,  5, LEN_CCL_BANK3    );
-    sd_read_binary(CONF_CCL_BANK4_FILE_NAME,    (u8*)Conf_ccl_Buffer4,  5, LEN_CCL_BANK4    );
-    
-    sd_read_hex(CONF_WEIGHT_BANK_FILE_NAME,     (u8*)Conf_weight_Buffer, LEN_WEIGHT_BANK);
-    
+    spi_busy = 1;
+    Status = XSpiPs_Transfer(SpiPtr, Buffer, RecvBuffer, ByteCount);
+    if (Status != XST_SUCCESS) {
+        spi_busy = 0;
+        return XST_FAILURE;
+    }
+    return XST_SUCCESS;
+}
+
+static int spi_wait()
+{
+    while (spi_busy);
+    if (spi_error) {
+        spi_error = 0;
+        return XST_FAILURE;
+    }
+    return XST_SUCCESS;
+}
+
+
+int read_model_data(){
+    u32 size;
+
+    // whole model in one read, then check the header and CRCs
+    if (sd_read_file(CONF_MODEL_FILE_NAME, (u8*)Model_File_Buffer, sizeof(Model_File_Buffer), &size) != 0) {
+        return XST_FAILURE;
+    }
+    if (model_parse(&Model, (u8*)Model_File_Buffer, size) != 0) {
+        return XST_FAILURE;
+    }
+    return XST_SUCCESS;
+}
+
+
+int setup_spi_interrupt(XScuGic *gic_inst_ptr, XSpiPs *SpiInstancePtr, u16 SpiIntrId)
+{
+    int Status;
+
+    Status = XScuGic_Connect(gic_inst_ptr, SpiIntrId,
+                    (Xil_ExceptionHandler) XSpiPs_InterruptHandler, (void *) SpiInstancePtr);
+    if (Status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    XSpiPs_SetStatusHandler(SpiInstancePtr, SpiInstancePtr, (XSpiPs_StatusHandler) spi_status_handler);
+    XScuGic_Enable(gic_inst_ptr, SpiIntrId);
+
+    return XST_SUCCESS;
 }
 
 
 int initial_TMA(XSpiPs *SpiInstancePtr){
-    uint32_t addr_uint32;
-    uint8_t addr_uint8 [4];
-    
+    u32 byte_count;
+    int buf = 0;
+    u8 match;
+
     // configure configuration register
-    SPIWrite(SpiInstancePtr, 0, LEN_CONF_REG * 4, Conf_reg_Buffer);
-    
-    // load model block index 
-    addr_uint32 = binary_str_to_uint32(BLOCK_IDX_BANK_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
-    }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_BLOCK_BANK * 4, Conf_block_Buffer);
-    
-    // load model row count
-    // ------------------------bank0------------------------
-    addr_uint32 = binary_str_to_uint32(ROW_CNT_BANK0_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    byte_count = model_spi_conf(&Model, Spi_Tx_Buffer[buf]);
+    if (SPIWrite(SpiInstancePtr, 0, byte_count, Spi_Tx_Buffer[buf]) != XST_SUCCESS) {
+        return XST_FAILURE;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_ROW_BANK0 * 4, Conf_row_Buffer0);
-    // ------------------------bank1------------------------
-    addr_uint32 = binary_str_to_uint32(ROW_CNT_BANK1_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+
+    // The banks survive a restart of the firmware: with the length registers
+    // set, skip their load if the bank CRCs still match the model.
+    match = 0;
+    if (SKIP_MATCHING_BANKS && check_model_banks(SpiInstancePtr, &match) != XST_SUCCESS) {
+        return XST_FAILURE;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_ROW_BANK1 * 4, Conf_row_Buffer1);
-    // ------------------------bank2------------------------
-    addr_uint32 = binary_str_to_uint32(ROW_CNT_BANK2_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    if (match) {
+        xil_printf("Model banks match, load skipped.\r\n");
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_ROW_BANK2 * 4, Conf_row_Buffer2);
-    // ------------------------bank3------------------------
-    addr_uint32 = binary_str_to_uint32(ROW_CNT_BANK3_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+
+    // load model block index, row count, ccl index and weight banks, then the
+    // class start table and the early exit class bounds: unpack the next bank
+    // into the idle buffer while the current one is shifted out
+    for (int i = match ? MODEL_N_BANK : 0; i <= MODEL_N_BANK + 1; i++) {
+        buf ^= 1;
+        if (i < MODEL_N_BANK) {
+            byte_count = model_spi_bank(&Model, i, Spi_Tx_Buffer[buf]);
+        } else if (i == MODEL_N_BANK) {
+            byte_count = model_spi_class(&Model, Spi_Tx_Buffer[buf]);
+        } else {
+            byte_count = model_spi_bound(&Model, Spi_Tx_Buffer[buf]);
+        }
+        if (spi_wait() != XST_SUCCESS) {
+            return XST_FAILURE;
+        }
+        if (byte_count && spi_start(SpiInstancePtr, Spi_Tx_Buffer[buf], NULL, byte_count) != XST_SUCCESS) {
+            return XST_FAILURE;
+        }
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_ROW_BANK3 * 4, Conf_row_Buffer3);
-    // ------------------------bank4------------------------
-    addr_uint32 = binary_str_to_uint32(ROW_CNT_BANK4_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    if (spi_wait() != XST_SUCCESS) {
+        return XST_FAILURE;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_ROW_BANK4 * 4, Conf_row_Buffer4);
-    
+    inf_stride = Model.header->conf_reg[CONF_ADDR_INF_STRIDE] > 1 ? Model.header->conf_reg[CONF_ADDR_INF_STRIDE] : 1;
 
-    // load model ccl index 
-    // ------------------------bank0------------------------
-    addr_uint32 = binary_str_to_uint32(CCL_IDX_BANK0_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    // Start inference
+    u8 *p = Spi_Tx_Buffer[0];
+    u32 en_inf[2] = {CONF_SPI_EN_INF_ADDR, CONF_SPI_EN_INF_DATA};
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < 4; i++) {
+            *p++ = (en_inf[k] >> (24 - i * 8)) & 0xFF;
+        }
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_CCL_BANK0 * 4, Conf_ccl_Buffer0);
-    // ------------------------bank1------------------------
-    addr_uint32 = binary_str_to_uint32(CCL_IDX_BANK1_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    return SPIWrite(SpiInstancePtr, 0, 8, Spi_Tx_Buffer[0]);
+}
+
+
+// Skip the classes set in mask from the next inference on (0 runs them all).
+// EN_INF is cleared around the write, so no inference sees a half-written
+// register.
+int set_class_skip(XSpiPs *SpiInstancePtr, u16 mask){
+    u8 *p = Spi_Tx_Buffer[0];
+    u32 word[6] = {CONF_SPI_EN_INF_ADDR, 0,
+                   CONF_SPI_CLASS_SKIP_ADDR, mask,
+                   CONF_SPI_EN_INF_ADDR, CONF_SPI_EN_INF_DATA};
+
+    for (int k = 0; k < 6; k++) {
+        for (int i = 0; i < 4; i++) {
+            *p++ = (word[k] >> (24 - i * 8)) & 0xFF;
+        }
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_CCL_BANK1 * 4, Conf_ccl_Buffer1);
-    // ------------------------bank2------------------------
-    addr_uint32 = binary_str_to_uint32(CCL_IDX_BANK2_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    return SPIWrite(SpiInstancePtr, 0, 24, Spi_Tx_Buffer[0]);
+}
+
+
+// Run an inference on every stride-th window from the next one on (1-63).
+// The binarizer takes the new stride at its next window, so EN_INF stays set.
+int set_inf_stride(XSpiPs *SpiInstancePtr, u8 stride){
+    u8 *p = Spi_Tx_Buffer[0];
+    u32 word[2];
+
+    if (stride == 0) {
+        stride = 1;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_CCL_BANK2 * 4, Conf_ccl_Buffer2);
-    // ------------------------bank3------------------------
-    addr_uint32 = binary_str_to_uint32(CCL_IDX_BANK3_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    if (stride > CONF_INF_STRIDE_MAX) {
+        return XST_FAILURE;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_CCL_BANK3 * 4, Conf_ccl_Buffer3);
-    // ------------------------bank4------------------------
-    addr_uint32 = binary_str_to_uint32(CCL_IDX_BANK4_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
-    }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_CCL_BANK4 * 4, Conf_ccl_Buffer4);
-    
-    // load model weight
-    // ------------------------bank0------------------------
-    addr_uint32 = binary_str_to_uint32(WEIGHT_BANK0_CONFIG_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+    word[0] = CONF_SPI_INF_STRIDE_ADDR;
+    word[1] = stride;
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < 4; i++) {
+            *p++ = (word[k] >> (24 - i * 8)) & 0xFF;
+        }
+    }
+    if (SPIWrite(SpiInstancePtr, 0, 8, Spi_Tx_Buffer[0]) != XST_SUCCESS) {
+        return XST_FAILURE;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    SPIWrite(SpiInstancePtr, 0, LEN_WEIGHT_BANK * 4, Conf_weight_Buffer);
+    inf_stride = stride;
+    return XST_SUCCESS;
+}
 
-    // load data to feature bank
-    //SPIWrite(SpiInstancePtr, 0, 129 * 4, Conf_feature_bank_Buffer);
-    
-    // Start inference
-    // addr
-    addr_uint32 = binary_str_to_uint32(CONF_SPI_EN_INF_ADDR);
-    for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+
+u8 get_inf_stride(){
+    return inf_stride;
+}
+
+
+// Let the accelerator post-process the results (keyword_decision.sv): from
+// now on Inf_Done only rises for a keyword repeated run times within window
+// results, and Result holds it; the holdoff results after it are ignored.
+// A window of 0 turns it off and every inference interrupts again.
+int set_keyword_decision(XSpiPs *SpiInstancePtr, u8 window, u8 run, u8 holdoff){
+    u8 *p = Spi_Tx_Buffer[0];
+    u32 word[5] = {CONF_SPI_KWD_ADDR, window != 0, window, run, holdoff};
+
+    if (window > CONF_KWD_MAX || run > CONF_KWD_MAX || holdoff > CONF_KWD_MAX) {
+        return XST_FAILURE;
+    }
+    for (int k = 0; k < 5; k++) {
+        for (int i = 0; i < 4; i++) {
+            *p++ = (word[k] >> (24 - i * 8)) & 0xFF;
+        }
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
-    // data
-    addr_uint32 = binary_str_to_uint32(CONF_SPI_EN_INF_DATA);
+    return SPIWrite(SpiInstancePtr, 0, 20, Spi_Tx_Buffer[0]);
+}
+
+
+// One MISO read burst of n_word words from addr of a read command.
+static int spi_read(XSpiPs *SpiInstancePtr, u32 cmd, u32 bank_sel, u32 addr, u32 n_word, u32 *word){
+    u8 *p = Spi_Tx_Buffer[0];
+    u32 cmd_word = (cmd << 28) | (bank_sel << 25) | ((n_word - 1) << 12) | addr;
+
     for (int i = 0; i < 4; i++) {
-        addr_uint8[i] = (addr_uint32 >> (24 - i * 8)) & 0xFF;
+        *p++ = (cmd_word >> (24 - i * 8)) & 0xFF;
+    }
+    for (u32 i = 0; i < (1 + n_word) * 4; i++) {
+        *p++ = 0;
+    }
+    if (spi_start(SpiInstancePtr, Spi_Tx_Buffer[0], Spi_Rx_Buffer, (2 + n_word) * 4) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    if (spi_wait() != XST_SUCCESS) {
+        return XST_FAILURE;
     }
-    SPIWrite(SpiInstancePtr, 0, 4, addr_uint8);
 
+    // skip the command word and the turnaround frame
+    p = Spi_Rx_Buffer + 8;
+    for (u32 k = 0; k < n_word; k++, p += 4) {
+        word[k] = ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | p[3];
+    }
     return XST_SUCCESS;
 }
 
 
-void SPIWrite(XSpiPs *SpiPtr, u32 Offset, u32 ByteCount, u8 *Buffer)
+// Read the oldest record of the result FIFO; rec->valid is 0 if it was empty.
+// The record is popped as it is read, so call this once per Inf_Done.
+int read_result(XSpiPs *SpiInstancePtr, tkws_result_t *rec){
+    u32 num_class = Model.header->conf_reg[CONF_ADDR_NUM_CLASS];
+    u32 n_word = 2 + (num_class + 1) / 2;
+    u32 word[RESULT_MAX_WORDS];
+
+    if (spi_read(SpiInstancePtr, SPI_CMD_RESULT_FIFO, 0, 0, n_word, word) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    rec->valid = word[0] >> 31;
+    if (!rec->valid) {
+        return XST_SUCCESS;
+    }
+    rec->num_class = (word[0] >> 24) & 0xF;
+    rec->result    = (word[0] >> 20) & 0xF;
+    rec->frame_cnt = word[0] & 0xFFFF;
+    rec->margin    = word[1] & 0x3FFF;
+    for (u32 c = 0; c < 16; c++) {
+        rec->score[c] = c < num_class ? (s16)(word[2 + c / 2] >> (16 * (c % 2))) : -8192;
+    }
+    return XST_SUCCESS;
+}
+
+
+// Read the performance counters of the last inference; perf->valid is 0
+// before the first Inf_Done. They hold until the next Inf_Done.
+int read_perf_counters(XSpiPs *SpiInstancePtr, tkws_perf_t *perf){
+    u32 word[PERF_CNT_WORDS];
+
+    if (spi_read(SpiInstancePtr, SPI_CMD_READ_REG, SPI_READ_PERF_CNT, 0, PERF_CNT_WORDS, word) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    perf->valid = word[0] >> 31;
+    if (!perf->valid) {
+        return XST_SUCCESS;
+    }
+    perf->frame_cnt       = word[0] & 0xFFFF;
+    perf->cycle           = word[1];
+    perf->decode_cycle    = word[2];
+    perf->summation_cycle = word[3];
+    perf->fe_latency      = word[4];
+    perf->idle_cycle      = word[5];
+    for (int i = 0; i < MODEL_N_PE_COL; i++) {
+        perf->col_busy[i]  = word[6 + 2 * i];
+        perf->col_wait[i]  = word[7 + 2 * i];
+    }
+    return XST_SUCCESS;
+}
+
+
+// Read the status word; status->valid is 0 if nothing answers on MISO.
+int read_status(XSpiPs *SpiInstancePtr, tkws_status_t *status){
+    u32 word;
+
+    if (spi_read(SpiInstancePtr, SPI_CMD_READ_REG, SPI_READ_STATUS, 0, 1, &word) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    status->valid       = word >> 31;
+    status->busy        = (word >> 30) & 0x1;
+    status->crc_valid   = (word >> 29) & 0x1;
+    status->result_cnt  = (word >> 24) & 0x7;
+    status->result      = (word >> 20) & 0xF;
+    status->last_result = (word >> 16) & 0xF;
+    status->done_cnt    = word & 0xFFFF;
+    return XST_SUCCESS;
+}
+
+
+// Compare the bank CRCs of the accelerator with the model; *match is 0 if
+// any differs, or if the accelerator does not answer. The CRCs are
+// recomputed after every bank or configuration register write, which takes
+// one system clock cycle per bank word while no inference runs.
+int check_model_banks(XSpiPs *SpiInstancePtr, u8 *match){
+    tkws_status_t status = {0};
+    u32 crc[MODEL_N_BANK];
+
+    *match = 0;
+    for (int i = 0; i < CRC_MAX_POLL; i++) {
+        if (read_status(SpiInstancePtr, &status) != XST_SUCCESS) {
+            return XST_FAILURE;
+        }
+        if (!status.valid || status.crc_valid) {
+            break;
+        }
+        usleep(CRC_POLL_US);
+    }
+    if (!status.valid || !status.crc_valid) {
+        return XST_SUCCESS;
+    }
+    if (spi_read(SpiInstancePtr, SPI_CMD_READ_REG, SPI_READ_BANK_CRC, 0, MODEL_N_BANK, crc) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    for (int i = 0; i < MODEL_N_BANK; i++) {
+        if (crc[i] != model_bank_crc(&Model, i)) {
+            return XST_SUCCESS;
+        }
+    }
+    *match = 1;
+    return XST_SUCCESS;
+}
+
+
+int SPIWrite(XSpiPs *SpiPtr, u32 Offset, u32 ByteCount, u8 *Buffer)
 {   
     u8 *buffer_start;
     buffer_start = Buffer + Offset;
-    XSpiPs_PolledTransfer(SpiPtr, buffer_start, NULL, ByteCount);
+    if (spi_start(SpiPtr, buffer_start, NULL, ByteCount) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+    return spi_wait();
 }
@@ -3,68 +3,71 @@
 
 #include <stdio.h>
 #include "tf_card.h"
+#include "tkws_model.h"
 #include "xspips.h"
+#include "xscugic.h"
 #include "xparameters.h"
 
 
 // file name
-#define CONF_REG_FILE_NAME          "spi_config_reg.txt"
-#define CONF_BLOCK_BANK_FILE_NAME   "block_idx_bank.dat"
-#define CONF_ROW_BANK0_FILE_NAME    "row_cnt_bank0.dat"
-#define CONF_ROW_BANK1_FILE_NAME    "row_cnt_bank1.dat"
-#define CONF_ROW_BANK2_FILE_NAME    "row_cnt_bank2.dat"
-#define CONF_ROW_BANK3_FILE_NAME    "row_cnt_bank3.dat"
-#define CONF_ROW_BANK4_FILE_NAME    "row_cnt_bank4.dat"
-
-#define CONF_CCL_BANK0_FILE_NAME    "col_cla_idx_bank0.dat"
-#define CONF_CCL_BANK1_FILE_NAME    "col_cla_idx_bank1.dat"
-#define CONF_CCL_BANK2_FILE_NAME    "col_cla_idx_bank2.dat"
-#define CONF_CCL_BANK3_FILE_NAME    "col_cla_idx_bank3.dat"
-#define CONF_CCL_BANK4_FILE_NAME    "col_cla_idx_bank4.dat"
-
-#define CONF_WEIGHT_BANK_FILE_NAME  "weight_bank.dat"
-
-// define file length
-#define LEN_CONF_REG        28
-#define LEN_BLOCK_BANK      1152
-#define LEN_ROW_BANK0       1592
-#define LEN_ROW_BANK1       1618
-#define LEN_ROW_BANK2       1627
-#define LEN_ROW_BANK3       1614
-#define LEN_ROW_BANK4       1668
-
-#define LEN_CCL_BANK0       3127
-#define LEN_CCL_BANK1       3114
-#define LEN_CCL_BANK2       3099
-#define LEN_CCL_BANK3       3108
-#define LEN_CCL_BANK4       3186
-
-#define LEN_WEIGHT_BANK     1440
+#define CONF_MODEL_FILE_NAME        MODEL_FILE_NAME
+
+
+// One record of the result FIFO (result_fifo.sv), written at every Inf_Done
+typedef struct {
+    u8  valid;          // 0 if the FIFO was empty
+    u8  num_class;
+    u8  result;
+    u16 frame_cnt;      // counts every Inf_Done, a gap means dropped records
+    u16 margin;         // lead over the second best class
+    s16 score[16];      // class sums, -8192 for the classes not summed
+} tkws_result_t;
+
+// Performance counters of the last inference (perf_counter.sv), copied at
+// every Inf_Done. A PE column is busy with pe_ena set, waiting while another
+// column is busy and idle while none is.
+typedef struct {
+    u8  valid;          // 0 before the first Inf_Done
+    u16 frame_cnt;      // Inf_Done number, as in the result FIFO
+    u32 cycle;          // decode_en or tail_flush_en cycles
+    u32 decode_cycle;
+    u32 summation_cycle;
+    u32 fe_latency;     // cycles the window waited for the accelerator
+    u32 idle_cycle;
+    u32 col_busy[MODEL_N_PE_COL];
+    u32 col_wait[MODEL_N_PE_COL];
+} tkws_perf_t;
+
+// Status word (spi_readback.sv). done_cnt counts every Inf_Done, so polling
+// it can replace the Inf_Done interrupt.
+typedef struct {
+    u8  valid;          // 0 if nothing answers on MISO
+    u8  busy;           // an inference is running
+    u8  crc_valid;      // the bank CRCs match the banks
+    u8  result_cnt;     // records in the result FIFO
+    u8  result;         // Result pin
+    u8  last_result;    // argmax of the last inference
+    u16 done_cnt;
+} tkws_status_t;
 
 
 // declaration buffer
-u8 Conf_reg_Buffer  [LEN_CONF_REG * 4];
-u8 Conf_block_Buffer[LEN_BLOCK_BANK * 4];
-u8 Conf_row_Buffer0 [LEN_ROW_BANK0  * 4];
-u8 Conf_row_Buffer1 [LEN_ROW_BANK1  * 4];
-u8 Conf_row_Buffer2 [LEN_ROW_BANK2  * 4];
-u8 Conf_row_Buffer3 [LEN_ROW_BANK3  * 4];
-u8 Conf_row_Buffer4 [LEN_ROW_BANK4  * 4];
+u32 Model_File_Buffer[MODEL_MAX_FILE_SIZE / 4];         // model.tkm as read from the TF card
+u8  Spi_Tx_Buffer    [2][MODEL_MAX_SPI_WORDS * 4];      // ping-pong SPI transactions, big-endian words
+tkws_model_t Model;
 
-u8 Conf_ccl_Buffer0 [LEN_CCL_BANK0  * 4];
-u8 Conf_ccl_Buffer1 [LEN_CCL_BANK1  * 4];
-u8 Conf_ccl_Buffer2 [LEN_CCL_BANK2  * 4];
-u8 Conf_ccl_Buffer3 [LEN_CCL_BANK3  * 4];
-u8 Conf_ccl_Buffer4 [LEN_CCL_BANK4  * 4];
-
-u8 Conf_weight_Buffer[(LEN_WEIGHT_BANK) * 4];
-
-u8 Conf_feature_bank_Buffer  [129 * 4];
-
-uint32_t binary_str_to_uint32(char *str);
-void read_model_data();
+int read_model_data();
+int setup_spi_interrupt(XScuGic *gic_inst_ptr, XSpiPs *SpiInstancePtr, u16 SpiIntrId);
 int initial_TMA(XSpiPs *SpiInstancePtr);
-void SPIWrite(XSpiPs *SpiPtr, u32 Offset, u32 ByteCount, u8 *Buffer);
-
-
-#endif
\ No newline at end of file
+int set_class_skip(XSpiPs *SpiInstancePtr, u16 mask);
+int set_inf_stride(XSpiPs *SpiInstancePtr, u8 stride);
+u8 get_inf_stride();
+int read_result(XSpiPs *SpiInstancePtr, tkws_result_t *rec);
+int read_perf_counters(XSpiPs *SpiInstancePtr, tkws_perf_t *perf);
+int read_status(XSpiPs *SpiInstancePtr, tkws_status_t *status);
+int check_model_banks(XSpiPs *SpiInstancePtr, u8 *match);
+int set_keyword_decision(XSpiPs *SpiInstancePtr, u8 window, u8 run, u8 holdoff);
+int SPIWrite(XSpiPs *SpiPtr, u32 Offset, u32 ByteCount, u8 *Buffer);
+
+
+#endif
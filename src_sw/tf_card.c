@@ -135,3 +135,37 @@ int sd_read_hex(char *file_name, u8 *dest_buf, u32 max_lines) {
     f_close(&fil);
     return error ? -1 : 0;
 }
+
+/**
+ * @brief Read a whole file into a buffer with one f_read.
+ * @param file_name: File name.
+ * @param dest_buf: Target memory address.
+ * @param max_size: Size of the buffer in bytes.
+ * @param size: Returns the file size in bytes.
+ * @return Success returns 0, failure (or a file larger than max_size) returns -1.
+ */
+int sd_read_file(char *file_name, u8 *dest_buf, u32 max_size, u32 *size) {
+    FIL fil;
+    FRESULT res;
+    UINT br;
+
+    res = f_open(&fil, file_name, FA_READ);
+    if (res != FR_OK) {
+        printf("Error: Failed to open file.\n");
+        return -1;
+    }
+    if (f_size(&fil) > max_size) {
+        printf("Error: File is too large.\n");
+        f_close(&fil);
+        return -1;
+    }
+
+    *size = f_size(&fil);
+    res = f_read(&fil, dest_buf, *size, &br);
+    f_close(&fil);
+    if (res != FR_OK || br != *size) {
+        printf("Error: Failed to read file.\n");
+        return -1;
+    }
+    return 0;
+}
@@ -10,5 +10,6 @@ int platform_init_fs();
 int sd_mount();
 int sd_read_binary(char *file_name, u8 *src_addr, u32 bit_len, u32 max_lines);
 int sd_read_hex(char *file_name, u8 *dest_buf, u32 max_lines);
+int sd_read_file(char *file_name, u8 *dest_buf, u32 max_size, u32 *size);
 
 #endif
@@ -0,0 +1,282 @@
+#include "tkws_model.h"
+#include <stddef.h>
+#include "xil_printf.h"
+
+#define SPI_CMD_CONF_REG    0
+
+// Banks in payload (and SPI load) order
+typedef struct {
+    u8 cmd;         // SPI A[30:28]
+    u8 bank_sel;    // SPI A[27:25]
+    u8 bits;        // word width
+    u8 len_addr;    // config_addr of the length register
+} model_bank_t;
+
+// Bank i: the block index bank, the row count banks, the CCL index banks
+// (one per column, in bank_sel order), then the weight bank.
+static model_bank_t model_bank(int i)
+{
+    model_bank_t b;
+
+    if (i == 0) {
+        b = (model_bank_t){1, 0, 4 * MODEL_N_PE_COL, CONF_ADDR_LEN_BLOCK_BANK};
+    } else if (i <= MODEL_N_PE_COL) {
+        b = (model_bank_t){2, i - 1, 6, CONF_ADDR_LEN_ROW_BANK + i - 1};
+    } else if (i <= 2 * MODEL_N_PE_COL) {
+        b = (model_bank_t){3, i - 1 - MODEL_N_PE_COL, 5, CONF_ADDR_LEN_CCL_BANK + i - 1 - MODEL_N_PE_COL};
+    } else {
+        b = (model_bank_t){4, 0, 9, CONF_ADDR_LEN_WEIGHT_BANK};
+    }
+    return b;
+}
+
+// Configuration register bursts: {first config_addr, number of registers}
+static const u8 model_conf_burst[][2] = {
+    {CONF_ADDR_EN_CONF,         1},
+    {CONF_ADDR_EN_FE,           1},
+    {CONF_ADDR_NUM_CLASS,       1},
+    {CONF_ADDR_NUM_CLAUSE,      1},
+    {CONF_ADDR_NUM_SUM_TIME,    1},
+    {CONF_ADDR_FLUX_TH,         1},
+    {CONF_ADDR_LEN_BLOCK_BANK,  1},
+    {CONF_ADDR_LEN_ROW_BANK,    MODEL_N_PE_COL},
+    {CONF_ADDR_LEN_CCL_BANK,    MODEL_N_PE_COL},
+    {CONF_ADDR_LEN_WEIGHT_BANK, 1},
+};
+
+
+u32 model_crc32(const u8 *data, u32 size)
+{
+    u32 crc = 0xFFFFFFFF;
+    for (u32 i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static u32 spi_write_word(u32 cmd, u32 bank_sel, u32 burst_len, u32 addr, u32 pack)
+{
+    return (1U << 31) | (cmd << 28) | (bank_sel << 25) | (pack << 24) | ((burst_len - 1) << 12) | addr;
+}
+
+// bits-wide field at bit offset bit of a packed bank (up to 32 bits, the
+// block index word on 8 columns)
+static u32 get_bits(const u32 *src, u32 bit, u32 bits)
+{
+    u32 value = src[bit / 32] >> (bit % 32);
+    if (bit % 32 + bits > 32) {
+        value |= src[bit / 32 + 1] << (32 - bit % 32);
+    }
+    return (bits < 32) ? value & ((1U << bits) - 1) : value;
+}
+
+// SPI shifts every word MSB first
+static u8 *put_spi_word(u8 *buf, u32 value)
+{
+    buf[0] = (value >> 24) & 0xFF;
+    buf[1] = (value >> 16) & 0xFF;
+    buf[2] = (value >> 8) & 0xFF;
+    buf[3] = value & 0xFF;
+    return buf + 4;
+}
+
+int model_parse(tkws_model_t *model, const u8 *file, u32 size)
+{
+    const model_header_t *header = (const model_header_t *)file;
+    model_header_t check;
+    u32 offset = 0;
+
+    if (size < MODEL_HEADER_SIZE || header->magic != MODEL_FILE_MAGIC) {
+        xil_printf("Error: not a model file.\r\n");
+        return -1;
+    }
+    if (header->version != MODEL_FILE_VERSION || header->header_size != MODEL_HEADER_SIZE) {
+        xil_printf("Error: unsupported model file version %d.\r\n", header->version);
+        return -1;
+    }
+    if (header->n_pe_col != MODEL_N_PE_COL) {
+        xil_printf("Error: model is built for %d PE columns.\r\n", header->n_pe_col);
+        return -1;
+    }
+
+    check = *header;
+    check.header_crc = 0;
+    if (model_crc32((const u8 *)&check, MODEL_HEADER_SIZE) != header->header_crc) {
+        xil_printf("Error: model header CRC mismatch.\r\n");
+        return -1;
+    }
+    if (header->payload_size != size - MODEL_HEADER_SIZE ||
+        model_crc32(file + MODEL_HEADER_SIZE, header->payload_size) != header->payload_crc) {
+        xil_printf("Error: model payload is truncated or corrupt.\r\n");
+        return -1;
+    }
+
+    for (int i = 0; i < MODEL_N_BANK; i++) {
+        u32 len = header->conf_reg[model_bank(i).len_addr];
+        if (len >= MODEL_MAX_SPI_WORDS) {
+            xil_printf("Error: model bank %d is too long.\r\n", i);
+            return -1;
+        }
+        model->bank_offset[i] = offset / 4;
+        offset += MODEL_PACKED_SIZE(len, model_bank(i).bits);
+    }
+    if (offset != header->payload_size) {
+        xil_printf("Error: model bank lengths do not match the payload.\r\n");
+        return -1;
+    }
+
+    model->header = header;
+    model->payload = (const u32 *)(file + MODEL_HEADER_SIZE);
+    return 0;
+}
+
+u32 model_bank_len(const tkws_model_t *model, int bank)
+{
+    return model->header->conf_reg[model_bank(bank).len_addr];
+}
+
+u32 model_bank_crc(const tkws_model_t *model, int bank)
+{
+    const model_bank_t b = model_bank(bank);
+    const u32 *src = model->payload + model->bank_offset[bank];
+    const u32 len = model_bank_len(model, bank);
+    u32 crc = 0xFFFFFFFF;
+
+    for (u32 i = 0; i < len; i++) {
+        crc ^= get_bits(src, i * b.bits, b.bits);
+        for (int k = 0; k < 32; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+u32 model_spi_conf(const tkws_model_t *model, u8 *spi_buf)
+{
+    u8 *p = spi_buf;
+
+    for (u32 i = 0; i < sizeof(model_conf_burst) / sizeof(model_conf_burst[0]); i++) {
+        u32 addr = model_conf_burst[i][0];
+        u32 n = model_conf_burst[i][1];
+        p = put_spi_word(p, spi_write_word(SPI_CMD_CONF_REG, 0, n, addr, 0));
+        for (u32 k = 0; k < n; k++) {
+            p = put_spi_word(p, model->header->conf_reg[addr + k]);
+        }
+    }
+    if (model->header->conf_reg[CONF_ADDR_EN_EARLY_EXIT]) {
+        p = put_spi_word(p, spi_write_word(SPI_CMD_CONF_REG, 0, 1, CONF_ADDR_EN_EARLY_EXIT, 0));
+        p = put_spi_word(p, 1);
+    }
+    if (model->header->conf_reg[CONF_ADDR_CLASS_SKIP]) {
+        p = put_spi_word(p, spi_write_word(SPI_CMD_CONF_REG, 0, 1, CONF_ADDR_CLASS_SKIP, 0));
+        p = put_spi_word(p, model->header->conf_reg[CONF_ADDR_CLASS_SKIP]);
+    }
+    if (model->header->conf_reg[CONF_ADDR_INF_STRIDE] > 1) {
+        p = put_spi_word(p, spi_write_word(SPI_CMD_CONF_REG, 0, 1, CONF_ADDR_INF_STRIDE, 0));
+        p = put_spi_word(p, model->header->conf_reg[CONF_ADDR_INF_STRIDE]);
+    }
+    // keyword_decision.sv also takes SPI_VAD_CLASS as the silence class
+    if (model->header->conf_reg[CONF_ADDR_VAD_TH] || model->header->conf_reg[CONF_ADDR_VAD_CLASS] != VAD_CLASS_RESET) {
+        p = put_spi_word(p, spi_write_word(SPI_CMD_CONF_REG, 0, 2, CONF_ADDR_VAD_TH, 0));
+        p = put_spi_word(p, model->header->conf_reg[CONF_ADDR_VAD_TH]);
+        p = put_spi_word(p, model->header->conf_reg[CONF_ADDR_VAD_CLASS]);
+    }
+    if (model->header->conf_reg[CONF_ADDR_EN_KWD]) {
+        p = put_spi_word(p, spi_write_word(SPI_CMD_CONF_REG, 0, 4, CONF_ADDR_EN_KWD, 0));
+        for (u32 k = 0; k < 4; k++) {
+            p = put_spi_word(p, model->header->conf_reg[CONF_ADDR_EN_KWD + k]);
+        }
+    }
+    return p - spi_buf;
+}
+
+u32 model_spi_bank(const tkws_model_t *model, int bank, u8 *spi_buf)
+{
+    const model_bank_t b = model_bank(bank);
+    const u32 *src = model->payload + model->bank_offset[bank];
+    const u32 len = model_bank_len(model, bank);
+    const u32 n = 32 / b.bits;     // words per packed SPI frame (1 for the block index)
+    u8 *p = spi_buf;
+
+    if (len == 0) {
+        return 0;
+    }
+    p = put_spi_word(p, spi_write_word(b.cmd, b.bank_sel, len, 0, n > 1));
+    for (u32 i = 0; i < len; i += n) {
+        u32 frame = 0;
+        for (u32 k = 0; k < n && i + k < len; k++) {
+            frame |= get_bits(src, (i + k) * b.bits, b.bits) << (k * b.bits);
+        }
+        p = put_spi_word(p, frame);
+    }
+    return p - spi_buf;
+}
+
+u32 model_spi_class(const tkws_model_t *model, u8 *spi_buf)
+{
+    const u32 *conf = model->header->conf_reg;
+    const u32 *block = model->payload + model->bank_offset[0];
+    const u32 class_len_block = 32 * conf[CONF_ADDR_NUM_SUM_TIME];     // blocks per class
+    u32 row_addr[MODEL_N_PE_COL] = {0};
+    u32 ccl_addr[MODEL_N_PE_COL] = {0};
+    u8 *p = spi_buf;
+
+    if (class_len_block == 0 || conf[CONF_ADDR_LEN_BLOCK_BANK] != conf[CONF_ADDR_NUM_CLASS] * class_len_block) {
+        return 0;
+    }
+    p = put_spi_word(p, spi_write_word(model_bank(0).cmd, 1, 8 * conf[CONF_ADDR_NUM_CLASS], 0, 0));
+    for (u32 b = 0; b < conf[CONF_ADDR_LEN_BLOCK_BANK]; b++) {
+        u32 nib = get_bits(block, b * model_bank(0).bits, model_bank(0).bits);
+
+        if (b % class_len_block == 0 && b / class_len_block < conf[CONF_ADDR_NUM_CLASS]) {
+            for (u32 k = 0; k < 8; k++) {
+                p = put_spi_word(p, k < MODEL_N_PE_COL ? (row_addr[k] << 16) | ccl_addr[k] : 0);
+            }
+        }
+        // every set bit takes one row count word, which takes its two
+        // counters' worth of CCL index words
+        for (u32 k = 0; k < MODEL_N_PE_COL; k++, nib >>= 4) {
+            const u32 *row = model->payload + model->bank_offset[1 + k];
+            for (u32 e = 0; e < 4; e++) {
+                if ((nib >> e) & 1) {
+                    u32 cnt = get_bits(row, row_addr[k] * model_bank(1 + k).bits, model_bank(1 + k).bits);
+                    row_addr[k]++;
+                    ccl_addr[k] += (cnt & 0x7) + ((cnt >> 3) & 0x7);
+                }
+            }
+        }
+    }
+    return p - spi_buf;
+}
+
+u32 model_spi_bound(const tkws_model_t *model, u8 *spi_buf)
+{
+    const u32 *conf = model->header->conf_reg;
+    const model_bank_t b = model_bank(MODEL_N_BANK - 1);
+    const u32 *src = model->payload + model->bank_offset[MODEL_N_BANK - 1];
+    const u32 len = conf[CONF_ADDR_LEN_WEIGHT_BANK];
+    const u32 n_weight = 4 * MODEL_N_PE_COL * 2 * conf[CONF_ADDR_NUM_SUM_TIME];    // weights per class
+    u8 *p = spi_buf;
+
+    if (!conf[CONF_ADDR_EN_EARLY_EXIT] || len == 0) {
+        return 0;
+    }
+    p = put_spi_word(p, spi_write_word(b.cmd, 1, conf[CONF_ADDR_NUM_CLASS], 0, 0));
+    for (u32 c = 0; c < conf[CONF_ADDR_NUM_CLASS]; c++) {
+        int pos = 0, neg = 0;
+        for (u32 i = c * n_weight; i < (c + 1) * n_weight; i++) {
+            int w = get_bits(src, (i % len) * b.bits, b.bits);
+            w = (w & 0x100) ? w - 512 : w;      // 9-bit two's complement
+            if (w > 0) {
+                pos += w;
+            } else {
+                neg += w;
+            }
+        }
+        p = put_spi_word(p, (pos > 8191 || neg < -8192) ? 8191 : pos);
+    }
+    return p - spi_buf;
+}
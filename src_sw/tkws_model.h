@@ -0,0 +1,110 @@
+#ifndef __TKWS_MODEL_H
+#define __TKWS_MODEL_H
+
+#include "xil_types.h"
+
+// Packed model container written by src_model (tkws_ogbcsr, model/model.tkm).
+// Little-endian: a header with the configuration registers and the bank
+// lengths (160 bytes up to 7 PE columns), then the banks bit-packed LSB first
+// in SPI load order, each starting on a 32-bit word boundary. Header and
+// payload are CRC-32 protected.
+#define MODEL_FILE_NAME             "model.tkm"
+#define MODEL_FILE_MAGIC            0x4D574B54      // "TKWM"
+#define MODEL_FILE_VERSION          1
+#define MODEL_HEADER_SIZE           (32 + 4 * MODEL_N_CONF_REG)
+
+// PE columns of the accelerator (N_PE_COL of TsetlinKWS.sv), 1 to 8
+#ifndef MODEL_N_PE_COL
+#define MODEL_N_PE_COL              5
+#endif
+#define MODEL_N_CONF_REG            (CONF_ADDR_KWD_HOLDOFF < 32 ? 32 : CONF_ADDR_KWD_HOLDOFF + 1)
+#define MODEL_N_BANK                (2 + 2 * MODEL_N_PE_COL)
+
+// config_addr of the SPI configuration registers (spi_slave.sv)
+#define CONF_ADDR_EN_CONF           0
+#define CONF_ADDR_EN_INF            1
+#define CONF_ADDR_EN_FE             2
+#define CONF_ADDR_NUM_CLASS         3
+#define CONF_ADDR_NUM_CLAUSE        4
+#define CONF_ADDR_NUM_SUM_TIME      5
+#define CONF_ADDR_FLUX_TH           6
+#define CONF_ADDR_LEN_BLOCK_BANK    7
+#define CONF_ADDR_LEN_ROW_BANK      8
+#define CONF_ADDR_LEN_CCL_BANK      (CONF_ADDR_LEN_ROW_BANK + MODEL_N_PE_COL)
+#define CONF_ADDR_LEN_WEIGHT_BANK   (CONF_ADDR_LEN_CCL_BANK + MODEL_N_PE_COL)
+#define CONF_ADDR_EN_EARLY_EXIT     (CONF_ADDR_LEN_WEIGHT_BANK + 1)
+#define CONF_ADDR_CLASS_SKIP        (CONF_ADDR_EN_EARLY_EXIT + 1)
+#define CONF_ADDR_INF_STRIDE        (CONF_ADDR_CLASS_SKIP + 1)
+#define CONF_ADDR_VAD_TH            (CONF_ADDR_INF_STRIDE + 1)
+#define CONF_ADDR_VAD_CLASS         (CONF_ADDR_VAD_TH + 1)
+#define CONF_ADDR_EN_KWD            (CONF_ADDR_VAD_CLASS + 1)
+#define CONF_ADDR_KWD_WINDOW        (CONF_ADDR_EN_KWD + 1)
+#define CONF_ADDR_KWD_RUN           (CONF_ADDR_KWD_WINDOW + 1)
+#define CONF_ADDR_KWD_HOLDOFF       (CONF_ADDR_KWD_RUN + 1)
+
+// SPI_VAD_CLASS after reset, the silence class of the shipped model
+#define VAD_CLASS_RESET             10
+
+// Bytes of len words packed at bits each, and the largest payload the length
+// registers allow (11-bit lengths, 12-bit for the CCL banks).
+#define MODEL_PACKED_SIZE(len, bits)    (4 * (((len) * (bits) + 31) / 32))
+#define MODEL_MAX_PAYLOAD_SIZE      (MODEL_PACKED_SIZE(2047, 4 * MODEL_N_PE_COL) +      \
+                                     MODEL_N_PE_COL * MODEL_PACKED_SIZE(2047, 6) +      \
+                                     MODEL_N_PE_COL * MODEL_PACKED_SIZE(4095, 5) +      \
+                                     MODEL_PACKED_SIZE(2047, 9))
+#define MODEL_MAX_FILE_SIZE         (MODEL_HEADER_SIZE + MODEL_MAX_PAYLOAD_SIZE)
+
+// Longest SPI transaction: the address word and a full CCL bank.
+#define MODEL_MAX_SPI_WORDS         (1 + 4095)
+
+typedef struct {
+    u32 magic;
+    u16 version;
+    u16 header_size;
+    u16 n_pe_col;
+    u16 reserved0;
+    u32 payload_size;
+    u32 payload_crc;
+    u32 reserved1[2];
+    u32 header_crc;                         // computed with this field set to 0
+    u32 conf_reg[MODEL_N_CONF_REG];         // indexed by config_addr
+} model_header_t;
+
+typedef struct {
+    const model_header_t   *header;
+    const u32              *payload;
+    u32                     bank_offset[MODEL_N_BANK];  // in payload words
+} tkws_model_t;
+
+u32 model_crc32(const u8 *data, u32 size);
+
+// Check the header and payload of a model file read into memory (32-bit
+// aligned) and locate the banks. Returns 0 on success, -1 on failure.
+int model_parse(tkws_model_t *model, const u8 *file, u32 size);
+
+u32 model_bank_len(const tkws_model_t *model, int bank);
+
+// CRC-32 of a bank as the accelerator computes it (spi_readback.sv): over its
+// model_bank_len() words, each zero extended to 32 bits and taken as 4
+// little-endian bytes.
+u32 model_bank_crc(const tkws_model_t *model, int bank);
+
+// Fill spi_buf with big-endian SPI words and return the byte count: the
+// configuration register bursts (EN_INF left clear), or the write command
+// and words of bank 0 (block index), 1-5 (row count), 6-10 (column/clause
+// index) or 11 (weight). The row count, CCL index and weight banks are sent
+// as packed bursts (5, 6 and 3 words per SPI frame).
+u32 model_spi_conf(const tkws_model_t *model, u8 *spi_buf);
+u32 model_spi_bank(const tkws_model_t *model, int bank, u8 *spi_buf);
+
+// Class start table (block index burst, bank_sel 1): for every class and PE
+// column, the row count and CCL index address of its first block, which
+// lets the decoder skip the classes set in CLASS_SKIP.
+u32 model_spi_class(const tkws_model_t *model, u8 *spi_buf);
+
+// Class bound table for the early exit (weight burst, bank_sel 1): the sum
+// of the positive weights of every class, 8191 if class_summation could
+// wrap. Returns 0 when the model leaves EN_EARLY_EXIT clear.
+u32 model_spi_bound(const tkws_model_t *model, u8 *spi_buf);
+
+#endif